@@ -0,0 +1,159 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Replacement of the global operator new (and delete) counting every allocation of the program and
+// attributing it to the stage the allocating thread is in (CurrentStageLabel, see
+// utils/StageInstrumentation.h). Within atlasUtilsBenchmarks the label is the benchmark
+// (name/resolution), or the innermost instrumented stage if ATLAS_UTILS_INSTRUMENT is on as well.
+// Threads spawned by ParallelFor do not inherit the label, their allocations are reported as
+// outside of any stage. Only allocations are counted, deallocations are forwarded to free.
+//
+// The table is printed at program exit, AllocationsOfStage (AllocationHook.h) queries a single
+// stage. Only linked into the benchmarks if the cmake option ATLAS_UTILS_INTERFACE_COUNTERS is on,
+// since every allocation takes a (short) detour.
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+
+#include "../utils/StageInstrumentation.h"
+
+#include "AllocationHook.h"
+
+namespace {
+
+// the hook must not allocate itself, all state lives in fixed size, constant initialized tables
+constexpr int maxLabels = 256;
+constexpr int labelLength = 96;
+const char* const noLabel = "(outside of stages)";
+
+struct LabelAllocations {
+  char label[labelLength];
+  std::atomic<long> allocations;
+  std::atomic<long> bytes;
+};
+
+LabelAllocations table[maxLabels];
+std::atomic<int> tableSize{0};
+std::mutex tableMutex;
+
+// index of the last label looked up by the calling thread
+thread_local int lastIdx = -1;
+
+// index of the table entry of label, inserted if new. labels beyond maxLabels share the last entry
+int LabelIndex(const char* label) {
+  if(lastIdx >= 0 && strncmp(table[lastIdx].label, label, labelLength - 1) == 0) {
+    return lastIdx;
+  }
+  std::lock_guard<std::mutex> lock(tableMutex);
+  const int size = tableSize.load();
+  int idx = 0;
+  while(idx < size && strncmp(table[idx].label, label, labelLength - 1) != 0) {
+    idx++;
+  }
+  if(idx == size) {
+    if(size < maxLabels) {
+      strncpy(table[idx].label, label, labelLength - 1);
+      tableSize = size + 1;
+    } else {
+      idx = maxLabels - 1;
+    }
+  }
+  lastIdx = idx;
+  return idx;
+}
+
+void CountAllocation(std::size_t size) {
+  const char* label = CurrentStageLabel();
+  LabelAllocations& entry = table[LabelIndex(label ? label : noLabel)];
+  entry.allocations.fetch_add(1, std::memory_order_relaxed);
+  entry.bytes.fetch_add(long(size), std::memory_order_relaxed);
+}
+
+void* Allocate(std::size_t size) {
+  CountAllocation(size);
+  if(void* ptr = malloc(size ? size : 1)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void* AllocateAligned(std::size_t size, std::align_val_t alignment) {
+  CountAllocation(size);
+  // aligned_alloc requires the size to be a multiple of the alignment
+  const std::size_t align = std::size_t(alignment);
+  if(void* ptr = aligned_alloc(align, (size + align - 1) / align * align)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+struct AllocationReport {
+  ~AllocationReport() {
+    const int size = tableSize.load();
+    printf("\nallocations per stage:\n");
+    printf("%-48s %14s %16s\n", "stage", "allocations", "bytes");
+    for(int idx = 0; idx < size; idx++) {
+      printf("%-48s %14ld %16ld\n", table[idx].label, table[idx].allocations.load(),
+             table[idx].bytes.load());
+    }
+  }
+} allocationReport;
+
+} // namespace
+
+StageAllocations AllocationsOfStage(const char* label) {
+  std::lock_guard<std::mutex> lock(tableMutex);
+  StageAllocations allocations;
+  for(int idx = 0; idx < tableSize.load(); idx++) {
+    if(strncmp(table[idx].label, label, labelLength - 1) == 0) {
+      allocations.allocations = table[idx].allocations.load();
+      allocations.bytes = table[idx].bytes.load();
+    }
+  }
+  return allocations;
+}
+
+void* operator new(std::size_t size) { return Allocate(size); }
+void* operator new[](std::size_t size) { return Allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+  try {
+    return Allocate(size);
+  } catch(const std::bad_alloc&) {
+    return nullptr;
+  }
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+  return operator new(size, std::nothrow);
+}
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  return AllocateAligned(size, alignment);
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+  return AllocateAligned(size, alignment);
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+void operator delete[](void* ptr) noexcept { free(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { free(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { free(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { free(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { free(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { free(ptr); }
@@ -0,0 +1,25 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Queries of the allocation counts of AllocationHook.cpp, which needs to be linked in
+
+#pragma once
+
+struct StageAllocations {
+  long allocations = 0;
+  long bytes = 0;
+};
+
+// allocations attributed to the stage label so far, 0 if there have been none
+StageAllocations AllocationsOfStage(const char* label);
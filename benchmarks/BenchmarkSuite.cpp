@@ -0,0 +1,247 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "BenchmarkSuite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <numeric>
+#include <optional>
+
+#include "../utils/MemoryFootprint.h"
+#include "../utils/ParallelFor.h"
+#include "../utils/StageInstrumentation.h"
+#include "../utils/WallClock.h"
+
+namespace {
+std::string jsonEscape(const std::string& str) {
+  std::string escaped;
+  for(char c : str) {
+    if(c == '"' || c == '\\') {
+      escaped += '\\';
+    }
+    escaped += c;
+  }
+  return escaped;
+}
+
+bool parseInt(const std::string& str, int& value) {
+  char* end = nullptr;
+  long parsed = strtol(str.c_str(), &end, 10);
+  if(str.empty() || *end != '\0' || parsed < 0) {
+    return false;
+  }
+  value = int(parsed);
+  return true;
+}
+
+// num / den, 0 for a zero denominator (inf and nan are not valid json)
+double ratio(double num, double den) { return den > 0. ? num / den : 0.; }
+} // namespace
+
+double BenchmarkResult::minTime() const { return *std::min_element(times.begin(), times.end()); }
+double BenchmarkResult::maxTime() const { return *std::max_element(times.begin(), times.end()); }
+double BenchmarkResult::meanTime() const {
+  return std::accumulate(times.begin(), times.end(), 0.) / times.size();
+}
+double BenchmarkResult::medianTime() const {
+  std::vector<double> sorted = times;
+  std::sort(sorted.begin(), sorted.end());
+  const int mid = sorted.size() / 2;
+  return sorted.size() % 2 == 1 ? sorted[mid] : 0.5 * (sorted[mid - 1] + sorted[mid]);
+}
+double BenchmarkResult::stddevTime() const {
+  if(times.size() < 2) {
+    return 0.;
+  }
+  const double mean = meanTime();
+  double sumSq = 0.;
+  for(double time : times) {
+    sumSq += (time - mean) * (time - mean);
+  }
+  return sqrt(sumSq / (times.size() - 1));
+}
+
+BenchmarkSuite::BenchmarkSuite(const BenchmarkOptions& options) : options_(options) {
+  options_.repetitions = std::max(1, options_.repetitions);
+  options_.warmup = std::max(0, options_.warmup);
+  printf("%-32s %6s %10s %12s %12s %12s %8s %10s %10s\n", "benchmark", "res", "elements",
+         "min [ms]", "median [ms]", "max [ms]", "cv [%]", "GB/s", "GFlop/s");
+}
+
+bool BenchmarkSuite::enabled(const std::string& name) const {
+  return name.find(options_.filter) != std::string::npos;
+}
+
+void BenchmarkSuite::run(const std::string& name, int resolution, long elements,
+                         const std::function<void()>& fn, BenchmarkCounters counters) {
+  if(!enabled(name)) {
+    return;
+  }
+  // allocations made while running the benchmark are attributed to name/resolution
+  const std::string label = name + "/" + std::to_string(resolution);
+  StageLabel stageLabel(label.c_str());
+  for(int run = 0; run < options_.warmup; run++) {
+    fn();
+  }
+  BenchmarkResult result;
+  result.name = name;
+  result.resolution = resolution;
+  result.elements = elements;
+  result.counters = counters;
+  for(int run = 0; run < options_.repetitions; run++) {
+    auto start = Clock::now();
+    fn();
+    result.times.push_back(SecondsSince(start));
+  }
+
+  const double median = result.medianTime();
+  printf("%-32s %6d %10ld %12.3f %12.3f %12.3f %8.1f %10.3f %10.3f\n", name.c_str(), resolution,
+         elements, 1e3 * result.minTime(), 1e3 * median, 1e3 * result.maxTime(),
+         100. * ratio(result.stddevTime(), result.meanTime()),
+         1e-9 * ratio(counters.bytes, median), 1e-9 * ratio(counters.flops, median));
+  fflush(stdout);
+  results_.push_back(std::move(result));
+}
+
+double BenchmarkSuite::measure(const std::string& name, int resolution, long elements,
+                               const std::function<void()>& fn, BenchmarkCounters counters) {
+  if(!enabled(name)) {
+    fn();
+    return 0.;
+  }
+  run(name, resolution, elements, fn, counters);
+  return results_.back().medianTime();
+}
+
+void BenchmarkSuite::recordMemory(const std::string& name, int resolution,
+                                  const MemoryFootprint& footprint) {
+  if(!enabled(name)) {
+    return;
+  }
+  BenchmarkMemory memory;
+  memory.name = name;
+  memory.resolution = resolution;
+  memory.cells = footprint.total(FootprintLocation::Cells);
+  memory.edges = footprint.total(FootprintLocation::Edges);
+  memory.nodes = footprint.total(FootprintLocation::Nodes);
+  memory.other = footprint.total(FootprintLocation::None);
+  memory.total = footprint.total();
+  memory_.push_back(std::move(memory));
+}
+
+void BenchmarkSuite::printMemory() const {
+  if(memory_.empty()) {
+    return;
+  }
+  const double MB = 1024. * 1024.;
+  printf("\n%-32s %6s %12s %12s %12s %12s %12s\n", "memory", "res", "cells [MB]", "edges [MB]",
+         "nodes [MB]", "other [MB]", "total [MB]");
+  for(const BenchmarkMemory& memory : memory_) {
+    printf("%-32s %6d %12.3f %12.3f %12.3f %12.3f %12.3f\n", memory.name.c_str(),
+           memory.resolution, memory.cells / MB, memory.edges / MB, memory.nodes / MB,
+           memory.other / MB, memory.total / MB);
+  }
+  fflush(stdout);
+}
+
+bool BenchmarkSuite::writeJson(const std::string& filename) const {
+  FILE* fp = fopen(filename.c_str(), "w");
+  if(!fp) {
+    return false;
+  }
+  char date[64];
+  time_t now = time(nullptr);
+  strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+#ifdef NDEBUG
+  const char* buildType = "release";
+#else
+  const char* buildType = "debug";
+#endif
+
+  fprintf(fp, "{\n  \"context\": {\n");
+  fprintf(fp, "    \"date\": \"%s\",\n", date);
+  fprintf(fp, "    \"build_type\": \"%s\",\n", buildType);
+  fprintf(fp, "    \"num_threads\": %d,\n", NumThreads());
+  fprintf(fp, "    \"warmup\": %d,\n", options_.warmup);
+  fprintf(fp, "    \"repetitions\": %d\n", options_.repetitions);
+  fprintf(fp, "  },\n  \"benchmarks\": [");
+  for(size_t resultIdx = 0; resultIdx < results_.size(); resultIdx++) {
+    const BenchmarkResult& result = results_[resultIdx];
+    const double median = result.medianTime();
+    fprintf(fp, "%s\n    {\n", resultIdx == 0 ? "" : ",");
+    fprintf(fp, "      \"name\": \"%s\",\n", jsonEscape(result.name).c_str());
+    fprintf(fp, "      \"resolution\": %d,\n", result.resolution);
+    fprintf(fp, "      \"elements\": %ld,\n", result.elements);
+    fprintf(fp, "      \"min_time\": %.9e,\n", result.minTime());
+    fprintf(fp, "      \"median_time\": %.9e,\n", median);
+    fprintf(fp, "      \"mean_time\": %.9e,\n", result.meanTime());
+    fprintf(fp, "      \"max_time\": %.9e,\n", result.maxTime());
+    fprintf(fp, "      \"stddev_time\": %.9e,\n", result.stddevTime());
+    fprintf(fp, "      \"bytes\": %.9e,\n", result.counters.bytes);
+    fprintf(fp, "      \"flops\": %.9e,\n", result.counters.flops);
+    fprintf(fp, "      \"bytes_per_second\": %.9e,\n", ratio(result.counters.bytes, median));
+    fprintf(fp, "      \"flops_per_second\": %.9e,\n", ratio(result.counters.flops, median));
+    fprintf(fp, "      \"times\": [");
+    for(size_t timeIdx = 0; timeIdx < result.times.size(); timeIdx++) {
+      fprintf(fp, "%s%.9e", timeIdx == 0 ? "" : ", ", result.times[timeIdx]);
+    }
+    fprintf(fp, "]\n    }");
+  }
+  fprintf(fp, "\n  ],\n  \"memory\": [");
+  for(size_t memoryIdx = 0; memoryIdx < memory_.size(); memoryIdx++) {
+    const BenchmarkMemory& memory = memory_[memoryIdx];
+    fprintf(fp, "%s\n    {\n", memoryIdx == 0 ? "" : ",");
+    fprintf(fp, "      \"name\": \"%s\",\n", jsonEscape(memory.name).c_str());
+    fprintf(fp, "      \"resolution\": %d,\n", memory.resolution);
+    fprintf(fp, "      \"cells\": %zu,\n", memory.cells);
+    fprintf(fp, "      \"edges\": %zu,\n", memory.edges);
+    fprintf(fp, "      \"nodes\": %zu,\n", memory.nodes);
+    fprintf(fp, "      \"other\": %zu,\n", memory.other);
+    fprintf(fp, "      \"total\": %zu\n    }", memory.total);
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  return fclose(fp) == 0;
+}
+
+bool ParseBenchmarkOptions(int argc, char const* argv[], BenchmarkOptions& options,
+                           std::vector<std::string>& remaining) {
+  for(int argIdx = 1; argIdx < argc; argIdx++) {
+    const std::string arg = argv[argIdx];
+    auto value = [&](const std::string& key) -> std::optional<std::string> {
+      if(arg.rfind(key + "=", 0) == 0) {
+        return arg.substr(key.size() + 1);
+      }
+      return std::nullopt;
+    };
+    if(auto warmup = value("--warmup")) {
+      if(!parseInt(*warmup, options.warmup)) {
+        return false;
+      }
+    } else if(auto repetitions = value("--repetitions")) {
+      if(!parseInt(*repetitions, options.repetitions) || options.repetitions < 1) {
+        return false;
+      }
+    } else if(auto filter = value("--filter")) {
+      options.filter = *filter;
+    } else if(auto jsonFile = value("--json")) {
+      options.jsonFile = *jsonFile;
+    } else {
+      remaining.push_back(arg);
+    }
+  }
+  return true;
+}
@@ -0,0 +1,116 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Minimal benchmark harness in the spirit of Google Benchmark, without the dependency.
+//
+//  - every benchmark is a callable which is run `warmup` times untimed and then `repetitions`
+//    times timed, each repetition is timed individually using the wall clock (steady_clock)
+//  - preparation which should not be timed (allocating and initializing fields, generating the
+//    mesh a stencil runs on) is done by the caller before handing the callable to run()
+//  - optional counters give the number of bytes moved and floating point operations performed by
+//    one call, from which bandwidth and flop rate are derived using the median time
+//  - results are printed as a table while the suite runs and can be written to a JSON file for
+//    regression tracking (see writeJson for the layout)
+//  - the memory held by the configuration a benchmark runs on can be recorded alongside the
+//    timings (recordMemory), it is summarized per location type by printMemory
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <vector>
+
+struct BenchmarkOptions {
+  int warmup = 1;
+  int repetitions = 5;
+  // only benchmarks whose name contains filter are run
+  std::string filter;
+  // results are written to this file in JSON format if not empty
+  std::string jsonFile;
+};
+
+// work done by one call of a benchmark, 0 if unknown
+struct BenchmarkCounters {
+  double bytes = 0.;
+  double flops = 0.;
+};
+
+struct BenchmarkResult {
+  std::string name;
+  // problem size the benchmark ran at (e.g. ny of the mesh) and the number of elements processed
+  int resolution = 0;
+  long elements = 0;
+  BenchmarkCounters counters;
+  // wall time of each repetition in seconds
+  std::vector<double> times;
+
+  double minTime() const;
+  double maxTime() const;
+  double meanTime() const;
+  double medianTime() const;
+  double stddevTime() const;
+};
+
+// memory held by the mesh, fields and geometry caches of a benchmark, in bytes per location type
+struct BenchmarkMemory {
+  std::string name;
+  int resolution = 0;
+  size_t cells = 0;
+  size_t edges = 0;
+  size_t nodes = 0;
+  size_t other = 0;
+  size_t total = 0;
+};
+
+class MemoryFootprint;
+
+class BenchmarkSuite {
+public:
+  explicit BenchmarkSuite(const BenchmarkOptions& options);
+
+  // true if a benchmark of that name passes the filter. use to skip expensive preparation
+  bool enabled(const std::string& name) const;
+
+  // times fn and records the result under name/resolution, if enabled(name)
+  void run(const std::string& name, int resolution, long elements,
+           const std::function<void()>& fn, BenchmarkCounters counters = {});
+
+  // as run, for benchmarks whose results are checked by the caller: if the benchmark is filtered
+  // out, fn is called once untimed. returns the median time in seconds, 0 if filtered out
+  double measure(const std::string& name, int resolution, long elements,
+                 const std::function<void()>& fn, BenchmarkCounters counters = {});
+
+  // records the totals of footprint under name/resolution, if enabled(name)
+  void recordMemory(const std::string& name, int resolution, const MemoryFootprint& footprint);
+
+  const std::vector<BenchmarkResult>& results() const { return results_; }
+  const std::vector<BenchmarkMemory>& memory() const { return memory_; }
+
+  // table of the recorded memory footprints, nothing if none have been recorded
+  void printMemory() const;
+
+  // writes {"context": {...}, "benchmarks": [{...}, ...], "memory": [{...}, ...]}, times in
+  // seconds and memory in bytes. returns false if the file could not be written
+  bool writeJson(const std::string& filename) const;
+
+private:
+  BenchmarkOptions options_;
+  std::vector<BenchmarkResult> results_;
+  std::vector<BenchmarkMemory> memory_;
+};
+
+// parses --warmup=N, --repetitions=N, --filter=S and --json=FILE from argv into options.
+// unrecognized arguments are returned in order. returns false on malformed values
+bool ParseBenchmarkOptions(int argc, char const* argv[], BenchmarkOptions& options,
+                           std::vector<std::string>& remaining);
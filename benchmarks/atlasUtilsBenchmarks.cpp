@@ -0,0 +1,502 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Performance suite for the stencils and utilities, see BenchmarkSuite.h for the harness. For each
+// resolution ny, the following is timed:
+//
+//  - mesh/*      generation of the rectangular test meshes (AtlasMeshRect, AtlasMeshRectComplete,
+//                toylibMeshRect)
+//  - setup/*     computation of the geometrical factors of the ICON Laplacian test case
+//  - laplace/*   the generated ICON Laplacian on the atlas, lattice, flat, toylib and structured
+//                backends
+//  - diamond/*   the generated diamond Laplacian on the atlas backend
+//  - netcdf/*    writing and reading the complete mesh in the DWD netcdf format
+//  - submesh/*   extracting half of the cells of the complete mesh
+//
+// Stencil inputs other than the ones set up by AtlasIconLaplaceFields are arbitrary smooth values,
+// only the access pattern matters for the timings. The byte counters are the compulsory traffic
+// (every field element read or written once), i.e. a lower bound of the actual memory traffic. The
+// flop counters are nominal counts assuming complete neighborhoods. The memory held by the mesh,
+// fields and geometry caches of the laplace/* benchmarks is recorded and summarized at the end.
+//
+// usage: atlasUtilsBenchmarks [--warmup=N] [--repetitions=N] [--filter=S] [--json=FILE]
+//                             [--k_size=N] [ny ...]
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <atlas/array.h>
+#include <atlas/field.h>
+#include <atlas/mesh.h>
+
+#include "../stencils/generated_iconDiamondLaplace.hpp"
+#include "../stencils/generated_iconLaplace.hpp"
+#include "../stencils/interfaces/atlas_interface.hpp"
+#include "../stencils/interfaces/atlas_lattice_interface.hpp"
+#include "../stencils/interfaces/flat_interface.hpp"
+#include "../stencils/interfaces/structured_interface.hpp"
+#include "../stencils/interfaces/toylib_interface.hpp"
+
+#include "../stencils/atlasIconLaplaceSetup.h"
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/AtlasExtractSubmesh.h"
+#include "../utils/AtlasFromNetcdf.h"
+#include "../utils/AtlasLattice.h"
+#include "../utils/AtlasToNetcdf.h"
+#include "../utils/FlatMesh.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/GenerateRectToylibMesh.h"
+#include "../utils/MemoryFootprint.h"
+#include "../utils/ToylibGeomHelper.h"
+
+#include "BenchmarkSuite.h"
+
+namespace {
+const int edgesPerVertex = 6;
+const int edgesPerCell = 3;
+const int verticesInDiamond = 4;
+
+//===------------------------------------------------------------------------------------------===//
+// counters
+//===------------------------------------------------------------------------------------------===//
+
+// ICON Laplacian per level: 7 edge fields (vec, nabla2t1, nabla2t2, nabla2, primal and dual
+// length, tangent orientation), div and geofac_div on cells, rot and geofac_rot on vertices
+BenchmarkCounters LaplaceCounters(long numEdges, long numCells, long numNodes, int k_size) {
+  const double doubles = 7. * numEdges + (1. + edgesPerCell) * numCells +
+                         (1. + edgesPerVertex) * numNodes;
+  const double flops = 2. * edgesPerVertex * numNodes + 2. * edgesPerCell * numCells +
+                       12. * numEdges;
+  return {8. * doubles * k_size, flops * k_size};
+}
+
+// diamond Laplacian per level: 11 dense and 5 sparse edge fields, u and v on vertices. 105 flops
+// per edge (vn_vert 12, dvt_tang 21, dvt_norm 20, kh_smag_1 13, kh_smag_2 12, kh_smag 3, nabla2
+// 24)
+BenchmarkCounters DiamondCounters(long numEdges, long numNodes, int k_size) {
+  const double doubles = (11. + 5. * verticesInDiamond) * numEdges + 2. * numNodes;
+  return {8. * doubles * k_size, 105. * numEdges * k_size};
+}
+
+//===------------------------------------------------------------------------------------------===//
+// fields
+//===------------------------------------------------------------------------------------------===//
+
+atlas::Field MakeAtlasField(const std::string& name, int size, int k_size) {
+  return atlas::Field{name, atlas::array::DataType::real64(),
+                      atlas::array::make_shape(size, k_size)};
+}
+atlas::Field MakeAtlasSparseField(const std::string& name, int size, int k_size,
+                                  int sparseSize) {
+  return atlas::Field{name, atlas::array::DataType::real64(),
+                      atlas::array::make_shape(size, k_size, sparseSize)};
+}
+
+// all fields of the diamond Laplacian on an atlas mesh
+class DiamondFields {
+public:
+  DiamondFields(const atlas::Mesh& mesh, int k_size) {
+    const int numEdges = mesh.edges().size();
+    const int numNodes = mesh.nodes().size();
+    for(int fieldIdx = 0; fieldIdx < numEdgeFields; fieldIdx++) {
+      edge_F.push_back(MakeAtlasField("edge", numEdges, k_size));
+      edge.push_back(atlas::array::make_view<double, 2>(edge_F.back()));
+    }
+    for(int fieldIdx = 0; fieldIdx < numSparseFields; fieldIdx++) {
+      sparse_F.push_back(MakeAtlasSparseField("sparse", numEdges, k_size, verticesInDiamond));
+      sparse.push_back(atlas::array::make_view<double, 3>(sparse_F.back()));
+    }
+    for(int fieldIdx = 0; fieldIdx < 2; fieldIdx++) {
+      node_F.push_back(MakeAtlasField("node", numNodes, k_size));
+      node.push_back(atlas::array::make_view<double, 2>(node_F.back()));
+    }
+
+    for(int k = 0; k < k_size; k++) {
+      for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+        // diff_multfac_smag, tangent_orientation, inv_primal_edge_length, inv_vert_vert_length, vn
+        edge[0](edgeIdx, k) = 1. + 0.1 * sin(0.2 * edgeIdx + k);
+        edge[1](edgeIdx, k) = (edgeIdx % 2 == 0) ? 1. : -1.;
+        edge[2](edgeIdx, k) = 1. + 0.5 * sin(0.3 * edgeIdx);
+        edge[3](edgeIdx, k) = 1. + 0.5 * cos(0.7 * edgeIdx);
+        edge[4](edgeIdx, k) = sin(0.1 * edgeIdx + k);
+        for(int nbhIdx = 0; nbhIdx < verticesInDiamond; nbhIdx++) {
+          // primal and dual normals
+          sparse[0](edgeIdx, nbhIdx, k) = cos(0.3 * edgeIdx + nbhIdx);
+          sparse[1](edgeIdx, nbhIdx, k) = sin(0.3 * edgeIdx + nbhIdx);
+          sparse[2](edgeIdx, nbhIdx, k) = sin(0.3 * edgeIdx + nbhIdx);
+          sparse[3](edgeIdx, nbhIdx, k) = -cos(0.3 * edgeIdx + nbhIdx);
+        }
+      }
+      for(int nodeIdx = 0; nodeIdx < numNodes; nodeIdx++) {
+        node[0](nodeIdx, k) = sin(0.1 * nodeIdx + k);
+        node[1](nodeIdx, k) = cos(0.1 * nodeIdx + k);
+      }
+    }
+  }
+  DiamondFields(const DiamondFields&) = delete;
+
+  void run(const atlas::Mesh& mesh, int k_size) {
+    dawn_generated::cxxnaiveico::ICON_laplacian_diamond_stencil<atlasInterface::atlasTag>(
+        mesh, k_size, edge[0], edge[1], edge[2], edge[3], node[0], node[1], sparse[0], sparse[1],
+        sparse[2], sparse[3], sparse[4], edge[4], edge[5], edge[6], edge[7], edge[8], edge[9],
+        edge[10])
+        .run();
+  }
+
+private:
+  static constexpr int numEdgeFields = 11;
+  static constexpr int numSparseFields = 5;
+
+  std::vector<atlas::Field> edge_F, sparse_F, node_F;
+  std::vector<atlasInterface::Field<double>> edge, node;
+  std::vector<atlasInterface::SparseDimension<double>> sparse;
+};
+
+// all fields of the ICON Laplacian on a toylib grid
+struct ToylibLaplaceFields {
+  toylib::EdgeData<double> vec;
+  toylib::FaceData<double> div_vec;
+  toylib::VertexData<double> rot_vec;
+  toylib::EdgeData<double> nabla2t1_vec;
+  toylib::EdgeData<double> nabla2t2_vec;
+  toylib::EdgeData<double> nabla2_vec;
+  toylib::EdgeData<double> primal_edge_length;
+  toylib::EdgeData<double> dual_edge_length;
+  toylib::EdgeData<double> tangent_orientation;
+  toylib::SparseVertexData<double> geofac_rot;
+  toylib::SparseFaceData<double> geofac_div;
+
+  ToylibLaplaceFields(const toylib::Grid& grid, int k_size)
+      : vec(grid, k_size), div_vec(grid, k_size), rot_vec(grid, k_size),
+        nabla2t1_vec(grid, k_size), nabla2t2_vec(grid, k_size), nabla2_vec(grid, k_size),
+        primal_edge_length(grid, k_size), dual_edge_length(grid, k_size),
+        tangent_orientation(grid, k_size), geofac_rot(grid, edgesPerVertex, k_size),
+        geofac_div(grid, edgesPerCell, k_size) {
+    const int numEdges = grid.all_edges().size();
+    for(int k = 0; k < k_size; k++) {
+      for(int id = 0; id < numEdges; id++) {
+        vec(id, k) = sin(0.1 * id + k);
+        primal_edge_length(id, k) = 1. + 0.5 * sin(0.3 * id);
+        dual_edge_length(id, k) = 1. + 0.5 * cos(0.7 * id);
+        tangent_orientation(id, k) = (id % 2 == 0) ? 1. : -1.;
+      }
+      for(int id = 0; id < int(grid.vertices().size()); id++) {
+        for(int nbhIdx = 0; nbhIdx < edgesPerVertex; nbhIdx++) {
+          geofac_rot(id, nbhIdx, k) = cos(0.2 * id + nbhIdx);
+        }
+      }
+      for(int id = 0; id < int(grid.faces().size()); id++) {
+        for(int nbhIdx = 0; nbhIdx < edgesPerCell; nbhIdx++) {
+          geofac_div(id, nbhIdx, k) = sin(0.4 * id + nbhIdx);
+        }
+      }
+    }
+  }
+
+  template <typename Tag>
+  void run(const dawn::mesh_t<Tag>& mesh, int k_size) {
+    dawn_generated::cxxnaiveico::ICON_laplacian_stencil<Tag>(
+        mesh, k_size, vec, div_vec, rot_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec,
+        primal_edge_length, dual_edge_length, tangent_orientation, geofac_rot, geofac_div)
+        .run();
+  }
+
+  void addFootprint(MemoryFootprint& footprint) const {
+    for(auto field : {std::make_pair("vec", &vec), std::make_pair("nabla2t1_vec", &nabla2t1_vec),
+                      std::make_pair("nabla2t2_vec", &nabla2t2_vec),
+                      std::make_pair("nabla2_vec", &nabla2_vec),
+                      std::make_pair("primal_edge_length", &primal_edge_length),
+                      std::make_pair("dual_edge_length", &dual_edge_length),
+                      std::make_pair("tangent_orientation", &tangent_orientation)}) {
+      AddFootprint(footprint, field.first, *field.second);
+    }
+    AddFootprint(footprint, "div_vec", div_vec);
+    AddFootprint(footprint, "rot_vec", rot_vec);
+    AddFootprint(footprint, "geofac_rot", geofac_rot);
+    AddFootprint(footprint, "geofac_div", geofac_div);
+  }
+};
+
+// the inputs of AtlasIconLaplaceFields copied to the flat backend, on a FlatMesh converted from the
+// same atlas mesh
+struct FlatLaplaceFields {
+  flatInterface::Field<double> vec, div_vec, rot_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec,
+      primal_edge_length, dual_edge_length, tangent_orientation;
+  flatInterface::SparseField<double> geofac_rot, geofac_div;
+
+  FlatLaplaceFields(const FlatMesh& mesh, const AtlasIconLaplaceFields& f, int k_size)
+      : vec(mesh.numEdges(), k_size), div_vec(mesh.numCells(), k_size),
+        rot_vec(mesh.numVertices(), k_size), nabla2t1_vec(mesh.numEdges(), k_size),
+        nabla2t2_vec(mesh.numEdges(), k_size), nabla2_vec(mesh.numEdges(), k_size),
+        primal_edge_length(mesh.numEdges(), k_size), dual_edge_length(mesh.numEdges(), k_size),
+        tangent_orientation(mesh.numEdges(), k_size),
+        geofac_rot(mesh.numVertices(), AtlasIconLaplaceFields::edgesPerVertex, k_size),
+        geofac_div(mesh.numCells(), AtlasIconLaplaceFields::edgesPerCell, k_size) {
+    for(int k = 0; k < k_size; k++) {
+      for(int edgeIdx = 0; edgeIdx < mesh.numEdges(); edgeIdx++) {
+        vec(edgeIdx, k) = f.vec(edgeIdx, k);
+        primal_edge_length(edgeIdx, k) = f.primal_edge_length(edgeIdx, k);
+        dual_edge_length(edgeIdx, k) = f.dual_edge_length(edgeIdx, k);
+        tangent_orientation(edgeIdx, k) = f.tangent_orientation(edgeIdx, k);
+      }
+      for(int nodeIdx = 0; nodeIdx < mesh.numVertices(); nodeIdx++) {
+        for(int nbhIdx = 0; nbhIdx < AtlasIconLaplaceFields::edgesPerVertex; nbhIdx++) {
+          geofac_rot(nodeIdx, nbhIdx, k) = f.geofac_rot(nodeIdx, nbhIdx, k);
+        }
+      }
+      for(int cellIdx = 0; cellIdx < mesh.numCells(); cellIdx++) {
+        for(int nbhIdx = 0; nbhIdx < AtlasIconLaplaceFields::edgesPerCell; nbhIdx++) {
+          geofac_div(cellIdx, nbhIdx, k) = f.geofac_div(cellIdx, nbhIdx, k);
+        }
+      }
+    }
+  }
+
+  void run(const FlatMesh& mesh, int k_size) {
+    dawn_generated::cxxnaiveico::ICON_laplacian_stencil<flatInterface::flatTag>(
+        mesh, k_size, vec, div_vec, rot_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec,
+        primal_edge_length, dual_edge_length, tangent_orientation, geofac_rot, geofac_div)
+        .run();
+  }
+
+  void addFootprint(MemoryFootprint& footprint) const {
+    for(auto field : {std::make_pair("vec", &vec), std::make_pair("nabla2t1_vec", &nabla2t1_vec),
+                      std::make_pair("nabla2t2_vec", &nabla2t2_vec),
+                      std::make_pair("nabla2_vec", &nabla2_vec),
+                      std::make_pair("primal_edge_length", &primal_edge_length),
+                      std::make_pair("dual_edge_length", &dual_edge_length),
+                      std::make_pair("tangent_orientation", &tangent_orientation)}) {
+      footprint.add("field", field.first, FootprintLocation::Edges, field.second->bytes());
+    }
+    footprint.add("field", "div_vec", FootprintLocation::Cells, div_vec.bytes());
+    footprint.add("field", "rot_vec", FootprintLocation::Nodes, rot_vec.bytes());
+    footprint.add("field", "geofac_rot", FootprintLocation::Nodes, geofac_rot.bytes());
+    footprint.add("field", "geofac_div", FootprintLocation::Cells, geofac_div.bytes());
+  }
+};
+
+template <typename Tag, typename MeshT>
+void RunAtlasLaplace(const MeshT& mesh, int k_size, AtlasIconLaplaceFields& f) {
+  dawn_generated::cxxnaiveico::ICON_laplacian_stencil<Tag>(
+      mesh, k_size, f.vec, f.div_vec, f.rot_vec, f.nabla2t1_vec, f.nabla2t2_vec, f.nabla2_vec,
+      f.primal_edge_length, f.dual_edge_length, f.tangent_orientation, f.geofac_rot, f.geofac_div)
+      .run();
+}
+
+// geometrical factors of a toylib grid as computed by mylibIconLaplaceDriver
+void ToylibGeometry(const toylib::Grid& grid, std::vector<double>& edgeValues,
+                    std::vector<double>& cellValues, std::vector<double>& nodeValues) {
+  edgeValues.clear();
+  cellValues.clear();
+  nodeValues.clear();
+  for(const auto& e : grid.edges()) {
+    auto [nx, ny] = PrimalNormal(e);
+    edgeValues.push_back(EdgeLength(e));
+    edgeValues.push_back(DualEdgeLength(e));
+    edgeValues.push_back(TangentOrientation(e));
+    edgeValues.push_back(nx);
+    edgeValues.push_back(ny);
+  }
+  for(const auto& c : grid.faces()) {
+    cellValues.push_back(CellArea(c));
+  }
+  for(const auto& v : grid.vertices()) {
+    nodeValues.push_back(DualCellArea(v));
+  }
+}
+
+//===------------------------------------------------------------------------------------------===//
+// benchmarks at one resolution
+//===------------------------------------------------------------------------------------------===//
+
+void BenchmarkMeshes(BenchmarkSuite& suite, int ny) {
+  const long numCells = AtlasMeshRect(ny).cells().size();
+  suite.run("mesh/atlasRect", ny, numCells, [&]() { AtlasMeshRect(ny); });
+  suite.run("mesh/atlasRectComplete", ny, numCells, [&]() { AtlasMeshRectComplete(ny); });
+  const long numFaces = toylibMeshRect(ny).faces().size();
+  suite.run("mesh/toylibRect", ny, numFaces, [&]() { toylibMeshRect(ny); });
+}
+
+void BenchmarkAtlas(BenchmarkSuite& suite, int ny, int k_size) {
+  atlas::Mesh mesh = AtlasMeshRectComplete(ny);
+  // the lattice backend requires the neighbor tables in lattice order. sorting them before setting
+  // up the fields allows both backends to run on the same mesh and fields
+  auto lattice = AtlasLatticeFromMesh(mesh);
+  if(lattice && !AtlasSortByLattice(mesh, *lattice)) {
+    lattice = std::nullopt;
+  }
+  const long numEdges = mesh.edges().size();
+  const long numCells = mesh.cells().size();
+  const long numNodes = mesh.nodes().size();
+
+  AtlasToCartesian wrapper(mesh, true);
+  suite.run("setup/atlasLaplace", ny, numEdges * k_size, [&]() {
+    AtlasToCartesian wrapper(mesh, true);
+    AtlasIconLaplaceFields fields(mesh, wrapper, k_size);
+  });
+
+  const BenchmarkCounters laplaceCounters = LaplaceCounters(numEdges, numCells, numNodes, k_size);
+  if(suite.enabled("laplace/atlas")) {
+    AtlasIconLaplaceFields fields(mesh, wrapper, k_size);
+    suite.run(
+        "laplace/atlas", ny, numEdges * k_size,
+        [&]() { RunAtlasLaplace<atlasInterface::atlasTag>(mesh, k_size, fields); },
+        laplaceCounters);
+    MemoryFootprint footprint;
+    AddFootprint(footprint, mesh);
+    AddFootprint(footprint, wrapper);
+    fields.addFootprint(footprint);
+    suite.recordMemory("laplace/atlas", ny, footprint);
+    if(lattice) {
+      atlasLatticeInterface::LatticeMesh latticeMesh(mesh, *lattice);
+      suite.run(
+          "laplace/atlasLattice", ny, numEdges * k_size,
+          [&]() {
+            RunAtlasLaplace<atlasLatticeInterface::atlasLatticeTag>(latticeMesh, k_size, fields);
+          },
+          laplaceCounters);
+      AddFootprint(footprint, *lattice);
+      suite.recordMemory("laplace/atlasLattice", ny, footprint);
+    } else {
+      std::cout << "laplace/atlasLattice skipped, mesh is not a lattice section\n";
+    }
+  }
+  if(suite.enabled("laplace/flat")) {
+    FlatMesh flatMesh = FlatMeshFromAtlas(mesh);
+    AtlasIconLaplaceFields atlasFields(mesh, wrapper, k_size);
+    FlatLaplaceFields fields(flatMesh, atlasFields, k_size);
+    suite.run(
+        "laplace/flat", ny, numEdges * k_size, [&]() { fields.run(flatMesh, k_size); },
+        laplaceCounters);
+    MemoryFootprint footprint;
+    AddFootprint(footprint, flatMesh);
+    fields.addFootprint(footprint);
+    suite.recordMemory("laplace/flat", ny, footprint);
+  }
+
+  if(suite.enabled("diamond/atlas")) {
+    DiamondFields fields(mesh, k_size);
+    suite.run(
+        "diamond/atlas", ny, numEdges * k_size, [&]() { fields.run(mesh, k_size); },
+        DiamondCounters(numEdges, numNodes, k_size));
+  }
+
+  const std::string filename = "atlasUtilsBenchmarks_mesh.nc";
+  if(suite.enabled("netcdf/")) {
+    suite.run("netcdf/write", ny, numCells, [&]() { AtlasToNetCDF(mesh, filename); });
+    if(AtlasMeshFromNetCDFComplete(filename)) {
+      suite.run("netcdf/readComplete", ny, numCells,
+                [&]() { AtlasMeshFromNetCDFComplete(filename); });
+    } else {
+      std::cout << "netcdf/readComplete skipped, could not read back " << filename << "\n";
+    }
+    std::remove(filename.c_str());
+  }
+
+  const std::pair<int, int> half{0, int(numCells / 2)};
+  suite.run("submesh/extractMinimal", ny, numCells,
+            [&]() { AtlasExtractSubMeshMinimal(mesh, half); });
+  suite.run("submesh/extractComplete", ny, numCells,
+            [&]() { AtlasExtractSubMeshComplete(mesh, half); });
+}
+
+void BenchmarkToylib(BenchmarkSuite& suite, int ny, int k_size) {
+  if(suite.enabled("setup/toylibGeometry")) {
+    toylib::Grid grid = toylibMeshRect(ny);
+    std::vector<double> edgeValues, cellValues, nodeValues;
+    suite.run("setup/toylibGeometry", ny, grid.edges().size(),
+              [&]() { ToylibGeometry(grid, edgeValues, cellValues, nodeValues); });
+  }
+
+  // toylib and structured backend on the same (non periodic) regular grid
+  const int nx = 2 * ny;
+  toylib::Grid grid(nx, ny, false);
+  structuredInterface::StructuredGrid<false> structuredGrid(nx, ny);
+  const long numEdges = grid.all_edges().size();
+  const BenchmarkCounters counters =
+      LaplaceCounters(numEdges, grid.faces().size(), grid.vertices().size(), k_size);
+  if(suite.enabled("laplace/toylib")) {
+    ToylibLaplaceFields fields(grid, k_size);
+    suite.run(
+        "laplace/toylib", ny, numEdges * k_size,
+        [&]() { fields.run<toylibInterface::toylibTag>(grid, k_size); }, counters);
+    MemoryFootprint footprint;
+    AddFootprint(footprint, grid);
+    fields.addFootprint(footprint);
+    suite.recordMemory("laplace/toylib", ny, footprint);
+  }
+  if(suite.enabled("laplace/structured")) {
+    ToylibLaplaceFields fields(grid, k_size);
+    suite.run(
+        "laplace/structured", ny, numEdges * k_size,
+        [&]() { fields.run<structuredInterface::structuredTag<false>>(structuredGrid, k_size); },
+        counters);
+    // the structured grid is implicit, only the fields hold memory
+    MemoryFootprint footprint;
+    fields.addFootprint(footprint);
+    suite.recordMemory("laplace/structured", ny, footprint);
+  }
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  BenchmarkOptions options;
+  std::vector<std::string> args;
+  bool valid = ParseBenchmarkOptions(argc, argv, options, args);
+
+  int k_size = 1;
+  std::vector<int> resolutions;
+  for(const std::string& arg : args) {
+    if(arg.rfind("--k_size=", 0) == 0) {
+      k_size = atoi(arg.c_str() + 9);
+    } else if(atoi(arg.c_str()) > 1) {
+      resolutions.push_back(atoi(arg.c_str()));
+    } else {
+      valid = false;
+    }
+  }
+  if(!valid || k_size < 1) {
+    std::cout << "intended use is\n"
+              << argv[0]
+              << " [--warmup=N] [--repetitions=N] [--filter=S] [--json=FILE] [--k_size=N] [ny ...]"
+              << std::endl;
+    return -1;
+  }
+  if(resolutions.empty()) {
+    resolutions = {16, 32, 64};
+  }
+
+  BenchmarkSuite suite(options);
+  for(int ny : resolutions) {
+    BenchmarkMeshes(suite, ny);
+    BenchmarkAtlas(suite, ny, k_size);
+    BenchmarkToylib(suite, ny, k_size);
+  }
+
+  suite.printMemory();
+
+  INSTRUMENT_REPORT("atlasUtilsBenchmarks_trace.json");
+
+  if(!options.jsonFile.empty() && !suite.writeJson(options.jsonFile)) {
+    std::cout << "could not write " << options.jsonFile << "\n";
+    return 1;
+  }
+  return 0;
+}
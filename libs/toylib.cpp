@@ -16,6 +16,11 @@
 
 #include "../stencils/interfaces/toylib_interface.hpp"
 
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
 toylib::ToylibElement::~ToylibElement() {}
 
 namespace {
@@ -25,6 +30,46 @@ bool inner_face(toylib::Face const& f) {
          (f.color() == toylib::face_color::upward && f.vertex(1).id() > f.vertex(0).id() &&
           f.vertex(1).id() > f.vertex(2).id());
 }
+
+bool is_little_endian() {
+  const uint16_t probe = 1;
+  unsigned char first_byte;
+  memcpy(&first_byte, &probe, 1);
+  return first_byte == 1;
+}
+
+// a data array in the appended section of a vtu file. write_values streams exactly num_bytes bytes
+struct VtuArray {
+  std::string name;
+  std::string type;
+  int num_components;
+  uint64_t num_bytes;
+  std::function<void(std::ostream&)> write_values;
+};
+
+// writes value(idx) for idx in [0, count) through a small fixed size buffer
+template <typename T, typename ValueFn>
+void write_generated(std::ostream& os, size_t count, ValueFn&& value) {
+  std::array<T, 4096> buf;
+  size_t fill = 0;
+  for(size_t idx = 0; idx < count; ++idx) {
+    buf[fill++] = value(idx);
+    if(fill == buf.size()) {
+      os.write(reinterpret_cast<const char*>(buf.data()), fill * sizeof(T));
+      fill = 0;
+    }
+  }
+  os.write(reinterpret_cast<const char*>(buf.data()), fill * sizeof(T));
+}
+
+void write_array_headers(std::ostream& os, std::vector<VtuArray> const& arrays, size_t first,
+                         size_t last, std::vector<uint64_t> const& offsets) {
+  for(size_t idx = first; idx < last; ++idx) {
+    os << "        <DataArray type=\"" << arrays[idx].type << "\" Name=\"" << arrays[idx].name
+       << "\" NumberOfComponents=\"" << arrays[idx].num_components
+       << "\" format=\"appended\" offset=\"" << offsets[idx] << "\"/>\n";
+  }
+}
 } // namespace
 
 namespace toylib {
@@ -74,7 +119,7 @@ std::ostream& toVtk(Grid const& grid, int k_size, std::ostream& os) {
 
   os << "POINTS " << grid.vertices().size() * k_size << " float\n";
   for(int k_level = 0; k_level < k_size; k_level++) {
-    for(auto v : grid.vertices())
+    for(const auto& v : grid.vertices())
       os << v.x() << " " << v.y() << " " << k_level << "\n";
   }
 
@@ -84,7 +129,7 @@ std::ostream& toVtk(Grid const& grid, int k_size, std::ostream& os) {
   for(int k_level = 0; k_level < k_size; k_level++) {
     for(auto& f : grid.faces())
       if(inner_face(f)) {
-        const int k_offset = k_level * grid.nx() * grid.ny();
+        const int k_offset = k_level * grid.vertices().size();
         os << "3 " << f.vertex(0).id() + k_offset << " " << f.vertex(1).id() + k_offset << " "
            << f.vertex(2).id() + k_offset << '\n';
       }
@@ -92,7 +137,7 @@ std::ostream& toVtk(Grid const& grid, int k_size, std::ostream& os) {
 
   os << "CELL_TYPES " << fcnt * k_size << '\n';
   for(int k_level = 0; k_level < k_size; k_level++) {
-    for(auto f : grid.faces()) {
+    for(const auto& f : grid.faces()) {
       if(inner_face(f)) {
         os << "5\n";
       }
@@ -129,9 +174,11 @@ std::ostream& toVtk(std::string const& name, EdgeData<double> const& e_data, Gri
   for(int k_level = 0; k_level < f_data.k_size(); ++k_level) {
     for(const auto& cell : grid.faces()) {
       f_data(cell, k_level) = toylibInterface::reduce(
-          toylibInterface::toylibTag{}, grid, &cell, 0,
+          toylibInterface::toylibTag{}, grid, &cell, 0.,
           std::vector<dawn::LocationType>{dawn::LocationType::Cells, dawn::LocationType::Edges},
-          [&](auto& lhs, const auto& rhs) { lhs += f_data(cell, k_level); });
+          [&](auto& lhs, const auto& rhs) { lhs += e_data(rhs, k_level); });
+      // average as VtuWriter does
+      f_data(cell, k_level) /= cell.edges().size();
     }
   }
 
@@ -144,14 +191,163 @@ std::ostream& toVtk(std::string const& name, VertexData<double> const& v_data, G
   for(int k_level = 0; k_level < f_data.k_size(); ++k_level) {
     for(auto& cell : grid.faces()) {
       f_data(cell, k_level) = toylibInterface::reduce(
-          toylibInterface::toylibTag{}, grid, &cell, 0,
+          toylibInterface::toylibTag{}, grid, &cell, 0.,
           std::vector<dawn::LocationType>{dawn::LocationType::Cells, dawn::LocationType::Vertices},
-          [&](auto& lhs, const auto& rhs) { lhs += f_data(cell, k_level); });
+          [&](auto& lhs, const auto& rhs) { lhs += v_data(rhs, k_level); });
+      f_data(cell, k_level) /= cell.vertices().size();
     }
   }
 
   return toVtk(name, f_data, grid, os);
 }
+VtuWriter::VtuWriter(Grid const& grid, int k_size) : grid_(grid), k_size_(k_size) {
+  for(const auto& f : grid.faces()) {
+    if(inner_face(f)) {
+      cells_.push_back(&f);
+    }
+  }
+}
+
+VtuWriter& VtuWriter::add(std::string const& name, FaceData<double> const& f_data) {
+  assert(f_data.k_size() >= k_size_);
+  face_fields_.emplace_back(name, &f_data);
+  return *this;
+}
+VtuWriter& VtuWriter::add(std::string const& name, EdgeData<double> const& e_data) {
+  assert(e_data.k_size() >= k_size_);
+  edge_fields_.emplace_back(name, &e_data);
+  return *this;
+}
+VtuWriter& VtuWriter::add(std::string const& name, VertexData<double> const& v_data) {
+  assert(v_data.k_size() >= k_size_);
+  vertex_fields_.emplace_back(name, &v_data);
+  return *this;
+}
+
+std::ostream& VtuWriter::write(std::ostream& os) const {
+  const size_t num_vertices = grid_.vertices().size();
+  const size_t num_cells = cells_.size();
+  const size_t num_points_total = num_vertices * k_size_;
+  const size_t num_cells_total = num_cells * k_size_;
+  // if no face is dropped, face fields can be written level by level straight from their buffers
+  const bool all_faces = num_cells == grid_.faces().size();
+
+  std::vector<VtuArray> arrays;
+  arrays.push_back({"Points", "Float64", 3, 3 * num_points_total * sizeof(double),
+                    [&](std::ostream& out) {
+                      for(int k_level = 0; k_level < k_size_; ++k_level) {
+                        write_generated<double>(out, 3 * num_vertices, [&](size_t idx) {
+                          const Vertex& v = grid_.vertices()[idx / 3];
+                          return std::array<double, 3>{v.x(), v.y(), double(k_level)}[idx % 3];
+                        });
+                      }
+                    }});
+  const size_t first_cell_array = arrays.size();
+  arrays.push_back({"connectivity", "Int64", 1, 3 * num_cells_total * sizeof(int64_t),
+                    [&](std::ostream& out) {
+                      for(int k_level = 0; k_level < k_size_; ++k_level) {
+                        const int64_t k_offset = int64_t(k_level) * num_vertices;
+                        write_generated<int64_t>(out, 3 * num_cells, [&](size_t idx) {
+                          return k_offset + cells_[idx / 3]->vertex(idx % 3).id();
+                        });
+                      }
+                    }});
+  arrays.push_back({"offsets", "Int64", 1, num_cells_total * sizeof(int64_t),
+                    [&](std::ostream& out) {
+                      write_generated<int64_t>(out, num_cells_total,
+                                               [](size_t idx) { return int64_t(3 * (idx + 1)); });
+                    }});
+  arrays.push_back({"types", "UInt8", 1, num_cells_total * sizeof(uint8_t),
+                    [&](std::ostream& out) {
+                      // 5 = VTK_TRIANGLE
+                      write_generated<uint8_t>(out, num_cells_total, [](size_t) { return 5; });
+                    }});
+  const size_t first_point_data = arrays.size();
+  for(const auto& [name, v_data] : vertex_fields_) {
+    arrays.push_back({name, "Float64", 1, num_points_total * sizeof(double),
+                      [&, v_data = v_data](std::ostream& out) {
+                        for(int k_level = 0; k_level < k_size_; ++k_level) {
+                          out.write(reinterpret_cast<const char*>(v_data->level_data(k_level)),
+                                    num_vertices * sizeof(double));
+                        }
+                      }});
+  }
+  const size_t first_cell_data = arrays.size();
+  arrays.push_back({"id", "Int32", 1, num_cells_total * sizeof(int32_t), [&](std::ostream& out) {
+                      for(int k_level = 0; k_level < k_size_; ++k_level) {
+                        write_generated<int32_t>(out, num_cells,
+                                                 [&](size_t idx) { return cells_[idx]->id(); });
+                      }
+                    }});
+  for(const auto& [name, f_data] : face_fields_) {
+    arrays.push_back({name, "Float64", 1, num_cells_total * sizeof(double),
+                      [&, f_data = f_data](std::ostream& out) {
+                        for(int k_level = 0; k_level < k_size_; ++k_level) {
+                          const double* level = f_data->level_data(k_level);
+                          if(all_faces) {
+                            out.write(reinterpret_cast<const char*>(level),
+                                      num_cells * sizeof(double));
+                          } else {
+                            write_generated<double>(out, num_cells, [&](size_t idx) {
+                              return level[cells_[idx]->id()];
+                            });
+                          }
+                        }
+                      }});
+  }
+  for(const auto& [name, e_data] : edge_fields_) {
+    arrays.push_back({name, "Float64", 1, num_cells_total * sizeof(double),
+                      [&, e_data = e_data](std::ostream& out) {
+                        for(int k_level = 0; k_level < k_size_; ++k_level) {
+                          const double* level = e_data->level_data(k_level);
+                          write_generated<double>(out, num_cells, [&](size_t idx) {
+                            const Face& f = *cells_[idx];
+                            return (level[f.edge(0).id()] + level[f.edge(1).id()] +
+                                    level[f.edge(2).id()]) /
+                                   3.;
+                          });
+                        }
+                      }});
+  }
+
+  // every array in the appended section is preceded by its size in bytes (UInt64)
+  std::vector<uint64_t> offsets(arrays.size());
+  uint64_t offset = 0;
+  for(size_t idx = 0; idx < arrays.size(); ++idx) {
+    offsets[idx] = offset;
+    offset += sizeof(uint64_t) + arrays[idx].num_bytes;
+  }
+
+  os << "<?xml version=\"1.0\"?>\n"
+     << "<VTKFile type=\"UnstructuredGrid\" version=\"1.0\" byte_order=\""
+     << (is_little_endian() ? "LittleEndian" : "BigEndian") << "\" header_type=\"UInt64\">\n"
+     << "  <UnstructuredGrid>\n"
+     << "    <Piece NumberOfPoints=\"" << num_points_total << "\" NumberOfCells=\""
+     << num_cells_total << "\">\n";
+  os << "      <Points>\n";
+  write_array_headers(os, arrays, 0, first_cell_array, offsets);
+  os << "      </Points>\n      <Cells>\n";
+  write_array_headers(os, arrays, first_cell_array, first_point_data, offsets);
+  os << "      </Cells>\n      <PointData>\n";
+  write_array_headers(os, arrays, first_point_data, first_cell_data, offsets);
+  os << "      </PointData>\n      <CellData>\n";
+  write_array_headers(os, arrays, first_cell_data, arrays.size(), offsets);
+  os << "      </CellData>\n    </Piece>\n  </UnstructuredGrid>\n";
+
+  os << "  <AppendedData encoding=\"raw\">\n_";
+  for(const auto& array : arrays) {
+    os.write(reinterpret_cast<const char*>(&array.num_bytes), sizeof(uint64_t));
+    array.write_values(os);
+  }
+  os << "\n  </AppendedData>\n</VTKFile>\n";
+  return os;
+}
+
+void VtuWriter::write(std::string const& fname) const {
+  std::ofstream os(fname, std::ios::binary);
+  write(os);
+}
+
 void Vertex::add_edge(Edge& e) { edges_.push_back(&e); }
 
 void Grid::scale(double scale) {
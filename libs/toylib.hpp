@@ -20,6 +20,7 @@
 #include <functional>
 #include <iostream>
 #include <set>
+#include <string>
 #include <vector>
 
 namespace toylib {
@@ -476,11 +477,26 @@ public:
   T const& operator()(ToylibElement const* f, size_t k_level) const {
     return data_[k_level][static_cast<const O*>(f)->id()];
   }
+  // access by element id, used by backends which do not materialize elements
+  T& operator()(int id, size_t k_level) { return data_[k_level][id]; }
+  T const& operator()(int id, size_t k_level) const { return data_[k_level][id]; }
   auto begin() { return data_.begin(); }
   auto end() { return data_.end(); }
 
+  // contiguous values of a single level, indexed by element id
+  T const* level_data(size_t k_level) const { return data_[k_level].data(); }
+
   int k_size() const { return data_.size(); }
 
+  // bytes held by the values, including the per level vectors
+  size_t bytes() const {
+    size_t bytes = data_.capacity() * sizeof(std::vector<T>);
+    for(const auto& level : data_) {
+      bytes += level.capacity() * sizeof(T);
+    }
+    return bytes;
+  }
+
 private:
   std::vector<std::vector<T>> data_;
 };
@@ -531,8 +547,30 @@ public:
     assert(elem->id() < dense_size_);
     return data_[k_level][static_cast<const O*>(elem)->id()][sparse_idx];
   }
+  T& operator()(int id, size_t sparse_idx, size_t k_level) {
+    assert(sparse_idx < sparse_size_);
+    assert(size_t(id) < dense_size_);
+    return data_[k_level][id][sparse_idx];
+  }
+  T const& operator()(int id, size_t sparse_idx, size_t k_level) const {
+    assert(sparse_idx < sparse_size_);
+    assert(size_t(id) < dense_size_);
+    return data_[k_level][id][sparse_idx];
+  }
   int k_size() const { return data_.size(); }
 
+  // bytes held by the values, including the per level and per element vectors
+  size_t bytes() const {
+    size_t bytes = data_.capacity() * sizeof(std::vector<std::vector<T>>);
+    for(const auto& level : data_) {
+      bytes += level.capacity() * sizeof(std::vector<T>);
+      for(const auto& elem : level) {
+        bytes += elem.capacity() * sizeof(T);
+      }
+    }
+    return bytes;
+  }
+
 private:
   std::vector<std::vector<std::vector<T>>> data_;
   size_t dense_size_;
@@ -566,4 +604,40 @@ std::ostream& toVtk(std::string const& name, EdgeData<double> const& e_data, Gri
 std::ostream& toVtk(std::string const& name, VertexData<double> const& v_data, Grid const& grid,
                     std::ostream& os = std::cout);
 
+//===------------------------------------------------------------------------------------------===//
+// vtu output
+//===------------------------------------------------------------------------------------------===//
+
+// Writes the grid together with any number of fields into a single XML unstructured grid file
+// (.vtu) using raw appended binary data. As for toVtk the levels are stacked, i.e. level k is
+// placed at z = k, and only the faces which do not wrap around a periodic boundary are written.
+//
+//  - face fields are written as cell data
+//  - vertex fields are written as point data
+//  - edge fields are written as cell data, averaged over the three edges of each face
+//
+// The writer only keeps references to the fields, they need to stay alive until write() is called.
+// Values are streamed from the field buffers, contiguous levels are written as a whole.
+class VtuWriter {
+public:
+  VtuWriter(Grid const& grid, int k_size);
+
+  VtuWriter& add(std::string const& name, FaceData<double> const& f_data);
+  VtuWriter& add(std::string const& name, EdgeData<double> const& e_data);
+  VtuWriter& add(std::string const& name, VertexData<double> const& v_data);
+
+  std::ostream& write(std::ostream& os) const;
+  void write(std::string const& fname) const;
+
+private:
+  Grid const& grid_;
+  int k_size_;
+  // faces written as cells
+  std::vector<Face const*> cells_;
+
+  std::vector<std::pair<std::string, FaceData<double> const*>> face_fields_;
+  std::vector<std::pair<std::string, EdgeData<double> const*>> edge_fields_;
+  std::vector<std::pair<std::string, VertexData<double> const*>> vertex_fields_;
+};
+
 } // namespace toylib
\ No newline at end of file
@@ -44,12 +44,8 @@ for ny in range(16, 128+1, 16):
             rotErrors.append(parseError(line))
         elif (line.startswith('[lap]')):
             lapErrors.append(parseError(line))
-        elif (line.startswith('---')):
-            continue
-        else:
-            print("unexpected line in ouptut")
-            sys.exit(1)
+        # all other lines (timings, output statistics) are ignored
 
 toCSV(divErrors, processName[2:] + "ConvDiv.csv")
-toCSV(divErrors, processName[2:] + "ConvRot.csv")
-toCSV(divErrors, processName[2:] + "ConvLap.csv")
+toCSV(rotErrors, processName[2:] + "ConvRot.csv")
+toCSV(lapErrors, processName[2:] + "ConvLap.csv")
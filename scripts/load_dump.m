@@ -0,0 +1,18 @@
+function data = load_dump(fname)
+  % reads a file written by one of the dump functions, works for both the ascii and the binary
+  % dump format (see stencils/io/dumpBackend.h). returns a numRows x numCols matrix, i.e. the same
+  % as load(fname) for ascii dumps
+  fid = fopen(fname, 'r');
+  magic = fread(fid, 4, 'char=>char')';
+  if ~strcmp(magic, 'ADMP')
+    fclose(fid);
+    data = load(fname);
+    return;
+  end
+  version = fread(fid, 1, 'uint32', 0, 'ieee-le');
+  numRows = fread(fid, 1, 'uint64', 0, 'ieee-le');
+  numCols = fread(fid, 1, 'uint32', 0, 'ieee-le');
+  fread(fid, 1, 'uint32', 0, 'ieee-le');
+  data = fread(fid, [numRows, numCols], 'double', 0, 'ieee-le');
+  fclose(fid);
+endfunction
@@ -0,0 +1,20 @@
+import struct
+import sys
+
+
+def load_dump(fname):
+    """reads a file written by one of the dump functions (ascii or binary, see
+    stencils/io/dumpBackend.h), returns a list of rows"""
+    with open(fname, 'rb') as f:
+        if f.read(4) != b'ADMP':
+            with open(fname) as ascii:
+                return [[float(token) for token in line.split()] for line in ascii if line.strip()]
+        version, numRows, numCols, _ = struct.unpack('<IQII', f.read(20))
+        columns = [struct.unpack('<%dd' % numRows, f.read(8 * numRows)) for _ in range(numCols)]
+        return [list(row) for row in zip(*columns)]
+
+
+if __name__ == "__main__":
+    for fname in sys.argv[1:]:
+        rows = load_dump(fname)
+        print("%s: %d rows, %d columns" % (fname, len(rows), len(rows[0]) if rows else 0))
@@ -0,0 +1,121 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Compares the matrix free ICON Laplacian (the generated stencil on the atlas backend) with its
+// assembled form (atlasIconLaplaceMatrix.h) applied by a parallel sparse matrix vector product, on
+// rectangular meshes of increasing size. Assembling costs some time up front, which pays off after
+// a number of applications; for each mesh the time per application of both variants, the assembly
+// time and the number of applications after which the assembled form is faster overall are
+// reported. The results of both variants are checked to agree on the inner edges.
+
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include <atlas/array.h>
+#include <atlas/mesh.h>
+
+#include "interfaces/atlas_interface.hpp"
+
+#include "atlasIconLaplaceMatrix.h"
+#include "atlasIconLaplaceSetup.h"
+#include "generated_iconLaplace.hpp"
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/CsrMatrix.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/ParallelFor.h"
+#include "../utils/WallClock.h"
+
+namespace {
+// runs fn at least minRuns times and for at least minSeconds, returns the time per run
+template <typename Fn>
+double timePerRun(Fn&& fn, int minRuns = 3, double minSeconds = 0.2) {
+  int runs = 0;
+  auto start = Clock::now();
+  do {
+    fn();
+    runs++;
+  } while(runs < minRuns || SecondsSince(start) < minSeconds);
+  return SecondsSince(start) / runs;
+}
+
+// returns false if the results differ on the inner edges
+bool benchmarkMesh(int ny, int k_size) {
+  atlas::Mesh mesh = AtlasMeshRectComplete(ny);
+  AtlasToCartesian wrapper(mesh, true);
+  AtlasIconLaplaceFields fields(mesh, wrapper, k_size);
+
+  const double timeMatrixFree = timePerRun([&]() {
+    dawn_generated::cxxnaiveico::ICON_laplacian_stencil<atlasInterface::atlasTag>(
+        mesh, k_size, fields.vec, fields.div_vec, fields.rot_vec, fields.nabla2t1_vec,
+        fields.nabla2t2_vec, fields.nabla2_vec, fields.primal_edge_length,
+        fields.dual_edge_length, fields.tangent_orientation, fields.geofac_rot, fields.geofac_div)
+        .run();
+  });
+
+  auto start = Clock::now();
+  CsrMatrix laplacian = AssembleIconLaplaceMatrix(mesh, fields);
+  const double timeAssembly = SecondsSince(start);
+
+  auto vec = atlas::array::make_view<double, 2>(fields.vec_F);
+  std::vector<double> nabla2(mesh.edges().size() * k_size);
+  const double timeAssembled =
+      timePerRun([&]() { CsrApply(laplacian, vec.data(), nabla2.data(), k_size); });
+
+  // the order of the operations differs, so do the results in the last few bits
+  double maxDiff = 0.;
+  double maxAbs = 0.;
+  for(int edgeIdx : wrapper.innerEdges(mesh)) {
+    for(int k = 0; k < k_size; k++) {
+      const double ref = fields.nabla2_vec(edgeIdx, k);
+      maxDiff = fmax(maxDiff, fabs(nabla2[edgeIdx * k_size + k] - ref));
+      maxAbs = fmax(maxAbs, fabs(ref));
+    }
+  }
+  const bool agree = maxDiff <= 1e-10 * maxAbs;
+
+  // applications n after which assembly + n * timeAssembled < n * timeMatrixFree
+  const double gain = timeMatrixFree - timeAssembled;
+  const int breakEven = gain > 0. ? int(ceil(timeAssembly / gain)) : -1;
+
+  printf("%5d %8d %9d %12.3f %12.3f %12.3f %8.1f %10d %10.2e %s\n", ny, int(mesh.edges().size()),
+         laplacian.numNonZeros(), 1e3 * timeMatrixFree, 1e3 * timeAssembled, 1e3 * timeAssembly,
+         timeMatrixFree / timeAssembled, breakEven, maxDiff / maxAbs, agree ? "" : "MISMATCH");
+  return agree;
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  if(argc > 3) {
+    std::cout << "intended use is\n" << argv[0] << " [k_size] [max_ny]" << std::endl;
+    return -1;
+  }
+  const int k_size = argc > 1 ? atoi(argv[1]) : 1;
+  const int maxNy = argc > 2 ? atoi(argv[2]) : 64;
+  if(k_size < 1 || maxNy < 8) {
+    std::cout << "k_size needs to be at least 1, max_ny at least 8\n";
+    return -1;
+  }
+
+  printf("%d levels, %d threads, times in ms per application\n", k_size, NumThreads());
+  printf("%5s %8s %9s %12s %12s %12s %8s %10s %10s\n", "ny", "edges", "nonzeros", "matrix free",
+         "assembled", "assembly", "speedup", "break even", "rel diff");
+  bool agree = true;
+  for(int ny = 8; ny <= maxNy; ny *= 2) {
+    agree = benchmarkMesh(ny, k_size) && agree;
+  }
+  return agree ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Compares applying the ICON Laplacian to N fields one by one (ICON_laplacian_stencil) with
+// applying it to all N at once (ICON_laplacian_batched_stencil, iconLaplaceBatched.hpp) on the
+// atlas backend, for N = 1, 4, 8, 16 and 32. The fields are scaled copies of vec. Reports the time
+// per field of both variants and checks that the results are identical.
+//
+// Furthermore the output is checked against the analytical Laplacian, once with the error norms
+// accumulated within the edge loop of the batched stencil (fused) and once with a separate pass
+// over the output after the stencil. Both need to give the same norms.
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <atlas/array.h>
+#include <atlas/field.h>
+#include <atlas/mesh.h>
+
+#include "interfaces/atlas_interface.hpp"
+
+#include "atlasIconLaplaceSetup.h"
+#include "generated_iconLaplace.hpp"
+#include "iconLaplaceBatched.hpp"
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/ErrorNorms.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/WallClock.h"
+
+namespace {
+using atlasInterface::atlasTag;
+
+// input, intermediary and output fields of one member of the batch
+class MemberFields {
+public:
+  MemberFields(const atlas::Mesh& mesh, int k_size)
+      : vec_F(makeField("vec", mesh.edges().size(), k_size)),
+        div_vec_F(makeField("div_vec", mesh.cells().size(), k_size)),
+        rot_vec_F(makeField("rot_vec", mesh.nodes().size(), k_size)),
+        nabla2t1_vec_F(makeField("nabla2t1_vec", mesh.edges().size(), k_size)),
+        nabla2t2_vec_F(makeField("nabla2t2_vec", mesh.edges().size(), k_size)),
+        nabla2_vec_F(makeField("nabla2_vec", mesh.edges().size(), k_size)),
+        vec(atlas::array::make_view<double, 2>(vec_F)),
+        div_vec(atlas::array::make_view<double, 2>(div_vec_F)),
+        rot_vec(atlas::array::make_view<double, 2>(rot_vec_F)),
+        nabla2t1_vec(atlas::array::make_view<double, 2>(nabla2t1_vec_F)),
+        nabla2t2_vec(atlas::array::make_view<double, 2>(nabla2t2_vec_F)),
+        nabla2_vec(atlas::array::make_view<double, 2>(nabla2_vec_F)) {}
+  MemberFields(const MemberFields&) = delete;
+
+  atlas::Field vec_F, div_vec_F, rot_vec_F, nabla2t1_vec_F, nabla2t2_vec_F, nabla2_vec_F;
+  atlasInterface::Field<double> vec, div_vec, rot_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec;
+
+private:
+  static atlas::Field makeField(const std::string& name, int size, int k_size) {
+    return atlas::Field{name, atlas::array::DataType::real64(),
+                        atlas::array::make_shape(size, k_size)};
+  }
+};
+
+template <int N>
+void benchmarkBatch(const atlas::Mesh& mesh, AtlasIconLaplaceFields& fields,
+                    const std::vector<char>& innerEdges, int runs, bool& identical) {
+  const int k_size = fields.k_size;
+  std::vector<std::unique_ptr<MemberFields>> single, batched;
+  for(int n = 0; n < N; n++) {
+    single.push_back(std::make_unique<MemberFields>(mesh, k_size));
+    batched.push_back(std::make_unique<MemberFields>(mesh, k_size));
+    for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
+      for(int k = 0; k < k_size; k++) {
+        single[n]->vec(edgeIdx, k) = (n + 1) * fields.vec(edgeIdx, k);
+        batched[n]->vec(edgeIdx, k) = (n + 1) * fields.vec(edgeIdx, k);
+      }
+    }
+  }
+
+  auto start = Clock::now();
+  for(int run = 0; run < runs; run++) {
+    for(int n = 0; n < N; n++) {
+      MemberFields& f = *single[n];
+      dawn_generated::cxxnaiveico::ICON_laplacian_stencil<atlasTag>(
+          mesh, k_size, f.vec, f.div_vec, f.rot_vec, f.nabla2t1_vec, f.nabla2t2_vec, f.nabla2_vec,
+          fields.primal_edge_length, fields.dual_edge_length, fields.tangent_orientation,
+          fields.geofac_rot, fields.geofac_div)
+          .run();
+    }
+  }
+  const double timeSingle = SecondsSince(start) / runs / N;
+
+  using stencil_t = ICON_laplacian_batched_stencil<atlasTag, N>;
+  typename stencil_t::template batch_t<atlasInterface::Field<double>> vec, div_vec, rot_vec,
+      nabla2t1_vec, nabla2t2_vec, nabla2_vec;
+  for(int n = 0; n < N; n++) {
+    vec[n] = &batched[n]->vec;
+    div_vec[n] = &batched[n]->div_vec;
+    rot_vec[n] = &batched[n]->rot_vec;
+    nabla2t1_vec[n] = &batched[n]->nabla2t1_vec;
+    nabla2t2_vec[n] = &batched[n]->nabla2t2_vec;
+    nabla2_vec[n] = &batched[n]->nabla2_vec;
+  }
+  start = Clock::now();
+  for(int run = 0; run < runs; run++) {
+    stencil_t(mesh, k_size, vec, div_vec, rot_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec,
+              fields.primal_edge_length, fields.dual_edge_length, fields.tangent_orientation,
+              fields.geofac_rot, fields.geofac_div)
+        .run();
+  }
+  const double timeBatched = SecondsSince(start) / runs / N;
+
+  // bitwise comparison, NaNs at the boundary included
+  bool same = true;
+  for(int n = 0; n < N; n++) {
+    auto ref = atlas::array::make_view<double, 2>(single[n]->nabla2_vec_F);
+    auto out = atlas::array::make_view<double, 2>(batched[n]->nabla2_vec_F);
+    same = same && memcmp(ref.data(), out.data(), sizeof(double) * ref.size()) == 0;
+  }
+
+  // error norms of member n against the analytical solution (scaled like the input) on level 0
+  auto solution = [&](int n) {
+    return [&fields, n](int edgeIdx) { return (n + 1) * fields.lapVecSol(edgeIdx, 0); };
+  };
+  auto stencil = [&]() {
+    return stencil_t(mesh, k_size, vec, div_vec, rot_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec,
+                     fields.primal_edge_length, fields.dual_edge_length,
+                     fields.tangent_orientation, fields.geofac_rot, fields.geofac_div);
+  };
+  std::vector<ErrorNormsAccumulator> fused(N, ErrorNormsAccumulator(mesh.edges().size()));
+  start = Clock::now();
+  stencil().run([&](int edgeIdx, int k, int n, double value) {
+    if(k == 0 && innerEdges[edgeIdx]) {
+      fused[n].add(edgeIdx, solution(n)(edgeIdx), value);
+    }
+  });
+  const double timeFused = SecondsSince(start) / N;
+
+  std::vector<ErrorNorms> separate;
+  start = Clock::now();
+  stencil().run();
+  for(int n = 0; n < N; n++) {
+    auto output = [&, n](int edgeIdx) { return (*nabla2_vec[n])(edgeIdx, 0); };
+    separate.push_back(ComputeErrorNorms(solution(n), output, innerEdges));
+  }
+  const double timeSeparate = SecondsSince(start) / N;
+
+  for(int n = 0; n < N; n++) {
+    const ErrorNorms norms = fused[n].result();
+    same = same && norms.Linf == separate[n].Linf && norms.L1 == separate[n].L1 &&
+           norms.L2 == separate[n].L2 && norms.count == separate[n].count;
+  }
+  identical = identical && same;
+
+  printf("%4d %14.3f %14.3f %8.1f %14.3f %14.3f %s\n", N, 1e3 * timeSingle, 1e3 * timeBatched,
+         timeSingle / timeBatched, 1e3 * timeFused, 1e3 * timeSeparate,
+         same ? "identical" : "MISMATCH");
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  if(argc < 2 || argc > 4) {
+    std::cout << "intended use is\n" << argv[0] << " ny [k_size] [runs]" << std::endl;
+    return -1;
+  }
+  const int w = atoi(argv[1]);
+  const int k_size = argc > 2 ? atoi(argv[2]) : 1;
+  const int runs = argc > 3 ? atoi(argv[3]) : 1;
+  if(w < 2 || k_size < 1 || runs < 1) {
+    std::cout << "ny needs to be at least 2, k_size and runs at least 1\n";
+    return -1;
+  }
+
+  atlas::Mesh mesh = AtlasMeshRectComplete(w);
+  AtlasToCartesian wrapper(mesh, true);
+  AtlasIconLaplaceFields fields(mesh, wrapper, k_size);
+
+  printf("mesh with %d edges, %d levels, times in ms per field\n", int(mesh.edges().size()),
+         k_size);
+  printf("%4s %14s %14s %8s %14s %14s\n", "N", "one by one", "batched", "speedup",
+         "fused check", "check after");
+  const std::vector<char> innerEdges = wrapper.innerEdgesMask(mesh);
+  bool identical = true;
+  benchmarkBatch<1>(mesh, fields, innerEdges, runs, identical);
+  benchmarkBatch<4>(mesh, fields, innerEdges, runs, identical);
+  benchmarkBatch<8>(mesh, fields, innerEdges, runs, identical);
+  benchmarkBatch<16>(mesh, fields, innerEdges, runs, identical);
+  benchmarkBatch<32>(mesh, fields, innerEdges, runs, identical);
+  return identical ? 0 : 1;
+}
@@ -35,17 +35,15 @@
 // atlas utilities
 #include "../utils/AtlasCartesianWrapper.h"
 #include "../utils/AtlasFromNetcdf.h"
+#include "../utils/ErrorNorms.h"
 #include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/WallClock.h"
 #include "interfaces/unstructured_interface.hpp"
 
 // io
+#include "io/asyncWriter.h"
 #include "io/atlasIO.h"
 
-std::tuple<double, double, double> MeasureErrors(std::vector<int> indices,
-                                                 const atlasInterface::Field<double>& ref,
-                                                 const atlasInterface::Field<double>& sol,
-                                                 int level);
-
 int main(int argc, char const* argv[]) {
   // enable floating point exception
   // feenableexcept(FE_INVALID | FE_OVERFLOW);
@@ -265,52 +263,50 @@ int main(int argc, char const* argv[]) {
       .run();
 
   //===------------------------------------------------------------------------------------------===//
-  // dumping a hopefully nice colorful laplacian
+  // dumping a hopefully nice colorful laplacian (in the background, while the errors are measured)
   //===------------------------------------------------------------------------------------------===//
-  dumpEdgeField("diamondLaplICONatlas_out.txt", mesh, wrapper, nabla2, 0, wrapper.innerEdges(mesh));
-  dumpEdgeField("diamondLaplICONatlas_sol.txt", mesh, wrapper, nabla2_sol, 0,
-                wrapper.innerEdges(mesh));
-
-  {
+  auto wallStart = Clock::now();
+  AsyncWriter writer;
+  writer.submit([&, f = nabla2]() mutable {
+    dumpEdgeField("diamondLaplICONatlas_out.txt", mesh, wrapper, f, 0, wrapper.innerEdges(mesh));
+  });
+  writer.submit([&, f = nabla2_sol]() mutable {
+    dumpEdgeField("diamondLaplICONatlas_sol.txt", mesh, wrapper, f, 0, wrapper.innerEdges(mesh));
+  });
+  writer.submit([&, f = kh_smag]() {
     FILE* fp = fopen("kh_smag_ref.txt", "w+");
     for(int level = 0; level < k_size; level++) {
       for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-        fprintf(fp, "%f ", kh_smag(edgeIdx, level));
+        fprintf(fp, "%f ", f(edgeIdx, level));
       }
       fprintf(fp, "\n");
     }
     fclose(fp);
-  }
+  });
 
   //===------------------------------------------------------------------------------------------===//
   // measuring errors
   //===------------------------------------------------------------------------------------------===//
+  const std::vector<char> innerEdges = wrapper.innerEdgesMask(mesh);
   for(int i = 0; i < k_size; i++) {
-    auto [Linf, L1, L2] = MeasureErrors(wrapper.innerEdges(mesh), nabla2_sol, nabla2, i);
+    ErrorNorms norms = ComputeErrorNorms([&](int edgeIdx) { return nabla2_sol(edgeIdx, i); },
+                                         [&](int edgeIdx) { return nabla2(edgeIdx, i); },
+                                         innerEdges);
     // printf("[lap] dx: %e L_inf: %e L_1: %e L_2: %e\n", 180. / w, Linf, L1, L2);
-    printf("%e %e %e %e\n", 180. / w, Linf, L1, L2);
+    printf("%e %e %e %e\n", 180. / w, norms.Linf, norms.L1, norms.L2);
   }
 
+  writer.flush();
+  double wallTime = SecondsSince(wallStart);
+  printf("output: %d dumps, stalled %f s of %f s (%.2f%%)\n", writer.jobsWritten(),
+         writer.stallTime(), wallTime, 100. * writer.stallTime() / wallTime);
+
+  INSTRUMENT_REPORT("diamondLaplacian_trace.json");
+
   return 0;
 }
 
-std::tuple<double, double, double> MeasureErrors(std::vector<int> indices,
-                                                 const atlasInterface::Field<double>& ref,
-                                                 const atlasInterface::Field<double>& sol,
-                                                 int level) {
-  double Linf = 0.;
-  double L1 = 0.;
-  double L2 = 0.;
-  for(int idx : indices) {
-    double dif = ref(idx, level) - sol(idx, level);
-    Linf = fmax(fabs(dif), Linf);
-    L1 += fabs(dif);
-    L2 += dif * dif;
-  }
-  L1 /= indices.size();
-  L2 = sqrt(L2) / sqrt(indices.size());
-  return {Linf, L1, L2};
-} // {
+// {
   //   FILE* fp = fopen("input.txt", "w+");
   //   for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
   //     auto cToE = atlasInterface::getNeighbors(
@@ -0,0 +1,70 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "atlasIconLaplaceMatrix.h"
+
+#include <utility>
+#include <vector>
+
+#include "../utils/ParallelFor.h"
+
+CsrMatrix AssembleIconLaplaceMatrix(const atlas::Mesh& mesh, const AtlasIconLaplaceFields& fields) {
+  using atlasInterface::atlasTag;
+  using dawn::LocationType;
+
+  // the weights of the two neighbors in the edge -> vertex and edge -> cell reductions
+  const double weights[2] = {-1., 1.};
+  const int level = 0;
+
+  std::vector<std::vector<std::pair<int, double>>> rows(mesh.edges().size());
+  ParallelFor(
+      0, mesh.edges().size(),
+      [&](int edgeIdx) {
+        const double primal = fields.primal_edge_length(edgeIdx, level);
+        const double dual = fields.dual_edge_length(edgeIdx, level);
+        if(primal == 0. || dual == 0.) {
+          return;
+        }
+        auto& row = rows[edgeIdx];
+
+        // - tangent_orientation / primal_edge_length * (rot_vec(v_1) - rot_vec(v_0))
+        const double rotScale = -fields.tangent_orientation(edgeIdx, level) / primal;
+        auto nodes = getNeighbors(atlasTag{}, mesh, {LocationType::Edges, LocationType::Vertices},
+                                  edgeIdx);
+        for(size_t nbhIdx = 0; nbhIdx < nodes.size(); nbhIdx++) {
+          const int nodeIdx = nodes[nbhIdx];
+          auto nodeEdges = getNeighbors(atlasTag{}, mesh,
+                                        {LocationType::Vertices, LocationType::Edges}, nodeIdx);
+          for(size_t sparseIdx = 0; sparseIdx < nodeEdges.size(); sparseIdx++) {
+            row.push_back({nodeEdges[sparseIdx], rotScale * weights[nbhIdx] *
+                                                     fields.geofac_rot(nodeIdx, sparseIdx, level)});
+          }
+        }
+
+        // (div_vec(c_1) - div_vec(c_0)) / dual_edge_length
+        auto cells =
+            getNeighbors(atlasTag{}, mesh, {LocationType::Edges, LocationType::Cells}, edgeIdx);
+        for(size_t nbhIdx = 0; nbhIdx < cells.size(); nbhIdx++) {
+          const int cellIdx = cells[nbhIdx];
+          auto cellEdges = getNeighbors(atlasTag{}, mesh,
+                                        {LocationType::Cells, LocationType::Edges}, cellIdx);
+          for(size_t sparseIdx = 0; sparseIdx < cellEdges.size(); sparseIdx++) {
+            row.push_back({cellEdges[sparseIdx], weights[nbhIdx] / dual *
+                                                     fields.geofac_div(cellIdx, sparseIdx, level)});
+          }
+        }
+      },
+      256);
+  return CsrFromRows(mesh.edges().size(), rows);
+}
@@ -0,0 +1,39 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Assembled form of the ICON vector Laplacian (ICON_laplacian_stencil in generated_iconLaplace.hpp)
+// as a sparse edge -> edge matrix. The stencil computes
+//
+//   rot_vec(v)    = sum_i geofac_rot(v, i) vec(e_i(v))
+//   div_vec(c)    = sum_i geofac_div(c, i) vec(e_i(c))
+//   nabla2_vec(e) = (div_vec(c_1) - div_vec(c_0)) / dual_edge_length(e)
+//                   - tangent_orientation(e) (rot_vec(v_1) - rot_vec(v_0)) / primal_edge_length(e)
+//
+// which is linear in vec and is composed into one row per edge here. Applying the matrix
+// (CsrApply, all levels at once) gives the same result as running the stencil, up to round off.
+//
+// The geometrical factors are taken from level 0, i.e. they are assumed to be the same on all
+// levels (which is how AtlasIconLaplaceFields initializes them). Rows of edges with a dual (or
+// primal) edge length of 0, i.e. of boundary edges, are left empty: the stencil divides by zero
+// there and its result is meaningless anyway.
+
+#pragma once
+
+#include <atlas/mesh.h>
+
+#include "atlasIconLaplaceSetup.h"
+
+#include "../utils/CsrMatrix.h"
+
+CsrMatrix AssembleIconLaplaceMatrix(const atlas::Mesh& mesh, const AtlasIconLaplaceFields& fields);
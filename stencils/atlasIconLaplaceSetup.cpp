@@ -0,0 +1,350 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "atlasIconLaplaceSetup.h"
+
+#include <cassert>
+#include <cmath>
+#include <tuple>
+
+namespace {
+template <typename T>
+static int sgn(T val) {
+  return (T(0) < val) - (val < T(0));
+}
+
+atlas::Field MakeAtlasField(const std::string& name, int size, int k_size) {
+  return atlas::Field{name, atlas::array::DataType::real64(),
+                      atlas::array::make_shape(size, k_size)};
+}
+
+atlas::Field MakeAtlasSparseField(const std::string& name, int size, int k_size, int sparseSize) {
+  return atlas::Field{name, atlas::array::DataType::real64(),
+                      atlas::array::make_shape(size, k_size, sparseSize)};
+}
+
+// copies level 0 of a field to all other levels
+void CopyLevel0(atlasInterface::Field<double>& field, int size, int k_size) {
+  for(int idx = 0; idx < size; idx++) {
+    for(int k = 1; k < k_size; k++) {
+      field(idx, k) = field(idx, 0);
+    }
+  }
+}
+void CopyLevel0(atlasInterface::SparseDimension<double>& field, int size, int sparseSize,
+                int k_size) {
+  for(int idx = 0; idx < size; idx++) {
+    for(int nbhIdx = 0; nbhIdx < sparseSize; nbhIdx++) {
+      for(int k = 1; k < k_size; k++) {
+        field(idx, nbhIdx, k) = field(idx, nbhIdx, 0);
+      }
+    }
+  }
+}
+} // namespace
+
+AtlasIconLaplaceFields::AtlasIconLaplaceFields(const atlas::Mesh& mesh,
+                                               const AtlasToCartesian& wrapper, int k_size)
+    : k_size(k_size), vec_F(MakeAtlasField("vec", mesh.edges().size(), k_size)),
+      divVecSol_F(MakeAtlasField("divVecSol", mesh.cells().size(), k_size)),
+      rotVecSol_F(MakeAtlasField("rotVecSol", mesh.nodes().size(), k_size)),
+      lapVecSol_F(MakeAtlasField("lapVecSol", mesh.edges().size(), k_size)),
+      nabla2_vec_F(MakeAtlasField("nabla2_vec", mesh.edges().size(), k_size)),
+      nabla2t1_vec_F(MakeAtlasField("nabla2t1_vec", mesh.edges().size(), k_size)),
+      nabla2t2_vec_F(MakeAtlasField("nabla2t2_vec", mesh.edges().size(), k_size)),
+      rot_vec_F(MakeAtlasField("rot_vec", mesh.nodes().size(), k_size)),
+      div_vec_F(MakeAtlasField("div_vec", mesh.cells().size(), k_size)),
+      geofac_rot_F(
+          MakeAtlasSparseField("geofac_rot", mesh.nodes().size(), k_size, edgesPerVertex)),
+      edge_orientation_vertex_F(MakeAtlasSparseField(
+          "edge_orientation_vertex", mesh.nodes().size(), k_size, edgesPerVertex)),
+      geofac_div_F(
+          MakeAtlasSparseField("geofac_div", mesh.cells().size(), k_size, edgesPerCell)),
+      edge_orientation_cell_F(MakeAtlasSparseField("edge_orientation_cell", mesh.cells().size(),
+                                                   k_size, edgesPerCell)),
+      tangent_orientation_F(MakeAtlasField("tangent_orientation", mesh.edges().size(), k_size)),
+      primal_edge_length_F(MakeAtlasField("primal_edge_length", mesh.edges().size(), k_size)),
+      dual_edge_length_F(MakeAtlasField("dual_edge_length", mesh.edges().size(), k_size)),
+      primal_normal_x_F(MakeAtlasField("primal_normal_x", mesh.edges().size(), k_size)),
+      primal_normal_y_F(MakeAtlasField("primal_normal_y", mesh.edges().size(), k_size)),
+      dual_normal_x_F(MakeAtlasField("dual_normal_x", mesh.edges().size(), k_size)),
+      dual_normal_y_F(MakeAtlasField("dual_normal_y", mesh.edges().size(), k_size)),
+      cell_area_F(MakeAtlasField("cell_area", mesh.cells().size(), k_size)),
+      dual_cell_area_F(MakeAtlasField("dual_cell_area", mesh.nodes().size(), k_size)),
+      vec(atlas::array::make_view<double, 2>(vec_F)),
+      divVecSol(atlas::array::make_view<double, 2>(divVecSol_F)),
+      rotVecSol(atlas::array::make_view<double, 2>(rotVecSol_F)),
+      lapVecSol(atlas::array::make_view<double, 2>(lapVecSol_F)),
+      nabla2_vec(atlas::array::make_view<double, 2>(nabla2_vec_F)),
+      nabla2t1_vec(atlas::array::make_view<double, 2>(nabla2t1_vec_F)),
+      nabla2t2_vec(atlas::array::make_view<double, 2>(nabla2t2_vec_F)),
+      rot_vec(atlas::array::make_view<double, 2>(rot_vec_F)),
+      div_vec(atlas::array::make_view<double, 2>(div_vec_F)),
+      geofac_rot(atlas::array::make_view<double, 3>(geofac_rot_F)),
+      edge_orientation_vertex(atlas::array::make_view<double, 3>(edge_orientation_vertex_F)),
+      geofac_div(atlas::array::make_view<double, 3>(geofac_div_F)),
+      edge_orientation_cell(atlas::array::make_view<double, 3>(edge_orientation_cell_F)),
+      tangent_orientation(atlas::array::make_view<double, 2>(tangent_orientation_F)),
+      primal_edge_length(atlas::array::make_view<double, 2>(primal_edge_length_F)),
+      dual_edge_length(atlas::array::make_view<double, 2>(dual_edge_length_F)),
+      primal_normal_x(atlas::array::make_view<double, 2>(primal_normal_x_F)),
+      primal_normal_y(atlas::array::make_view<double, 2>(primal_normal_y_F)),
+      dual_normal_x(atlas::array::make_view<double, 2>(dual_normal_x_F)),
+      dual_normal_y(atlas::array::make_view<double, 2>(dual_normal_y_F)),
+      cell_area(atlas::array::make_view<double, 2>(cell_area_F)),
+      dual_cell_area(atlas::array::make_view<double, 2>(dual_cell_area_F)) {
+  // everything is computed on level 0 and copied to the other levels at the end
+  const int level = 0;
+
+  //===------------------------------------------------------------------------------------------===//
+  // initialize geometrical info on edges
+  //===------------------------------------------------------------------------------------------===//
+  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
+    primal_edge_length(edgeIdx, level) = wrapper.edgeLength(mesh, edgeIdx);
+    dual_edge_length(edgeIdx, level) = wrapper.dualEdgeLength(mesh, edgeIdx);
+    tangent_orientation(edgeIdx, level) = wrapper.tangentOrientation(mesh, edgeIdx);
+    auto [nx, ny] = wrapper.primalNormal(mesh, edgeIdx);
+    primal_normal_x(edgeIdx, level) = nx;
+    primal_normal_y(edgeIdx, level) = ny;
+    // The primal normal, dual normal
+    // forms a left-handed coordinate system
+    dual_normal_x(edgeIdx, level) = ny;
+    dual_normal_y(edgeIdx, level) = -nx;
+  }
+
+  //===------------------------------------------------------------------------------------------===//
+  // initialize geometrical info on cells
+  //===------------------------------------------------------------------------------------------===//
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    cell_area(cellIdx, level) = wrapper.cellArea(mesh, cellIdx);
+  }
+
+  //===------------------------------------------------------------------------------------------===//
+  // initialize geometrical info on vertices
+  //===------------------------------------------------------------------------------------------===//
+  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+    dual_cell_area(nodeIdx, level) = wrapper.dualCellArea(mesh, nodeIdx);
+  }
+
+  //===------------------------------------------------------------------------------------------===//
+  // input (spherical harmonics) and analytical solutions for div, curl and Laplacian
+  //===------------------------------------------------------------------------------------------===//
+
+  auto sphericalHarmonic = [](double x, double y) -> std::tuple<double, double> {
+    return {0.25 * sqrt(105. / (2 * M_PI)) * cos(2 * x) * cos(y) * cos(y) * sin(y),
+            0.5 * sqrt(15. / (2 * M_PI)) * cos(x) * cos(y) * sin(y)};
+  };
+  auto analyticalDivergence = [](double x, double y) {
+    return -0.5 * (sqrt(105. / (2 * M_PI))) * sin(2 * x) * cos(y) * cos(y) * sin(y) +
+           0.5 * sqrt(15. / (2 * M_PI)) * cos(x) * (cos(y) * cos(y) - sin(y) * sin(y));
+  };
+  auto analyticalCurl = [](double x, double y) {
+    double c1 = 0.25 * sqrt(105. / (2 * M_PI));
+    double c2 = 0.5 * sqrt(15. / (2 * M_PI));
+    double dudy = c1 * cos(2 * x) * cos(y) * (cos(y) * cos(y) - 2 * sin(y) * sin(y));
+    double dvdx = -c2 * cos(y) * sin(x) * sin(y);
+    return dvdx - dudy;
+  };
+  auto analyticalLaplacian = [](double x, double y) -> std::tuple<double, double> {
+    double c1 = 0.25 * sqrt(105. / (2 * M_PI));
+    double c2 = 0.5 * sqrt(15. / (2 * M_PI));
+    return {-4 * c1 * cos(2 * x) * cos(y) * cos(y) * sin(y), -4 * c2 * cos(x) * sin(y) * cos(y)};
+  };
+
+  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
+    auto [xm, ym] = wrapper.edgeMidpoint(mesh, edgeIdx);
+    auto [u, v] = sphericalHarmonic(xm, ym);
+    auto [lu, lv] = analyticalLaplacian(xm, ym);
+    vec(edgeIdx, level) = primal_normal_x(edgeIdx, level) * u + primal_normal_y(edgeIdx, level) * v;
+    lapVecSol(edgeIdx, level) =
+        primal_normal_x(edgeIdx, level) * lu + primal_normal_y(edgeIdx, level) * lv;
+  }
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    auto [xm, ym] = wrapper.cellMidpoint(mesh, cellIdx);
+    divVecSol(cellIdx, level) = analyticalDivergence(xm, ym);
+  }
+  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+    auto [xm, ym] = wrapper.nodeLocation(nodeIdx);
+    rotVecSol(nodeIdx, level) = analyticalCurl(xm, ym);
+  }
+
+  //===------------------------------------------------------------------------------------------===//
+  // Init geometrical factors (sparse fields)
+  //===------------------------------------------------------------------------------------------===//
+
+  // init edge orientations for vertices and cells
+  auto dot = [](const Vector& v1, const Vector& v2) {
+    return std::get<0>(v1) * std::get<0>(v2) + std::get<1>(v1) * std::get<1>(v2);
+  };
+
+  // Here, the ICON documentation states confusingly enough:
+  //
+  // +1 when the vector from this to the neigh-
+  // bor vertex has the same orientation as the
+  // tangent unit vector of the connecting edge.
+  // -1 otherwise
+  //
+  // what this is really supposed to achieve is to compute a sparse dimension which ensures
+  // that the normal and the orientation of the edge form a left handed coordinate system
+  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+    const auto& nodeEdgeConnectivity = mesh.nodes().edge_connectivity();
+    const auto& edgeNodeConnectivity = mesh.edges().node_connectivity();
+
+    const int missingVal = nodeEdgeConnectivity.missing_value();
+    int numNbh = nodeEdgeConnectivity.cols(nodeIdx);
+
+    // arbitrary val at boundary
+    bool anyMissing = false;
+    for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
+      anyMissing |= nodeEdgeConnectivity(nodeIdx, nbhIdx) == missingVal;
+    }
+    if(numNbh != 6 || anyMissing) {
+      for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
+        edge_orientation_vertex(nodeIdx, nbhIdx, level) = -1;
+      }
+      continue;
+    }
+
+    for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
+      int edgeIdx = nodeEdgeConnectivity(nodeIdx, nbhIdx);
+
+      int n0 = edgeNodeConnectivity(edgeIdx, 0);
+      int n1 = edgeNodeConnectivity(edgeIdx, 1);
+
+      int centerIdx = (n0 == nodeIdx) ? n0 : n1;
+      int farIdx = (n0 == nodeIdx) ? n1 : n0;
+
+      auto [xLo, yLo] = wrapper.nodeLocation(centerIdx);
+      auto [xHi, yHi] = wrapper.nodeLocation(farIdx);
+
+      Vector edge = {xHi - xLo, yHi - yLo};
+      Vector dualNormal = {dual_normal_x(edgeIdx, level), dual_normal_y(edgeIdx, level)};
+
+      // geometrical factor "corrects" normal such that the resulting system is left handed
+      edge_orientation_vertex(nodeIdx, nbhIdx, level) = sgn(dot(edge, dualNormal));
+    }
+  }
+
+  // ICON documentation states
+  //
+  // The orientation of the edge normal vector
+  // (the variable primal normal in the edges ta-
+  // ble) for the cell according to Gauss formula.
+  // It is equal to +1 if the normal to the edge
+  // is outwards from the cell, otherwise is -1.
+  //
+  // which is quite clear, here goes:
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    const atlas::mesh::HybridElements::Connectivity& cellEdgeConnectivity =
+        mesh.cells().edge_connectivity();
+    auto [xm, ym] = wrapper.cellCircumcenter(mesh, cellIdx);
+
+    int numNbh = cellEdgeConnectivity.cols(cellIdx);
+    assert(numNbh == edgesPerCell);
+
+    for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
+      int edgeIdx = cellEdgeConnectivity(cellIdx, nbhIdx);
+      auto [emX, emY] = wrapper.edgeMidpoint(mesh, edgeIdx);
+      Vector toOutsdie{emX - xm, emY - ym};
+      Vector primal = {primal_normal_x(edgeIdx, level), primal_normal_y(edgeIdx, level)};
+      edge_orientation_cell(cellIdx, nbhIdx, level) = sgn(dot(toOutsdie, primal));
+    }
+    // explanation: the vector cellMidpoint -> edgeMidpoint is guaranteed to point outside. The
+    // dot product checks if the edge normal has the same orientation. edgeMidpoint is arbitrary,
+    // any point on e would work just as well
+  }
+
+  // now, consume these two "orientation" fields to form the actual geometrical factors (which
+  // include information about the meshes edge lengths and cell areas)
+  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+    const atlas::mesh::Nodes::Connectivity& nodeEdgeConnectivity = mesh.nodes().edge_connectivity();
+
+    int numNbh = nodeEdgeConnectivity.cols(nodeIdx);
+
+    for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
+      int edgeIdx = nodeEdgeConnectivity(nodeIdx, nbhIdx);
+      geofac_rot(nodeIdx, nbhIdx, level) =
+          (dual_cell_area(nodeIdx, level) == 0.)
+              ? 0
+              : dual_edge_length(edgeIdx, level) * edge_orientation_vertex(nodeIdx, nbhIdx, level) /
+                    dual_cell_area(nodeIdx, level);
+    }
+    // Original ICON code
+    //
+    // ptr_int%geofac_rot(jv,je,jb) =                &
+    //    & ptr_patch%edges%dual_edge_length(ile,ibe) * &
+    //    & ptr_patch%verts%edge_orientation(jv,jb,je)/ &
+    //    & ptr_patch%verts%dual_area(jv,jb) * REAL(ifac,wp)
+  }
+
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    const atlas::mesh::HybridElements::Connectivity& cellEdgeConnectivity =
+        mesh.cells().edge_connectivity();
+
+    int numNbh = cellEdgeConnectivity.cols(cellIdx);
+    assert(numNbh == edgesPerCell);
+
+    for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
+      int edgeIdx = cellEdgeConnectivity(cellIdx, nbhIdx);
+      geofac_div(cellIdx, nbhIdx, level) = primal_edge_length(edgeIdx, level) *
+                                           edge_orientation_cell(cellIdx, nbhIdx, level) /
+                                           cell_area(cellIdx, level);
+    }
+    // Original ICON code
+    //
+    //  ptr_int%geofac_div(jc,je,jb) = &
+    //    & ptr_patch%edges%primal_edge_length(ile,ibe) * &
+    //    & ptr_patch%cells%edge_orientation(jc,jb,je)  / &
+    //    & ptr_patch%cells%area(jc,jb)
+  }
+
+  //===------------------------------------------------------------------------------------------===//
+  // all levels are the same
+  //===------------------------------------------------------------------------------------------===//
+  const int numEdges = mesh.edges().size();
+  const int numCells = mesh.cells().size();
+  const int numNodes = mesh.nodes().size();
+  for(auto* field : {&vec, &lapVecSol, &tangent_orientation, &primal_edge_length,
+                     &dual_edge_length, &primal_normal_x, &primal_normal_y, &dual_normal_x,
+                     &dual_normal_y}) {
+    CopyLevel0(*field, numEdges, k_size);
+  }
+  for(auto* field : {&divVecSol, &cell_area}) {
+    CopyLevel0(*field, numCells, k_size);
+  }
+  for(auto* field : {&rotVecSol, &dual_cell_area}) {
+    CopyLevel0(*field, numNodes, k_size);
+  }
+  CopyLevel0(geofac_rot, numNodes, edgesPerVertex, k_size);
+  CopyLevel0(edge_orientation_vertex, numNodes, edgesPerVertex, k_size);
+  CopyLevel0(geofac_div, numCells, edgesPerCell, k_size);
+  CopyLevel0(edge_orientation_cell, numCells, edgesPerCell, k_size);
+}
+
+void AtlasIconLaplaceFields::addFootprint(MemoryFootprint& footprint) const {
+  for(const atlas::Field* field :
+      {&vec_F, &lapVecSol_F, &nabla2_vec_F, &nabla2t1_vec_F, &nabla2t2_vec_F,
+       &tangent_orientation_F, &primal_edge_length_F, &dual_edge_length_F, &primal_normal_x_F,
+       &primal_normal_y_F, &dual_normal_x_F, &dual_normal_y_F}) {
+    AddFootprint(footprint, FootprintLocation::Edges, *field);
+  }
+  for(const atlas::Field* field :
+      {&divVecSol_F, &div_vec_F, &geofac_div_F, &edge_orientation_cell_F, &cell_area_F}) {
+    AddFootprint(footprint, FootprintLocation::Cells, *field);
+  }
+  for(const atlas::Field* field : {&rotVecSol_F, &rot_vec_F, &geofac_rot_F,
+                                   &edge_orientation_vertex_F, &dual_cell_area_F}) {
+    AddFootprint(footprint, FootprintLocation::Nodes, *field);
+  }
+}
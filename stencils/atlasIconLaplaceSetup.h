@@ -0,0 +1,76 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Setup of the ICON Laplacian test case (nabla2vec from mo_math_laplace.f90) on an atlas mesh,
+// shared by the drivers running it. AtlasIconLaplaceFields allocates all fields of the test case
+// and initializes
+//
+//  - the geometrical info on edges, cells and vertices (edge lengths, normals, areas)
+//  - the sparse geometrical factors geofac_rot and geofac_div consumed by the stencil
+//  - the input vec (a spherical harmonic projected onto the primal normals) and the analytical
+//    solutions for its divergence, curl and Laplacian
+//
+// All levels are initialized to the same values. The output and intermediary fields (nabla2*,
+// rot_vec, div_vec) are only allocated. No attempt is made to compute anything meaningful at the
+// boundaries, see atlasIconLaplaceDriver.cpp
+
+#pragma once
+
+#include <string>
+
+#include <atlas/array.h>
+#include <atlas/field.h>
+#include <atlas/mesh.h>
+
+#include "interfaces/atlas_interface.hpp"
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/MemoryFootprint.h"
+
+class AtlasIconLaplaceFields {
+public:
+  static constexpr int edgesPerVertex = 6;
+  static constexpr int edgesPerCell = 3;
+
+  AtlasIconLaplaceFields(const atlas::Mesh& mesh, const AtlasToCartesian& wrapper, int k_size);
+  AtlasIconLaplaceFields(const AtlasIconLaplaceFields&) = delete;
+
+  // records all fields with the location type they are allocated on
+  void addFootprint(MemoryFootprint& footprint) const;
+
+  int k_size;
+
+  // the atlas fields own the storage, the views below refer to them
+  atlas::Field vec_F, divVecSol_F, rotVecSol_F, lapVecSol_F;
+  atlas::Field nabla2_vec_F, nabla2t1_vec_F, nabla2t2_vec_F, rot_vec_F, div_vec_F;
+  atlas::Field geofac_rot_F, edge_orientation_vertex_F, geofac_div_F, edge_orientation_cell_F;
+  atlas::Field tangent_orientation_F, primal_edge_length_F, dual_edge_length_F;
+  atlas::Field primal_normal_x_F, primal_normal_y_F, dual_normal_x_F, dual_normal_y_F;
+  atlas::Field cell_area_F, dual_cell_area_F;
+
+  // input field and analytical solutions
+  atlasInterface::Field<double> vec, divVecSol, rotVecSol, lapVecSol;
+
+  // output (nabla2_vec and its two terms) and intermediary fields
+  atlasInterface::Field<double> nabla2_vec, nabla2t1_vec, nabla2t2_vec, rot_vec, div_vec;
+
+  // sparse dimensions
+  atlasInterface::SparseDimension<double> geofac_rot, edge_orientation_vertex, geofac_div,
+      edge_orientation_cell;
+
+  // geometrical info
+  atlasInterface::Field<double> tangent_orientation, primal_edge_length, dual_edge_length;
+  atlasInterface::Field<double> primal_normal_x, primal_normal_y, dual_normal_x, dual_normal_y;
+  atlasInterface::Field<double> cell_area, dual_cell_area;
+};
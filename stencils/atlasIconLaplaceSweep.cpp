@@ -0,0 +1,278 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Runs the ICON Laplacian (see atlasIconLaplaceDriver.cpp) for a sweep of resolutions in a single
+// process and collects the error norms of divergence, curl and Laplacian together with the wall
+// times of mesh generation, geometry setup and the stencil. Compared to running the driver once per
+// resolution this avoids the process startup and the output of the fields, and independent
+// resolutions can be run concurrently (--threads=N, one resolution per thread, largest first).
+// Atlas mesh and field construction is not known to be thread safe, it is serialized between the
+// threads; only the stencils and the error norms run concurrently. Within a resolution the stencil
+// is run --runs times on the same fields, the minimum time is reported.
+//
+// The wall times are only reported for --threads=1: with concurrent resolutions they are taken
+// while the resolutions compete for the cores (and wait for each other), which makes them
+// incomparable between runs. The table prints "-" instead, the CSV leaves the fields empty and the
+// JSON writes null.
+//
+// The results are printed as a table and optionally written as CSV (one row per resolution) or
+// JSON. The norms are the same as printed by atlasIconLaplaceDriver, in addition the norms relative
+// to the analytical solutions are written.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fenv.h>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include <atlas/mesh.h>
+
+#include "interfaces/atlas_interface.hpp"
+
+#include "atlasIconLaplaceSetup.h"
+#include "generated_iconLaplace.hpp"
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/ErrorNorms.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/ParallelFor.h"
+#include "../utils/WallClock.h"
+
+namespace {
+struct SweepResult {
+  int ny = 0;
+  double dx = 0.;
+  int numEdges = 0;
+  double meshTime = 0.;
+  double geometryTime = 0.;
+  double stencilTime = 0.;
+  ErrorNorms div, rot, lap;
+};
+
+// atlasMutex serializes the construction (and destruction) of the atlas objects between
+// concurrent calls
+SweepResult RunResolution(int ny, int k_size, int runs, std::mutex& atlasMutex) {
+  const int level = 0;
+  SweepResult result;
+  result.ny = ny;
+  result.dx = 180. / ny;
+
+  // declared first, such that it is held again while the atlas objects are destroyed
+  std::unique_lock<std::mutex> atlasLock(atlasMutex);
+  auto start = Clock::now();
+  atlas::Mesh mesh = AtlasMeshRectComplete(ny);
+  result.meshTime = SecondsSince(start);
+  result.numEdges = mesh.edges().size();
+
+  start = Clock::now();
+  AtlasToCartesian wrapper(mesh, true);
+  AtlasIconLaplaceFields fields(mesh, wrapper, k_size);
+  result.geometryTime = SecondsSince(start);
+  atlasLock.unlock();
+
+  for(int run = 0; run < runs; run++) {
+    start = Clock::now();
+    dawn_generated::cxxnaiveico::ICON_laplacian_stencil<atlasInterface::atlasTag>(
+        mesh, k_size, fields.vec, fields.div_vec, fields.rot_vec, fields.nabla2t1_vec,
+        fields.nabla2t2_vec, fields.nabla2_vec, fields.primal_edge_length, fields.dual_edge_length,
+        fields.tangent_orientation, fields.geofac_rot, fields.geofac_div)
+        .run();
+    const double time = SecondsSince(start);
+    result.stencilTime = run == 0 ? time : std::min(result.stencilTime, time);
+  }
+
+  auto atLevel = [&](const atlasInterface::Field<double>& field) {
+    return [&field, level](int idx) { return field(idx, level); };
+  };
+  result.div = ComputeErrorNorms(atLevel(fields.divVecSol), atLevel(fields.div_vec),
+                                 wrapper.innerCellsMask(mesh));
+  result.rot = ComputeErrorNorms(atLevel(fields.rotVecSol), atLevel(fields.rot_vec),
+                                 wrapper.innerNodesMask(mesh));
+  result.lap = ComputeErrorNorms(atLevel(fields.lapVecSol), atLevel(fields.nabla2_vec),
+                                 wrapper.innerEdgesMask(mesh));
+  atlasLock.lock();
+  return result;
+}
+
+// the times are left empty unless withTimes
+bool WriteCsv(const std::string& filename, const std::vector<SweepResult>& results,
+              bool withTimes) {
+  FILE* fp = fopen(filename.c_str(), "w");
+  if(!fp) {
+    return false;
+  }
+  fprintf(fp, "ny,dx,edges,mesh_time,geometry_time,stencil_time");
+  for(const char* quantity : {"div", "rot", "lap"}) {
+    fprintf(fp, ",%s_L_inf,%s_L_1,%s_L_2,%s_rel_L_inf,%s_rel_L_1,%s_rel_L_2", quantity, quantity,
+            quantity, quantity, quantity, quantity);
+  }
+  fprintf(fp, "\n");
+  for(const SweepResult& result : results) {
+    fprintf(fp, "%d,%e,%d", result.ny, result.dx, result.numEdges);
+    for(double time : {result.meshTime, result.geometryTime, result.stencilTime}) {
+      if(withTimes) {
+        fprintf(fp, ",%e", time);
+      } else {
+        fprintf(fp, ",");
+      }
+    }
+    for(const ErrorNorms& norms : {result.div, result.rot, result.lap}) {
+      fprintf(fp, ",%e,%e,%e,%e,%e,%e", norms.Linf, norms.L1, norms.L2, norms.relLinf,
+              norms.relL1, norms.relL2);
+    }
+    fprintf(fp, "\n");
+  }
+  return fclose(fp) == 0;
+}
+
+// the times are written as null unless withTimes
+bool WriteJson(const std::string& filename, const std::vector<SweepResult>& results, int k_size,
+               int runs, int numThreads, bool withTimes) {
+  FILE* fp = fopen(filename.c_str(), "w");
+  if(!fp) {
+    return false;
+  }
+  fprintf(fp, "{\n  \"k_size\": %d,\n  \"runs\": %d,\n  \"threads\": %d,\n  \"resolutions\": [",
+          k_size, runs, numThreads);
+  for(size_t resultIdx = 0; resultIdx < results.size(); resultIdx++) {
+    const SweepResult& result = results[resultIdx];
+    fprintf(fp, "%s\n    {\n", resultIdx == 0 ? "" : ",");
+    fprintf(fp, "      \"ny\": %d,\n", result.ny);
+    fprintf(fp, "      \"dx\": %.9e,\n", result.dx);
+    fprintf(fp, "      \"edges\": %d,\n", result.numEdges);
+    const std::tuple<const char*, double> times[] = {{"mesh_time", result.meshTime},
+                                                     {"geometry_time", result.geometryTime},
+                                                     {"stencil_time", result.stencilTime}};
+    for(auto [name, time] : times) {
+      if(withTimes) {
+        fprintf(fp, "      \"%s\": %.9e,\n", name, time);
+      } else {
+        fprintf(fp, "      \"%s\": null,\n", name);
+      }
+    }
+    const std::tuple<const char*, ErrorNorms> quantities[] = {
+        {"div", result.div}, {"rot", result.rot}, {"lap", result.lap}};
+    for(int quantityIdx = 0; quantityIdx < 3; quantityIdx++) {
+      auto [name, norms] = quantities[quantityIdx];
+      fprintf(fp,
+              "      \"%s\": {\"L_inf\": %.9e, \"L_1\": %.9e, \"L_2\": %.9e, \"rel_L_inf\": "
+              "%.9e, \"rel_L_1\": %.9e, \"rel_L_2\": %.9e}%s\n",
+              name, norms.Linf, norms.L1, norms.L2, norms.relLinf, norms.relL1, norms.relL2,
+              quantityIdx < 2 ? "," : "");
+    }
+    fprintf(fp, "    }");
+  }
+  fprintf(fp, "\n  ]\n}\n");
+  return fclose(fp) == 0;
+}
+
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  // enable floating point exception
+  feenableexcept(FE_INVALID | FE_OVERFLOW);
+
+  int k_size = 1;
+  int runs = 1;
+  int numThreads = 1;
+  std::string csvFile, jsonFile;
+  std::vector<int> resolutions;
+  bool valid = true;
+  for(int argIdx = 1; argIdx < argc; argIdx++) {
+    const std::string arg = argv[argIdx];
+    auto value = [&](const std::string& key) -> std::optional<std::string> {
+      if(arg.rfind(key + "=", 0) == 0) {
+        return arg.substr(key.size() + 1);
+      }
+      return std::nullopt;
+    };
+    if(auto kSize = value("--k_size")) {
+      k_size = atoi(kSize->c_str());
+    } else if(auto numRuns = value("--runs")) {
+      runs = atoi(numRuns->c_str());
+    } else if(auto threads = value("--threads")) {
+      numThreads = atoi(threads->c_str());
+    } else if(auto csv = value("--csv")) {
+      csvFile = *csv;
+    } else if(auto json = value("--json")) {
+      jsonFile = *json;
+    } else if(atoi(arg.c_str()) > 1) {
+      resolutions.push_back(atoi(arg.c_str()));
+    } else {
+      valid = false;
+    }
+  }
+  if(!valid || k_size < 1 || runs < 1 || numThreads < 1) {
+    std::cout << "intended use is\n"
+              << argv[0]
+              << " [--k_size=N] [--runs=N] [--threads=N] [--csv=FILE] [--json=FILE] [ny ...]"
+              << std::endl;
+    return -1;
+  }
+  if(resolutions.empty()) {
+    // same resolutions as scripts/convergence_plot.py
+    for(int ny = 16; ny <= 128; ny += 16) {
+      resolutions.push_back(ny);
+    }
+  }
+  std::sort(resolutions.begin(), resolutions.end());
+
+  // the largest resolutions are started first, such that concurrent runs finish at about the
+  // same time
+  std::vector<SweepResult> results(resolutions.size());
+  std::mutex atlasMutex;
+  auto wallStart = Clock::now();
+  ParallelTasks(
+      resolutions.size(),
+      [&](int taskIdx) {
+        const int resultIdx = resolutions.size() - 1 - taskIdx;
+        results[resultIdx] = RunResolution(resolutions[resultIdx], k_size, runs, atlasMutex);
+      },
+      numThreads);
+  const double wallTime = SecondsSince(wallStart);
+
+  printf("%6s %12s %10s %12s %12s %12s %12s %12s %12s\n", "ny", "dx", "edges", "mesh [s]",
+         "geom [s]", "stencil [s]", "div L_2", "rot L_2", "lap L_2");
+  const bool withTimes = numThreads == 1;
+  for(const SweepResult& result : results) {
+    printf("%6d %12e %10d", result.ny, result.dx, result.numEdges);
+    for(double time : {result.meshTime, result.geometryTime, result.stencilTime}) {
+      if(withTimes) {
+        printf(" %12.6f", time);
+      } else {
+        printf(" %12s", "-");
+      }
+    }
+    printf(" %12e %12e %12e\n", result.div.L2, result.rot.L2, result.lap.L2);
+  }
+  printf("%zu resolutions on %d threads, %f s wall time\n", results.size(), numThreads, wallTime);
+  if(!withTimes) {
+    printf("per resolution times are only reported for --threads=1\n");
+  }
+
+  if(!csvFile.empty() && !WriteCsv(csvFile, results, withTimes)) {
+    std::cout << "could not write " << csvFile << "\n";
+    return 1;
+  }
+  if(!jsonFile.empty() && !WriteJson(jsonFile, results, k_size, runs, numThreads, withTimes)) {
+    std::cout << "could not write " << jsonFile << "\n";
+    return 1;
+  }
+  return 0;
+}
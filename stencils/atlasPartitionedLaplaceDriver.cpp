@@ -0,0 +1,366 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Runs the ICON Laplacian (see atlasIconLaplaceDriver.cpp) on a partitioned mesh, with one thread
+// per part and halo exchanges between the stages:
+//
+//  - the rect mesh is split into num_parts parts with one halo layer (AtlasPartition.h). geometry
+//    and geometrical factors are computed once on the whole mesh (atlasIconLaplaceSetup.h) and
+//    copied to all local elements of each part, the input vec only to the owned edges
+//  - stage 1 computes rot_vec on the owned vertices and div_vec on the owned cells. it needs vec
+//    on the halo edges, which is exchanged first
+//  - stage 2 computes nabla2_vec on the owned edges. it needs rot_vec and div_vec on the halo
+//    vertices and cells, which are exchanged after stage 1
+//
+// Both exchanges overlap with computation: elements which only depend on owned values are
+// computed between starting and finishing the exchange (AtlasHaloExchange.h). The partitioned
+// result is compared bit for bit against the stencil run on the whole mesh.
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include <atlas/array.h>
+#include <atlas/mesh.h>
+
+#include "interfaces/atlas_interface.hpp"
+
+#include "atlasIconLaplaceSetup.h"
+#include "generated_iconLaplace.hpp"
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/AtlasHaloExchange.h"
+#include "../utils/AtlasPartition.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/ParallelFor.h"
+#include "../utils/WallClock.h"
+
+namespace {
+using atlasInterface::atlasTag;
+using dawn::LocationType;
+
+// message tags of the three exchanges
+enum ExchangeTag { TagVec = 0, TagRot, TagDiv };
+
+// fields of the stencil on one part. geometry on all local elements, vec on the owned edges only.
+// the halo of vec is initialized with NaN, such that missing halo values show in the comparison
+class PartFields {
+  // declared first, such that the storage is constructed before (and outlives) the views
+  std::vector<atlas::Field> storage_;
+
+public:
+  PartFields(const AtlasPart& part, int partIdx, const AtlasIconLaplaceFields& global,
+             int k_size)
+      : vec(makeField("vec", part.mesh.edges().size(), k_size)),
+        rot_vec(makeField("rot_vec", part.mesh.nodes().size(), k_size)),
+        div_vec(makeField("div_vec", part.mesh.cells().size(), k_size)),
+        nabla2t1_vec(makeField("nabla2t1_vec", part.mesh.edges().size(), k_size)),
+        nabla2t2_vec(makeField("nabla2t2_vec", part.mesh.edges().size(), k_size)),
+        nabla2_vec(makeField("nabla2_vec", part.mesh.edges().size(), k_size)),
+        primal_edge_length(makeField("primal_edge_length", part.mesh.edges().size(), k_size)),
+        dual_edge_length(makeField("dual_edge_length", part.mesh.edges().size(), k_size)),
+        tangent_orientation(makeField("tangent_orientation", part.mesh.edges().size(), k_size)),
+        geofac_rot(makeSparseField("geofac_rot", part.mesh.nodes().size(), k_size,
+                                   AtlasIconLaplaceFields::edgesPerVertex)),
+        geofac_div(makeSparseField("geofac_div", part.mesh.cells().size(), k_size,
+                                   AtlasIconLaplaceFields::edgesPerCell)) {
+    const AtlasSubMeshIndices& indices = part.indices;
+    auto partEdge = atlas::array::make_view<int, 1>(part.mesh.edges().partition());
+    for(int k = 0; k < k_size; k++) {
+      for(int edgeIdx = 0; edgeIdx < int(indices.edges.size()); edgeIdx++) {
+        const int glbIdx = indices.edges[edgeIdx];
+        vec(edgeIdx, k) = partEdge(edgeIdx) == partIdx ? global.vec(glbIdx, k)
+                                                      : std::numeric_limits<double>::quiet_NaN();
+        primal_edge_length(edgeIdx, k) = global.primal_edge_length(glbIdx, k);
+        dual_edge_length(edgeIdx, k) = global.dual_edge_length(glbIdx, k);
+        tangent_orientation(edgeIdx, k) = global.tangent_orientation(glbIdx, k);
+      }
+      // the neighbor tables of the parts keep the order (and positions) of the global tables
+      for(int nodeIdx = 0; nodeIdx < int(indices.nodes.size()); nodeIdx++) {
+        for(int nbhIdx = 0; nbhIdx < AtlasIconLaplaceFields::edgesPerVertex; nbhIdx++) {
+          geofac_rot(nodeIdx, nbhIdx, k) = global.geofac_rot(indices.nodes[nodeIdx], nbhIdx, k);
+        }
+      }
+      for(int cellIdx = 0; cellIdx < int(indices.cells.size()); cellIdx++) {
+        for(int nbhIdx = 0; nbhIdx < AtlasIconLaplaceFields::edgesPerCell; nbhIdx++) {
+          geofac_div(cellIdx, nbhIdx, k) = global.geofac_div(indices.cells[cellIdx], nbhIdx, k);
+        }
+      }
+    }
+  }
+
+  atlasInterface::Field<double> vec, rot_vec, div_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec;
+  atlasInterface::Field<double> primal_edge_length, dual_edge_length, tangent_orientation;
+  atlasInterface::SparseDimension<double> geofac_rot, geofac_div;
+
+private:
+  atlas::array::ArrayView<double, 2> makeField(const std::string& name, int size, int k_size) {
+    storage_.emplace_back(name, atlas::array::DataType::real64(),
+                          atlas::array::make_shape(size, k_size));
+    return atlas::array::make_view<double, 2>(storage_.back());
+  }
+  atlas::array::ArrayView<double, 3> makeSparseField(const std::string& name, int size,
+                                                     int k_size, int sparseSize) {
+    storage_.emplace_back(name, atlas::array::DataType::real64(),
+                          atlas::array::make_shape(size, k_size, sparseSize));
+    return atlas::array::make_view<double, 3>(storage_.back());
+  }
+};
+
+// owned elements of a part, split into the ones computable from owned values only (interior) and
+// the ones depending on halo values (boundary)
+struct PartElements {
+  std::vector<int> interiorNodes, boundaryNodes;
+  std::vector<int> interiorCells, boundaryCells;
+  std::vector<int> interiorEdges, boundaryEdges;
+};
+
+template <typename ConnectivityT, typename OwnedFn>
+bool allOwned(const ConnectivityT& conn, int idx, OwnedFn&& owned) {
+  for(int nbhIdx = 0; nbhIdx < conn.cols(idx); nbhIdx++) {
+    const int nbh = conn(idx, nbhIdx);
+    if(nbh != conn.missing_value() && !owned(nbh)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+PartElements ClassifyElements(const AtlasPart& part, int partIdx) {
+  const atlas::Mesh& mesh = part.mesh;
+  auto partNode = atlas::array::make_view<int, 1>(mesh.nodes().partition());
+  auto partEdge = atlas::array::make_view<int, 1>(mesh.edges().partition());
+  auto partCell = atlas::array::make_view<int, 1>(mesh.cells().partition());
+  auto ownedNode = [&](int nodeIdx) { return partNode(nodeIdx) == partIdx; };
+  auto ownedEdge = [&](int edgeIdx) { return partEdge(edgeIdx) == partIdx; };
+  auto ownedCell = [&](int cellIdx) { return partCell(cellIdx) == partIdx; };
+
+  PartElements elements;
+  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+    if(ownedNode(nodeIdx)) {
+      (allOwned(mesh.nodes().edge_connectivity(), nodeIdx, ownedEdge) ? elements.interiorNodes
+                                                                       : elements.boundaryNodes)
+          .push_back(nodeIdx);
+    }
+  }
+  for(int cellIdx = 0; cellIdx < part.numOwnedCells; cellIdx++) {
+    (allOwned(mesh.cells().edge_connectivity(), cellIdx, ownedEdge) ? elements.interiorCells
+                                                                     : elements.boundaryCells)
+        .push_back(cellIdx);
+  }
+  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
+    if(ownedEdge(edgeIdx)) {
+      const bool interior = allOwned(mesh.edges().node_connectivity(), edgeIdx, ownedNode) &&
+                            allOwned(mesh.edges().cell_connectivity(), edgeIdx, ownedCell);
+      (interior ? elements.interiorEdges : elements.boundaryEdges).push_back(edgeIdx);
+    }
+  }
+  return elements;
+}
+
+// the statements of ICON_laplacian_stencil (generated_iconLaplace.hpp) for single elements. the
+// expressions are the same, so are the results
+void rotAndDiv(const atlas::Mesh& mesh, PartFields& f, const std::vector<int>& nodes,
+               const std::vector<int>& cells, int k_size) {
+  for(int k = 0; k < k_size; k++) {
+    for(int nodeIdx : nodes) {
+      int sparse_dimension_idx0 = 0;
+      f.rot_vec(nodeIdx, k) =
+          reduce(atlasTag{}, mesh, nodeIdx, (::dawn::float_type)0.0,
+                 std::vector<LocationType>{LocationType::Vertices, LocationType::Edges},
+                 [&](auto& lhs, auto red_loc1) {
+                   lhs += (f.vec(red_loc1, k) * f.geofac_rot(nodeIdx, sparse_dimension_idx0, k));
+                   sparse_dimension_idx0++;
+                   return lhs;
+                 });
+    }
+    for(int cellIdx : cells) {
+      int sparse_dimension_idx0 = 0;
+      f.div_vec(cellIdx, k) =
+          reduce(atlasTag{}, mesh, cellIdx, (::dawn::float_type)0.0,
+                 std::vector<LocationType>{LocationType::Cells, LocationType::Edges},
+                 [&](auto& lhs, auto red_loc1) {
+                   lhs += (f.vec(red_loc1, k) * f.geofac_div(cellIdx, sparse_dimension_idx0, k));
+                   sparse_dimension_idx0++;
+                   return lhs;
+                 });
+    }
+  }
+}
+
+void nabla2(const atlas::Mesh& mesh, PartFields& f, const std::vector<int>& edges, int k_size) {
+  for(int k = 0; k < k_size; k++) {
+    for(int edgeIdx : edges) {
+      f.nabla2t1_vec(edgeIdx, k) = reduce(
+          atlasTag{}, mesh, edgeIdx, (::dawn::float_type)0.0,
+          std::vector<LocationType>{LocationType::Edges, LocationType::Vertices},
+          [&](auto& lhs, auto red_loc1, auto const& weight) {
+            lhs += weight * f.rot_vec(red_loc1, k);
+            return lhs;
+          },
+          std::vector<::dawn::float_type>({(::dawn::float_type)-1.0, (::dawn::float_type)1.0}));
+      f.nabla2t1_vec(edgeIdx, k) =
+          ((f.tangent_orientation(edgeIdx, k) * f.nabla2t1_vec(edgeIdx, k)) /
+           f.primal_edge_length(edgeIdx, k));
+      f.nabla2t2_vec(edgeIdx, k) = reduce(
+          atlasTag{}, mesh, edgeIdx, (::dawn::float_type)0.0,
+          std::vector<LocationType>{LocationType::Edges, LocationType::Cells},
+          [&](auto& lhs, auto red_loc1, auto const& weight) {
+            lhs += weight * f.div_vec(red_loc1, k);
+            return lhs;
+          },
+          std::vector<::dawn::float_type>({(::dawn::float_type)-1.0, (::dawn::float_type)1.0}));
+      f.nabla2t2_vec(edgeIdx, k) = (f.nabla2t2_vec(edgeIdx, k) / f.dual_edge_length(edgeIdx, k));
+      f.nabla2_vec(edgeIdx, k) = (f.nabla2t2_vec(edgeIdx, k) - f.nabla2t1_vec(edgeIdx, k));
+    }
+  }
+}
+
+// number of owned elements of one part whose value differs (bitwise) from the global field
+int countMismatches(const atlasInterface::Field<double>& local,
+                    const atlasInterface::Field<double>& global, const std::vector<int>& owned,
+                    const std::vector<int>& localToGlobal, int k_size) {
+  int numMismatches = 0;
+  for(int k = 0; k < k_size; k++) {
+    for(int idx : owned) {
+      const double a = local(idx, k);
+      const double b = global(localToGlobal[idx], k);
+      numMismatches += std::memcmp(&a, &b, sizeof(double)) != 0;
+    }
+  }
+  return numMismatches;
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  if(argc < 3 || argc > 4) {
+    std::cout << "intended use is\n" << argv[0] << " ny num_parts [runs]" << std::endl;
+    return -1;
+  }
+  const int w = atoi(argv[1]);
+  const int numParts = atoi(argv[2]);
+  const int runs = argc == 4 ? atoi(argv[3]) : 1;
+  const int k_size = 1;
+
+  atlas::Mesh mesh = AtlasMeshRectComplete(w);
+  AtlasToCartesian wrapper(mesh, true);
+  AtlasIconLaplaceFields global(mesh, wrapper, k_size);
+
+  //===------------------------------------------------------------------------------------------===//
+  // reference: the stencil on the whole mesh
+  //===------------------------------------------------------------------------------------------===//
+  auto start = Clock::now();
+  for(int run = 0; run < runs; run++) {
+    dawn_generated::cxxnaiveico::ICON_laplacian_stencil<atlasTag>(
+        mesh, k_size, global.vec, global.div_vec, global.rot_vec, global.nabla2t1_vec,
+        global.nabla2t2_vec, global.nabla2_vec, global.primal_edge_length, global.dual_edge_length,
+        global.tangent_orientation, global.geofac_rot, global.geofac_div)
+        .run();
+  }
+  const double timeSingle = SecondsSince(start) / runs;
+
+  //===------------------------------------------------------------------------------------------===//
+  // partitioned run
+  //===------------------------------------------------------------------------------------------===//
+  start = Clock::now();
+  std::vector<int> cellPart = AtlasPartitionCells(mesh, wrapper, numParts, true);
+  std::vector<AtlasPart> parts = AtlasPartitionMeshComplete(mesh, cellPart, numParts, 1);
+  std::vector<HaloLists> nodeLists = AtlasHaloLists(parts, HaloLocation::Nodes);
+  std::vector<HaloLists> edgeLists = AtlasHaloLists(parts, HaloLocation::Edges);
+  std::vector<HaloLists> cellLists = AtlasHaloLists(parts, HaloLocation::Cells);
+  const double timePartition = SecondsSince(start);
+
+  std::vector<std::unique_ptr<PartFields>> fields;
+  std::vector<PartElements> elements;
+  for(int partIdx = 0; partIdx < numParts; partIdx++) {
+    fields.push_back(std::make_unique<PartFields>(parts[partIdx], partIdx, global, k_size));
+    elements.push_back(ClassifyElements(parts[partIdx], partIdx));
+  }
+
+  MailboxTransport transport(numParts);
+  std::vector<double> waitTime(numParts, 0.);
+  start = Clock::now();
+  // every part needs its own thread, since parts block on receiving from each other
+  ParallelTasks(
+      numParts,
+      [&](int partIdx) {
+        const atlas::Mesh& partMesh = parts[partIdx].mesh;
+        PartFields& f = *fields[partIdx];
+        const PartElements& elems = elements[partIdx];
+        HaloExchange vecExchange(transport, partIdx, edgeLists[partIdx], TagVec);
+        HaloExchange rotExchange(transport, partIdx, nodeLists[partIdx], TagRot);
+        HaloExchange divExchange(transport, partIdx, cellLists[partIdx], TagDiv);
+        for(int run = 0; run < runs; run++) {
+          // stage 1
+          vecExchange.start(f.vec, k_size);
+          rotAndDiv(partMesh, f, elems.interiorNodes, elems.interiorCells, k_size);
+          auto waitStart = Clock::now();
+          vecExchange.finish(f.vec, k_size);
+          waitTime[partIdx] += SecondsSince(waitStart);
+          rotAndDiv(partMesh, f, elems.boundaryNodes, elems.boundaryCells, k_size);
+
+          // stage 2
+          rotExchange.start(f.rot_vec, k_size);
+          divExchange.start(f.div_vec, k_size);
+          nabla2(partMesh, f, elems.interiorEdges, k_size);
+          waitStart = Clock::now();
+          rotExchange.finish(f.rot_vec, k_size);
+          divExchange.finish(f.div_vec, k_size);
+          waitTime[partIdx] += SecondsSince(waitStart);
+          nabla2(partMesh, f, elems.boundaryEdges, k_size);
+        }
+      },
+      numParts);
+  const double timeParallel = SecondsSince(start) / runs;
+
+  //===------------------------------------------------------------------------------------------===//
+  // comparison
+  //===------------------------------------------------------------------------------------------===//
+  int numMismatches = 0;
+  double maxWait = 0.;
+  for(int partIdx = 0; partIdx < numParts; partIdx++) {
+    const AtlasSubMeshIndices& indices = parts[partIdx].indices;
+    const PartFields& f = *fields[partIdx];
+    const PartElements& elems = elements[partIdx];
+    auto concat = [](const std::vector<int>& a, const std::vector<int>& b) {
+      std::vector<int> all(a);
+      all.insert(all.end(), b.begin(), b.end());
+      return all;
+    };
+    numMismatches += countMismatches(f.rot_vec, global.rot_vec,
+                                     concat(elems.interiorNodes, elems.boundaryNodes),
+                                     indices.nodes, k_size);
+    numMismatches += countMismatches(f.div_vec, global.div_vec,
+                                     concat(elems.interiorCells, elems.boundaryCells),
+                                     indices.cells, k_size);
+    numMismatches += countMismatches(f.nabla2_vec, global.nabla2_vec,
+                                     concat(elems.interiorEdges, elems.boundaryEdges),
+                                     indices.edges, k_size);
+    maxWait = fmax(maxWait, waitTime[partIdx] / runs);
+  }
+
+  printf("%d parts, edge cut %d: partitioning %f s, single domain %f s, partitioned %f s per run "
+         "(max time waiting for halos %f s)\n",
+         numParts, AtlasPartitionEdgeCut(mesh, cellPart), timePartition, timeSingle,
+         timeParallel, maxWait);
+  if(numMismatches != 0) {
+    printf("partitioned result differs from the single domain result in %d values\n",
+           numMismatches);
+    return 1;
+  }
+  printf("partitioned result matches the single domain result\n");
+  return 0;
+}
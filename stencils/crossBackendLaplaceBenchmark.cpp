@@ -0,0 +1,400 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Runs the generated ICON Laplacian on the same mesh and the same inputs using every backend that
+// can represent the mesh, checks that all backends agree with the toylib backend and reports time
+// and memory of each side by side. The atlas and the flat mesh are converted from the toylib grid
+// (AtlasMeshFromToylib, FlatMeshFromToylib), such that all backends visit the neighbors in the
+// same order; the edge numbering differs and is mapped back to toylib ids. Two meshes are used:
+//
+//  - regular: toylib::Grid(2 * ny, ny), run on the toylib, atlas, flat and structured backends
+//  - rect:    toylibMeshRect(ny), run on the toylib, atlas and flat backends
+//
+// The inputs are arbitrary smooth values defined per toylib id, not geometrical quantities; only
+// the neighbor access pattern matters here. New backends are added by converting the toylib
+// inputs onto them and adding a row to the table.
+//
+// The timings are taken by the benchmark harness (benchmarks/BenchmarkSuite.h) under the names
+// regular/<backend> and rect/<backend>, the table reports the median times. Backends filtered out
+// are still run once to check their results.
+//
+// usage: crossBackendLaplaceBenchmark [--warmup=N] [--repetitions=N] [--filter=S] [--json=FILE]
+//                                     ny [k_size]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <atlas/array.h>
+#include <atlas/field.h>
+#include <atlas/library/Library.h>
+#include <atlas/mesh.h>
+
+#include "interfaces/atlas_interface.hpp"
+#include "interfaces/flat_interface.hpp"
+#include "interfaces/structured_interface.hpp"
+#include "interfaces/toylib_interface.hpp"
+#include "toylib.hpp"
+
+#include "generated_iconLaplace.hpp"
+
+#include "../benchmarks/BenchmarkSuite.h"
+
+#include "../utils/AtlasFromToylib.h"
+#include "../utils/FlatMesh.h"
+#include "../utils/GenerateRectToylibMesh.h"
+#include "../utils/MemoryFootprint.h"
+
+namespace {
+const int edgesPerVertex = 6;
+const int edgesPerCell = 3;
+
+// results of all backends need to agree to this (relative) tolerance with the toylib backend
+const double tolerance = 1e-12;
+
+double toMB(double bytes) { return bytes / (1024. * 1024.); }
+
+// all fields of the ICON Laplacian on the toylib grid. these are the reference inputs, the fields
+// of the other backends are copied from here
+struct ToylibFields {
+  toylib::EdgeData<double> vec;
+  toylib::FaceData<double> div_vec;
+  toylib::VertexData<double> rot_vec;
+  toylib::EdgeData<double> nabla2t1_vec;
+  toylib::EdgeData<double> nabla2t2_vec;
+  toylib::EdgeData<double> nabla2_vec;
+  toylib::EdgeData<double> primal_edge_length;
+  toylib::EdgeData<double> dual_edge_length;
+  toylib::EdgeData<double> tangent_orientation;
+  toylib::SparseVertexData<double> geofac_rot;
+  toylib::SparseFaceData<double> geofac_div;
+
+  // bytes of field data
+  double bytes;
+
+  ToylibFields(const toylib::Grid& grid, int k_size)
+      : vec(grid, k_size), div_vec(grid, k_size), rot_vec(grid, k_size),
+        nabla2t1_vec(grid, k_size), nabla2t2_vec(grid, k_size), nabla2_vec(grid, k_size),
+        primal_edge_length(grid, k_size), dual_edge_length(grid, k_size),
+        tangent_orientation(grid, k_size), geofac_rot(grid, edgesPerVertex, k_size),
+        geofac_div(grid, edgesPerCell, k_size) {
+    const int numEdges = grid.all_edges().size();
+    const int numNodes = grid.vertices().size();
+    const int numCells = grid.faces().size();
+    for(int k = 0; k < k_size; k++) {
+      for(int id = 0; id < numEdges; id++) {
+        vec(id, k) = sin(0.1 * id + k);
+        primal_edge_length(id, k) = 1. + 0.5 * sin(0.3 * id);
+        dual_edge_length(id, k) = 1. + 0.5 * cos(0.7 * id);
+        tangent_orientation(id, k) = (id % 2 == 0) ? 1. : -1.;
+      }
+      for(int id = 0; id < numNodes; id++) {
+        for(int nbhIdx = 0; nbhIdx < edgesPerVertex; nbhIdx++) {
+          geofac_rot(id, nbhIdx, k) = cos(0.2 * id + nbhIdx);
+        }
+      }
+      for(int id = 0; id < numCells; id++) {
+        for(int nbhIdx = 0; nbhIdx < edgesPerCell; nbhIdx++) {
+          geofac_div(id, nbhIdx, k) = sin(0.4 * id + nbhIdx);
+        }
+      }
+    }
+    bytes = sizeof(double) * k_size *
+            (7. * numEdges + numCells + numNodes + edgesPerVertex * numNodes +
+             edgesPerCell * numCells);
+  }
+};
+
+// copies the inputs from the toylib fields to the fields of another backend. toylibEdge maps the
+// edge indices of the backend to toylib ids, nodes and cells need to keep their toylib ids
+template <typename Fields>
+void CopyInputs(const ToylibFields& ref, const std::vector<int>& toylibEdge, int numNodes,
+                int numCells, int k_size, Fields& f) {
+  for(int k = 0; k < k_size; k++) {
+    for(int edgeIdx = 0; edgeIdx < int(toylibEdge.size()); edgeIdx++) {
+      const int id = toylibEdge[edgeIdx];
+      f.vec(edgeIdx, k) = ref.vec(id, k);
+      f.primal_edge_length(edgeIdx, k) = ref.primal_edge_length(id, k);
+      f.dual_edge_length(edgeIdx, k) = ref.dual_edge_length(id, k);
+      f.tangent_orientation(edgeIdx, k) = ref.tangent_orientation(id, k);
+    }
+    for(int nodeIdx = 0; nodeIdx < numNodes; nodeIdx++) {
+      for(int nbhIdx = 0; nbhIdx < edgesPerVertex; nbhIdx++) {
+        f.geofac_rot(nodeIdx, nbhIdx, k) = ref.geofac_rot(nodeIdx, nbhIdx, k);
+      }
+    }
+    for(int cellIdx = 0; cellIdx < numCells; cellIdx++) {
+      for(int nbhIdx = 0; nbhIdx < edgesPerCell; nbhIdx++) {
+        f.geofac_div(cellIdx, nbhIdx, k) = ref.geofac_div(cellIdx, nbhIdx, k);
+      }
+    }
+  }
+}
+
+// the same fields on the atlas mesh converted from the toylib grid
+class AtlasFields {
+public:
+  AtlasFields(const atlas::Mesh& mesh, const AtlasToylibIndices& indices,
+              const ToylibFields& ref, int k_size)
+      : vec_F(makeField("vec", mesh.edges().size(), k_size)),
+        div_vec_F(makeField("div_vec", mesh.cells().size(), k_size)),
+        rot_vec_F(makeField("rot_vec", mesh.nodes().size(), k_size)),
+        nabla2t1_vec_F(makeField("nabla2t1_vec", mesh.edges().size(), k_size)),
+        nabla2t2_vec_F(makeField("nabla2t2_vec", mesh.edges().size(), k_size)),
+        nabla2_vec_F(makeField("nabla2_vec", mesh.edges().size(), k_size)),
+        primal_edge_length_F(makeField("primal_edge_length", mesh.edges().size(), k_size)),
+        dual_edge_length_F(makeField("dual_edge_length", mesh.edges().size(), k_size)),
+        tangent_orientation_F(makeField("tangent_orientation", mesh.edges().size(), k_size)),
+        geofac_rot_F(
+            makeSparseField("geofac_rot", mesh.nodes().size(), edgesPerVertex, k_size)),
+        geofac_div_F(makeSparseField("geofac_div", mesh.cells().size(), edgesPerCell, k_size)),
+        vec(atlas::array::make_view<double, 2>(vec_F)),
+        div_vec(atlas::array::make_view<double, 2>(div_vec_F)),
+        rot_vec(atlas::array::make_view<double, 2>(rot_vec_F)),
+        nabla2t1_vec(atlas::array::make_view<double, 2>(nabla2t1_vec_F)),
+        nabla2t2_vec(atlas::array::make_view<double, 2>(nabla2t2_vec_F)),
+        nabla2_vec(atlas::array::make_view<double, 2>(nabla2_vec_F)),
+        primal_edge_length(atlas::array::make_view<double, 2>(primal_edge_length_F)),
+        dual_edge_length(atlas::array::make_view<double, 2>(dual_edge_length_F)),
+        tangent_orientation(atlas::array::make_view<double, 2>(tangent_orientation_F)),
+        geofac_rot(atlas::array::make_view<double, 3>(geofac_rot_F)),
+        geofac_div(atlas::array::make_view<double, 3>(geofac_div_F)) {
+    CopyInputs(ref, indices.toylibEdge, mesh.nodes().size(), mesh.cells().size(), k_size, *this);
+  }
+  AtlasFields(const AtlasFields&) = delete;
+
+  // bytes of field data
+  double bytes() const {
+    double sum = 0;
+    for(const atlas::Field* field :
+        {&vec_F, &div_vec_F, &rot_vec_F, &nabla2t1_vec_F, &nabla2t2_vec_F, &nabla2_vec_F,
+         &primal_edge_length_F, &dual_edge_length_F, &tangent_orientation_F, &geofac_rot_F,
+         &geofac_div_F}) {
+      sum += field->bytes();
+    }
+    return sum;
+  }
+
+  atlas::Field vec_F, div_vec_F, rot_vec_F, nabla2t1_vec_F, nabla2t2_vec_F, nabla2_vec_F,
+      primal_edge_length_F, dual_edge_length_F, tangent_orientation_F, geofac_rot_F, geofac_div_F;
+  atlasInterface::Field<double> vec, div_vec, rot_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec,
+      primal_edge_length, dual_edge_length, tangent_orientation;
+  atlasInterface::SparseDimension<double> geofac_rot, geofac_div;
+
+private:
+  static atlas::Field makeField(const std::string& name, int size, int k_size) {
+    return atlas::Field{name, atlas::array::DataType::real64(),
+                        atlas::array::make_shape(size, k_size)};
+  }
+  static atlas::Field makeSparseField(const std::string& name, int size, int sparseSize,
+                                      int k_size) {
+    return atlas::Field{name, atlas::array::DataType::real64(),
+                        atlas::array::make_shape(size, k_size, sparseSize)};
+  }
+};
+
+// the same fields on the flat mesh converted from the toylib grid
+struct FlatFields {
+  flatInterface::Field<double> vec, div_vec, rot_vec, nabla2t1_vec, nabla2t2_vec, nabla2_vec,
+      primal_edge_length, dual_edge_length, tangent_orientation;
+  flatInterface::SparseField<double> geofac_rot, geofac_div;
+
+  FlatFields(const FlatMesh& mesh, const std::vector<int>& toylibEdge, const ToylibFields& ref,
+             int k_size)
+      : vec(mesh.numEdges(), k_size), div_vec(mesh.numCells(), k_size),
+        rot_vec(mesh.numVertices(), k_size), nabla2t1_vec(mesh.numEdges(), k_size),
+        nabla2t2_vec(mesh.numEdges(), k_size), nabla2_vec(mesh.numEdges(), k_size),
+        primal_edge_length(mesh.numEdges(), k_size), dual_edge_length(mesh.numEdges(), k_size),
+        tangent_orientation(mesh.numEdges(), k_size),
+        geofac_rot(mesh.numVertices(), edgesPerVertex, k_size),
+        geofac_div(mesh.numCells(), edgesPerCell, k_size) {
+    CopyInputs(ref, toylibEdge, mesh.numVertices(), mesh.numCells(), k_size, *this);
+  }
+
+  // bytes of field data
+  double bytes() const {
+    return vec.bytes() + div_vec.bytes() + rot_vec.bytes() + nabla2t1_vec.bytes() +
+           nabla2t2_vec.bytes() + nabla2_vec.bytes() + primal_edge_length.bytes() +
+           dual_edge_length.bytes() + tangent_orientation.bytes() + geofac_rot.bytes() +
+           geofac_div.bytes();
+  }
+};
+
+// times the stencil under name, returns the median time in seconds (0 if filtered out)
+template <typename Tag, typename Fields>
+double timeStencil(BenchmarkSuite& suite, const std::string& name, int ny,
+                   const dawn::mesh_t<Tag>& mesh, int k_size, Fields& f, long numEdges) {
+  return suite.measure(name, ny, numEdges * k_size, [&]() {
+    dawn_generated::cxxnaiveico::ICON_laplacian_stencil<Tag>(
+        mesh, k_size, f.vec, f.div_vec, f.rot_vec, f.nabla2t1_vec, f.nabla2t2_vec, f.nabla2_vec,
+        f.primal_edge_length, f.dual_edge_length, f.tangent_orientation, f.geofac_rot,
+        f.geofac_div)
+        .run();
+  });
+}
+
+// largest relative difference of nabla2, div and rot to the toylib reference. edgeId, cellId and
+// nodeId map an element index of the backend to the toylib id
+template <typename Fields, typename EdgeIdFn, typename CellIdFn, typename NodeIdFn>
+double maxDifference(const ToylibFields& ref, const Fields& f, int numEdges, int numCells,
+                     int numNodes, int k_size, EdgeIdFn&& edgeId, CellIdFn&& cellId,
+                     NodeIdFn&& nodeId) {
+  double maxDiff = 0.;
+  auto update = [&](double value, double refValue) {
+    maxDiff = std::max(maxDiff, std::abs(value - refValue) / std::max(1., std::abs(refValue)));
+  };
+  for(int k = 0; k < k_size; k++) {
+    for(int idx = 0; idx < numEdges; idx++) {
+      update(f.nabla2_vec(idx, k), ref.nabla2_vec(edgeId(idx), k));
+    }
+    for(int idx = 0; idx < numCells; idx++) {
+      update(f.div_vec(idx, k), ref.div_vec(cellId(idx), k));
+    }
+    for(int idx = 0; idx < numNodes; idx++) {
+      update(f.rot_vec(idx, k), ref.rot_vec(nodeId(idx), k));
+    }
+  }
+  return maxDiff;
+}
+
+struct BackendResult {
+  std::string name;
+  double time;
+  double meshBytes;
+  double fieldBytes;
+  double maxDiff;
+};
+
+void printResults(const std::string& gridName, const toylib::Grid& grid, int k_size,
+                  const std::vector<BackendResult>& results) {
+  printf("%s grid: %d nodes, %d edges, %d cells, %d levels\n", gridName.c_str(),
+         int(grid.vertices().size()), int(grid.edges().size()), int(grid.faces().size()), k_size);
+  printf("  %-12s %12s %10s %12s %12s %12s\n", "backend", "time [ms]", "rel. time", "mesh [MB]",
+         "fields [MB]", "max diff");
+  for(const auto& result : results) {
+    // backends which have been filtered out have no time
+    const double refTime = results.front().time;
+    printf("  %-12s %12.3f %10.2f %12.3f %12.3f %12.3e %s\n", result.name.c_str(),
+           1e3 * result.time, refTime > 0. ? result.time / refTime : 0., toMB(result.meshBytes),
+           toMB(result.fieldBytes), result.maxDiff, result.maxDiff <= tolerance ? "" : "DIFFER");
+  }
+}
+
+// runs the toylib, atlas and flat backends on grid, appends their results. returns the toylib
+// fields holding the reference results
+std::unique_ptr<ToylibFields> runUnstructured(BenchmarkSuite& suite, const std::string& gridName,
+                                              int ny, const toylib::Grid& grid, int k_size,
+                                              std::vector<BackendResult>& results) {
+  const long numEdges = grid.all_edges().size();
+  auto ref = std::make_unique<ToylibFields>(grid, k_size);
+  const double toylibTime = timeStencil<toylibInterface::toylibTag>(
+      suite, gridName + "/toylib", ny, grid, k_size, *ref, numEdges);
+  MemoryFootprint gridFootprint;
+  AddFootprint(gridFootprint, grid);
+  results.push_back({"toylib", toylibTime, double(gridFootprint.total()), ref->bytes, 0.});
+
+  AtlasToylibIndices indices;
+  atlas::Mesh mesh = AtlasMeshFromToylib(grid, indices);
+  AtlasFields atlasFields(mesh, indices, *ref, k_size);
+  const double atlasTime = timeStencil<atlasInterface::atlasTag>(
+      suite, gridName + "/atlas", ny, mesh, k_size, atlasFields, numEdges);
+  auto identity = [](int idx) { return idx; };
+  results.push_back(
+      {"atlas", atlasTime, double(mesh.footprint()), atlasFields.bytes(),
+       maxDifference(*ref, atlasFields, mesh.edges().size(), mesh.cells().size(),
+                     mesh.nodes().size(), k_size,
+                     [&](int edgeIdx) { return indices.toylibEdge[edgeIdx]; }, identity,
+                     identity)});
+
+  std::vector<int> toylibEdge;
+  FlatMesh flatMesh = FlatMeshFromToylib(grid, toylibEdge);
+  FlatFields flatFields(flatMesh, toylibEdge, *ref, k_size);
+  const double flatTime = timeStencil<flatInterface::flatTag>(
+      suite, gridName + "/flat", ny, flatMesh, k_size, flatFields, numEdges);
+  results.push_back({"flat", flatTime, double(flatMesh.bytes()), flatFields.bytes(),
+                     maxDifference(*ref, flatFields, flatMesh.numEdges(), flatMesh.numCells(),
+                                   flatMesh.numVertices(), k_size,
+                                   [&](int edgeIdx) { return toylibEdge[edgeIdx]; }, identity,
+                                   identity)});
+  return ref;
+}
+
+bool allAgree(const std::vector<BackendResult>& results) {
+  return std::all_of(results.begin(), results.end(),
+                     [](const BackendResult& result) { return result.maxDiff <= tolerance; });
+}
+
+bool runRegular(BenchmarkSuite& suite, int ny, int k_size) {
+  const int nx = 2 * ny;
+  toylib::Grid grid(nx, ny, false);
+  std::vector<BackendResult> results;
+  auto ref = runUnstructured(suite, "regular", ny, grid, k_size, results);
+
+  // the structured backend uses the toylib numbering, such that the toylib fields can be used
+  structuredInterface::StructuredGrid<false> mesh(nx, ny);
+  ToylibFields structuredFields(grid, k_size);
+  const double structuredTime = timeStencil<structuredInterface::structuredTag<false>>(
+      suite, "regular/structured", ny, mesh, k_size, structuredFields, grid.all_edges().size());
+  auto identity = [](int idx) { return idx; };
+  results.push_back({"structured", structuredTime, double(sizeof(mesh)), structuredFields.bytes,
+                     maxDifference(*ref, structuredFields, grid.all_edges().size(),
+                                   grid.faces().size(), grid.vertices().size(), k_size, identity,
+                                   identity, identity)});
+
+  printResults("regular", grid, k_size, results);
+  return allAgree(results);
+}
+
+bool runRect(BenchmarkSuite& suite, int ny, int k_size) {
+  toylib::Grid grid = toylibMeshRect(ny);
+  std::vector<BackendResult> results;
+  runUnstructured(suite, "rect", ny, grid, k_size, results);
+  printResults("rect", grid, k_size, results);
+  return allAgree(results);
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  BenchmarkOptions options;
+  std::vector<std::string> args;
+  const bool valid = ParseBenchmarkOptions(argc, argv, options, args);
+  if(!valid || args.empty() || args.size() > 2) {
+    std::cout << "intended use is\n"
+              << argv[0] << " [--warmup=N] [--repetitions=N] [--filter=S] [--json=FILE] ny [k_size]"
+              << std::endl;
+    return -1;
+  }
+  int ny = atoi(args[0].c_str());
+  int k_size = args.size() > 1 ? atoi(args[1].c_str()) : 1;
+  if(ny < 2 || k_size < 1) {
+    std::cout << "ny needs to be at least 2, k_size at least 1\n";
+    return -1;
+  }
+
+  BenchmarkSuite suite(options);
+  bool agree = runRegular(suite, ny, k_size);
+  agree &= runRect(suite, ny, k_size);
+
+  atlas::Library::instance().finalise();
+  if(!options.jsonFile.empty() && !suite.writeJson(options.jsonFile)) {
+    std::cout << "could not write " << options.jsonFile << "\n";
+    return 1;
+  }
+  return agree ? 0 : 1;
+}
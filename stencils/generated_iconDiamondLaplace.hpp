@@ -4,6 +4,8 @@
 #define DAWN_BACKEND_T CXXNAIVEICO
 #include "interfaces/unstructured_interface.hpp"
 
+#include "../utils/StageInstrumentation.h"
+
 //---- Globals ----
 
 //---- Stencils ----
@@ -68,7 +70,9 @@ private:
       using dawn::deref;
       {
         for(int k = 0 + 0; k <= (m_k_size == 0 ? 0 : (m_k_size - 1)) + 0 + 0; ++k) {
+          INSTRUMENT_STAGE("diamond/vn_vert")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int for_loop_idx = 0;
               for(auto inner_loc :
@@ -86,7 +90,9 @@ private:
               }
             }
           }
+          INSTRUMENT_STAGE("diamond/dvt_tang_reduce")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_dvt_tang(deref(LibTag{}, loc), k + 0) = reduce(
@@ -108,12 +114,16 @@ private:
                                                    (::dawn::float_type)0.0}));
             }
           }
+          INSTRUMENT_STAGE("diamond/dvt_tang_scale")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_dvt_tang(deref(LibTag{}, loc), k + 0) =
                 (m_dvt_tang(deref(LibTag{}, loc), k + 0) *
                  m_tangent_orientation(deref(LibTag{}, loc), k + 0));
           }
+          INSTRUMENT_STAGE("diamond/dvt_norm")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_dvt_norm(deref(LibTag{}, loc), k + 0) = reduce(
@@ -135,7 +145,9 @@ private:
                                                    (::dawn::float_type)1.0}));
             }
           }
+          INSTRUMENT_STAGE("diamond/kh_smag_1_reduce")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_kh_smag_1(deref(LibTag{}, loc), k + 0) = reduce(
@@ -153,7 +165,9 @@ private:
                                                    (::dawn::float_type)0.0}));
             }
           }
+          INSTRUMENT_STAGE("diamond/kh_smag_1_combine")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_kh_smag_1(deref(LibTag{}, loc), k + 0) =
                 (((m_kh_smag_1(deref(LibTag{}, loc), k + 0) *
                    m_tangent_orientation(deref(LibTag{}, loc), k + 0)) *
@@ -161,11 +175,15 @@ private:
                  (m_dvt_norm(deref(LibTag{}, loc), k + 0) *
                   m_inv_vert_vert_length(deref(LibTag{}, loc), k + 0)));
           }
+          INSTRUMENT_STAGE("diamond/kh_smag_1_square")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_kh_smag_1(deref(LibTag{}, loc), k + 0) = (m_kh_smag_1(deref(LibTag{}, loc), k + 0) *
                                                         m_kh_smag_1(deref(LibTag{}, loc), k + 0));
           }
+          INSTRUMENT_STAGE("diamond/kh_smag_2_reduce")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_kh_smag_2(deref(LibTag{}, loc), k + 0) = reduce(
@@ -183,24 +201,32 @@ private:
                                                    (::dawn::float_type)1.0}));
             }
           }
+          INSTRUMENT_STAGE("diamond/kh_smag_2_combine")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_kh_smag_2(deref(LibTag{}, loc), k + 0) =
                 ((m_kh_smag_2(deref(LibTag{}, loc), k + 0) *
                   m_inv_vert_vert_length(deref(LibTag{}, loc), k + 0)) +
                  (m_dvt_tang(deref(LibTag{}, loc), k + 0) *
                   m_inv_primal_edge_length(deref(LibTag{}, loc), k + 0)));
           }
+          INSTRUMENT_STAGE("diamond/kh_smag_2_square")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_kh_smag_2(deref(LibTag{}, loc), k + 0) = (m_kh_smag_2(deref(LibTag{}, loc), k + 0) *
                                                         m_kh_smag_2(deref(LibTag{}, loc), k + 0));
           }
+          INSTRUMENT_STAGE("diamond/kh_smag")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_kh_smag(deref(LibTag{}, loc), k + 0) =
                 (m_diff_multfac_smag(deref(LibTag{}, loc), k + 0) *
                  sqrt(m_kh_smag_1(deref(LibTag{}, loc), k + 0) +
                       m_kh_smag_2(deref(LibTag{}, loc), k + 0)));
           }
+          INSTRUMENT_STAGE("diamond/nabla2_reduce")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_nabla2(deref(LibTag{}, loc), k + 0) = reduce(
@@ -225,7 +251,9 @@ private:
                         m_inv_vert_vert_length(deref(LibTag{}, loc), k + 0))}));
             }
           }
+          INSTRUMENT_STAGE("diamond/nabla2_combine")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_nabla2(deref(LibTag{}, loc), k + 0) =
                 (m_nabla2(deref(LibTag{}, loc), k + 0) -
                  ((((::dawn::float_type)8.0 * m_vn(deref(LibTag{}, loc), k + 0)) *
@@ -5,6 +5,8 @@
 
 #include "interfaces/unstructured_interface.hpp"
 
+#include "../utils/StageInstrumentation.h"
+
 //---- Globals ----
 
 //---- Stencils ----
@@ -54,7 +56,9 @@ private:
       using dawn::deref;
       {
         for(int k = 0 + 0; k <= (m_k_size == 0 ? 0 : (m_k_size - 1)) + 0 + 0; ++k) {
+          INSTRUMENT_STAGE("laplacian/rot_vec")
           for(auto const& loc : getVertices(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_rot_vec(deref(LibTag{}, loc), k + 0) =
@@ -70,7 +74,9 @@ private:
                          });
             }
           }
+          INSTRUMENT_STAGE("laplacian/div_vec")
           for(auto const& loc : getCells(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_div_vec(deref(LibTag{}, loc), k + 0) =
@@ -86,7 +92,9 @@ private:
                          });
             }
           }
+          INSTRUMENT_STAGE("laplacian/nabla2t1_vec_reduce")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_nabla2t1_vec(deref(LibTag{}, loc), k + 0) = reduce(
@@ -102,13 +110,17 @@ private:
                       {(::dawn::float_type)-1.0, (::dawn::float_type)1.0}));
             }
           }
+          INSTRUMENT_STAGE("laplacian/nabla2t1_vec_scale")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_nabla2t1_vec(deref(LibTag{}, loc), k + 0) =
                 ((m_tangent_orientation(deref(LibTag{}, loc), k + 0) *
                   m_nabla2t1_vec(deref(LibTag{}, loc), k + 0)) /
                  m_primal_edge_length(deref(LibTag{}, loc), k + 0));
           }
+          INSTRUMENT_STAGE("laplacian/nabla2t2_vec_reduce")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             {
               int sparse_dimension_idx0 = 0;
               m_nabla2t2_vec(deref(LibTag{}, loc), k + 0) = reduce(
@@ -124,12 +136,16 @@ private:
                       {(::dawn::float_type)-1.0, (::dawn::float_type)1.0}));
             }
           }
+          INSTRUMENT_STAGE("laplacian/nabla2t2_vec_scale")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_nabla2t2_vec(deref(LibTag{}, loc), k + 0) =
                 (m_nabla2t2_vec(deref(LibTag{}, loc), k + 0) /
                  m_dual_edge_length(deref(LibTag{}, loc), k + 0));
           }
+          INSTRUMENT_STAGE("laplacian/nabla2_vec")
           for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+            INSTRUMENT_ELEMENTS(1);
             m_nabla2_vec(deref(LibTag{}, loc), k + 0) =
                 (m_nabla2t2_vec(deref(LibTag{}, loc), k + 0) -
                  m_nabla2t1_vec(deref(LibTag{}, loc), k + 0));
@@ -0,0 +1,157 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Batched variant of ICON_laplacian_stencil (generated_iconLaplace.hpp): applies the Laplacian to
+// N input fields at once. Every reduction walks the neighbors of an element once and loads the
+// geometrical factors once, accumulating into a std::array holding one value per field. The
+// statements acting on single edges are fused into one loop over the edges.
+//
+// The operations applied to each field (and their order) are the same as in the generated
+// stencil, hence the results of both are identical. Like the generated stencil, this works with
+// any backend implementing the unstructured interface.
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include "interfaces/unstructured_interface.hpp"
+
+template <typename LibTag, int N>
+class ICON_laplacian_batched_stencil {
+public:
+  // one field per member of the batch
+  template <typename FieldT>
+  using batch_t = std::array<FieldT*, N>;
+
+  ICON_laplacian_batched_stencil(const dawn::mesh_t<LibTag>& mesh, int k_size,
+                                 batch_t<dawn::edge_field_t<LibTag, double>> vec,
+                                 batch_t<dawn::cell_field_t<LibTag, double>> div_vec,
+                                 batch_t<dawn::vertex_field_t<LibTag, double>> rot_vec,
+                                 batch_t<dawn::edge_field_t<LibTag, double>> nabla2t1_vec,
+                                 batch_t<dawn::edge_field_t<LibTag, double>> nabla2t2_vec,
+                                 batch_t<dawn::edge_field_t<LibTag, double>> nabla2_vec,
+                                 dawn::edge_field_t<LibTag, double>& primal_edge_length,
+                                 dawn::edge_field_t<LibTag, double>& dual_edge_length,
+                                 dawn::edge_field_t<LibTag, double>& tangent_orientation,
+                                 dawn::sparse_vertex_field_t<LibTag, double>& geofac_rot,
+                                 dawn::sparse_cell_field_t<LibTag, double>& geofac_div)
+      : m_mesh(mesh), m_k_size(k_size), m_vec(vec), m_div_vec(div_vec), m_rot_vec(rot_vec),
+        m_nabla2t1_vec(nabla2t1_vec), m_nabla2t2_vec(nabla2t2_vec), m_nabla2_vec(nabla2_vec),
+        m_primal_edge_length(primal_edge_length), m_dual_edge_length(dual_edge_length),
+        m_tangent_orientation(tangent_orientation), m_geofac_rot(geofac_rot),
+        m_geofac_div(geofac_div) {}
+
+  void run() {
+    run([](auto const&, int, int, double) {});
+  }
+
+  // same as run(), additionally calls onNabla2(loc, k, n, value) right after nabla2_vec of member n
+  // has been computed at edge loc and level k, e.g. to accumulate error norms without a second
+  // pass over the output (see ErrorNormsAccumulator in utils/ErrorNorms.h). the edges are visited
+  // in the order of the backend, sequentially
+  template <typename EdgeFn>
+  void run(EdgeFn&& onNabla2) {
+    using dawn::deref;
+    using batch_value_t = std::array<double, N>;
+    const std::vector<double> weights = {-1.0, 1.0};
+
+    for(int k = 0; k < m_k_size; ++k) {
+      for(auto const& loc : getVertices(LibTag{}, m_mesh)) {
+        int sparse_dimension_idx0 = 0;
+        batch_value_t rot = reduce(
+            LibTag{}, m_mesh, loc, batch_value_t{},
+            std::vector<dawn::LocationType>{dawn::LocationType::Vertices,
+                                            dawn::LocationType::Edges},
+            [&](auto& lhs, auto red_loc1) {
+              const double geofac = m_geofac_rot(deref(LibTag{}, loc), sparse_dimension_idx0, k);
+              for(int n = 0; n < N; n++) {
+                lhs[n] += ((*m_vec[n])(deref(LibTag{}, red_loc1), k) * geofac);
+              }
+              sparse_dimension_idx0++;
+              return lhs;
+            });
+        for(int n = 0; n < N; n++) {
+          (*m_rot_vec[n])(deref(LibTag{}, loc), k) = rot[n];
+        }
+      }
+      for(auto const& loc : getCells(LibTag{}, m_mesh)) {
+        int sparse_dimension_idx0 = 0;
+        batch_value_t div = reduce(
+            LibTag{}, m_mesh, loc, batch_value_t{},
+            std::vector<dawn::LocationType>{dawn::LocationType::Cells, dawn::LocationType::Edges},
+            [&](auto& lhs, auto red_loc1) {
+              const double geofac = m_geofac_div(deref(LibTag{}, loc), sparse_dimension_idx0, k);
+              for(int n = 0; n < N; n++) {
+                lhs[n] += ((*m_vec[n])(deref(LibTag{}, red_loc1), k) * geofac);
+              }
+              sparse_dimension_idx0++;
+              return lhs;
+            });
+        for(int n = 0; n < N; n++) {
+          (*m_div_vec[n])(deref(LibTag{}, loc), k) = div[n];
+        }
+      }
+      for(auto const& loc : getEdges(LibTag{}, m_mesh)) {
+        batch_value_t t1 = reduce(
+            LibTag{}, m_mesh, loc, batch_value_t{},
+            std::vector<dawn::LocationType>{dawn::LocationType::Edges,
+                                            dawn::LocationType::Vertices},
+            [&](auto& lhs, auto red_loc1, auto const& weight) {
+              for(int n = 0; n < N; n++) {
+                lhs[n] += weight * (*m_rot_vec[n])(deref(LibTag{}, red_loc1), k);
+              }
+              return lhs;
+            },
+            std::vector<double>(weights));
+        batch_value_t t2 = reduce(
+            LibTag{}, m_mesh, loc, batch_value_t{},
+            std::vector<dawn::LocationType>{dawn::LocationType::Edges, dawn::LocationType::Cells},
+            [&](auto& lhs, auto red_loc1, auto const& weight) {
+              for(int n = 0; n < N; n++) {
+                lhs[n] += weight * (*m_div_vec[n])(deref(LibTag{}, red_loc1), k);
+              }
+              return lhs;
+            },
+            std::vector<double>(weights));
+        const double tangent = m_tangent_orientation(deref(LibTag{}, loc), k);
+        const double primal = m_primal_edge_length(deref(LibTag{}, loc), k);
+        const double dual = m_dual_edge_length(deref(LibTag{}, loc), k);
+        for(int n = 0; n < N; n++) {
+          const double nabla2t1 = ((tangent * t1[n]) / primal);
+          const double nabla2t2 = (t2[n] / dual);
+          (*m_nabla2t1_vec[n])(deref(LibTag{}, loc), k) = nabla2t1;
+          (*m_nabla2t2_vec[n])(deref(LibTag{}, loc), k) = nabla2t2;
+          (*m_nabla2_vec[n])(deref(LibTag{}, loc), k) = (nabla2t2 - nabla2t1);
+          onNabla2(loc, k, n, nabla2t2 - nabla2t1);
+        }
+      }
+    }
+  }
+
+private:
+  dawn::mesh_t<LibTag> const& m_mesh;
+  int m_k_size;
+  batch_t<dawn::edge_field_t<LibTag, double>> m_vec;
+  batch_t<dawn::cell_field_t<LibTag, double>> m_div_vec;
+  batch_t<dawn::vertex_field_t<LibTag, double>> m_rot_vec;
+  batch_t<dawn::edge_field_t<LibTag, double>> m_nabla2t1_vec;
+  batch_t<dawn::edge_field_t<LibTag, double>> m_nabla2t2_vec;
+  batch_t<dawn::edge_field_t<LibTag, double>> m_nabla2_vec;
+  dawn::edge_field_t<LibTag, double>& m_primal_edge_length;
+  dawn::edge_field_t<LibTag, double>& m_dual_edge_length;
+  dawn::edge_field_t<LibTag, double>& m_tangent_orientation;
+  dawn::sparse_vertex_field_t<LibTag, double>& m_geofac_rot;
+  dawn::sparse_cell_field_t<LibTag, double>& m_geofac_div;
+};
@@ -25,6 +25,7 @@
 #include <unordered_map>
 #include <variant>
 
+#include "interface_counters.hpp"
 #include "unstructured_interface.hpp"
 
 namespace utility {
@@ -138,6 +139,7 @@ inline std::vector<int> getNeighs(const atlas::Mesh::HybridElements::Connectivit
       neighs.emplace_back(nbhIdx);
     }
   }
+  INTERFACE_COUNT_VECTOR(neighs);
   return neighs;
 }
 
@@ -149,6 +151,7 @@ inline std::vector<int> getNeighs(const atlas::mesh::Nodes::Connectivity& conn,
       neighs.emplace_back(nbhIdx);
     }
   }
+  INTERFACE_COUNT_VECTOR(neighs);
   return neighs;
 }
 
@@ -177,14 +180,17 @@ inline void getNeighborsImpl(
   for(auto idx : front) {
     // Build up new front for next recursive call
     auto nextElems = nbhTables.at({from, to})(idx);
+    INTERFACE_COUNT_FUNCTION();
     newFront.insert(std::end(newFront), std::begin(nextElems), std::end(nextElems));
 
     if(isNeighborOfTarget) {
       const auto& targetElems = nbhTables.at({from, targetType})(idx);
+      INTERFACE_COUNT_FUNCTION();
       // Add to result set the neighbors (of target type) of current (idx)
       std::copy(targetElems.begin(), targetElems.end(), std::inserter(result, result.end()));
     }
   }
+  INTERFACE_COUNT_VECTOR(newFront);
 
   if(chain.size() >= 2) {
     getNeighborsImpl(nbhTables, chain, targetType, newFront, result);
@@ -212,6 +218,8 @@ private:
 // entry point, kicks off the recursive function above if required
 inline std::vector<int> getNeighbors(atlasTag, atlas::Mesh const& mesh,
                                      std::vector<dawn::LocationType> chain, int idx) {
+  INTERFACE_COUNT_GET_NEIGHBORS(chain);
+  INTERFACE_COUNT_VECTOR(chain);
 
   // target type is at the end of the chain (we collect all neighbors of this type "along" the
   // chain)
@@ -273,6 +281,8 @@ inline std::vector<int> getNeighbors(atlasTag, atlas::Mesh const& mesh,
 
   std::vector<int> resultUnique;
   std::copy_if(result.begin(), result.end(), std::back_inserter(resultUnique), std::ref(pred));
+  INTERFACE_COUNT_VECTOR(resultUnique);
+  INTERFACE_COUNT_VISITED(resultUnique.size());
   return resultUnique;
 }
 
@@ -284,6 +294,9 @@ template <typename Init, typename Op, typename WeightT>
 auto reduce(atlasTag, atlas::Mesh const& m, int idx, Init init,
             std::vector<dawn::LocationType> chain, Op&& op, std::vector<WeightT>&& weights) {
   static_assert(std::is_arithmetic<WeightT>::value, "weights need to be of arithmetic type!\n");
+  INTERFACE_COUNT_REDUCE(chain);
+  INTERFACE_COUNT_VECTOR(chain);
+  INTERFACE_COUNT_VECTOR(weights);
   int i = 0;
   for(auto&& objIdx : getNeighbors(atlasTag{}, m, chain, idx))
     op(init, objIdx, weights[i++]);
@@ -297,6 +310,8 @@ auto reduce(atlasTag, atlas::Mesh const& m, int idx, Init init,
 template <typename Init, typename Op>
 auto reduce(atlasTag, atlas::Mesh const& m, int idx, Init init,
             std::vector<dawn::LocationType> chain, Op&& op) {
+  INTERFACE_COUNT_REDUCE(chain);
+  INTERFACE_COUNT_VECTOR(chain);
   for(auto&& objIdx : getNeighbors(atlasTag{}, m, chain, idx))
     op(init, objIdx);
   return init;
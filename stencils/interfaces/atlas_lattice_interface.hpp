@@ -0,0 +1,174 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+// Backend for atlas meshes which are sections of the equilateral triangle lattice (see
+// utils/AtlasLattice.h), e.g. icosahedral patches projected by AtlasProjectMesh. Elements and
+// fields are the same as for atlasTag. Neighbors of interior elements are computed by index
+// arithmetic on the lattice, only elements at the rim of the patch fall back to the atlas neighbor
+// tables. Both need to agree on the order of the neighbors, the mesh therefore has to be sorted
+// using AtlasSortByLattice before any sparse fields are set up:
+//
+//    AtlasLattice lattice = AtlasLatticeFromMesh(mesh).value();
+//    AtlasSortByLattice(mesh, lattice);
+//    atlasLatticeInterface::LatticeMesh latticeMesh(mesh, lattice);
+//    ICON_laplacian_stencil<atlasLatticeInterface::atlasLatticeTag>(latticeMesh, k_size, ...)
+
+#include "AtlasLattice.h"
+#include "atlas_interface.hpp"
+
+namespace atlasLatticeInterface {
+
+struct atlasLatticeTag {};
+
+class LatticeMesh {
+public:
+  LatticeMesh(const atlas::Mesh& mesh, const AtlasLattice& lattice)
+      : mesh_(mesh), lattice_(lattice) {}
+  const atlas::Mesh& mesh() const { return mesh_; }
+  const AtlasLattice& lattice() const { return lattice_; }
+
+private:
+  const atlas::Mesh& mesh_;
+  const AtlasLattice& lattice_;
+};
+
+LatticeMesh meshType(atlasLatticeTag);
+int indexType(atlasLatticeTag);
+
+template <typename T>
+atlasInterface::Field<T> cellFieldType(atlasLatticeTag);
+template <typename T>
+atlasInterface::Field<T> edgeFieldType(atlasLatticeTag);
+template <typename T>
+atlasInterface::Field<T> vertexFieldType(atlasLatticeTag);
+
+template <typename T>
+atlasInterface::SparseDimension<T> sparseCellFieldType(atlasLatticeTag);
+template <typename T>
+atlasInterface::SparseDimension<T> sparseEdgeFieldType(atlasLatticeTag);
+template <typename T>
+atlasInterface::SparseDimension<T> sparseVertexFieldType(atlasLatticeTag);
+
+inline auto getCells(atlasLatticeTag, LatticeMesh const& m) {
+  return utility::irange(0, m.mesh().cells().size());
+}
+inline auto getEdges(atlasLatticeTag, LatticeMesh const& m) {
+  return utility::irange(0, m.mesh().edges().size());
+}
+inline auto getVertices(atlasLatticeTag, LatticeMesh const& m) {
+  return utility::irange(0, m.mesh().nodes().size());
+}
+
+// copies the present entries of a table row, returns their number
+template <typename ConnectivityT>
+int tableNeighbors(const ConnectivityT& conn, int idx, int nbh[]) {
+  int numNbh = 0;
+  for(int n = 0; n < conn.cols(idx); ++n) {
+    if(conn(idx, n) != conn.missing_value()) {
+      nbh[numNbh++] = conn(idx, n);
+    }
+  }
+  return numNbh;
+}
+
+// direct neighbors (from -> to) of idx. nbh needs to hold AtlasLattice::maxNeighbors entries
+inline int directNeighbors(LatticeMesh const& m, dawn::LocationType from, dawn::LocationType to,
+                           int idx, int nbh[]) {
+  const AtlasLattice& lattice = m.lattice();
+  switch(from) {
+  case dawn::LocationType::Cells:
+    if(to == dawn::LocationType::Edges)
+      return lattice.edgesOfCell(idx, nbh);
+    if(to == dawn::LocationType::Vertices)
+      return lattice.nodesOfCell(idx, nbh);
+    break;
+  case dawn::LocationType::Edges:
+    if(to == dawn::LocationType::Cells) {
+      if(!lattice.interiorEdge(idx))
+        return tableNeighbors(m.mesh().edges().cell_connectivity(), idx, nbh);
+      return lattice.cellsOfEdge(idx, nbh);
+    }
+    if(to == dawn::LocationType::Vertices)
+      return lattice.nodesOfEdge(idx, nbh);
+    break;
+  case dawn::LocationType::Vertices:
+    if(to == dawn::LocationType::Cells) {
+      if(!lattice.interiorNode(idx))
+        return tableNeighbors(m.mesh().nodes().cell_connectivity(), idx, nbh);
+      return lattice.cellsOfNode(idx, nbh);
+    }
+    if(to == dawn::LocationType::Edges) {
+      if(!lattice.interiorNode(idx))
+        return tableNeighbors(m.mesh().nodes().edge_connectivity(), idx, nbh);
+      return lattice.edgesOfNode(idx, nbh);
+    }
+    break;
+  }
+  return 0;
+}
+
+// longer chains are rare and not performance critical, they are handed to the atlas backend
+inline std::vector<int> getNeighbors(atlasLatticeTag, LatticeMesh const& m,
+                                     const std::vector<dawn::LocationType>& chain, int idx) {
+  if(chain.size() == 2) {
+    int nbh[AtlasLattice::maxNeighbors];
+    int numNbh = directNeighbors(m, chain[0], chain[1], idx, nbh);
+    return std::vector<int>(nbh, nbh + numNbh);
+  }
+  return atlasInterface::getNeighbors(atlasInterface::atlasTag{}, m.mesh(), chain, idx);
+}
+
+//===------------------------------------------------------------------------------------------===//
+// weighted version
+//===------------------------------------------------------------------------------------------===//
+
+template <typename Init, typename Op, typename WeightT>
+auto reduce(atlasLatticeTag, LatticeMesh const& m, int idx, Init init,
+            const std::vector<dawn::LocationType>& chain, Op&& op, std::vector<WeightT>&& weights) {
+  static_assert(std::is_arithmetic<WeightT>::value, "weights need to be of arithmetic type!\n");
+  if(chain.size() == 2) {
+    int nbh[AtlasLattice::maxNeighbors];
+    int numNbh = directNeighbors(m, chain[0], chain[1], idx, nbh);
+    for(int i = 0; i < numNbh; i++)
+      op(init, nbh[i], weights[i]);
+    return init;
+  }
+  int i = 0;
+  for(auto&& objIdx : getNeighbors(atlasLatticeTag{}, m, chain, idx))
+    op(init, objIdx, weights[i++]);
+  return init;
+}
+
+//===------------------------------------------------------------------------------------------===//
+// unweighted version
+//===------------------------------------------------------------------------------------------===//
+
+template <typename Init, typename Op>
+auto reduce(atlasLatticeTag, LatticeMesh const& m, int idx, Init init,
+            const std::vector<dawn::LocationType>& chain, Op&& op) {
+  if(chain.size() == 2) {
+    int nbh[AtlasLattice::maxNeighbors];
+    int numNbh = directNeighbors(m, chain[0], chain[1], idx, nbh);
+    for(int i = 0; i < numNbh; i++)
+      op(init, nbh[i]);
+    return init;
+  }
+  for(auto&& objIdx : getNeighbors(atlasLatticeTag{}, m, chain, idx))
+    op(init, objIdx);
+  return init;
+}
+
+} // namespace atlasLatticeInterface
@@ -0,0 +1,226 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+// Backend on plain arrays. The mesh is a FlatMesh (utils/FlatMesh.h), i.e. int32_t neighbor tables
+// in fixed width or CSR format without missing values, converted from an atlas mesh or a toylib
+// grid. Fields are contiguous, aligned arrays of values stored level by level. Direct neighbors
+// are visited straight from the tables without any allocation, which makes this backend the
+// reference for the overhead of the other unstructured backends:
+//
+//    FlatMesh mesh = FlatMeshFromAtlas(atlasMesh);
+//    flatInterface::Field<double> vec(mesh.numEdges(), k_size);
+//    flatInterface::SparseField<double> geofac_div(mesh.numCells(), edgesPerCell, k_size);
+//    ICON_laplacian_stencil<flatInterface::flatTag>(mesh, k_size, vec, ...)
+//
+// Elements and neighbors are in the order of the source mesh, s.t. sparse fields and weights set
+// up for the source mesh can be copied over unchanged.
+
+#include "FlatMesh.h"
+#include "unstructured_interface.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace flatInterface {
+
+struct flatTag {};
+
+// size values per level, stored level by level
+template <typename T>
+class Field {
+public:
+  Field(int size, int k_size) : size_(size), k_size_(k_size), data_(size_t(size) * k_size) {
+    std::fill(data_.data(), data_.data() + data_.size(), T());
+  }
+
+  T const& operator()(int idx, int k) const { return data_[size_t(k) * size_ + idx]; }
+  T& operator()(int idx, int k) { return data_[size_t(k) * size_ + idx]; }
+
+  int size() const { return size_; }
+  int k_size() const { return k_size_; }
+  T* data() { return data_.data(); }
+  const T* data() const { return data_.data(); }
+  size_t bytes() const { return data_.bytes(); }
+
+private:
+  int size_;
+  int k_size_;
+  AlignedArray<T> data_;
+};
+
+// sparseSize values per element and level, stored level by level. the values of an element are
+// contiguous
+template <typename T>
+class SparseField {
+public:
+  SparseField(int size, int sparseSize, int k_size)
+      : size_(size), sparseSize_(sparseSize), k_size_(k_size),
+        data_(size_t(size) * sparseSize * k_size) {
+    std::fill(data_.data(), data_.data() + data_.size(), T());
+  }
+
+  T const& operator()(int idx, int sparseIdx, int k) const {
+    return data_[(size_t(k) * size_ + idx) * sparseSize_ + sparseIdx];
+  }
+  T& operator()(int idx, int sparseIdx, int k) {
+    return data_[(size_t(k) * size_ + idx) * sparseSize_ + sparseIdx];
+  }
+
+  int size() const { return size_; }
+  int sparseSize() const { return sparseSize_; }
+  int k_size() const { return k_size_; }
+  T* data() { return data_.data(); }
+  const T* data() const { return data_.data(); }
+  size_t bytes() const { return data_.bytes(); }
+
+private:
+  int size_;
+  int sparseSize_;
+  int k_size_;
+  AlignedArray<T> data_;
+};
+
+FlatMesh meshType(flatTag);
+int indexType(flatTag);
+
+template <typename T>
+Field<T> cellFieldType(flatTag);
+template <typename T>
+Field<T> edgeFieldType(flatTag);
+template <typename T>
+Field<T> vertexFieldType(flatTag);
+
+template <typename T>
+SparseField<T> sparseCellFieldType(flatTag);
+template <typename T>
+SparseField<T> sparseEdgeFieldType(flatTag);
+template <typename T>
+SparseField<T> sparseVertexFieldType(flatTag);
+
+// the indices [0, size)
+class IndexRange {
+public:
+  class iterator {
+  public:
+    int operator*() const { return idx_; }
+    iterator& operator++() {
+      ++idx_;
+      return *this;
+    }
+    bool operator==(const iterator& other) const { return idx_ == other.idx_; }
+    bool operator!=(const iterator& other) const { return idx_ != other.idx_; }
+
+    explicit iterator(int idx) : idx_(idx) {}
+
+  private:
+    int idx_;
+  };
+
+  explicit IndexRange(int size) : size_(size) {}
+  iterator begin() const { return iterator(0); }
+  iterator end() const { return iterator(size_); }
+
+private:
+  int size_;
+};
+
+inline IndexRange getCells(flatTag, FlatMesh const& m) { return IndexRange(m.numCells()); }
+inline IndexRange getEdges(flatTag, FlatMesh const& m) { return IndexRange(m.numEdges()); }
+inline IndexRange getVertices(flatTag, FlatMesh const& m) { return IndexRange(m.numVertices()); }
+
+inline const FlatConnectivity& table(FlatMesh const& mesh, dawn::LocationType from,
+                                     dawn::LocationType to) {
+  return mesh.table(FlatLocation(int(from)), FlatLocation(int(to)));
+}
+
+// same semantics as atlasInterface::getNeighbors: all elements of the target type (the last entry
+// of the chain) encountered along the chain, without duplicates and without the origin
+inline std::vector<int> getNeighbors(flatTag, FlatMesh const& mesh,
+                                     const std::vector<dawn::LocationType>& chain, int idx) {
+  const dawn::LocationType targetType = chain.back();
+  std::vector<int> result;
+  auto addToResult = [&](int nbh) {
+    if(chain.front() == targetType && nbh == idx) {
+      return;
+    }
+    if(std::find(result.begin(), result.end(), nbh) == result.end()) {
+      result.push_back(nbh);
+    }
+  };
+
+  std::vector<int> front{idx};
+  for(size_t chainIdx = 0; chainIdx + 1 < chain.size(); chainIdx++) {
+    const dawn::LocationType from = chain[chainIdx];
+    const FlatConnectivity& next = table(mesh, from, chain[chainIdx + 1]);
+    std::vector<int> newFront;
+    for(int elem : front) {
+      newFront.insert(newFront.end(), next.begin(elem), next.end(elem));
+      if(from != targetType) {
+        const FlatConnectivity& targets = table(mesh, from, targetType);
+        std::for_each(targets.begin(elem), targets.end(elem), addToResult);
+      }
+    }
+    front = std::move(newFront);
+  }
+  return result;
+}
+
+//===------------------------------------------------------------------------------------------===//
+// weighted version
+//===------------------------------------------------------------------------------------------===//
+
+template <typename Init, typename Op, typename WeightT>
+auto reduce(flatTag, FlatMesh const& mesh, int idx, Init init,
+            const std::vector<dawn::LocationType>& chain, Op&& op, std::vector<WeightT>&& weights) {
+  static_assert(std::is_arithmetic<WeightT>::value, "weights need to be of arithmetic type!\n");
+  // direct neighbors are free of duplicates, visit them straight from the table
+  if(chain.size() == 2) {
+    const FlatConnectivity& conn = table(mesh, chain[0], chain[1]);
+    const int32_t* nbh = conn.begin(idx);
+    const int numNbh = conn.end(idx) - nbh;
+    for(int i = 0; i < numNbh; i++) {
+      op(init, nbh[i], weights[i]);
+    }
+    return init;
+  }
+  int i = 0;
+  for(int nbh : getNeighbors(flatTag{}, mesh, chain, idx)) {
+    op(init, nbh, weights[i++]);
+  }
+  return init;
+}
+
+//===------------------------------------------------------------------------------------------===//
+// unweighted version
+//===------------------------------------------------------------------------------------------===//
+
+template <typename Init, typename Op>
+auto reduce(flatTag, FlatMesh const& mesh, int idx, Init init,
+            const std::vector<dawn::LocationType>& chain, Op&& op) {
+  if(chain.size() == 2) {
+    const FlatConnectivity& conn = table(mesh, chain[0], chain[1]);
+    for(const int32_t* nbh = conn.begin(idx); nbh != conn.end(idx); ++nbh) {
+      op(init, *nbh);
+    }
+    return init;
+  }
+  for(int nbh : getNeighbors(flatTag{}, mesh, chain, idx)) {
+    op(init, nbh);
+  }
+  return init;
+}
+
+} // namespace flatInterface
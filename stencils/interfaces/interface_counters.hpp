@@ -0,0 +1,169 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Optional profiling counters for the neighbor access of the atlas and toylib interfaces. Per
+// neighbor chain (e.g. Edges > Cells > Vertices) the number of getNeighbors and reduce calls and
+// the number of neighbors returned are counted. Furthermore the std::vector buffers created while
+// collecting neighbors (count and bytes) and the invocations of the std::function neighbor tables
+// are counted. Allocations made by other containers (std::list, std::set, std::function) are not
+// included, see benchmarks/AllocationHook.cpp for a complete account.
+//
+// Counters are kept per thread (no synchronization on the hot path), merged when a thread exits
+// and printed at program exit. The macros expand to nothing unless ATLAS_UTILS_INTERFACE_COUNTERS
+// is defined (cmake option -DATLAS_UTILS_INTERFACE_COUNTERS=ON).
+
+#pragma once
+
+#include "unstructured_interface.hpp"
+
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#ifdef ATLAS_UTILS_INTERFACE_COUNTERS
+#define INTERFACE_COUNT_GET_NEIGHBORS(chain)                                                       \
+  interfaceCounters::ThreadCounters::get().countGetNeighbors(chain)
+#define INTERFACE_COUNT_VISITED(numNeighbors)                                                      \
+  interfaceCounters::ThreadCounters::get().countVisited(numNeighbors)
+#define INTERFACE_COUNT_REDUCE(chain) interfaceCounters::ThreadCounters::get().countReduce(chain)
+#define INTERFACE_COUNT_VECTOR(vec) interfaceCounters::ThreadCounters::get().countVector(vec)
+#define INTERFACE_COUNT_FUNCTION() interfaceCounters::ThreadCounters::get().functionInvocations++
+#else
+#define INTERFACE_COUNT_GET_NEIGHBORS(chain)
+#define INTERFACE_COUNT_VISITED(numNeighbors)
+#define INTERFACE_COUNT_REDUCE(chain)
+#define INTERFACE_COUNT_VECTOR(vec)
+#define INTERFACE_COUNT_FUNCTION()
+#endif
+
+namespace interfaceCounters {
+
+struct ChainCounters {
+  long getNeighborsCalls = 0;
+  long reduceCalls = 0;
+  long neighborsVisited = 0;
+};
+
+struct Counters {
+  // keyed by the encoded chain, see chainKey
+  std::map<int, ChainCounters> chains;
+  long vectorsAllocated = 0;
+  long bytesAllocated = 0;
+  long functionInvocations = 0;
+
+  void add(const Counters& other) {
+    for(const auto& [key, chain] : other.chains) {
+      ChainCounters& sum = chains[key];
+      sum.getNeighborsCalls += chain.getNeighborsCalls;
+      sum.reduceCalls += chain.reduceCalls;
+      sum.neighborsVisited += chain.neighborsVisited;
+    }
+    vectorsAllocated += other.vectorsAllocated;
+    bytesAllocated += other.bytesAllocated;
+    functionInvocations += other.functionInvocations;
+  }
+};
+
+// chains are encoded in base 4 (location type + 1 per link), such that counting does not need to
+// build a string
+inline int chainKey(const std::vector<dawn::LocationType>& chain) {
+  int key = 0;
+  for(auto type : chain) {
+    key = 4 * key + int(type) + 1;
+  }
+  return key;
+}
+
+inline std::string chainName(int key) {
+  const char* names[] = {"Cells", "Edges", "Vertices"};
+  std::string name;
+  for(; key > 0; key /= 4) {
+    name = std::string(names[key % 4 - 1]) + (name.empty() ? "" : " > ") + name;
+  }
+  return name;
+}
+
+// counters of all threads which exited so far, printed at program exit
+class GlobalCounters {
+public:
+  static GlobalCounters& get() {
+    static GlobalCounters counters;
+    return counters;
+  }
+
+  void merge(const Counters& counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    total_.add(counters);
+  }
+
+  ~GlobalCounters() {
+    if(total_.chains.empty() && total_.vectorsAllocated == 0) {
+      return;
+    }
+    printf("interface counters\n");
+    printf("%-36s %14s %14s %16s %10s\n", "chain", "getNeighbors", "reduce", "neighbors",
+           "per call");
+    for(const auto& [key, chain] : total_.chains) {
+      printf("%-36s %14ld %14ld %16ld %10.2f\n", chainName(key).c_str(), chain.getNeighborsCalls,
+             chain.reduceCalls, chain.neighborsVisited,
+             chain.getNeighborsCalls > 0 ? double(chain.neighborsVisited) / chain.getNeighborsCalls
+                                         : 0.);
+    }
+    printf("vectors allocated %ld (%ld bytes), std::function invocations %ld\n",
+           total_.vectorsAllocated, total_.bytesAllocated, total_.functionInvocations);
+  }
+
+private:
+  GlobalCounters() = default;
+
+  std::mutex mutex_;
+  Counters total_;
+};
+
+// counters of the calling thread, merged into GlobalCounters when the thread exits
+class ThreadCounters : public Counters {
+public:
+  static ThreadCounters& get() {
+    thread_local ThreadCounters counters;
+    return counters;
+  }
+
+  // the neighbors returned by a getNeighbors call are attributed to the chain of the last call
+  void countGetNeighbors(const std::vector<dawn::LocationType>& chain) {
+    lastChain_ = &chains[chainKey(chain)];
+    lastChain_->getNeighborsCalls++;
+  }
+  void countVisited(int numNeighbors) { lastChain_->neighborsVisited += numNeighbors; }
+  void countReduce(const std::vector<dawn::LocationType>& chain) {
+    chains[chainKey(chain)].reduceCalls++;
+  }
+  template <typename T>
+  void countVector(const std::vector<T>& vec) {
+    vectorsAllocated += vec.capacity() > 0 ? 1 : 0;
+    bytesAllocated += vec.capacity() * sizeof(T);
+  }
+
+  ~ThreadCounters() { GlobalCounters::get().merge(*this); }
+
+private:
+  // GlobalCounters needs to be constructed first, such that it is destroyed after the counters of
+  // the main thread are merged
+  ThreadCounters() { GlobalCounters::get(); }
+
+  ChainCounters* lastChain_ = nullptr;
+};
+
+} // namespace interfaceCounters
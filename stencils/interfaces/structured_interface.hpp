@@ -0,0 +1,397 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+// Table free backend for the regular grids generated by toylib::Grid(nx, ny, periodic). Elements
+// are plain ids using exactly the numbering of toylib::Grid, and all neighbors are computed from
+// the (i, j, color) index of an element instead of being looked up. Neighbors are returned in the
+// same order as the toylib backend returns them, such that sparse fields and weights set up for
+// toylibTag can be used unchanged.
+//
+// Fields are the toylib fields (indexed by id), i.e. they are allocated from the toylib::Grid with
+// the same nx, ny and periodicity:
+//
+//    toylib::Grid grid(nx, ny, periodic);
+//    structuredInterface::StructuredGrid<periodic> mesh(nx, ny);
+//    toylib::EdgeData<double> vec(grid, k_size);
+//    ICON_laplacian_stencil<structuredInterface::structuredTag<periodic>>(mesh, k_size, vec, ...)
+//
+// The periodic and the non periodic variant are distinct tags, s.t. the boundary handling is
+// resolved at compile time.
+
+#include "../../libs/toylib.hpp"
+#include "unstructured_interface.hpp"
+
+#include <algorithm>
+#include <array>
+#include <assert.h>
+#include <vector>
+
+namespace structuredInterface {
+
+template <bool periodic>
+struct structuredTag {};
+
+// neighbors of a single element. no element of these grids has more than six neighbors of any
+// type, s.t. the neighbors can be kept on the stack
+class NeighborList {
+public:
+  static constexpr int maxSize = 6;
+
+  void push_back(int id) {
+    assert(size_ < maxSize);
+    ids_[size_++] = id;
+  }
+  int size() const { return size_; }
+  int operator[](int idx) const { return ids_[idx]; }
+  const int* begin() const { return ids_.data(); }
+  const int* end() const { return ids_.data() + size_; }
+
+private:
+  std::array<int, maxSize> ids_;
+  int size_ = 0;
+};
+
+// range of element ids. if validEdgesOf is set, the ids are edge ids and invalid edges are skipped
+template <typename GridT>
+class IdRange {
+public:
+  class iterator {
+  public:
+    int operator*() const { return id_; }
+    iterator& operator++() {
+      ++id_;
+      if(grid_) {
+        while(id_ < end_ && !grid_->isValidEdge(id_)) {
+          ++id_;
+        }
+      }
+      return *this;
+    }
+    bool operator==(const iterator& other) const { return id_ == other.id_; }
+    bool operator!=(const iterator& other) const { return id_ != other.id_; }
+
+    iterator(int id, int end, const GridT* grid) : id_(id), end_(end), grid_(grid) {}
+
+  private:
+    int id_;
+    int end_;
+    const GridT* grid_;
+  };
+
+  IdRange(int size, const GridT* validEdgesOf = nullptr) : size_(size), grid_(validEdgesOf) {}
+
+  iterator begin() const {
+    int first = 0;
+    while(grid_ && first < size_ && !grid_->isValidEdge(first)) {
+      ++first;
+    }
+    return iterator(first, size_, grid_);
+  }
+  iterator end() const { return iterator(size_, size_, grid_); }
+
+private:
+  int size_;
+  const GridT* grid_;
+};
+
+// index arithmetic of toylib::Grid(nx, ny, periodic). see the constructor of toylib::Grid for the
+// layout and the local orderings used below
+template <bool periodic>
+class StructuredGrid {
+public:
+  StructuredGrid(int nx, int ny) : nx_(nx), ny_(ny) {
+    // the toylib backend removes duplicate neighbors, which only appear on periodic grids with a
+    // single row or column. these are not supported here
+    assert(nx >= 2 && ny >= 2);
+  }
+
+  int nx() const { return nx_; }
+  int ny() const { return ny_; }
+
+  int numCells() const { return 2 * nx_ * ny_; }
+  int numVertices() const { return periodic ? nx_ * ny_ : (nx_ + 1) * (ny_ + 1); }
+  // number of edge ids, including the ids of invalid edges on non periodic grids (these are
+  // allocated by toylib::EdgeData as well)
+  int numEdgeIds() const { return periodic ? 3 * nx_ * ny_ : 3 * (nx_ + 1) * (ny_ + 1); }
+
+  //===--------------------------------------------------------------------------------------===//
+  // (i, j, color) -> id
+  //===--------------------------------------------------------------------------------------===//
+  int cell(int i, int j, toylib::face_color c) const { return 2 * (wrapJ(j) * nx_ + wrapI(i)) + c; }
+  int edge(int i, int j, toylib::edge_color c) const {
+    return 3 * (wrapJ(j) * rowSize() + wrapI(i)) + c;
+  }
+  int vertex(int i, int j) const { return wrapJ(j) * rowSize() + wrapI(i); }
+
+  bool isValidEdge(int id) const {
+    if(periodic) {
+      return true;
+    }
+    const int c = id % 3;
+    const int i = (id / 3) % rowSize();
+    const int j = (id / 3) / rowSize();
+    switch(c) {
+    case toylib::edge_color::horizontal:
+      return i < nx_;
+    case toylib::edge_color::diagonal:
+      return i < nx_ && j < ny_;
+    default:
+      return j < ny_;
+    }
+  }
+
+  //===--------------------------------------------------------------------------------------===//
+  // direct neighbors, in the order of toylib
+  //===--------------------------------------------------------------------------------------===//
+  void edgesOfCell(int id, NeighborList& nbh) const {
+    const int c = id % 2, i = (id / 2) % nx_, j = (id / 2) / nx_;
+    if(c == toylib::face_color::upward) {
+      nbh.push_back(edge(i, j, toylib::edge_color::vertical));
+      nbh.push_back(edge(i, j, toylib::edge_color::diagonal));
+      nbh.push_back(edge(i, j + 1, toylib::edge_color::horizontal));
+    } else {
+      nbh.push_back(edge(i, j, toylib::edge_color::diagonal));
+      nbh.push_back(edge(i, j, toylib::edge_color::horizontal));
+      nbh.push_back(edge(i + 1, j, toylib::edge_color::vertical));
+    }
+  }
+  void verticesOfCell(int id, NeighborList& nbh) const {
+    const int c = id % 2, i = (id / 2) % nx_, j = (id / 2) / nx_;
+    nbh.push_back(vertex(i, j));
+    if(c == toylib::face_color::upward) {
+      nbh.push_back(vertex(i + 1, j + 1));
+      nbh.push_back(vertex(i, j + 1));
+    } else {
+      nbh.push_back(vertex(i + 1, j));
+      nbh.push_back(vertex(i + 1, j + 1));
+    }
+  }
+  void verticesOfEdge(int id, NeighborList& nbh) const {
+    const int c = id % 3, i = (id / 3) % rowSize(), j = (id / 3) / rowSize();
+    nbh.push_back(vertex(i, j));
+    switch(c) {
+    case toylib::edge_color::horizontal:
+      nbh.push_back(vertex(i + 1, j));
+      break;
+    case toylib::edge_color::diagonal:
+      nbh.push_back(vertex(i + 1, j + 1));
+      break;
+    default:
+      nbh.push_back(vertex(i, j + 1));
+      break;
+    }
+  }
+  void cellsOfEdge(int id, NeighborList& nbh) const {
+    const int c = id % 3, i = (id / 3) % rowSize(), j = (id / 3) / rowSize();
+    switch(c) {
+    case toylib::edge_color::horizontal:
+      if(periodic || j > 0)
+        nbh.push_back(cell(i, j - 1, toylib::face_color::upward));
+      if(periodic || j < ny_)
+        nbh.push_back(cell(i, j, toylib::face_color::downward));
+      break;
+    case toylib::edge_color::diagonal:
+      // toylib swaps the faces of diagonal edges ("ICON compat attempt")
+      nbh.push_back(cell(i, j, toylib::face_color::upward));
+      nbh.push_back(cell(i, j, toylib::face_color::downward));
+      break;
+    default:
+      if(periodic || i < nx_)
+        nbh.push_back(cell(i, j, toylib::face_color::upward));
+      if(periodic || i > 0)
+        nbh.push_back(cell(i - 1, j, toylib::face_color::downward));
+      break;
+    }
+  }
+  void edgesOfVertex(int id, NeighborList& nbh) const {
+    const int i = id % rowSize(), j = id / rowSize();
+    if(periodic || i > 0)
+      nbh.push_back(edge(i - 1, j, toylib::edge_color::horizontal));
+    if(periodic || (i > 0 && j > 0))
+      nbh.push_back(edge(i - 1, j - 1, toylib::edge_color::diagonal));
+    if(periodic || j > 0)
+      nbh.push_back(edge(i, j - 1, toylib::edge_color::vertical));
+    if(periodic || i < nx_)
+      nbh.push_back(edge(i, j, toylib::edge_color::horizontal));
+    if(periodic || (i < nx_ && j < ny_))
+      nbh.push_back(edge(i, j, toylib::edge_color::diagonal));
+    if(periodic || j < ny_)
+      nbh.push_back(edge(i, j, toylib::edge_color::vertical));
+  }
+  void cellsOfVertex(int id, NeighborList& nbh) const {
+    const int i = id % rowSize(), j = id / rowSize();
+    if(periodic || (i > 0 && j > 0)) {
+      nbh.push_back(cell(i - 1, j - 1, toylib::face_color::upward));
+      nbh.push_back(cell(i - 1, j - 1, toylib::face_color::downward));
+    }
+    if(periodic || (i < nx_ && j > 0))
+      nbh.push_back(cell(i, j - 1, toylib::face_color::upward));
+    if(periodic || (i < nx_ && j < ny_)) {
+      nbh.push_back(cell(i, j, toylib::face_color::downward));
+      nbh.push_back(cell(i, j, toylib::face_color::upward));
+    }
+    if(periodic || (i > 0 && j < ny_))
+      nbh.push_back(cell(i - 1, j, toylib::face_color::downward));
+  }
+
+  // dispatches to the functions above. there are no neighbors of the same location type
+  void neighbors(dawn::LocationType from, dawn::LocationType to, int id, NeighborList& nbh) const {
+    switch(from) {
+    case dawn::LocationType::Cells:
+      if(to == dawn::LocationType::Edges)
+        edgesOfCell(id, nbh);
+      else if(to == dawn::LocationType::Vertices)
+        verticesOfCell(id, nbh);
+      break;
+    case dawn::LocationType::Edges:
+      if(to == dawn::LocationType::Cells)
+        cellsOfEdge(id, nbh);
+      else if(to == dawn::LocationType::Vertices)
+        verticesOfEdge(id, nbh);
+      break;
+    case dawn::LocationType::Vertices:
+      if(to == dawn::LocationType::Cells)
+        cellsOfVertex(id, nbh);
+      else if(to == dawn::LocationType::Edges)
+        edgesOfVertex(id, nbh);
+      break;
+    }
+  }
+
+private:
+  int rowSize() const { return periodic ? nx_ : nx_ + 1; }
+  int wrapI(int i) const { return periodic ? (i + nx_) % nx_ : i; }
+  int wrapJ(int j) const { return periodic ? (j + ny_) % ny_ : j; }
+
+  int nx_;
+  int ny_;
+};
+
+template <bool periodic>
+StructuredGrid<periodic> meshType(structuredTag<periodic>);
+template <bool periodic>
+int indexType(structuredTag<periodic>);
+
+template <typename T, bool periodic>
+toylib::FaceData<T> cellFieldType(structuredTag<periodic>);
+template <typename T, bool periodic>
+toylib::EdgeData<T> edgeFieldType(structuredTag<periodic>);
+template <typename T, bool periodic>
+toylib::VertexData<T> vertexFieldType(structuredTag<periodic>);
+
+template <typename T, bool periodic>
+toylib::SparseFaceData<T> sparseCellFieldType(structuredTag<periodic>);
+template <typename T, bool periodic>
+toylib::SparseEdgeData<T> sparseEdgeFieldType(structuredTag<periodic>);
+template <typename T, bool periodic>
+toylib::SparseVertexData<T> sparseVertexFieldType(structuredTag<periodic>);
+
+template <bool periodic>
+auto getCells(structuredTag<periodic>, StructuredGrid<periodic> const& m) {
+  return IdRange<StructuredGrid<periodic>>(m.numCells());
+}
+template <bool periodic>
+auto getEdges(structuredTag<periodic>, StructuredGrid<periodic> const& m) {
+  return IdRange<StructuredGrid<periodic>>(m.numEdgeIds(), &m);
+}
+template <bool periodic>
+auto getVertices(structuredTag<periodic>, StructuredGrid<periodic> const& m) {
+  return IdRange<StructuredGrid<periodic>>(m.numVertices());
+}
+
+// same semantics as toylibInterface::getNeighbors: all elements of the target type (the last
+// entry of the chain) encountered along the chain, without duplicates and without the origin
+template <bool periodic>
+std::vector<int> getNeighbors(structuredTag<periodic>, StructuredGrid<periodic> const& mesh,
+                              const std::vector<dawn::LocationType>& chain, int idx) {
+  const dawn::LocationType targetType = chain.back();
+  std::vector<int> result;
+  auto addToResult = [&](int id) {
+    if(chain.front() == targetType && id == idx) {
+      return;
+    }
+    if(std::find(result.begin(), result.end(), id) == result.end()) {
+      result.push_back(id);
+    }
+  };
+
+  std::vector<int> front{idx};
+  for(size_t chainIdx = 0; chainIdx + 1 < chain.size(); chainIdx++) {
+    const dawn::LocationType from = chain[chainIdx];
+    const dawn::LocationType to = chain[chainIdx + 1];
+    std::vector<int> newFront;
+    for(int id : front) {
+      NeighborList next;
+      mesh.neighbors(from, to, id, next);
+      newFront.insert(newFront.end(), next.begin(), next.end());
+      if(from != targetType) {
+        NeighborList targets;
+        mesh.neighbors(from, targetType, id, targets);
+        for(int target : targets) {
+          addToResult(target);
+        }
+      }
+    }
+    front = std::move(newFront);
+  }
+  return result;
+}
+
+//===------------------------------------------------------------------------------------------===//
+// weighted version
+//===------------------------------------------------------------------------------------------===//
+
+template <bool periodic, typename Init, typename Op, typename Weight>
+auto reduce(structuredTag<periodic>, StructuredGrid<periodic> const& mesh, int idx, Init init,
+            const std::vector<dawn::LocationType>& chain, Op&& op, std::vector<Weight>&& weights) {
+  // direct neighbors are free of duplicates, collect them on the stack
+  if(chain.size() == 2) {
+    NeighborList nbh;
+    mesh.neighbors(chain[0], chain[1], idx, nbh);
+    for(int i = 0; i < nbh.size(); i++) {
+      op(init, nbh[i], weights[i]);
+    }
+    return init;
+  }
+  int i = 0;
+  for(int id : getNeighbors(structuredTag<periodic>{}, mesh, chain, idx)) {
+    op(init, id, weights[i++]);
+  }
+  return init;
+}
+
+//===------------------------------------------------------------------------------------------===//
+// unweighted version
+//===------------------------------------------------------------------------------------------===//
+
+template <bool periodic, typename Init, typename Op>
+auto reduce(structuredTag<periodic>, StructuredGrid<periodic> const& mesh, int idx, Init init,
+            const std::vector<dawn::LocationType>& chain, Op&& op) {
+  if(chain.size() == 2) {
+    NeighborList nbh;
+    mesh.neighbors(chain[0], chain[1], idx, nbh);
+    for(int id : nbh) {
+      op(init, id);
+    }
+    return init;
+  }
+  for(int id : getNeighbors(structuredTag<periodic>{}, mesh, chain, idx)) {
+    op(init, id);
+  }
+  return init;
+}
+
+} // namespace structuredInterface
@@ -15,6 +15,7 @@
 #pragma once
 
 #include "../../libs/toylib.hpp"
+#include "interface_counters.hpp"
 #include "unstructured_interface.hpp"
 
 #include <assert.h>
@@ -51,6 +52,7 @@ inline std::vector<const toylib::ToylibElement*> getCells(toylibTag, toylib::Gri
                  [](const toylib::Face& in) -> const toylib::ToylibElement* {
                    return static_cast<const toylib::ToylibElement*>(&in);
                  });
+  INTERFACE_COUNT_VECTOR(ret);
   return ret;
 }
 inline std::vector<const toylib::ToylibElement*> getEdges(toylibTag, toylib::Grid const& m) {
@@ -59,6 +61,7 @@ inline std::vector<const toylib::ToylibElement*> getEdges(toylibTag, toylib::Gri
                  [](const toylib::Edge& in) -> const toylib::ToylibElement* {
                    return static_cast<const toylib::ToylibElement*>(&in);
                  });
+  INTERFACE_COUNT_VECTOR(ret);
   return ret;
 }
 inline std::vector<const toylib::ToylibElement*> getVertices(toylibTag, toylib::Grid const& m) {
@@ -67,6 +70,7 @@ inline std::vector<const toylib::ToylibElement*> getVertices(toylibTag, toylib::
                  [](const toylib::Vertex& in) -> const toylib::ToylibElement* {
                    return static_cast<const toylib::ToylibElement*>(&in);
                  });
+  INTERFACE_COUNT_VECTOR(ret);
   return ret;
 }
 
@@ -106,14 +110,17 @@ inline void getNeighborsImpl(
   for(auto idx : front) {
     // Build up new front for next recursive call
     auto nextElems = nbhTables.at({from, to})(idx);
+    INTERFACE_COUNT_FUNCTION();
     newFront.insert(std::end(newFront), std::begin(nextElems), std::end(nextElems));
 
     if(isNeighborOfTarget) {
       const auto& targetElems = nbhTables.at({from, targetType})(idx);
+      INTERFACE_COUNT_FUNCTION();
       // Add to result set the neighbors (of target type) of current (idx)
       std::copy(targetElems.begin(), targetElems.end(), std::inserter(result, result.end()));
     }
   }
+  INTERFACE_COUNT_VECTOR(newFront);
   if(chain.size() >= 2) {
     getNeighborsImpl(nbhTables, chain, targetType, newFront, result);
   }
@@ -140,6 +147,8 @@ private:
 inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const toylib::Grid& mesh,
                                                               std::vector<dawn::LocationType> chain,
                                                               const toylib::ToylibElement* elem) {
+  INTERFACE_COUNT_GET_NEIGHBORS(chain);
+  INTERFACE_COUNT_VECTOR(chain);
   switch(chain.front()) {
   case dawn::LocationType::Cells:
     assert(dynamic_cast<const toylib::Face*>(elem) != nullptr);
@@ -167,6 +176,7 @@ inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const t
                    [](const toylib::Face* in) -> const toylib::ToylibElement* {
                      return static_cast<const toylib::ToylibElement*>(in);
                    });
+    INTERFACE_COUNT_VECTOR(ret);
     return ret;
   };
   auto verticesFromEdge =
@@ -178,6 +188,7 @@ inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const t
                    [](const toylib::Vertex* in) -> const toylib::ToylibElement* {
                      return static_cast<const toylib::ToylibElement*>(in);
                    });
+    INTERFACE_COUNT_VECTOR(ret);
     return ret;
   };
 
@@ -190,6 +201,7 @@ inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const t
                    [](const toylib::Vertex* in) -> const toylib::ToylibElement* {
                      return static_cast<const toylib::ToylibElement*>(in);
                    });
+    INTERFACE_COUNT_VECTOR(ret);
     return ret;
   };
   auto edgesFromCell =
@@ -201,6 +213,7 @@ inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const t
                    [](const toylib::Edge* in) -> const toylib::ToylibElement* {
                      return static_cast<const toylib::ToylibElement*>(in);
                    });
+    INTERFACE_COUNT_VECTOR(ret);
     return ret;
   };
 
@@ -213,6 +226,7 @@ inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const t
                    [](const toylib::Face* in) -> const toylib::ToylibElement* {
                      return static_cast<const toylib::ToylibElement*>(in);
                    });
+    INTERFACE_COUNT_VECTOR(ret);
     return ret;
   };
   auto edgesFromVertex =
@@ -224,6 +238,7 @@ inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const t
                    [](const toylib::Edge* in) -> const toylib::ToylibElement* {
                      return static_cast<const toylib::ToylibElement*>(in);
                    });
+    INTERFACE_COUNT_VECTOR(ret);
     return ret;
   };
 
@@ -266,6 +281,8 @@ inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const t
 
   std::vector<const toylib::ToylibElement*> resultUnique;
   std::copy_if(result.begin(), result.end(), std::back_inserter(resultUnique), std::ref(pred));
+  INTERFACE_COUNT_VECTOR(resultUnique);
+  INTERFACE_COUNT_VISITED(resultUnique.size());
   return resultUnique;
 }
 
@@ -276,6 +293,8 @@ inline std::vector<const toylib::ToylibElement*> getNeighbors(toylibTag, const t
 template <typename Init, typename Op>
 auto reduce(toylibTag, toylib::Grid const& grid, toylib::ToylibElement const* idx, Init init,
             std::vector<dawn::LocationType> chain, Op&& op) {
+  INTERFACE_COUNT_REDUCE(chain);
+  INTERFACE_COUNT_VECTOR(chain);
   for(auto ptr : getNeighbors(toylibTag{}, grid, chain, idx)) {
     switch(chain.back()) {
     case dawn::LocationType::Cells:
@@ -300,6 +319,9 @@ auto reduce(toylibTag, toylib::Grid const& grid, toylib::ToylibElement const* id
 template <typename Init, typename Op, typename Weight>
 auto reduce(toylibTag, toylib::Grid const& grid, toylib::ToylibElement const* idx, Init init,
             std::vector<dawn::LocationType> chain, Op&& op, std::vector<Weight>&& weights) {
+  INTERFACE_COUNT_REDUCE(chain);
+  INTERFACE_COUNT_VECTOR(chain);
+  INTERFACE_COUNT_VECTOR(weights);
   int i = 0;
   for(auto ptr : getNeighbors(toylibTag{}, grid, chain, idx)) {
     switch(chain.back()) {
@@ -0,0 +1,96 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "asyncWriter.h"
+
+#include "../../utils/WallClock.h"
+
+AsyncWriter::AsyncWriter(int maxQueued) : maxQueued_(maxQueued) {
+  if(isAsync()) {
+    worker_ = std::thread(&AsyncWriter::workerLoop, this);
+  }
+}
+
+AsyncWriter::~AsyncWriter() {
+  flush();
+  if(isAsync()) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      shutdown_ = true;
+    }
+    jobAvailable_.notify_one();
+    worker_.join();
+  }
+}
+
+void AsyncWriter::submit(std::function<void()> job) {
+  auto start = Clock::now();
+  if(!isAsync()) {
+    job();
+    std::lock_guard<std::mutex> lock(mutex_);
+    jobsWritten_++;
+    stallTime_ += SecondsSince(start);
+    return;
+  }
+
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // back-pressure: wait for the worker to make room
+    jobDone_.wait(lock, [&] { return int(queue_.size()) < maxQueued_; });
+    queue_.push_back(std::move(job));
+    stallTime_ += SecondsSince(start);
+  }
+  jobAvailable_.notify_one();
+}
+
+void AsyncWriter::flush() {
+  auto start = Clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
+  jobDone_.wait(lock, [&] { return queue_.empty() && !busy_; });
+  stallTime_ += SecondsSince(start);
+}
+
+double AsyncWriter::stallTime() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return stallTime_;
+}
+
+int AsyncWriter::jobsWritten() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return jobsWritten_;
+}
+
+void AsyncWriter::workerLoop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while(true) {
+    jobAvailable_.wait(lock, [&] { return !queue_.empty() || shutdown_; });
+    if(queue_.empty()) {
+      // shutdown requested and nothing left to do
+      return;
+    }
+    std::function<void()> job = std::move(queue_.front());
+    queue_.pop_front();
+    busy_ = true;
+    // a slot in the queue just became available
+    jobDone_.notify_all();
+
+    lock.unlock();
+    job();
+    lock.lock();
+
+    busy_ = false;
+    jobsWritten_++;
+    jobDone_.notify_all();
+  }
+}
@@ -0,0 +1,81 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Background writer for debug and snapshot output. Jobs (typically a call to one of the dump
+// functions) are executed in submission order on a single worker thread, so formatting and disk
+// I/O overlap with whatever the caller does next.
+//
+//  - at most maxQueued jobs are pending at any time. submit() blocks while the queue is full
+//    (back-pressure), which bounds the memory held by snapshots
+//  - everything a job references must stay alive and unmodified until the job ran. data which keeps
+//    changing (e.g. the state of a time stepping loop) has to be copied into the job, see
+//    snapshotLevel
+//  - the destructor flushes, i.e. no output is lost on shutdown
+//  - maxQueued == 0 runs every job synchronously inside submit(), which is useful to compare
+//    against the blocking behavior
+//
+// The time the calling thread spends blocked in submit() and flush() (or, in synchronous mode,
+// executing the jobs) is accumulated and can be queried using stallTime().
+class AsyncWriter {
+public:
+  explicit AsyncWriter(int maxQueued = 2);
+  ~AsyncWriter();
+
+  AsyncWriter(const AsyncWriter&) = delete;
+  AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+  void submit(std::function<void()> job);
+  // blocks until all jobs submitted so far are written
+  void flush();
+
+  // seconds the submitting thread was stalled on output
+  double stallTime() const;
+  int jobsWritten() const;
+  bool isAsync() const { return maxQueued_ > 0; }
+
+private:
+  void workerLoop();
+
+  const int maxQueued_;
+  std::deque<std::function<void()>> queue_;
+  bool busy_ = false;
+  bool shutdown_ = false;
+  int jobsWritten_ = 0;
+  double stallTime_ = 0.;
+
+  mutable std::mutex mutex_;
+  std::condition_variable jobAvailable_;
+  std::condition_variable jobDone_;
+  std::thread worker_;
+};
+
+// copies a single level of a field with size elements into a flat buffer. the snapshot can then be
+// handed to an AsyncWriter while the field is advanced further
+template <typename FieldT>
+std::vector<double> snapshotLevel(const FieldT& field, int size, int level) {
+  std::vector<double> snapshot(size);
+  for(int idx = 0; idx < size; idx++) {
+    snapshot[idx] = field(idx, level);
+  }
+  return snapshot;
+}
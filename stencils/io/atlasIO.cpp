@@ -16,68 +16,88 @@
 
 #include <atlas/util/CoordinateEnums.h>
 
+namespace {
+// edges out of candidates matching color (all candidates if no color is given). the orientation is
+// computed in parallel, the order of candidates is kept
+std::vector<int> selectEdges(const atlas::Mesh& mesh, const AtlasToCartesian& wrapper,
+                             const std::vector<int>& candidates,
+                             std::optional<Orientation> color) {
+  if(!color.has_value()) {
+    return candidates;
+  }
+  std::vector<char> keep(candidates.size());
+  ParallelFor(0, candidates.size(), [&](int idx) {
+    keep[idx] = wrapper.edgeOrientation(mesh, candidates[idx]) == color.value();
+  });
+  std::vector<int> selected;
+  for(size_t idx = 0; idx < candidates.size(); idx++) {
+    if(keep[idx]) {
+      selected.push_back(candidates[idx]);
+    }
+  }
+  return selected;
+}
+
+std::vector<int> allEdges(const atlas::Mesh& mesh) {
+  std::vector<int> edges(mesh.edges().size());
+  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
+    edges[edgeIdx] = edgeIdx;
+  }
+  return edges;
+}
+
+double finiteOrZero(double value) { return std::isfinite(value) ? value : 0.; }
+} // namespace
+
 void dumpMesh4Triplot(const atlas::Mesh& mesh, const std::string prefix,
                       std::optional<AtlasToCartesian> wrapper) {
   auto xy = atlas::array::make_view<double, 2>(mesh.nodes().xy());
   const atlas::mesh::HybridElements::Connectivity& node_connectivity =
       mesh.cells().node_connectivity();
 
-  {
-    char buf[256];
-    sprintf(buf, "%sT.txt", prefix.c_str());
-    FILE* fp = fopen(buf, "w+");
-    for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-      int nodeIdx0 = node_connectivity(cellIdx, 0) + 1;
-      int nodeIdx1 = node_connectivity(cellIdx, 1) + 1;
-      int nodeIdx2 = node_connectivity(cellIdx, 2) + 1;
-      fprintf(fp, "%d %d %d\n", nodeIdx0, nodeIdx1, nodeIdx2);
-    }
-    fclose(fp);
-  }
-
-  {
-    char buf[256];
-    sprintf(buf, "%sP.txt", prefix.c_str());
-    FILE* fp = fopen(buf, "w+");
-    for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
-      if(wrapper == std::nullopt) {
-        double x = xy(nodeIdx, atlas::LON);
-        double y = xy(nodeIdx, atlas::LAT);
-        fprintf(fp, "%f %f \n", x, y);
-      } else {
-        auto [x, y] = wrapper.value().nodeLocation(nodeIdx);
-        fprintf(fp, "%f %f \n", x, y);
-      }
-    }
-    fclose(fp);
-  }
+  dumpRows<3>(prefix + "T.txt", mesh.cells().size(),
+              {DumpNotation::Integer, DumpNotation::Integer, DumpNotation::Integer},
+              [&](int cellIdx, std::array<double, 3>& row) {
+                for(int nbhIdx = 0; nbhIdx < 3; nbhIdx++) {
+                  row[nbhIdx] = node_connectivity(cellIdx, nbhIdx) + 1;
+                }
+              });
+
+  dumpRows<2>(prefix + "P.txt", mesh.nodes().size(), {DumpNotation::Fixed, DumpNotation::Fixed},
+              [&](int nodeIdx, std::array<double, 2>& row) {
+                if(wrapper == std::nullopt) {
+                  row = {xy(nodeIdx, atlas::LON), xy(nodeIdx, atlas::LAT)};
+                } else {
+                  auto [x, y] = wrapper.value().nodeLocation(nodeIdx);
+                  row = {x, y};
+                }
+              });
 }
 
-void dumpMesh(const atlas::Mesh& mesh, AtlasToCartesian& wrapper, const std::string& fname) {
-  FILE* fp = fopen(fname.c_str(), "w+");
+void dumpMesh(const atlas::Mesh& mesh, const AtlasToCartesian& wrapper, const std::string& fname) {
   const atlas::mesh::HybridElements::Connectivity& edgeNodeConnectivity =
       mesh.edges().node_connectivity();
-  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-    int numNbh = edgeNodeConnectivity.cols(edgeIdx);
-    assert(numNbh == 2);
-
-    int nbhLo = edgeNodeConnectivity(edgeIdx, 0);
-    int nbhHi = edgeNodeConnectivity(edgeIdx, 1);
-
-    auto [xLo, yLo] = wrapper.nodeLocation(nbhLo);
-    auto [xHi, yHi] = wrapper.nodeLocation(nbhHi);
-
-    fprintf(fp, "%f %f %f %f\n", xLo, yLo, xHi, yHi);
-  }
-  fclose(fp);
+  dumpRows<4>(fname, mesh.edges().size(),
+              {DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed},
+              [&](int edgeIdx, std::array<double, 4>& row) {
+                int numNbh = edgeNodeConnectivity.cols(edgeIdx);
+                assert(numNbh == 2);
+
+                int nbhLo = edgeNodeConnectivity(edgeIdx, 0);
+                int nbhHi = edgeNodeConnectivity(edgeIdx, 1);
+
+                auto [xLo, yLo] = wrapper.nodeLocation(nbhLo);
+                auto [xHi, yHi] = wrapper.nodeLocation(nbhHi);
+                row = {xLo, yLo, xHi, yHi};
+              });
 }
 
-void dumpDualMesh(const atlas::Mesh& mesh, AtlasToCartesian& wrapper, const std::string& fname) {
-  FILE* fp = fopen(fname.c_str(), "w+");
+void dumpDualMesh(const atlas::Mesh& mesh, const AtlasToCartesian& wrapper,
+                  const std::string& fname) {
   const atlas::mesh::HybridElements::Connectivity& edgeCellConnectivity =
       mesh.edges().cell_connectivity();
+  std::vector<int> innerEdges;
   for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-
     int nbhLo = edgeCellConnectivity(edgeIdx, 0);
     int nbhHi = edgeCellConnectivity(edgeIdx, 1);
 
@@ -85,75 +105,64 @@ void dumpDualMesh(const atlas::Mesh& mesh, AtlasToCartesian& wrapper, const std:
        nbhHi == edgeCellConnectivity.missing_value()) {
       continue;
     }
-
-    auto [xm1, ym1] = wrapper.cellCircumcenter(mesh, nbhLo);
-    auto [xm2, ym2] = wrapper.cellCircumcenter(mesh, nbhHi);
-
-    fprintf(fp, "%f %f %f %f\n", xm1, ym1, xm2, ym2);
+    innerEdges.push_back(edgeIdx);
   }
-  fclose(fp);
+
+  dumpRows<4>(fname, innerEdges.size(),
+              {DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed},
+              [&](int rowIdx, std::array<double, 4>& row) {
+                int edgeIdx = innerEdges[rowIdx];
+                auto [xm1, ym1] =
+                    wrapper.cellCircumcenter(mesh, edgeCellConnectivity(edgeIdx, 0));
+                auto [xm2, ym2] =
+                    wrapper.cellCircumcenter(mesh, edgeCellConnectivity(edgeIdx, 1));
+                row = {xm1, ym1, xm2, ym2};
+              });
 }
 
-void dumpNodeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field, int level) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+void dumpNodeField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field,
+                   int level) {
+  dumpXYValueRows(fname, mesh.nodes().size(), [&](int nodeIdx, std::array<double, 3>& row) {
     auto [xm, ym] = wrapper.nodeLocation(nodeIdx);
-    fprintf(fp, "%f %f %f\n", xm, ym, field(nodeIdx, level));
-  }
-  fclose(fp);
+    row = {xm, ym, field(nodeIdx, level)};
+  });
 }
 
-void dumpCellField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field, int level) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+void dumpCellField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field,
+                   int level) {
+  dumpXYValueRows(fname, mesh.cells().size(), [&](int cellIdx, std::array<double, 3>& row) {
     auto [xm, ym] = wrapper.cellCircumcenter(mesh, cellIdx);
-    fprintf(fp, "%f %f %f\n", xm, ym, field(cellIdx, level));
-  }
-  fclose(fp);
+    row = {xm, ym, field(cellIdx, level)};
+  });
 }
 
-void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field, int level,
-                   std::optional<Orientation> color) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-    if(color.has_value() && wrapper.edgeOrientation(mesh, edgeIdx) != color.value()) {
-      continue;
-    }
-    auto [xm, ym] = wrapper.edgeMidpoint(mesh, edgeIdx);
-    fprintf(fp, "%f %f %f\n", xm, ym,
-            std::isfinite(field(edgeIdx, level)) ? field(edgeIdx, level) : 0.);
-  }
-  fclose(fp);
+void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field,
+                   int level, std::optional<Orientation> color) {
+  dumpEdgeField(fname, mesh, wrapper, field, level, allEdges(mesh), color);
 }
 
-void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field, int level, std::vector<int> edgeList,
-                   std::optional<Orientation> color) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(int edgeIdx : edgeList) {
-    if(color.has_value() && wrapper.edgeOrientation(mesh, edgeIdx) != color.value()) {
-      continue;
-    }
-    auto [xm, ym] = wrapper.edgeMidpoint(mesh, edgeIdx);
-    fprintf(fp, "%f %f %f\n", xm, ym,
-            std::isfinite(field(edgeIdx, level)) ? field(edgeIdx, level) : 0.);
-  }
-  fclose(fp);
+void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field,
+                   int level, std::vector<int> edgeList, std::optional<Orientation> color) {
+  std::vector<int> edges = selectEdges(mesh, wrapper, edgeList, color);
+  dumpXYValueRows(fname, edges.size(), [&](int rowIdx, std::array<double, 3>& row) {
+    auto [xm, ym] = wrapper.edgeMidpoint(mesh, edges[rowIdx]);
+    row = {xm, ym, finiteOrZero(field(edges[rowIdx], level))};
+  });
 }
 
-void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field_x, atlasInterface::Field<double>& field_y,
-                   int level, std::optional<Orientation> color) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-    if(color.has_value() && wrapper.edgeOrientation(mesh, edgeIdx) != color.value()) {
-      continue;
-    }
-    auto [xm, ym] = wrapper.edgeMidpoint(mesh, edgeIdx);
-    fprintf(fp, "%f %f %f %f\n", xm, ym, field_x(edgeIdx, level), field_y(edgeIdx, level));
-  }
-  fclose(fp);
-}
\ No newline at end of file
+void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field_x,
+                   atlasInterface::Field<double>& field_y, int level,
+                   std::optional<Orientation> color) {
+  std::vector<int> edges = selectEdges(mesh, wrapper, allEdges(mesh), color);
+  dumpRows<4>(fname, edges.size(),
+              {DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed},
+              [&](int rowIdx, std::array<double, 4>& row) {
+                auto [xm, ym] = wrapper.edgeMidpoint(mesh, edges[rowIdx]);
+                row = {xm, ym, field_x(edges[rowIdx], level), field_y(edges[rowIdx], level)};
+              });
+}
@@ -29,20 +29,27 @@
 // atlas utilities
 #include "AtlasCartesianWrapper.h"
 
-void dumpMesh(const atlas::Mesh& m, AtlasToCartesian& wrapper, const std::string& fname);
-void dumpDualMesh(const atlas::Mesh& m, AtlasToCartesian& wrapper, const std::string& fname);
+// the dump functions below write through the active dump backend, see dumpBackend.h
+#include "dumpBackend.h"
+
+void dumpMesh(const atlas::Mesh& m, const AtlasToCartesian& wrapper, const std::string& fname);
+void dumpDualMesh(const atlas::Mesh& m, const AtlasToCartesian& wrapper, const std::string& fname);
 void dumpMesh4Triplot(const atlas::Mesh& mesh, const std::string prefix,
                       std::optional<AtlasToCartesian> wrapper = std::nullopt);
-void dumpNodeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field, int level);
-void dumpCellField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field, int level);
-void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field, int level,
+void dumpNodeField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field,
+                   int level);
+void dumpCellField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field,
+                   int level);
+void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field,
+                   int level, std::optional<Orientation> color = std::nullopt);
+void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field,
+                   int level, std::vector<int> edgeList,
                    std::optional<Orientation> color = std::nullopt);
-void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field, int level, std::vector<int> edgeList,
+void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh,
+                   const AtlasToCartesian& wrapper, atlasInterface::Field<double>& field_x,
+                   atlasInterface::Field<double>& field_y, int level,
                    std::optional<Orientation> color = std::nullopt);
-void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
-                   atlasInterface::Field<double>& field_x, atlasInterface::Field<double>& field_y,
-                   int level, std::optional<Orientation> color = std::nullopt);
\ No newline at end of file
@@ -0,0 +1,172 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "dumpBackend.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+
+namespace {
+// rows formatted per chunk, a chunk of ascii output is in the order of a few MB
+const int rowsPerChunk = 1 << 15;
+
+FILE* openForWrite(const std::string& fname) {
+  FILE* fp = fopen(fname.c_str(), "wb");
+  if(!fp) {
+    std::cerr << "could not open " << fname << " for writing\n";
+    return nullptr;
+  }
+  // all writes below are large blocks, stdio buffering would only add a copy
+  setvbuf(fp, nullptr, _IONBF, 0);
+  return fp;
+}
+
+// formats a single value like printf would using "%f", "%e" resp. "%d"
+char* formatValue(char* first, char* last, double value, DumpNotation notation) {
+  std::to_chars_result res;
+  switch(notation) {
+  case DumpNotation::Fixed:
+    res = std::to_chars(first, last, value, std::chars_format::fixed, 6);
+    break;
+  case DumpNotation::Scientific:
+    res = std::to_chars(first, last, value, std::chars_format::scientific, 6);
+    break;
+  case DumpNotation::Integer:
+    res = std::to_chars(first, last, (long long)value);
+    break;
+  }
+  return res.ptr;
+}
+
+void formatRows(std::string& out, const std::vector<DumpColumn>& columns, int lo, int hi) {
+  // "%f" of a double is at most 309 digits + sign + 7 for the fraction
+  const size_t maxValueLength = 320;
+  char line[maxValueLength + 1];
+  out.clear();
+  for(int rowIdx = lo; rowIdx < hi; rowIdx++) {
+    for(size_t colIdx = 0; colIdx < columns.size(); colIdx++) {
+      char* end = formatValue(line, line + maxValueLength, columns[colIdx].values[rowIdx],
+                              columns[colIdx].notation);
+      *end++ = (colIdx + 1 == columns.size()) ? '\n' : ' ';
+      out.append(line, end);
+    }
+  }
+}
+
+bool isLittleEndian() {
+  const uint16_t probe = 1;
+  unsigned char firstByte;
+  memcpy(&firstByte, &probe, 1);
+  return firstByte == 1;
+}
+
+template <typename T>
+void appendLittleEndian(std::vector<unsigned char>& out, T value) {
+  unsigned char bytes[sizeof(T)];
+  memcpy(bytes, &value, sizeof(T));
+  if(!isLittleEndian()) {
+    std::reverse(bytes, bytes + sizeof(T));
+  }
+  out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+std::mutex backendMutex;
+std::shared_ptr<const DumpBackend> activeBackend;
+
+std::shared_ptr<const DumpBackend> defaultBackend() {
+  const char* env = std::getenv("ATLAS_UTILS_DUMP_FORMAT");
+  if(env && std::string(env) == "binary") {
+    return std::make_shared<BinaryDumpBackend>();
+  }
+  if(env && std::string(env) != "ascii") {
+    std::cerr << "unknown ATLAS_UTILS_DUMP_FORMAT " << env << ", falling back to ascii\n";
+  }
+  return std::make_shared<AsciiDumpBackend>();
+}
+} // namespace
+
+void AsciiDumpBackend::write(const std::string& fname, const std::vector<DumpColumn>& columns,
+                             size_t numRows) const {
+  FILE* fp = openForWrite(fname);
+  if(!fp) {
+    return;
+  }
+
+  // format up to NumThreads() chunks in parallel, then write them in order. this bounds the memory
+  // needed to NumThreads() chunks regardless of the size of the table
+  const int numChunks = int((numRows + rowsPerChunk - 1) / rowsPerChunk);
+  std::vector<std::string> buffers(NumThreads());
+  for(int firstChunk = 0; firstChunk < numChunks; firstChunk += NumThreads()) {
+    const int numActive = std::min(NumThreads(), numChunks - firstChunk);
+    ParallelTasks(numActive, [&](int bufIdx) {
+      int chunkIdx = firstChunk + bufIdx;
+      int lo = chunkIdx * rowsPerChunk;
+      int hi = std::min(int(numRows), lo + rowsPerChunk);
+      formatRows(buffers[bufIdx], columns, lo, hi);
+    });
+    for(int bufIdx = 0; bufIdx < numActive; bufIdx++) {
+      fwrite(buffers[bufIdx].data(), 1, buffers[bufIdx].size(), fp);
+    }
+  }
+  fclose(fp);
+}
+
+void BinaryDumpBackend::write(const std::string& fname, const std::vector<DumpColumn>& columns,
+                              size_t numRows) const {
+  FILE* fp = openForWrite(fname);
+  if(!fp) {
+    return;
+  }
+
+  std::vector<unsigned char> header;
+  header.insert(header.end(), {'A', 'D', 'M', 'P'});
+  appendLittleEndian<uint32_t>(header, 1);
+  appendLittleEndian<uint64_t>(header, numRows);
+  appendLittleEndian<uint32_t>(header, uint32_t(columns.size()));
+  appendLittleEndian<uint32_t>(header, 0);
+  fwrite(header.data(), 1, header.size(), fp);
+
+  for(const DumpColumn& column : columns) {
+    if(isLittleEndian()) {
+      fwrite(column.values, sizeof(double), numRows, fp);
+    } else {
+      std::vector<unsigned char> swapped;
+      swapped.reserve(numRows * sizeof(double));
+      for(size_t rowIdx = 0; rowIdx < numRows; rowIdx++) {
+        appendLittleEndian(swapped, column.values[rowIdx]);
+      }
+      fwrite(swapped.data(), 1, swapped.size(), fp);
+    }
+  }
+  fclose(fp);
+}
+
+void setDumpBackend(std::shared_ptr<const DumpBackend> backend) {
+  std::lock_guard<std::mutex> lock(backendMutex);
+  activeBackend = std::move(backend);
+}
+
+std::shared_ptr<const DumpBackend> dumpBackend() {
+  std::lock_guard<std::mutex> lock(backendMutex);
+  if(!activeBackend) {
+    activeBackend = defaultBackend();
+  }
+  return activeBackend;
+}
@@ -0,0 +1,103 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ParallelFor.h"
+
+// All dump functions (atlasIO, toylibIO) produce a table: one row per element, one column per
+// quantity (e.g. x, y, value). The backend decides how that table ends up on disk:
+//
+//  - AsciiDumpBackend writes one whitespace separated line per row, using the same number format
+//    as the fprintf based dumpers did ("%f", "%e" resp. "%d"), which is what the octave scripts in
+//    /scripts read. rows are formatted in parallel chunks into large buffers, which are then
+//    written in one go
+//
+//  - BinaryDumpBackend writes a small header followed by the raw column data:
+//
+//      offset  type        content
+//      0       char[4]     magic "ADMP"
+//      4       uint32      format version (1)
+//      8       uint64      number of rows
+//      16      uint32      number of columns
+//      20      uint32      reserved (0)
+//      24      float64[]   the columns one after another (i.e. column major), little endian
+//
+//    see scripts/load_dump.m and scripts/load_dump.py for readers
+//
+// The active backend defaults to ascii. It can be switched using setDumpBackend, or by setting the
+// environment variable ATLAS_UTILS_DUMP_FORMAT to "binary" before the first dump.
+
+enum class DumpNotation { Fixed, Scientific, Integer };
+
+struct DumpColumn {
+  const double* values;
+  DumpNotation notation;
+};
+
+class DumpBackend {
+public:
+  virtual ~DumpBackend() = default;
+  // writes numRows rows, every column needs to point to numRows values
+  virtual void write(const std::string& fname, const std::vector<DumpColumn>& columns,
+                     size_t numRows) const = 0;
+};
+
+class AsciiDumpBackend : public DumpBackend {
+public:
+  void write(const std::string& fname, const std::vector<DumpColumn>& columns,
+             size_t numRows) const override;
+};
+
+class BinaryDumpBackend : public DumpBackend {
+public:
+  void write(const std::string& fname, const std::vector<DumpColumn>& columns,
+             size_t numRows) const override;
+};
+
+void setDumpBackend(std::shared_ptr<const DumpBackend> backend);
+std::shared_ptr<const DumpBackend> dumpBackend();
+
+// gathers numRows rows using fill(rowIdx, row), where row is an array of numCols values, and writes
+// them using the active backend. fill is called concurrently and must be thread safe
+template <int numCols, typename FillFn>
+void dumpRows(const std::string& fname, int numRows,
+              const std::array<DumpNotation, numCols>& notations, FillFn&& fill) {
+  std::vector<double> table(size_t(numRows) * numCols);
+  ParallelFor(0, numRows, [&](int rowIdx) {
+    std::array<double, numCols> row;
+    fill(rowIdx, row);
+    for(int colIdx = 0; colIdx < numCols; colIdx++) {
+      table[size_t(colIdx) * numRows + rowIdx] = row[colIdx];
+    }
+  });
+  std::vector<DumpColumn> columns;
+  for(int colIdx = 0; colIdx < numCols; colIdx++) {
+    columns.push_back({table.data() + size_t(colIdx) * numRows, notations[colIdx]});
+  }
+  dumpBackend()->write(fname, columns, numRows);
+}
+
+// shorthand for the most common case, x y value with value printed like x and y
+template <typename FillFn>
+void dumpXYValueRows(const std::string& fname, int numRows, FillFn&& fill,
+                     DumpNotation valueNotation = DumpNotation::Fixed) {
+  dumpRows<3>(fname, numRows, {DumpNotation::Fixed, DumpNotation::Fixed, valueNotation},
+              std::forward<FillFn>(fill));
+}
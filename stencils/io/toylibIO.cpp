@@ -14,136 +14,160 @@
 
 #include "toylibIO.h"
 
-void debugDumpMesh(const toylib::Grid& mesh, const std::string prefix) {
-  {
-    char buf[256];
-    sprintf(buf, "%sT.txt", prefix.c_str());
-    FILE* fp = fopen(buf, "w+");
-    for(const auto& cellIt : mesh.faces()) {
-      fprintf(fp, "%d %d %d\n", cellIt.vertex(0).id() + 1, cellIt.vertex(1).id() + 1,
-              cellIt.vertex(2).id() + 1);
+#include "dumpBackend.h"
+
+namespace {
+// edges of the mesh matching color (all edges if no color is given)
+std::vector<const toylib::Edge*> selectEdges(const toylib::Grid& mesh,
+                                             std::optional<toylib::edge_color> color) {
+  std::vector<const toylib::Edge*> selected;
+  for(const auto& e : mesh.edges()) {
+    if(color.has_value() && e.get().color() != color.value()) {
+      continue;
     }
-    fclose(fp);
+    selected.push_back(&e.get());
   }
-  {
-    char buf[256];
-    sprintf(buf, "%sP.txt", prefix.c_str());
-    FILE* fp = fopen(buf, "w+");
-    for(const auto& nodeIt : mesh.vertices()) {
-      fprintf(fp, "%f %f \n", nodeIt.x(), nodeIt.y());
-    }
-    fclose(fp);
+  return selected;
+}
+
+// writes one row per (element, edge of element) pair, placed half way between center and the
+// midpoint of the edge. elements with a varying number of edges are handled using a prefix sum
+template <typename ElemT, typename SparseT, typename CenterFn>
+void dumpSparseRows(const std::vector<ElemT>& elems, const SparseT& sparseData, int level,
+                    const std::string& fname, CenterFn&& center) {
+  std::vector<int> rowOffset(elems.size() + 1, 0);
+  for(size_t elemIdx = 0; elemIdx < elems.size(); elemIdx++) {
+    rowOffset[elemIdx + 1] = rowOffset[elemIdx] + elems[elemIdx].edges().size();
   }
+
+  std::vector<double> table(3 * size_t(rowOffset.back()));
+  double* xs = table.data();
+  double* ys = xs + rowOffset.back();
+  double* vals = ys + rowOffset.back();
+  ParallelFor(0, elems.size(), [&](int elemIdx) {
+    const ElemT& elem = elems[elemIdx];
+    auto [cx, cy] = center(elem);
+    int rowIdx = rowOffset[elemIdx];
+    int sparse_idx = 0;
+    for(const auto& e : elem.edges()) {
+      auto [emx, emy] = EdgeMidpoint(*e);
+      xs[rowIdx] = cx + 0.5 * (emx - cx);
+      ys[rowIdx] = cy + 0.5 * (emy - cy);
+      vals[rowIdx] = sparseData(elem, sparse_idx, level);
+      rowIdx++;
+      sparse_idx++;
+    }
+  });
+  dumpBackend()->write(fname,
+                       {{xs, DumpNotation::Fixed}, {ys, DumpNotation::Fixed},
+                        {vals, DumpNotation::Fixed}},
+                       rowOffset.back());
+}
+} // namespace
+
+void debugDumpMesh(const toylib::Grid& mesh, const std::string prefix) {
+  dumpRows<3>(prefix + "T.txt", mesh.faces().size(),
+              {DumpNotation::Integer, DumpNotation::Integer, DumpNotation::Integer},
+              [&](int cellIdx, std::array<double, 3>& row) {
+                const toylib::Face& cell = mesh.faces()[cellIdx];
+                row = {double(cell.vertex(0).id() + 1), double(cell.vertex(1).id() + 1),
+                       double(cell.vertex(2).id() + 1)};
+              });
+  dumpRows<2>(prefix + "P.txt", mesh.vertices().size(), {DumpNotation::Fixed, DumpNotation::Fixed},
+              [&](int nodeIdx, std::array<double, 2>& row) {
+                const toylib::Vertex& node = mesh.vertices()[nodeIdx];
+                row = {node.x(), node.y()};
+              });
 }
 
 void dumpMesh(const toylib::Grid& m, const std::string& fname) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(const auto& e : m.edges()) {
-    fprintf(fp, "%f %f %f %f\n", e.get().vertex(0).x(), e.get().vertex(0).y(),
-            e.get().vertex(1).x(), e.get().vertex(1).y());
-  }
-  fclose(fp);
+  dumpRows<4>(fname, m.edges().size(),
+              {DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed},
+              [&](int edgeIdx, std::array<double, 4>& row) {
+                const toylib::Edge& e = m.edges()[edgeIdx];
+                row = {e.vertex(0).x(), e.vertex(0).y(), e.vertex(1).x(), e.vertex(1).y()};
+              });
 }
 
 void dumpDualMesh(const toylib::Grid& m, const std::string& fname) {
-  FILE* fp = fopen(fname.c_str(), "w+");
+  std::vector<const toylib::Edge*> innerEdges;
   for(const auto& e : m.edges()) {
-    if(e.get().faces().size() != 2) {
-      continue;
+    if(e.get().faces().size() == 2) {
+      innerEdges.push_back(&e.get());
     }
+  }
 
-    // This is WRONG!, leads to a dual mesh which is not orthogonal to
-    // primal mesh
-    // auto [xm1, ym1] = CellMidPoint(e.get().face(0));
-    // auto [xm2, ym2] = CellMidPoint(e.get().face(1));
+  dumpRows<4>(fname, innerEdges.size(),
+              {DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed},
+              [&](int rowIdx, std::array<double, 4>& row) {
+                // This is WRONG!, leads to a dual mesh which is not orthogonal to
+                // primal mesh
+                // auto [xm1, ym1] = CellMidPoint(e.get().face(0));
+                // auto [xm2, ym2] = CellMidPoint(e.get().face(1));
 
-    auto [xm1, ym1] = CellCircumcenter(e.get().face(0));
-    auto [xm2, ym2] = CellCircumcenter(e.get().face(1));
-    fprintf(fp, "%f %f %f %f\n", xm1, ym1, xm2, ym2);
-  }
-  fclose(fp);
+                auto [xm1, ym1] = CellCircumcenter(innerEdges[rowIdx]->face(0));
+                auto [xm2, ym2] = CellCircumcenter(innerEdges[rowIdx]->face(1));
+                row = {xm1, ym1, xm2, ym2};
+              });
 }
 
 void dumpSparseData(const toylib::Grid& mesh, const toylib::SparseVertexData<double>& sparseData,
                     int level, int edgesPerVertex, const std::string& fname) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(const auto& v : mesh.vertices()) {
-    int sparse_idx = 0;
-    for(const auto& e : v.edges()) {
-      double val = sparseData(v, sparse_idx, level);
-      auto [emx, emy] = EdgeMidpoint(*e);
-      double dx = emx - v.x();
-      double dy = emy - v.y();
-      fprintf(fp, "%f %f %f\n", v.x() + 0.5 * dx, v.y() + 0.5 * dy, val);
-      sparse_idx++;
-    }
-  }
+  dumpSparseRows(mesh.vertices(), sparseData, level, fname, [](const toylib::Vertex& v) {
+    return std::tuple<double, double>(v.x(), v.y());
+  });
 }
 
 void dumpSparseData(const toylib::Grid& mesh, const toylib::SparseFaceData<double>& sparseData,
                     int level, int edgesPerCell, const std::string& fname) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(const auto& c : mesh.faces()) {
-    int sparse_idx = 0;
-    auto [cmx, cmy] = CellCircumcenter(c);
-    for(const auto& e : c.edges()) {
-      double val = sparseData(c, sparse_idx, level);
-      auto [emx, emy] = EdgeMidpoint(*e);
-      double dx = emx - cmx;
-      double dy = emy - cmy;
-      fprintf(fp, "%f %f %f\n", cmx + 0.5 * dx, cmy + 0.5 * dy, val);
-      sparse_idx++;
-    }
-  }
+  dumpSparseRows(mesh.faces(), sparseData, level, fname,
+                 [](const toylib::Face& c) { return CellCircumcenter(c); });
 }
 
 void dumpField(const std::string& fname, const toylib::Grid& mesh,
                const toylib::EdgeData<double>& field, int level,
                std::optional<toylib::edge_color> color) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(auto& e : mesh.edges()) {
-    if(color.has_value() && e.get().color() != color.value()) {
-      continue;
-    }
+  std::vector<const toylib::Edge*> edges = selectEdges(mesh, color);
+  dumpXYValueRows(fname, edges.size(), [&](int rowIdx, std::array<double, 3>& row) {
+    const toylib::Edge& e = *edges[rowIdx];
     auto [x, y] = EdgeMidpoint(e);
-    fprintf(fp, "%f %f %f\n", x, y, std::isfinite(field(e, level)) ? field(e, level) : 0.);
-  }
-  fclose(fp);
+    row = {x, y, std::isfinite(field(e, level)) ? field(e, level) : 0.};
+  });
 }
 
 void dumpField(const std::string& fname, const toylib::Grid& mesh,
                const toylib::EdgeData<double>& field_x, const toylib::EdgeData<double>& field_y,
                int level, std::optional<toylib::edge_color> color) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(auto& e : mesh.edges()) {
-    if(color.has_value() && e.get().color() != color.value()) {
-      continue;
-    }
-    auto [x, y] = EdgeMidpoint(e);
-    fprintf(fp, "%f %f %f %f\n", x, y, field_x(e, level), field_y(e, level));
-  }
-  fclose(fp);
+  std::vector<const toylib::Edge*> edges = selectEdges(mesh, color);
+  dumpRows<4>(fname, edges.size(),
+              {DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed, DumpNotation::Fixed},
+              [&](int rowIdx, std::array<double, 4>& row) {
+                const toylib::Edge& e = *edges[rowIdx];
+                auto [x, y] = EdgeMidpoint(e);
+                row = {x, y, field_x(e, level), field_y(e, level)};
+              });
 }
 
 void dumpField(const std::string& fname, const toylib::Grid& mesh,
                const toylib::FaceData<double>& field, int level,
                std::optional<toylib::face_color> color) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(auto& c : mesh.faces()) {
+  std::vector<const toylib::Face*> cells;
+  for(const auto& c : mesh.faces()) {
     if(color.has_value() && c.color() != color.value()) {
       continue;
     }
-    auto [x, y] = CellCircumcenter(c);
-    fprintf(fp, "%f %f %f\n", x, y, field(c, level));
+    cells.push_back(&c);
   }
-  fclose(fp);
+  dumpXYValueRows(fname, cells.size(), [&](int rowIdx, std::array<double, 3>& row) {
+    auto [x, y] = CellCircumcenter(*cells[rowIdx]);
+    row = {x, y, field(*cells[rowIdx], level)};
+  });
 }
 
 void dumpField(const std::string& fname, const toylib::Grid& mesh,
                const toylib::VertexData<double>& field, int level) {
-  FILE* fp = fopen(fname.c_str(), "w+");
-  for(auto& v : mesh.vertices()) {
-    fprintf(fp, "%f %f %f\n", v.x(), v.y(), field(v, level));
-  }
-  fclose(fp);
-}
\ No newline at end of file
+  dumpXYValueRows(fname, mesh.vertices().size(), [&](int nodeIdx, std::array<double, 3>& row) {
+    const toylib::Vertex& v = mesh.vertices()[nodeIdx];
+    row = {v.x(), v.y(), field(v, level)};
+  });
+}
@@ -39,7 +39,9 @@
 
 #include "generated_iconLaplace.hpp"
 
+#include "ErrorNorms.h"
 #include "GenerateRectToylibMesh.h"
+#include "MemoryFootprint.h"
 
 #include "io/toylibIO.h"
 
@@ -49,13 +51,6 @@ int sgn(T val) {
   return (T(0) < val) - (val < T(0));
 }
 
-//===------------------------------------------------------------------------------------------===//
-// error reporting
-//===------------------------------------------------------------------------------------------===//
-template <typename DataT, typename ElemT>
-std::tuple<double, double, double> MeasureError(DataT ref, DataT sol,
-                                                std::vector<ElemT> innerElements, int level);
-
 } // namespace
 
 int main(int argc, char const* argv[]) {
@@ -111,11 +106,11 @@ int main(int argc, char const* argv[]) {
   //===------------------------------------------------------------------------------------------===//
   // sparse dimensions for computing intermediary fields
   //===------------------------------------------------------------------------------------------===//
-  toylib::SparseVertexData<double> geofac_rot(mesh, k_size, edgesPerVertex);
-  toylib::SparseVertexData<double> edge_orientation_vertex(mesh, k_size, edgesPerVertex);
+  toylib::SparseVertexData<double> geofac_rot(mesh, edgesPerVertex, k_size);
+  toylib::SparseVertexData<double> edge_orientation_vertex(mesh, edgesPerVertex, k_size);
 
-  toylib::SparseFaceData<double> geofac_div(mesh, k_size, edgesPerCell);
-  toylib::SparseFaceData<double> edge_orientation_cell(mesh, k_size, edgesPerCell);
+  toylib::SparseFaceData<double> geofac_div(mesh, edgesPerCell, k_size);
+  toylib::SparseFaceData<double> edge_orientation_cell(mesh, edgesPerCell, k_size);
 
   //===------------------------------------------------------------------------------------------===//
   // fields containing geometric information
@@ -291,18 +286,20 @@ int main(int argc, char const* argv[]) {
   // report errors
   //===------------------------------------------------------------------------------------------===//
 
-  {
-    auto [Linf, L1, L2] = MeasureError(div_vec, divVecSol, innerCells(mesh), level);
-    printf("[div] dx: %e L_inf: %e L_1: %e L_2: %e\n", 180. / w, Linf, L1, L2);
-  }
-  {
-    auto [Linf, L1, L2] = MeasureError(rot_vec, rotVecSol, innerNodes(mesh), level);
-    printf("[rot] dx: %e L_inf: %e L_1: %e L_2: %e\n", 180. / w, Linf, L1, L2);
-  }
-  {
-    auto [Linf, L1, L2] = MeasureError(nabla2_vec, lapVecSol, innerEdges(mesh), level);
-    printf("[lap] dx: %e L_inf: %e L_1: %e L_2: %e\n", 180. / w, Linf, L1, L2);
-  }
+  // the norms skip elements where the difference is not finite
+  auto printNorms = [&](const char* name, const auto& ref, const auto& sol,
+                        const std::vector<char>& inner) {
+    auto refAt = [&](int id) { return ref(id, level); };
+    auto solAt = [&](int id) { return sol(id, level); };
+    ErrorNorms norms = ComputeErrorNorms(inner.size(), refAt, solAt, [&](int id) {
+      return inner[id] && std::isfinite(refAt(id) - solAt(id));
+    });
+    printf("[%s] dx: %e L_inf: %e L_1: %e L_2: %e\n", name, 180. / w, norms.Linf, norms.L1,
+           norms.L2);
+  };
+  printNorms("div", divVecSol, div_vec, innerCellsMask(mesh));
+  printNorms("rot", rotVecSol, rot_vec, innerNodesMask(mesh));
+  printNorms("lap", lapVecSol, nabla2_vec, innerEdgesMask(mesh));
 
   printf("-----\n");
 
@@ -312,27 +309,34 @@ int main(int argc, char const* argv[]) {
   dumpField("laplICONtoylib_div.txt", mesh, div_vec, level);
   dumpField("laplICONtoylib_rot.txt", mesh, rot_vec, level);
   dumpField("laplICONtoylib_out.txt", mesh, nabla2_vec, level);
-}
-
-namespace {
 
-template <typename DataT, typename ElemT>
-std::tuple<double, double, double> MeasureError(DataT ref, DataT sol,
-                                                std::vector<ElemT> innerElements, int level) {
-  double Linf = 0.;
-  double L1 = 0.;
-  double L2 = 0.;
-  for(const auto& elem : innerElements) {
-    double dif = ref(elem, level) - sol(elem, level);
-    if(!std::isfinite(dif)) {
-      continue;
-    }
-    Linf = fmax(fabs(dif), Linf);
-    L1 += fabs(dif);
-    L2 += dif * dif;
+  if(MemoryReportRequested()) {
+    MemoryFootprint footprint;
+    AddFootprint(footprint, mesh);
+    AddFootprint(footprint, "vec", vec);
+    AddFootprint(footprint, "divVecSol", divVecSol);
+    AddFootprint(footprint, "rotVecSol", rotVecSol);
+    AddFootprint(footprint, "lapVecSol", lapVecSol);
+    AddFootprint(footprint, "nabla2_vec", nabla2_vec);
+    AddFootprint(footprint, "nabla2t1_vec", nabla2t1_vec);
+    AddFootprint(footprint, "nabla2t2_vec", nabla2t2_vec);
+    AddFootprint(footprint, "rot_vec", rot_vec);
+    AddFootprint(footprint, "div_vec", div_vec);
+    AddFootprint(footprint, "geofac_rot", geofac_rot);
+    AddFootprint(footprint, "edge_orientation_vertex", edge_orientation_vertex);
+    AddFootprint(footprint, "geofac_div", geofac_div);
+    AddFootprint(footprint, "edge_orientation_cell", edge_orientation_cell);
+    AddFootprint(footprint, "tangent_orientation", tangent_orientation);
+    AddFootprint(footprint, "primal_edge_length", primal_edge_length);
+    AddFootprint(footprint, "dual_edge_length", dual_edge_length);
+    AddFootprint(footprint, "dual_normal_x", dual_normal_x);
+    AddFootprint(footprint, "dual_normal_y", dual_normal_y);
+    AddFootprint(footprint, "primal_normal_x", primal_normal_x);
+    AddFootprint(footprint, "primal_normal_y", primal_normal_y);
+    AddFootprint(footprint, "cell_area", cell_area);
+    AddFootprint(footprint, "dual_cell_area", dual_cell_area);
+    footprint.print();
   }
-  L1 /= innerElements.size();
-  L2 = sqrt(L2) / sqrt(innerElements.size());
-  return {Linf, L1, L2};
+
+  INSTRUMENT_REPORT("laplICONtoylib_trace.json");
 }
-} // namespace
\ No newline at end of file
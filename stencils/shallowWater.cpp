@@ -29,12 +29,18 @@
 // Shallow water equation solver as described in "A simple and efficient unstructured finite volume
 // scheme for solving the shallow water equations in overland flow applications" by Cea and Bladé
 // Follows notation in the paper as closely as possilbe
+//
+// Optionally runs an ensemble of members with perturbed splash heights and Manning coefficients in
+// a single pass over the mesh, see the usage message in main
 
+#include <algorithm>
 #include <cmath>
 #include <cstdio>
 #include <fenv.h>
+#include <limits>
 #include <optional>
 #include <set>
+#include <string>
 #include <vector>
 
 // atlas functions
@@ -53,6 +59,11 @@
 // atlas utilities
 #include "../utils/AtlasCartesianWrapper.h"
 #include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/StageInstrumentation.h"
+#include "../utils/WallClock.h"
+
+// io
+#include "io/asyncWriter.h"
 
 template <typename T>
 static int sgn(T val) {
@@ -67,6 +78,8 @@ void dumpNodeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCar
                    atlasInterface::Field<double>& field, int level);
 void dumpCellField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
                    atlasInterface::Field<double>& field, int level);
+void dumpCellSnapshot(const std::string& fname, const atlas::Mesh& mesh,
+                      const AtlasToCartesian& wrapper, const std::vector<double>& snapshot);
 void dumpCellFieldOnNodes(const std::string& fname, const atlas::Mesh& mesh,
                           AtlasToCartesian wrapper, atlasInterface::Field<double>& field,
                           int level);
@@ -87,11 +100,23 @@ int main(int argc, char const* argv[]) {
   // enable floating point exception
   feenableexcept(FE_INVALID | FE_OVERFLOW);
 
-  if(argc != 2) {
-    std::cout << "intended use is\n" << argv[0] << " ny" << std::endl;
+  if(argc < 2 || argc > 4) {
+    std::cout << "intended use is\n"
+              << argv[0] << " ny [members] [shared|member]" << std::endl;
     return -1;
   }
   int w = atoi(argv[1]);
+  const int numMembers = argc > 2 ? atoi(argv[2]) : 1;
+  const std::string dtMode = argc > 3 ? argv[3] : "shared";
+  if(numMembers < 1 || (dtMode != "shared" && dtMode != "member")) {
+    std::cout << "members needs to be at least 1, the time step mode shared or member\n";
+    return -1;
+  }
+  // shared: all members advance with the smallest stable time step of any member, i.e. they stay
+  // at the same time. member: every member advances with its own stable time step until it
+  // reaches t_final
+  const bool sharedTimeStep = dtMode == "shared";
+
   // reference level of fluid, make sure to chose this large enough, otherwise initial
   // splash may induce negative fluid height and crash the sim
   const double refHeight = 2.;
@@ -100,17 +125,30 @@ int main(int argc, char const* argv[]) {
   const double CFLconst = 0.05;
   const double Grav = -9.81;
 
+  // the members of the ensemble differ in the height of the initial splash and in the Manning
+  // coefficient. member 0 is the unperturbed run
+  std::vector<double> SplashAmplitude(numMembers);
+  std::vector<double> DampingCoeff(numMembers);
+  std::vector<double> ManningCoeff(numMembers);
+
   // use high frequency damping. original damping by Cea and Blade is heavily dissipative, hence the
   // damping can be modulated by a coefficient in this implementation
   const bool use_corrector = true;
-  const double DampingCoeff = 0.01;
 
   // optional bed friction, manning coefficient of 0.01 is roughly equal to flow of water over
   // concrete
   const bool use_friction = true;
-  const double ManningCoeff = 0.01;
 
-  int k_size = 1;
+  for(int member = 0; member < numMembers; member++) {
+    SplashAmplitude[member] = 1. + 0.05 * member;
+    DampingCoeff[member] = 0.01;
+    ManningCoeff[member] = 0.01 * (1. + 0.1 * member);
+  }
+
+  // the members are stored in the level dimension of the state fields, i.e. interleaved per cell
+  // and edge with the member index running fastest. all members are stepped together through each
+  // kernel, such that connectivity and geometry are loaded once for all of them. geometrical
+  // factors have a single level shared by all members
   const int level = 0;
   double lDomain = 10;
 
@@ -119,39 +157,8 @@ int main(int argc, char const* argv[]) {
   const bool dbg_out = false;
   const bool readMeshFromDisk = false;
 
-  atlas::Mesh mesh = AtlasMeshSquare(w);
-  atlas::mesh::actions::build_edges(mesh, atlas::util::Config("pole_edges", false));
-  atlas::mesh::actions::build_node_to_edge_connectivity(mesh);
-  atlas::mesh::actions::build_element_to_edge_connectivity(mesh);
-
-  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
-    const auto& nodeToEdge = mesh.nodes().edge_connectivity();
-    const auto& edgeToCell = mesh.edges().cell_connectivity();
-    auto& nodeToCell = mesh.nodes().cell_connectivity();
-
-    std::set<int> nbh;
-    for(int nbhEdgeIdx = 0; nbhEdgeIdx < nodeToEdge.cols(nodeIdx); nbhEdgeIdx++) {
-      int edgeIdx = nodeToEdge(nodeIdx, nbhEdgeIdx);
-      if(edgeIdx == nodeToEdge.missing_value()) {
-        continue;
-      }
-      for(int nbhCellIdx = 0; nbhCellIdx < edgeToCell.cols(edgeIdx); nbhCellIdx++) {
-        int cellIdx = edgeToCell(edgeIdx, nbhCellIdx);
-        if(cellIdx == edgeToCell.missing_value()) {
-          continue;
-        }
-        nbh.insert(cellIdx);
-      }
-    }
-
-    assert(nbh.size() <= 6);
-    std::vector<int> initData(nbh.size(), nodeToCell.missing_value());
-    nodeToCell.add(1, nbh.size(), initData.data());
-    int copyIter = 0;
-    for(const int n : nbh) {
-      nodeToCell.set(nodeIdx, copyIter++, n);
-    }
-  }
+  // comes with all neighbor tables, including node to cell
+  atlas::Mesh mesh = AtlasMeshSquareComplete(w);
 
   // wrapper with various atlas helper functions
   AtlasToCartesian wrapper(mesh, lDomain, false, true);
@@ -162,64 +169,69 @@ int main(int argc, char const* argv[]) {
   //===------------------------------------------------------------------------------------------===//
   // helper lambdas to readily construct atlas fields and views on one line
   //===------------------------------------------------------------------------------------------===//
-  auto MakeAtlasField = [&](const std::string& name,
-                            int size) -> std::tuple<atlas::Field, atlasInterface::Field<double>> {
+  auto MakeAtlasField =
+      [&](const std::string& name, int size,
+          int levels) -> std::tuple<atlas::Field, atlasInterface::Field<double>> {
     atlas::Field field_F{name, atlas::array::DataType::real64(),
-                         atlas::array::make_shape(mesh.edges().size(), k_size)};
+                         atlas::array::make_shape(size, levels)};
     return {field_F, atlas::array::make_view<double, 2>(field_F)};
   };
 
   auto MakeAtlasSparseField =
-      [&](const std::string& name, int size,
+      [&](const std::string& name, int size, int levels,
           int sparseSize) -> std::tuple<atlas::Field, atlasInterface::SparseDimension<double>> {
     atlas::Field field_F{name, atlas::array::DataType::real64(),
-                         atlas::array::make_shape(mesh.edges().size(), k_size, sparseSize)};
+                         atlas::array::make_shape(size, levels, sparseSize)};
     return {field_F, atlas::array::make_view<double, 3>(field_F)};
   };
 
+  const int M = numMembers;
+
   // Edge Fluxes
-  auto [Q_F, Q] = MakeAtlasField("Q", mesh.edges().size());    // mass
-  auto [Fx_F, Fx] = MakeAtlasField("Fx", mesh.edges().size()); // momentum
-  auto [Fy_F, Fy] = MakeAtlasField("Fy", mesh.edges().size());
+  auto [Q_F, Q] = MakeAtlasField("Q", mesh.edges().size(), M);    // mass
+  auto [Fx_F, Fx] = MakeAtlasField("Fx", mesh.edges().size(), M); // momentum
+  auto [Fy_F, Fy] = MakeAtlasField("Fy", mesh.edges().size(), M);
 
   // Edge Velocities (to be interpolated from cell circumcenters)
-  auto [Ux_F, Ux] = MakeAtlasField("Ux", mesh.edges().size());
-  auto [Uy_F, Uy] = MakeAtlasField("Uy", mesh.edges().size());
+  auto [Ux_F, Ux] = MakeAtlasField("Ux", mesh.edges().size(), M);
+  auto [Uy_F, Uy] = MakeAtlasField("Uy", mesh.edges().size(), M);
 
   // Height on edges (to be interpolated from cell circumcenters)
-  auto [hs_F, hs] = MakeAtlasField("hs", mesh.edges().size());
+  auto [hs_F, hs] = MakeAtlasField("hs", mesh.edges().size(), M);
 
   // Cell Centered Values
-  auto [h_F, h] = MakeAtlasField("h", mesh.cells().size());    // fluid height
-  auto [qx_F, qx] = MakeAtlasField("qx", mesh.cells().size()); // discharge
-  auto [qy_F, qy] = MakeAtlasField("qy", mesh.cells().size());
-  auto [Sx_F, Sx] = MakeAtlasField("Sx", mesh.cells().size()); // free surface gradient
-  auto [Sy_F, Sy] = MakeAtlasField("Sy", mesh.cells().size());
+  auto [h_F, h] = MakeAtlasField("h", mesh.cells().size(), M);    // fluid height
+  auto [qx_F, qx] = MakeAtlasField("qx", mesh.cells().size(), M); // discharge
+  auto [qy_F, qy] = MakeAtlasField("qy", mesh.cells().size(), M);
+  auto [Sx_F, Sx] = MakeAtlasField("Sx", mesh.cells().size(), M); // free surface gradient
+  auto [Sy_F, Sy] = MakeAtlasField("Sy", mesh.cells().size(), M);
 
   // Time Derivative of Cell Centered Values
-  auto [dhdt_F, dhdt] = MakeAtlasField("h", mesh.cells().size());    // fluid height
-  auto [dqxdt_F, dqxdt] = MakeAtlasField("qx", mesh.cells().size()); // discharge
-  auto [dqydt_F, dqydt] = MakeAtlasField("qy", mesh.cells().size());
+  auto [dhdt_F, dhdt] = MakeAtlasField("h", mesh.cells().size(), M);    // fluid height
+  auto [dqxdt_F, dqxdt] = MakeAtlasField("qx", mesh.cells().size(), M); // discharge
+  auto [dqydt_F, dqydt] = MakeAtlasField("qy", mesh.cells().size(), M);
 
   // CFL per cell
-  auto [cfl_F, cfl] = MakeAtlasField("CFL", mesh.cells().size());
+  auto [cfl_F, cfl] = MakeAtlasField("CFL", mesh.cells().size(), M);
 
   // upwinded edge values for fluid height, discharge
-  auto [hU_F, hU] = MakeAtlasField("h", mesh.cells().size());
-  auto [qUx_F, qUx] = MakeAtlasField("qx", mesh.cells().size());
-  auto [qUy_F, qUy] = MakeAtlasField("qy", mesh.cells().size());
+  auto [hU_F, hU] = MakeAtlasField("h", mesh.edges().size(), M);
+  auto [qUx_F, qUx] = MakeAtlasField("qx", mesh.edges().size(), M);
+  auto [qUy_F, qUy] = MakeAtlasField("qy", mesh.edges().size(), M);
+
+  // normal velocity
+  auto [lambda_F, lambda] = MakeAtlasField("lambda", mesh.edges().size(), M);
 
   // Geometrical factors on edges
-  auto [lambda_F, lambda] = MakeAtlasField("lambda", mesh.edges().size()); // normal velocity
-  auto [L_F, L] = MakeAtlasField("L", mesh.edges().size());                // edge length
-  auto [nx_F, nx] = MakeAtlasField("nx", mesh.edges().size());             // normals
-  auto [ny_F, ny] = MakeAtlasField("ny", mesh.edges().size());
-  auto [alpha_F, alpha] = MakeAtlasField("alpha", mesh.edges().size());
+  auto [L_F, L] = MakeAtlasField("L", mesh.edges().size(), 1);    // edge length
+  auto [nx_F, nx] = MakeAtlasField("nx", mesh.edges().size(), 1); // normals
+  auto [ny_F, ny] = MakeAtlasField("ny", mesh.edges().size(), 1);
+  auto [alpha_F, alpha] = MakeAtlasField("alpha", mesh.edges().size(), 1);
 
   // Geometrical factors on cells
-  auto [A_F, A] = MakeAtlasField("A", mesh.cells().size());
+  auto [A_F, A] = MakeAtlasField("A", mesh.cells().size(), 1);
   auto [edge_orientation_cell_F, edge_orientation_cell] =
-      MakeAtlasSparseField("edge_orientation_cell", mesh.cells().size(), edgesPerCell);
+      MakeAtlasSparseField("edge_orientation_cell", mesh.cells().size(), 1, edgesPerCell);
 
   //===------------------------------------------------------------------------------------------===//
   // initialize geometrical info on edges
@@ -281,14 +293,18 @@ int main(int argc, char const* argv[]) {
     xm -= 0;
     ym -= 0;
     double v = sqrt(xm * xm + ym * ym);
-    h(cellIdx, level) = exp(-5 * v * v) + refHeight;
+    for(int member = 0; member < M; member++) {
+      h(cellIdx, member) = SplashAmplitude[member] * exp(-5 * v * v) + refHeight;
+    }
     // h(cellIdx, level) = refHeight;
     // h(cellIdx, level) = sin(xm) * sin(ym) + refHeight;
   }
 
   for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-    qx(cellIdx, level) = 0.;
-    qy(cellIdx, level) = 0.;
+    for(int member = 0; member < M; member++) {
+      qx(cellIdx, member) = 0.;
+      qy(cellIdx, member) = 0.;
+    }
   }
 
   //===------------------------------------------------------------------------------------------===//
@@ -342,13 +358,25 @@ int main(int argc, char const* argv[]) {
   // dumpMesh4Triplot(mesh, "init", h, std::nullopt);
   dumpMesh4Triplot(mesh, "init", h, wrapper);
 
-  double t = 0.;
-  double dt = 0;
+  std::vector<double> t(M, 0.);
+  std::vector<double> dt(M, 0.);
   double t_final = 16.;
   int step = 0;
 
-  // writing this intentionally close to generated code
-  while(t < t_final) {
+  // snapshots are handed to a background writer, such that formatting and writing them overlaps
+  // with the next time steps. set asyncOutput to false to block on every dump instead. in both
+  // cases the fraction of the wall time spent stalled on output is reported at the end of the run
+  const bool asyncOutput = true;
+  const int maxQueuedSnapshots = 2;
+  AsyncWriter writer(asyncOutput ? maxQueuedSnapshots : 0);
+  auto wallStart = Clock::now();
+
+  // members which reached t_final (only in the per member time step mode) are frozen by stepping
+  // them with dt = 0
+  auto running = [&](int member) { return t[member] < t_final; };
+
+  // writing this intentionally close to generated code. the member loops are the innermost loops
+  while(*std::min_element(t.begin(), t.end()) < t_final) {
 
     // make some splashes
     if(step > 0 && step % 1000 == 0) {
@@ -357,15 +385,23 @@ int main(int argc, char const* argv[]) {
         xm -= 0;
         ym -= 0;
         double v = sqrt(xm * xm + ym * ym);
-        h(cellIdx, level) += exp(-5 * v * v);
+        for(int member = 0; member < M; member++) {
+          if(running(member)) {
+            h(cellIdx, member) += SplashAmplitude[member] * exp(-5 * v * v);
+          }
+        }
       }
     }
 
     // convert cell centered discharge to velocity and lerp to edges
+    INSTRUMENT_STAGE("shallowWater/lerp_Ux")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.edges().size()) * M);
       const auto& conn = mesh.edges().cell_connectivity();
       for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-        double lhs = 0.;
+        for(int member = 0; member < M; member++) {
+          Ux(edgeIdx, member) = 0.;
+        }
         double weights[2] = {1 - alpha(edgeIdx, level),
                              alpha(edgeIdx, level)}; // currently not supported in dawn
         for(int nbhIdx = 0; nbhIdx < conn.cols(edgeIdx); nbhIdx++) {
@@ -374,15 +410,20 @@ int main(int argc, char const* argv[]) {
             assert(weights[nbhIdx] == 0.);
             continue;
           }
-          lhs += qx(cellIdx, level) / h(cellIdx, level) * weights[nbhIdx];
+          for(int member = 0; member < M; member++) {
+            Ux(edgeIdx, member) += qx(cellIdx, member) / h(cellIdx, member) * weights[nbhIdx];
+          }
         }
-        Ux(edgeIdx, level) = lhs;
       }
     }
+    INSTRUMENT_STAGE("shallowWater/lerp_Uy")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.edges().size()) * M);
       const auto& conn = mesh.edges().cell_connectivity();
       for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-        double lhs = 0.;
+        for(int member = 0; member < M; member++) {
+          Uy(edgeIdx, member) = 0.;
+        }
         double weights[2] = {1 - alpha(edgeIdx, level), alpha(edgeIdx, level)};
         for(int nbhIdx = 0; nbhIdx < conn.cols(edgeIdx); nbhIdx++) {
           int cellIdx = conn(edgeIdx, nbhIdx);
@@ -390,15 +431,20 @@ int main(int argc, char const* argv[]) {
             assert(weights[nbhIdx] == 0.);
             continue;
           }
-          lhs += qy(cellIdx, level) / h(cellIdx, level) * weights[nbhIdx];
+          for(int member = 0; member < M; member++) {
+            Uy(edgeIdx, member) += qy(cellIdx, member) / h(cellIdx, member) * weights[nbhIdx];
+          }
         }
-        Uy(edgeIdx, level) = lhs;
       }
     }
+    INSTRUMENT_STAGE("shallowWater/lerp_hs")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.edges().size()) * M);
       const auto& conn = mesh.edges().cell_connectivity();
       for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-        double lhs = 0.;
+        for(int member = 0; member < M; member++) {
+          hs(edgeIdx, member) = 0.;
+        }
         double weights[2] = {1 - alpha(edgeIdx, level), alpha(edgeIdx, level)};
         for(int nbhIdx = 0; nbhIdx < conn.cols(edgeIdx); nbhIdx++) {
           int cellIdx = conn(edgeIdx, nbhIdx);
@@ -406,63 +452,93 @@ int main(int argc, char const* argv[]) {
             assert(weights[nbhIdx] == 0.);
             continue;
           }
-          lhs += h(cellIdx, level) * weights[nbhIdx];
+          for(int member = 0; member < M; member++) {
+            hs(edgeIdx, member) += h(cellIdx, member) * weights[nbhIdx];
+          }
         }
-        hs(edgeIdx, level) = lhs;
       }
     }
 
     // dumpEdgeField("hs", mesh, wrapper, hs, level);
 
     // normal edge velocity
+    INSTRUMENT_STAGE("shallowWater/lambda")
     for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-      lambda(edgeIdx, level) =
-          nx(edgeIdx, level) * Ux(edgeIdx, level) + ny(edgeIdx, level) * Uy(edgeIdx, level);
+      INSTRUMENT_ELEMENTS(M);
+      const double nxe = nx(edgeIdx, level);
+      const double nye = ny(edgeIdx, level);
+      for(int member = 0; member < M; member++) {
+        lambda(edgeIdx, member) = nxe * Ux(edgeIdx, member) + nye * Uy(edgeIdx, member);
+      }
     }
 
     // upwinding for edge values
     //  this pattern is currently unsupported
+    INSTRUMENT_STAGE("shallowWater/upwind")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.edges().size()) * M);
       const auto& conn = mesh.edges().cell_connectivity();
       for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
         int lo = conn(edgeIdx, 0);
         int hi = conn(edgeIdx, 1);
-        hU(edgeIdx, level) = (lambda(edgeIdx, level) < 0) ? h(hi, level) : h(lo, level);
-        qUx(edgeIdx, level) = (lambda(edgeIdx, level) < 0) ? qx(hi, level) : qx(lo, level);
-        qUy(edgeIdx, level) = (lambda(edgeIdx, level) < 0) ? qy(hi, level) : qy(lo, level);
+        for(int member = 0; member < M; member++) {
+          const int up = (lambda(edgeIdx, member) < 0) ? hi : lo;
+          hU(edgeIdx, member) = h(up, member);
+          qUx(edgeIdx, member) = qx(up, member);
+          qUy(edgeIdx, member) = qy(up, member);
+        }
       }
     }
 
     // update edge fluxes
+    INSTRUMENT_STAGE("shallowWater/flux_Q")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.edges().size()) * M);
       const auto& conn = mesh.edges().cell_connectivity();
       for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
         int cLo = conn(edgeIdx, 0);
         int cHi = conn(edgeIdx, 1);
         bool innerCell = cLo != conn.missing_value() && cHi != conn.missing_value();
-        Q(edgeIdx, level) = lambda(edgeIdx, level) * (hU(edgeIdx, level)) * L(edgeIdx, level);
+        const double Le = L(edgeIdx, level);
+        for(int member = 0; member < M; member++) {
+          Q(edgeIdx, member) = lambda(edgeIdx, member) * (hU(edgeIdx, member)) * Le;
+        }
         if(use_corrector && innerCell) {
-          double hj = h(cHi, level);
-          double hi = h(cLo, level);
-          double deltaij = hi - hj;
-          Q(edgeIdx, level) -= DampingCoeff * 0.5 * deltaij *
-                               sqrt(fabs(Grav) * hU(edgeIdx, level)) * L(edgeIdx, level);
+          for(int member = 0; member < M; member++) {
+            double hj = h(cHi, member);
+            double hi = h(cLo, member);
+            double deltaij = hi - hj;
+            Q(edgeIdx, member) -= DampingCoeff[member] * 0.5 * deltaij *
+                                  sqrt(fabs(Grav) * hU(edgeIdx, member)) * Le;
+          }
         }
       }
     }
+    INSTRUMENT_STAGE("shallowWater/flux_Fx")
     for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-      Fx(edgeIdx, level) = lambda(edgeIdx, level) * qUx(edgeIdx, level) * L(edgeIdx, level);
+      INSTRUMENT_ELEMENTS(M);
+      const double Le = L(edgeIdx, level);
+      for(int member = 0; member < M; member++) {
+        Fx(edgeIdx, member) = lambda(edgeIdx, member) * qUx(edgeIdx, member) * Le;
+      }
     }
+    INSTRUMENT_STAGE("shallowWater/flux_Fy")
     for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-      Fy(edgeIdx, level) = lambda(edgeIdx, level) * qUy(edgeIdx, level) * L(edgeIdx, level);
+      INSTRUMENT_ELEMENTS(M);
+      const double Le = L(edgeIdx, level);
+      for(int member = 0; member < M; member++) {
+        Fy(edgeIdx, member) = lambda(edgeIdx, member) * qUy(edgeIdx, member) * Le;
+      }
     }
 
     // boundary conditions (zero flux)
     // currently not supported in dawn
     for(auto it : boundaryEdges) {
-      Q(it, level) = 0;
-      Fx(it, level) = 0;
-      Fy(it, level) = 0;
+      for(int member = 0; member < M; member++) {
+        Q(it, member) = 0;
+        Fx(it, member) = 0;
+        Fy(it, member) = 0;
+      }
       // hs(it, level) = refHeight;
     }
 
@@ -470,99 +546,159 @@ int main(int argc, char const* argv[]) {
     // return 0;
 
     // evolve cell values
+    INSTRUMENT_STAGE("shallowWater/dhdt")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.cells().size()) * M);
       const auto& conn = mesh.cells().edge_connectivity();
       for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-        double lhs = 0.;
+        for(int member = 0; member < M; member++) {
+          dhdt(cellIdx, member) = 0.;
+        }
         for(int nbhIdx = 0; nbhIdx < conn.cols(cellIdx); nbhIdx++) {
           int edgeIdx = conn(cellIdx, nbhIdx);
-          lhs += Q(edgeIdx, level) * edge_orientation_cell(cellIdx, nbhIdx, level);
+          const double orientation = edge_orientation_cell(cellIdx, nbhIdx, level);
+          for(int member = 0; member < M; member++) {
+            dhdt(cellIdx, member) += Q(edgeIdx, member) * orientation;
+          }
         }
-        dhdt(cellIdx, level) = lhs;
       }
     }
+    // friction term of the discharge q in direction qDir
+    auto friction = [&](int cellIdx, int member, double qDir) {
+      double lenq = sqrt(qx(cellIdx, member) * qx(cellIdx, member) +
+                         qy(cellIdx, member) * qy(cellIdx, member));
+      return Grav * ManningCoeff[member] * ManningCoeff[member] /
+             pow(h(cellIdx, member), 10. / 3.) * lenq * qDir;
+    };
+    INSTRUMENT_STAGE("shallowWater/dqxdt")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.cells().size()) * M);
       const auto& conn = mesh.cells().edge_connectivity();
       for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-        double lhs = 0.;
+        for(int member = 0; member < M; member++) {
+          dqxdt(cellIdx, member) = 0.;
+        }
         for(int nbhIdx = 0; nbhIdx < conn.cols(cellIdx); nbhIdx++) {
           int edgeIdx = conn(cellIdx, nbhIdx);
-          lhs += Fx(edgeIdx, level) * edge_orientation_cell(cellIdx, nbhIdx, level);
+          const double orientation = edge_orientation_cell(cellIdx, nbhIdx, level);
+          for(int member = 0; member < M; member++) {
+            dqxdt(cellIdx, member) += Fx(edgeIdx, member) * orientation;
+          }
         }
-        dqxdt(cellIdx, level) = lhs / A(cellIdx, level);
-        if(use_friction) {
-          double lenq = sqrt(qx(cellIdx, level) * qx(cellIdx, level) +
-                             qy(cellIdx, level) * qy(cellIdx, level));
-          dqxdt(cellIdx, level) -= Grav * ManningCoeff * ManningCoeff /
-                                   pow(h(cellIdx, level), 10. / 3.) * lenq * qx(cellIdx, level);
+        for(int member = 0; member < M; member++) {
+          dqxdt(cellIdx, member) = dqxdt(cellIdx, member) / A(cellIdx, level);
+          if(use_friction) {
+            dqxdt(cellIdx, member) -= friction(cellIdx, member, qx(cellIdx, member));
+          }
         }
       }
     }
+    INSTRUMENT_STAGE("shallowWater/dqydt")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.cells().size()) * M);
       const auto& conn = mesh.cells().edge_connectivity();
       for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-        double lhs = 0.;
+        for(int member = 0; member < M; member++) {
+          dqydt(cellIdx, member) = 0.;
+        }
         for(int nbhIdx = 0; nbhIdx < conn.cols(cellIdx); nbhIdx++) {
           int edgeIdx = conn(cellIdx, nbhIdx);
-          lhs += Fy(edgeIdx, level) * edge_orientation_cell(cellIdx, nbhIdx, level);
+          const double orientation = edge_orientation_cell(cellIdx, nbhIdx, level);
+          for(int member = 0; member < M; member++) {
+            dqydt(cellIdx, member) += Fy(edgeIdx, member) * orientation;
+          }
         }
-        dqydt(cellIdx, level) = lhs / A(cellIdx, level);
-        if(use_friction) {
-          double lenq = sqrt(qx(cellIdx, level) * qx(cellIdx, level) +
-                             qy(cellIdx, level) * qy(cellIdx, level));
-          dqydt(cellIdx, level) -= Grav * ManningCoeff * ManningCoeff /
-                                   pow(h(cellIdx, level), 10. / 3.) * lenq * qy(cellIdx, level);
+        for(int member = 0; member < M; member++) {
+          dqydt(cellIdx, member) = dqydt(cellIdx, member) / A(cellIdx, level);
+          if(use_friction) {
+            dqydt(cellIdx, member) -= friction(cellIdx, member, qy(cellIdx, member));
+          }
         }
       }
     }
+    INSTRUMENT_STAGE("shallowWater/Sx")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.cells().size()) * M);
       const auto& conn = mesh.cells().edge_connectivity();
       for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-        double lhs = 0.;
+        for(int member = 0; member < M; member++) {
+          Sx(cellIdx, member) = 0.;
+        }
         for(int nbhIdx = 0; nbhIdx < conn.cols(cellIdx); nbhIdx++) {
           int edgeIdx = conn(cellIdx, nbhIdx);
-          lhs -= hs(edgeIdx, level) * nx(edgeIdx, level) *
-                 edge_orientation_cell(cellIdx, nbhIdx, level) * L(edgeIdx, level);
+          const double nxe = nx(edgeIdx, level);
+          const double orientation = edge_orientation_cell(cellIdx, nbhIdx, level);
+          const double Le = L(edgeIdx, level);
+          for(int member = 0; member < M; member++) {
+            Sx(cellIdx, member) -= hs(edgeIdx, member) * nxe * orientation * Le;
+          }
+        }
+        for(int member = 0; member < M; member++) {
+          Sx(cellIdx, member) = Sx(cellIdx, member) / A(cellIdx, level);
         }
-        Sx(cellIdx, level) = lhs / A(cellIdx, level);
       }
     }
+    INSTRUMENT_STAGE("shallowWater/Sy")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.cells().size()) * M);
       const auto& conn = mesh.cells().edge_connectivity();
       for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-        double lhs = 0.;
+        for(int member = 0; member < M; member++) {
+          Sy(cellIdx, member) = 0.;
+        }
         for(int nbhIdx = 0; nbhIdx < conn.cols(cellIdx); nbhIdx++) {
           int edgeIdx = conn(cellIdx, nbhIdx);
-          lhs -= hs(edgeIdx, level) * ny(edgeIdx, level) *
-                 edge_orientation_cell(cellIdx, nbhIdx, level) * L(edgeIdx, level);
+          const double nye = ny(edgeIdx, level);
+          const double orientation = edge_orientation_cell(cellIdx, nbhIdx, level);
+          const double Le = L(edgeIdx, level);
+          for(int member = 0; member < M; member++) {
+            Sy(cellIdx, member) -= hs(edgeIdx, member) * nye * orientation * Le;
+          }
+        }
+        for(int member = 0; member < M; member++) {
+          Sy(cellIdx, member) = Sy(cellIdx, member) / A(cellIdx, level);
         }
-        Sy(cellIdx, level) = lhs / A(cellIdx, level);
       }
     }
     for(auto it : boundaryCells) {
-      Sx(it, level) = 0.;
-      Sy(it, level) = 0.;
+      for(int member = 0; member < M; member++) {
+        Sx(it, member) = 0.;
+        Sy(it, member) = 0.;
+      }
     }
     // dumpEdgeField("hs", mesh, wrapper, hs, level);
     // dumpCellField("Sx", mesh, wrapper, Sx, level);
     // dumpCellField("Sy", mesh, wrapper, Sy, level);
 
+    INSTRUMENT_STAGE("shallowWater/tendencies")
     for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-      dhdt(cellIdx, level) = dhdt(cellIdx, level) / A(cellIdx, level) * dt;
-      dqxdt(cellIdx, level) =
-          (dqxdt(cellIdx, level) - Grav * (h(cellIdx, level)) * Sx(cellIdx, level)) * dt;
-      dqydt(cellIdx, level) =
-          (dqydt(cellIdx, level) - Grav * (h(cellIdx, level)) * Sy(cellIdx, level)) * dt;
+      INSTRUMENT_ELEMENTS(M);
+      const double Ac = A(cellIdx, level);
+      for(int member = 0; member < M; member++) {
+        dhdt(cellIdx, member) = dhdt(cellIdx, member) / Ac * dt[member];
+        dqxdt(cellIdx, member) =
+            (dqxdt(cellIdx, member) - Grav * (h(cellIdx, member)) * Sx(cellIdx, member)) *
+            dt[member];
+        dqydt(cellIdx, member) =
+            (dqydt(cellIdx, member) - Grav * (h(cellIdx, member)) * Sy(cellIdx, member)) *
+            dt[member];
+      }
     }
     for(auto it : boundaryCells) {
-      dhdt(it, level) = 0.;
-      dqxdt(it, level) = 0.;
-      dqydt(it, level) = 0.;
+      for(int member = 0; member < M; member++) {
+        dhdt(it, member) = 0.;
+        dqxdt(it, member) = 0.;
+        dqydt(it, member) = 0.;
+      }
     }
+    INSTRUMENT_STAGE("shallowWater/update")
     for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-      h(cellIdx, level) = h(cellIdx, level) + dhdt(cellIdx, level);
-      qx(cellIdx, level) = qx(cellIdx, level) - dqxdt(cellIdx, level);
-      qy(cellIdx, level) = qy(cellIdx, level) - dqydt(cellIdx, level);
+      INSTRUMENT_ELEMENTS(M);
+      for(int member = 0; member < M; member++) {
+        h(cellIdx, member) = h(cellIdx, member) + dhdt(cellIdx, member);
+        qx(cellIdx, member) = qx(cellIdx, member) - dqxdt(cellIdx, member);
+        qy(cellIdx, member) = qy(cellIdx, member) - dqydt(cellIdx, member);
+      }
     }
 
     // dumpCellField("h", mesh, wrapper, h, level);
@@ -575,38 +711,84 @@ int main(int argc, char const* argv[]) {
 
     // adapt CLF
     // this would probably be in the driver code anyway
+    INSTRUMENT_STAGE("shallowWater/cfl")
     {
+      INSTRUMENT_ELEMENTS(long(mesh.cells().size()) * M);
       const auto& conn = mesh.cells().edge_connectivity();
       for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
         double l0 = L(conn(cellIdx, 0), level);
         double l1 = L(conn(cellIdx, 1), level);
         double l2 = L(conn(cellIdx, 2), level);
-        double hi = h(cellIdx, level);
-        double Ux = qx(cellIdx, level) / hi;
-        double Uy = qy(cellIdx, level) / hi;
-        double U = sqrt(Ux * Ux + Uy * Uy);
-        cfl(cellIdx, level) = CFLconst * std::min({l0, l1, l2}) / (U + sqrt(fabs(Grav) * hi));
+        const double lmin = std::min({l0, l1, l2});
+        for(int member = 0; member < M; member++) {
+          double hi = h(cellIdx, member);
+          double Ux = qx(cellIdx, member) / hi;
+          double Uy = qy(cellIdx, member) / hi;
+          double U = sqrt(Ux * Ux + Uy * Uy);
+          cfl(cellIdx, member) = CFLconst * lmin / (U + sqrt(fabs(Grav) * hi));
+        }
       }
-      double mindt = std::numeric_limits<double>::max();
+      std::vector<double> mindt(M, std::numeric_limits<double>::max());
       for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
-        mindt = fmin(cfl(cellIdx, level), mindt);
+        for(int member = 0; member < M; member++) {
+          mindt[member] = fmin(cfl(cellIdx, member), mindt[member]);
+        }
+      }
+      const double sharedDt = *std::min_element(mindt.begin(), mindt.end());
+      for(int member = 0; member < M; member++) {
+        dt[member] = sharedTimeStep ? sharedDt : (running(member) ? mindt[member] : 0.);
       }
-      dt = mindt;
     }
 
-    t += dt;
+    for(int member = 0; member < M; member++) {
+      t[member] += dt[member];
+    }
 
+    INSTRUMENT_STAGE("shallowWater/output")
     if(step % 20 == 0) {
       char buf[256];
       // sprintf(buf, "out/step_%04d.txt", step);
 
       sprintf(buf, "out/stepH_%04d.txt", step);
-      dumpCellField(buf, mesh, wrapper, h, level);
+      // h keeps evolving while the snapshot is written, hence hand over a copy (of member 0)
+      writer.submit([&mesh, &wrapper, fname = std::string(buf),
+                     snapshot = snapshotLevel(h, mesh.cells().size(), 0)]() {
+        dumpCellSnapshot(fname, mesh, wrapper, snapshot);
+      });
       // dumpCellFieldOnNodes(buf, mesh, wrapper, h, level);
     }
-    std::cout << "time " << t << " timestep " << step++ << " dt " << dt << "\n";
+    if(sharedTimeStep) {
+      std::cout << "time " << t[0] << " timestep " << step++ << " dt " << dt[0] << "\n";
+    } else {
+      auto [tMin, tMax] = std::minmax_element(t.begin(), t.end());
+      auto [dtMin, dtMax] = std::minmax_element(dt.begin(), dt.end());
+      std::cout << "time " << *tMin << " - " << *tMax << " timestep " << step++ << " dt "
+                << *dtMin << " - " << *dtMax << "\n";
+    }
   }
 
+  writer.flush();
+  double wallTime = SecondsSince(wallStart);
+  printf("%s output: %d snapshots, stalled %f s of %f s wall time (%.2f%%)\n",
+         writer.isAsync() ? "async" : "blocking", writer.jobsWritten(), writer.stallTime(),
+         wallTime, 100. * writer.stallTime() / wallTime);
+
+  // summary of the ensemble: total fluid volume and maximum height of every member
+  if(M > 1) {
+    for(int member = 0; member < M; member++) {
+      double volume = 0.;
+      double hMax = 0.;
+      for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+        volume += h(cellIdx, member) * A(cellIdx, level);
+        hMax = fmax(hMax, h(cellIdx, member));
+      }
+      printf("member %d: manning %.4f damping %.4f t %f volume %f max height %f\n", member,
+             ManningCoeff[member], DampingCoeff[member], t[member], volume, hMax);
+    }
+  }
+
+  INSTRUMENT_REPORT("shallowWater_trace.json");
+
   dumpMesh4Triplot(mesh, "final", h, wrapper);
 }
 
@@ -695,6 +877,16 @@ void dumpCellField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCar
   fclose(fp);
 }
 
+void dumpCellSnapshot(const std::string& fname, const atlas::Mesh& mesh,
+                      const AtlasToCartesian& wrapper, const std::vector<double>& snapshot) {
+  FILE* fp = fopen(fname.c_str(), "w+");
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    auto [xm, ym] = wrapper.cellCircumcenter(mesh, cellIdx);
+    fprintf(fp, "%f %f %e\n", xm, ym, snapshot[cellIdx]);
+  }
+  fclose(fp);
+}
+
 void dumpEdgeField(const std::string& fname, const atlas::Mesh& mesh, AtlasToCartesian wrapper,
                    atlasInterface::Field<double>& field, int level,
                    std::optional<Orientation> color) {
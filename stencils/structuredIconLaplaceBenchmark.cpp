@@ -0,0 +1,167 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Runs the generated ICON Laplacian on a regular toylib grid twice, once using the toylib backend
+// (neighbors are looked up in the pointer tables of the grid) and once using the table free
+// structured backend (neighbors are computed from the element indices). Both runs use the same
+// grid numbering and the same inputs, the results are checked to be identical. This is done for a
+// non periodic and a periodic grid.
+//
+// The inputs are arbitrary smooth values, not geometrical quantities; only the neighbor access
+// pattern matters here. The timings are taken by the benchmark harness
+// (benchmarks/BenchmarkSuite.h) under the names {nonPeriodic, periodic}/{toylib, structured}, the
+// summary reports the median times.
+//
+// usage: structuredIconLaplaceBenchmark [--warmup=N] [--repetitions=N] [--filter=S] [--json=FILE]
+//                                       nx ny [k_size]
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "interfaces/structured_interface.hpp"
+#include "interfaces/toylib_interface.hpp"
+#include "toylib.hpp"
+
+#include "generated_iconLaplace.hpp"
+
+#include "../benchmarks/BenchmarkSuite.h"
+
+namespace {
+const int edgesPerVertex = 6;
+const int edgesPerCell = 3;
+
+// all fields of the ICON Laplacian, allocated on grid
+struct LaplaceFields {
+  toylib::EdgeData<double> vec;
+  toylib::FaceData<double> div_vec;
+  toylib::VertexData<double> rot_vec;
+  toylib::EdgeData<double> nabla2t1_vec;
+  toylib::EdgeData<double> nabla2t2_vec;
+  toylib::EdgeData<double> nabla2_vec;
+  toylib::EdgeData<double> primal_edge_length;
+  toylib::EdgeData<double> dual_edge_length;
+  toylib::EdgeData<double> tangent_orientation;
+  toylib::SparseVertexData<double> geofac_rot;
+  toylib::SparseFaceData<double> geofac_div;
+
+  LaplaceFields(const toylib::Grid& grid, int k_size)
+      : vec(grid, k_size), div_vec(grid, k_size), rot_vec(grid, k_size),
+        nabla2t1_vec(grid, k_size), nabla2t2_vec(grid, k_size), nabla2_vec(grid, k_size),
+        primal_edge_length(grid, k_size), dual_edge_length(grid, k_size),
+        tangent_orientation(grid, k_size), geofac_rot(grid, edgesPerVertex, k_size),
+        geofac_div(grid, edgesPerCell, k_size) {
+    const int numEdges = grid.all_edges().size();
+    for(int k = 0; k < k_size; k++) {
+      for(int id = 0; id < numEdges; id++) {
+        vec(id, k) = sin(0.1 * id + k);
+        primal_edge_length(id, k) = 1. + 0.5 * sin(0.3 * id);
+        dual_edge_length(id, k) = 1. + 0.5 * cos(0.7 * id);
+        tangent_orientation(id, k) = (id % 2 == 0) ? 1. : -1.;
+      }
+      for(int id = 0; id < int(grid.vertices().size()); id++) {
+        for(int nbhIdx = 0; nbhIdx < edgesPerVertex; nbhIdx++) {
+          geofac_rot(id, nbhIdx, k) = cos(0.2 * id + nbhIdx);
+        }
+      }
+      for(int id = 0; id < int(grid.faces().size()); id++) {
+        for(int nbhIdx = 0; nbhIdx < edgesPerCell; nbhIdx++) {
+          geofac_div(id, nbhIdx, k) = sin(0.4 * id + nbhIdx);
+        }
+      }
+    }
+  }
+};
+
+// times the stencil under name, returns the median time in seconds (0 if filtered out)
+template <typename Tag>
+double timeStencil(BenchmarkSuite& suite, const std::string& name, int ny,
+                   const dawn::mesh_t<Tag>& mesh, int k_size, LaplaceFields& f, long numEdges) {
+  return suite.measure(name, ny, numEdges * k_size, [&]() {
+    dawn_generated::cxxnaiveico::ICON_laplacian_stencil<Tag>(
+        mesh, k_size, f.vec, f.div_vec, f.rot_vec, f.nabla2t1_vec, f.nabla2t2_vec, f.nabla2_vec,
+        f.primal_edge_length, f.dual_edge_length, f.tangent_orientation, f.geofac_rot,
+        f.geofac_div)
+        .run();
+  });
+}
+
+template <bool periodic>
+bool runBenchmark(BenchmarkSuite& suite, int nx, int ny, int k_size) {
+  toylib::Grid grid(nx, ny, periodic);
+  structuredInterface::StructuredGrid<periodic> mesh(nx, ny);
+  const std::string prefix = periodic ? "periodic/" : "nonPeriodic/";
+  const long numEdges = grid.all_edges().size();
+
+  LaplaceFields toylibFields(grid, k_size);
+  LaplaceFields structuredFields(grid, k_size);
+
+  double toylibTime = timeStencil<toylibInterface::toylibTag>(suite, prefix + "toylib", ny, grid,
+                                                              k_size, toylibFields, numEdges);
+  double structuredTime = timeStencil<structuredInterface::structuredTag<periodic>>(
+      suite, prefix + "structured", ny, mesh, k_size, structuredFields, numEdges);
+
+  bool identical = true;
+  for(int k = 0; k < k_size; k++) {
+    for(const auto& e : grid.edges()) {
+      identical &= toylibFields.nabla2_vec(e, k) == structuredFields.nabla2_vec(e, k);
+    }
+    for(const auto& c : grid.faces()) {
+      identical &= toylibFields.div_vec(c, k) == structuredFields.div_vec(c, k);
+    }
+    for(const auto& v : grid.vertices()) {
+      identical &= toylibFields.rot_vec(v, k) == structuredFields.rot_vec(v, k);
+    }
+  }
+
+  printf("%s grid %d x %d, %d levels: toylib %.3f ms, structured %.3f ms, speedup %.1f, results "
+         "%s\n",
+         periodic ? "periodic" : "non periodic", nx, ny, k_size, 1e3 * toylibTime,
+         1e3 * structuredTime, structuredTime > 0. ? toylibTime / structuredTime : 0.,
+         identical ? "identical" : "DIFFER");
+  return identical;
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  BenchmarkOptions options;
+  std::vector<std::string> args;
+  const bool valid = ParseBenchmarkOptions(argc, argv, options, args);
+  if(!valid || args.size() < 2 || args.size() > 3) {
+    std::cout << "intended use is\n"
+              << argv[0]
+              << " [--warmup=N] [--repetitions=N] [--filter=S] [--json=FILE] nx ny [k_size]"
+              << std::endl;
+    return -1;
+  }
+  int nx = atoi(args[0].c_str());
+  int ny = atoi(args[1].c_str());
+  int k_size = args.size() > 2 ? atoi(args[2].c_str()) : 1;
+  if(nx < 2 || ny < 2 || k_size < 1) {
+    std::cout << "nx and ny need to be at least 2, k_size at least 1\n";
+    return -1;
+  }
+
+  BenchmarkSuite suite(options);
+  bool identical = runBenchmark<false>(suite, nx, ny, k_size);
+  identical &= runBenchmark<true>(suite, nx, ny, k_size);
+  if(!options.jsonFile.empty() && !suite.writeJson(options.jsonFile)) {
+    std::cout << "could not write " << options.jsonFile << "\n";
+    return 1;
+  }
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks the conversion of toylib grids into atlas meshes (AtlasMeshFromToylib) on a regular grid
+// and on the rectangular mesh used by mylibIconLaplaceDriver:
+//  - element counts agree, the edge mapping is a bijection between atlas edges and valid toylib
+//    edges
+//  - every neighbor table row of the atlas mesh lists the toylib neighbors in toylib order
+//  - the neighbor lists returned by the atlas and toylib interfaces agree for all chains used by
+//    the ICON Laplacian
+
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <atlas/library/Library.h>
+#include <atlas/mesh/Mesh.h>
+
+#include "../stencils/interfaces/atlas_interface.hpp"
+#include "../stencils/interfaces/toylib_interface.hpp"
+#include "../utils/AtlasFromToylib.h"
+#include "../utils/GenerateRectToylibMesh.h"
+
+namespace {
+template <typename ConnectivityT, typename NbhT, typename MapFn>
+void checkRow(const ConnectivityT& conn, int row, const std::vector<NbhT>& toylibNbhs,
+              MapFn&& toAtlas) {
+  int numPresent = 0;
+  for(int nbhIdx = 0; nbhIdx < conn.cols(row); nbhIdx++) {
+    if(conn(row, nbhIdx) != conn.missing_value()) {
+      assert(nbhIdx < int(toylibNbhs.size()));
+      assert(conn(row, nbhIdx) == toAtlas(toylibNbhs[nbhIdx]->id()));
+      numPresent++;
+    }
+  }
+  assert(numPresent == int(toylibNbhs.size()));
+}
+
+void checkMesh(const toylib::Grid& grid, const std::string& name) {
+  AtlasToylibIndices indices;
+  atlas::Mesh mesh = AtlasMeshFromToylib(grid, indices);
+  assert(mesh.nodes().size() == int(grid.vertices().size()));
+  assert(mesh.cells().size() == int(grid.faces().size()));
+  assert(mesh.edges().size() == int(grid.edges().size()));
+  assert(int(indices.toylibEdge.size()) == mesh.edges().size());
+  assert(indices.atlasEdge.size() == grid.all_edges().size());
+  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
+    assert(indices.atlasEdge[indices.toylibEdge[edgeIdx]] == edgeIdx);
+  }
+
+  auto sameIdx = [](int id) { return id; };
+  auto edgeIdx = [&](int id) { return indices.atlasEdge[id]; };
+  for(const auto& f : grid.faces()) {
+    checkRow(mesh.cells().node_connectivity(), f.id(), f.vertices(), sameIdx);
+    checkRow(mesh.cells().edge_connectivity(), f.id(), f.edges(), edgeIdx);
+  }
+  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
+    const toylib::Edge& e = grid.edges()[edgeIdx];
+    checkRow(mesh.edges().node_connectivity(), edgeIdx, e.vertices(), sameIdx);
+    checkRow(mesh.edges().cell_connectivity(), edgeIdx, e.faces(), sameIdx);
+  }
+  for(const auto& v : grid.vertices()) {
+    checkRow(mesh.nodes().edge_connectivity(), v.id(), v.edges(), edgeIdx);
+    checkRow(mesh.nodes().cell_connectivity(), v.id(), v.faces(), sameIdx);
+  }
+
+  // neighbor lists of both interfaces
+  using dawn::LocationType;
+  auto checkChain = [&](std::vector<LocationType> chain, const auto& toylibElems,
+                        auto&& elemToAtlas, auto&& nbhToAtlas) {
+    for(const auto& elem : toylibElems) {
+      const toylib::ToylibElement* toylibElem = &static_cast<const toylib::ToylibElement&>(elem);
+      auto atlasNbhs = atlasInterface::getNeighbors(atlasInterface::atlasTag{}, mesh, chain,
+                                                    elemToAtlas(toylibElem->id()));
+      auto toylibNbhs =
+          toylibInterface::getNeighbors(toylibInterface::toylibTag{}, grid, chain, toylibElem);
+      assert(atlasNbhs.size() == toylibNbhs.size());
+      for(size_t nbhIdx = 0; nbhIdx < atlasNbhs.size(); nbhIdx++) {
+        assert(atlasNbhs[nbhIdx] == nbhToAtlas(toylibNbhs[nbhIdx]->id()));
+      }
+    }
+  };
+  std::vector<toylib::Edge> edges;
+  for(const auto& e : grid.edges()) {
+    edges.push_back(e);
+  }
+  checkChain({LocationType::Vertices, LocationType::Edges}, grid.vertices(), sameIdx, edgeIdx);
+  checkChain({LocationType::Cells, LocationType::Edges}, grid.faces(), sameIdx, edgeIdx);
+  checkChain({LocationType::Edges, LocationType::Vertices}, edges, edgeIdx, sameIdx);
+  checkChain({LocationType::Edges, LocationType::Cells}, edges, edgeIdx, sameIdx);
+
+  std::cout << name << ": " << mesh.nodes().size() << " nodes, " << mesh.edges().size()
+            << " edges, " << mesh.cells().size() << " cells converted\n";
+}
+} // namespace
+
+int main() {
+  checkMesh(toylib::Grid(8, 4, false), "toylib::Grid(8, 4)");
+  checkMesh(toylibMeshRect(10), "toylibMeshRect(10)");
+  atlas::Library::instance().finalise();
+  std::cout << "converted meshes are consistent\n";
+}
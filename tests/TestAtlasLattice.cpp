@@ -0,0 +1,209 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks the lattice view of equilateral atlas meshes and the lattice backend:
+//  - lattice positions map back to the same elements
+//  - after AtlasSortByLattice, the lattice backend yields the same neighbors in the same order as
+//    the atlas backend, and the ICON Laplacian gives bitwise identical results with both
+//
+// The generated rectangular meshes are always checked. Optionally, a projected mesh (e.g. the
+// outProject.nc written by TestAtlasProjectMesh) can be passed, which is checked as well.
+
+#include <assert.h>
+#include <cmath>
+#include <iostream>
+#include <string>
+
+#include <atlas/library/Library.h>
+#include <atlas/mesh/Mesh.h>
+#include <atlas/mesh/actions/BuildEdges.h>
+#include <atlas/util/CoordinateEnums.h>
+
+#include "../stencils/generated_iconLaplace.hpp"
+#include "../stencils/interfaces/atlas_interface.hpp"
+#include "../stencils/interfaces/atlas_lattice_interface.hpp"
+#include "../utils/AtlasFromNetcdf.h"
+#include "../utils/AtlasLattice.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/WallClock.h"
+
+namespace {
+void checkPositions(const atlas::Mesh& mesh, const AtlasLattice& lattice) {
+  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+    auto [i, j] = lattice.nodePosition(nodeIdx);
+    assert(lattice.node(i, j) == nodeIdx);
+  }
+  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
+    auto [i, j, c] = lattice.edgePosition(edgeIdx);
+    assert(lattice.edge(i, j, c) == edgeIdx);
+  }
+  auto xy = atlas::array::make_view<double, 2>(mesh.nodes().xy());
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    auto [i, j, c] = lattice.cellPosition(cellIdx);
+    assert(lattice.cell(i, j, c) == cellIdx);
+    // cell nodes are counter clockwise
+    int nbh[AtlasLattice::maxNeighbors];
+    assert(lattice.nodesOfCell(cellIdx, nbh) == 3);
+    double area = 0.;
+    for(int n = 0; n < 3; n++) {
+      int a = nbh[n];
+      int b = nbh[(n + 1) % 3];
+      area += xy(a, atlas::LON) * xy(b, atlas::LAT) - xy(b, atlas::LON) * xy(a, atlas::LAT);
+    }
+    assert(area > 0.);
+  }
+}
+
+void checkNeighbors(const atlas::Mesh& mesh, const AtlasLattice& lattice) {
+  using dawn::LocationType;
+  atlasLatticeInterface::LatticeMesh latticeMesh(mesh, lattice);
+  const std::vector<std::vector<LocationType>> chains = {
+      {LocationType::Cells, LocationType::Edges},    {LocationType::Cells, LocationType::Vertices},
+      {LocationType::Edges, LocationType::Cells},    {LocationType::Edges, LocationType::Vertices},
+      {LocationType::Vertices, LocationType::Edges}, {LocationType::Vertices, LocationType::Cells}};
+  for(const auto& chain : chains) {
+    // node to cell tables are not always built
+    if(chain[0] == LocationType::Vertices && chain[1] == LocationType::Cells &&
+       mesh.nodes().cell_connectivity().rows() == 0) {
+      continue;
+    }
+    int size = chain[0] == LocationType::Cells
+                   ? mesh.cells().size()
+                   : (chain[0] == LocationType::Edges ? mesh.edges().size() : mesh.nodes().size());
+    for(int idx = 0; idx < size; idx++) {
+      assert(atlasLatticeInterface::getNeighbors(atlasLatticeInterface::atlasLatticeTag{},
+                                                 latticeMesh, chain, idx) ==
+             atlasInterface::getNeighbors(atlasInterface::atlasTag{}, mesh, chain, idx));
+    }
+  }
+}
+
+// runs the ICON Laplacian with synthetic inputs, returns nabla2_vec and the time taken
+template <typename Tag>
+std::tuple<std::vector<double>, double> runLaplacian(const atlas::Mesh& mesh,
+                                                     const dawn::mesh_t<Tag>& stencilMesh) {
+  const int k_size = 1;
+  auto makeField = [&](int size) {
+    return atlas::Field{"", atlas::array::DataType::real64(),
+                        atlas::array::make_shape(size, k_size)};
+  };
+  auto makeSparseField = [&](int size, int sparseSize) {
+    return atlas::Field{"", atlas::array::DataType::real64(),
+                        atlas::array::make_shape(size, k_size, sparseSize)};
+  };
+  const int numEdges = mesh.edges().size();
+  const int numCells = mesh.cells().size();
+  const int numNodes = mesh.nodes().size();
+  std::vector<atlas::Field> edgeFields;
+  for(int fieldIdx = 0; fieldIdx < 7; fieldIdx++) {
+    edgeFields.push_back(makeField(numEdges));
+  }
+  atlas::Field div_F = makeField(numCells);
+  atlas::Field rot_F = makeField(numNodes);
+  atlas::Field geofac_rot_F = makeSparseField(numNodes, 6);
+  atlas::Field geofac_div_F = makeSparseField(numCells, 3);
+
+  std::vector<atlasInterface::Field<double>> e;
+  for(auto& field : edgeFields) {
+    e.push_back(atlas::array::make_view<double, 2>(field));
+  }
+  atlasInterface::Field<double> div_vec = atlas::array::make_view<double, 2>(div_F);
+  atlasInterface::Field<double> rot_vec = atlas::array::make_view<double, 2>(rot_F);
+  atlasInterface::SparseDimension<double> geofac_rot =
+      atlas::array::make_view<double, 3>(geofac_rot_F);
+  atlasInterface::SparseDimension<double> geofac_div =
+      atlas::array::make_view<double, 3>(geofac_div_F);
+
+  // vec, nabla2t1, nabla2t2, nabla2, primal length, dual length, tangent orientation
+  for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+    e[0](edgeIdx, 0) = sin(0.1 * edgeIdx);
+    e[4](edgeIdx, 0) = 1. + 0.5 * sin(0.3 * edgeIdx);
+    e[5](edgeIdx, 0) = 1. + 0.5 * cos(0.7 * edgeIdx);
+    e[6](edgeIdx, 0) = (edgeIdx % 2 == 0) ? 1. : -1.;
+  }
+  for(int nodeIdx = 0; nodeIdx < numNodes; nodeIdx++) {
+    for(int nbhIdx = 0; nbhIdx < 6; nbhIdx++) {
+      geofac_rot(nodeIdx, nbhIdx, 0) = cos(0.2 * nodeIdx + nbhIdx);
+    }
+  }
+  for(int cellIdx = 0; cellIdx < numCells; cellIdx++) {
+    for(int nbhIdx = 0; nbhIdx < 3; nbhIdx++) {
+      geofac_div(cellIdx, nbhIdx, 0) = sin(0.4 * cellIdx + nbhIdx);
+    }
+  }
+
+  auto start = Clock::now();
+  dawn_generated::cxxnaiveico::ICON_laplacian_stencil<Tag>(stencilMesh, k_size, e[0], div_vec,
+                                                           rot_vec, e[1], e[2], e[3], e[4], e[5],
+                                                           e[6], geofac_rot, geofac_div)
+      .run();
+  double time = SecondsSince(start);
+
+  std::vector<double> result(numEdges);
+  for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+    result[edgeIdx] = e[3](edgeIdx, 0);
+  }
+  return {result, time};
+}
+
+void checkMesh(atlas::Mesh& mesh, const std::string& name) {
+  auto latticeOpt = AtlasLatticeFromMesh(mesh);
+  assert(latticeOpt.has_value());
+  const AtlasLattice& lattice = latticeOpt.value();
+  checkPositions(mesh, lattice);
+  bool sorted = AtlasSortByLattice(mesh, lattice);
+  assert(sorted);
+  checkNeighbors(mesh, lattice);
+
+  auto [atlasResult, atlasTime] = runLaplacian<atlasInterface::atlasTag>(mesh, mesh);
+  auto [latticeResult, latticeTime] = runLaplacian<atlasLatticeInterface::atlasLatticeTag>(
+      mesh, atlasLatticeInterface::LatticeMesh(mesh, lattice));
+  assert(atlasResult == latticeResult);
+  printf("%s: %d x %d lattice, laplacian atlas %.3f ms, lattice %.3f ms\n", name.c_str(),
+         lattice.nI(), lattice.nJ(), 1e3 * atlasTime, 1e3 * latticeTime);
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  {
+    atlas::Mesh mesh = AtlasMeshRectComplete(24);
+    checkMesh(mesh, "AtlasMeshRectComplete(24)");
+  }
+  {
+    atlas::Mesh mesh = AtlasMeshSquareComplete(17);
+    checkMesh(mesh, "AtlasMeshSquareComplete(17)");
+  }
+  {
+    atlas::Mesh mesh = AtlasMeshRect(16);
+    atlas::mesh::actions::build_edges(mesh, atlas::util::Config("pole_edges", false));
+    atlas::mesh::actions::build_node_to_edge_connectivity(mesh);
+    atlas::mesh::actions::build_element_to_edge_connectivity(mesh);
+    checkMesh(mesh, "AtlasMeshRect(16)");
+  }
+  if(argc == 2) {
+    auto meshOpt = AtlasMeshFromNetCDFComplete(argv[1]);
+    assert(meshOpt.has_value());
+    // the projected coordinates are stored as lonlat
+    atlas::Mesh mesh = meshOpt.value();
+    auto lonlat = atlas::array::make_view<double, 2>(mesh.nodes().lonlat());
+    auto xy = atlas::array::make_view<double, 2>(mesh.nodes().xy());
+    for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+      xy(nodeIdx, atlas::LON) = lonlat(nodeIdx, atlas::LON);
+      xy(nodeIdx, atlas::LAT) = lonlat(nodeIdx, atlas::LAT);
+    }
+    checkMesh(mesh, argv[1]);
+  }
+  atlas::Library::instance().finalise();
+  std::cout << "lattice backend matches the atlas backend\n";
+}
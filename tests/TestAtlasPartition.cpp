@@ -0,0 +1,187 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks the partitioner on generated rectangular meshes:
+//  - parts are balanced and refinement does not increase the edge cut
+//  - every cell is owned by exactly one part, the halo layers contain all cells sharing a node with
+//    the previous layer
+//  - partition, remote_index, ghost and global_index of all elements point to the same element on
+//    the owning part
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <atlas/library/Library.h>
+#include <atlas/mesh/Mesh.h>
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/AtlasPartition.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+
+namespace {
+void checkBalance(const std::vector<int>& cellPart, int numParts, double maxImbalance) {
+  std::vector<int> partSize(numParts, 0);
+  for(int part : cellPart) {
+    assert(part >= 0 && part < numParts);
+    partSize[part]++;
+  }
+  auto [minSize, maxSize] = std::minmax_element(partSize.begin(), partSize.end());
+  assert(*minSize > 0);
+  assert(*minSize >= int(floor(double(cellPart.size()) / numParts / maxImbalance)));
+  assert(*maxSize <= int(ceil(maxImbalance * cellPart.size() / numParts)));
+}
+
+// cells sharing a node with each cell of mesh
+std::vector<std::vector<int>> nodeNeighborCells(const atlas::Mesh& mesh) {
+  const auto& cellToNode = mesh.cells().node_connectivity();
+  std::vector<std::vector<int>> nodeToCell(mesh.nodes().size());
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    for(int nbhIdx = 0; nbhIdx < cellToNode.cols(cellIdx); nbhIdx++) {
+      nodeToCell[cellToNode(cellIdx, nbhIdx)].push_back(cellIdx);
+    }
+  }
+  std::vector<std::vector<int>> neighbors(mesh.cells().size());
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    for(int nbhIdx = 0; nbhIdx < cellToNode.cols(cellIdx); nbhIdx++) {
+      for(int otherIdx : nodeToCell[cellToNode(cellIdx, nbhIdx)]) {
+        neighbors[cellIdx].push_back(otherIdx);
+      }
+    }
+  }
+  return neighbors;
+}
+
+void checkHalo(const atlas::Mesh& mesh, const AtlasPart& part, int haloDepth) {
+  const auto neighbors = nodeNeighborCells(mesh);
+  std::vector<int> layer(mesh.cells().size(), -1);
+  auto haloCell = atlas::array::make_view<int, 1>(part.mesh.cells().halo());
+  for(int cellIdx = 0; cellIdx < int(part.indices.cells.size()); cellIdx++) {
+    layer[part.indices.cells[cellIdx]] = haloCell(cellIdx);
+    assert((haloCell(cellIdx) == 0) == (cellIdx < part.numOwnedCells));
+  }
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    if(layer[cellIdx] == -1 || layer[cellIdx] == haloDepth) {
+      continue;
+    }
+    for(int nbhIdx : neighbors[cellIdx]) {
+      assert(layer[nbhIdx] != -1 && layer[nbhIdx] <= layer[cellIdx] + 1);
+    }
+  }
+}
+
+// the element at remoteIdx of the owning part is the same element (same index in the input mesh)
+void checkRemote(const std::vector<AtlasPart>& parts, int partIdx,
+                 const std::vector<int> AtlasSubMeshIndices::*indices,
+                 const atlas::Field& partField, const atlas::Field& remoteField) {
+  auto partView = atlas::array::make_view<int, 1>(partField);
+  auto remoteIdx = atlas::array::make_indexview<atlas::idx_t, 1>(remoteField);
+  const std::vector<int>& old = parts[partIdx].indices.*indices;
+  for(int idx = 0; idx < int(old.size()); idx++) {
+    const int owner = partView(idx);
+    assert(owner >= 0 && owner < int(parts.size()));
+    const std::vector<int>& ownerOld = parts[owner].indices.*indices;
+    assert(remoteIdx(idx) >= 0 && remoteIdx(idx) < int(ownerOld.size()));
+    assert(ownerOld[remoteIdx(idx)] == old[idx]);
+  }
+}
+
+void checkParts(const atlas::Mesh& mesh, const std::vector<int>& cellPart,
+                const std::vector<AtlasPart>& parts, int haloDepth, bool complete) {
+  auto glbIdxNodeIn = atlas::array::make_view<atlas::gidx_t, 1>(mesh.nodes().global_index());
+  auto glbIdxCellIn = atlas::array::make_view<atlas::gidx_t, 1>(mesh.cells().global_index());
+
+  std::vector<int> timesOwned(mesh.cells().size(), 0);
+  for(int partIdx = 0; partIdx < int(parts.size()); partIdx++) {
+    const AtlasPart& part = parts[partIdx];
+    const atlas::Mesh& partMesh = part.mesh;
+
+    auto glbIdxCell = atlas::array::make_view<atlas::gidx_t, 1>(partMesh.cells().global_index());
+    auto partCell = atlas::array::make_view<int, 1>(partMesh.cells().partition());
+    for(int cellIdx = 0; cellIdx < int(part.indices.cells.size()); cellIdx++) {
+      const int oldIdx = part.indices.cells[cellIdx];
+      assert(glbIdxCell(cellIdx) == glbIdxCellIn(oldIdx));
+      assert(partCell(cellIdx) == cellPart[oldIdx]);
+      assert((cellIdx < part.numOwnedCells) == (cellPart[oldIdx] == partIdx));
+      timesOwned[oldIdx] += cellIdx < part.numOwnedCells;
+    }
+
+    auto glbIdxNode = atlas::array::make_view<atlas::gidx_t, 1>(partMesh.nodes().global_index());
+    auto partNode = atlas::array::make_view<int, 1>(partMesh.nodes().partition());
+    auto ghost = atlas::array::make_view<int, 1>(partMesh.nodes().ghost());
+    for(int nodeIdx = 0; nodeIdx < int(part.indices.nodes.size()); nodeIdx++) {
+      assert(glbIdxNode(nodeIdx) == glbIdxNodeIn(part.indices.nodes[nodeIdx]));
+      assert(ghost(nodeIdx) == (partNode(nodeIdx) != partIdx));
+    }
+
+    checkRemote(parts, partIdx, &AtlasSubMeshIndices::cells, partMesh.cells().partition(),
+                partMesh.cells().remote_index());
+    checkRemote(parts, partIdx, &AtlasSubMeshIndices::nodes, partMesh.nodes().partition(),
+                partMesh.nodes().remote_index());
+    if(complete) {
+      checkRemote(parts, partIdx, &AtlasSubMeshIndices::edges, partMesh.edges().partition(),
+                  partMesh.edges().remote_index());
+      // edges are the same edges as in the input mesh
+      const auto& edgeToNodeIn = mesh.edges().node_connectivity();
+      const auto& edgeToNode = partMesh.edges().node_connectivity();
+      for(int edgeIdx = 0; edgeIdx < int(part.indices.edges.size()); edgeIdx++) {
+        const int oldIdx = part.indices.edges[edgeIdx];
+        for(int nbhIdx = 0; nbhIdx < 2; nbhIdx++) {
+          assert(part.indices.nodes[edgeToNode(edgeIdx, nbhIdx)] == edgeToNodeIn(oldIdx, nbhIdx));
+        }
+      }
+    }
+    checkHalo(mesh, part, haloDepth);
+  }
+  assert(std::all_of(timesOwned.begin(), timesOwned.end(), [](int n) { return n == 1; }));
+}
+
+void checkMesh(const atlas::Mesh& mesh, const std::string& name, bool complete) {
+  AtlasToCartesian wrapper(mesh, false);
+  for(int numParts : {1, 3, 8}) {
+    std::vector<int> cellPart = AtlasPartitionCells(mesh, wrapper, numParts);
+    std::vector<int> cellPartRefined = AtlasPartitionCells(mesh, wrapper, numParts, true);
+    checkBalance(cellPart, numParts, 1.);
+    checkBalance(cellPartRefined, numParts, 1.03);
+    const int cut = AtlasPartitionEdgeCut(mesh, cellPart);
+    const int cutRefined = AtlasPartitionEdgeCut(mesh, cellPartRefined);
+    assert(cutRefined <= cut);
+    std::cout << name << ": " << numParts << " parts, edge cut " << cut << " (bisection), "
+              << cutRefined << " (refined)\n";
+
+    for(int haloDepth : {0, 1, 2}) {
+      auto parts = complete
+                       ? AtlasPartitionMeshComplete(mesh, cellPartRefined, numParts, haloDepth)
+                       : AtlasPartitionMeshMinimal(mesh, cellPartRefined, numParts, haloDepth);
+      checkParts(mesh, cellPartRefined, parts, haloDepth, complete);
+    }
+  }
+}
+} // namespace
+
+int main() {
+  {
+    atlas::Mesh mesh = AtlasMeshRectComplete(40);
+    checkMesh(mesh, "AtlasMeshRectComplete(40)", true);
+  }
+  {
+    atlas::Mesh mesh = AtlasMeshRect(30);
+    checkMesh(mesh, "AtlasMeshRect(30)", false);
+  }
+  atlas::Library::instance().finalise();
+  std::cout << "partitions are consistent\n";
+}
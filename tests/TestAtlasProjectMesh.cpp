@@ -13,10 +13,14 @@
 //===------------------------------------------------------------------------------------------===//
 
 #include <assert.h>
+#include <cstdlib>
 #include <iostream>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include <atlas/array.h>
 #include <atlas/library/Library.h>
 #include <atlas/mesh/HybridElements.h>
 #include <atlas/mesh/Mesh.h>
@@ -29,25 +33,92 @@
 #include "../utils/AtlasProjectMesh.h"
 #include "../utils/AtlasToNetcdf.h"
 
+namespace {
+template <typename ConnT>
+void checkSameTable(const ConnT& conn, const ConnT& other) {
+  assert(conn.rows() == other.rows());
+  for(int row = 0; row < conn.rows(); row++) {
+    assert(conn.cols(row) == other.cols(row));
+    for(int col = 0; col < conn.cols(row); col++) {
+      assert(conn(row, col) == other(row, col));
+    }
+  }
+}
+
+// same elements, coordinates and neighbor tables
+void checkSameMesh(const atlas::Mesh& mesh, const atlas::Mesh& other) {
+  assert(mesh.nodes().size() > 0 && mesh.edges().size() > 0 && mesh.cells().size() > 0);
+  assert(mesh.nodes().size() == other.nodes().size());
+  assert(mesh.edges().size() == other.edges().size());
+  assert(mesh.cells().size() == other.cells().size());
+  auto xy = atlas::array::make_view<double, 2>(mesh.nodes().xy());
+  auto xyOther = atlas::array::make_view<double, 2>(other.nodes().xy());
+  for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
+    assert(xy(nodeIdx, atlas::LON) == xyOther(nodeIdx, atlas::LON));
+    assert(xy(nodeIdx, atlas::LAT) == xyOther(nodeIdx, atlas::LAT));
+  }
+  checkSameTable(mesh.cells().node_connectivity(), other.cells().node_connectivity());
+  checkSameTable(mesh.cells().edge_connectivity(), other.cells().edge_connectivity());
+  checkSameTable(mesh.edges().node_connectivity(), other.edges().node_connectivity());
+  checkSameTable(mesh.edges().cell_connectivity(), other.edges().cell_connectivity());
+  checkSameTable(mesh.nodes().edge_connectivity(), other.nodes().edge_connectivity());
+}
+} // namespace
+
 int main(int argc, char const* argv[]) {
-  if(argc != 3) {
+  if(argc != 3 && argc != 5) {
     std::cout << "intended use is\n"
               << argv[0] << " input_file.nc"
-              << " output_file.nc" << std::endl;
+              << " output_file.nc [startFace numFaces]" << std::endl;
     return -1;
   }
   std::string inFname(argv[1]);
   std::string outFname(argv[2]);
+  const int icosahedralFaces = 20;
+  const int startFace = argc == 5 ? atoi(argv[3]) : 5;
+  const int numFace = argc == 5 ? atoi(argv[4]) : 5;
+  if(startFace < 0 || numFace < 1 || startFace + numFace > icosahedralFaces) {
+    std::cout << "the face range needs to be within the " << icosahedralFaces
+              << " icosahedral faces\n";
+    return -1;
+  }
 
   auto meshInOpt = AtlasMeshFromNetCDFComplete(inFname);
   assert(meshInOpt.has_value());
   atlas::Mesh meshIn = meshInOpt.value();
-  const int startFace = 5;
-  const int numFace = 5;
+
+  // only ranges of the equatorial band (faces 5 to 14) are orientable, see AtlasProjectMesh.h
+  auto orientable = [](int start, int num) { return start >= 5 && start + num <= 15; };
+  for(auto [start, num] : std::vector<std::pair<int, int>>{{0, 5}, {10, 6}, {15, 5}, {5, 0}}) {
+    assert(!AtlasProjectMesh(meshIn, start, num).has_value());
+  }
+  if(!orientable(startFace, numFace)) {
+    assert(!AtlasProjectMesh(meshIn, startFace, numFace).has_value());
+    std::cout << "faces " << startFace << " to " << startFace + numFace - 1
+              << " are not orientable, no projection\n";
+    return 0;
+  }
+
   auto meshProjectedOpt = AtlasProjectMesh(meshIn, startFace, numFace);
   assert(meshProjectedOpt.has_value());
   atlas::Mesh meshProjected = meshProjectedOpt.value();
   AtlasToNetCDF(meshProjected, outFname);
 
+  // projecting several face ranges at once needs to reproduce the single range projection of
+  // every range, and reject the same ranges
+  const std::vector<std::pair<int, int>> faceRanges = {
+      {startFace, numFace}, {startFace + numFace, numFace}, {0, 5}};
+  auto meshesProjected = AtlasProjectMeshFaces(meshIn, faceRanges);
+  assert(meshesProjected.size() == faceRanges.size());
+  for(size_t rangeIdx = 0; rangeIdx < faceRanges.size(); rangeIdx++) {
+    auto [rangeStart, rangeSize] = faceRanges[rangeIdx];
+    auto singleOpt = AtlasProjectMesh(meshIn, rangeStart, rangeSize);
+    assert(singleOpt.has_value() == orientable(rangeStart, rangeSize));
+    assert(meshesProjected[rangeIdx].has_value() == singleOpt.has_value());
+    if(singleOpt.has_value()) {
+      checkSameMesh(singleOpt.value(), meshesProjected[rangeIdx].value());
+    }
+  }
+
   std::cout << "projection ran succesfully!\n";
 }
\ No newline at end of file
@@ -0,0 +1,184 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks the conservative remap between rectangular meshes of different resolution:
+//  - remapping a mesh onto itself gives the identity
+//  - row sums are at most one, and one for destination cells covered by the source mesh
+//  - the integral of a field over the destination mesh equals the integral of the source field
+//    over the area both meshes cover, and a smooth field is reproduced up to the resolution
+//  - persisted weights are read back unchanged and give the same result
+// Reports the time needed to compute the weights and to apply them.
+
+#include <assert.h>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <atlas/array.h>
+#include <atlas/field.h>
+#include <atlas/library/Library.h>
+#include <atlas/mesh/Mesh.h>
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/AtlasRemap.h"
+#include "../utils/CsrMatrix.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/WallClock.h"
+
+namespace {
+atlas::Field MakeCellField(const std::string& name, const atlas::Mesh& mesh,
+                           const AtlasToCartesian& wrapper, int k_size) {
+  atlas::Field field{name, atlas::array::DataType::real64(),
+                     atlas::array::make_shape(mesh.cells().size(), k_size)};
+  auto view = atlas::array::make_view<double, 2>(field);
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    auto [x, y] = wrapper.cellMidpoint(mesh, cellIdx);
+    for(int k = 0; k < k_size; k++) {
+      view(cellIdx, k) = (k + 1) * (sin(x / 60.) + y / 90.);
+    }
+  }
+  return field;
+}
+
+void checkIdentity(const atlas::Mesh& mesh) {
+  AtlasToCartesian wrapper(mesh, false);
+  CsrMatrix weights = AtlasConservativeRemapWeights(mesh, wrapper, mesh, wrapper);
+  assert(weights.numRows == mesh.cells().size() && weights.numCols == mesh.cells().size());
+  for(int row = 0; row < weights.numRows; row++) {
+    assert(weights.rowStart[row + 1] - weights.rowStart[row] == 1);
+    assert(weights.colIdx[weights.rowStart[row]] == row);
+    assert(fabs(weights.values[weights.rowStart[row]] - 1.) < 1e-12);
+  }
+}
+
+void checkRemap(const atlas::Mesh& src, const atlas::Mesh& dst, const std::string& name) {
+  const int k_size = 4;
+  AtlasToCartesian srcWrapper(src, false);
+  AtlasToCartesian dstWrapper(dst, false);
+
+  auto start = Clock::now();
+  CsrMatrix weights = AtlasConservativeRemapWeights(src, srcWrapper, dst, dstWrapper);
+  const double timeWeights = SecondsSince(start);
+
+  std::vector<double> rowSums = CsrRowSums(weights);
+  int numCovered = 0;
+  for(double rowSum : rowSums) {
+    assert(rowSum <= 1. + 1e-12);
+    numCovered += fabs(rowSum - 1.) < 1e-12;
+  }
+  // the meshes only differ along the zig zag rims on the left and right
+  assert(numCovered > 0.9 * dst.cells().size());
+
+  atlas::Field srcField = MakeCellField("src", src, srcWrapper, k_size);
+  atlas::Field dstExact = MakeCellField("exact", dst, dstWrapper, k_size);
+  atlas::Field dstField{"dst", atlas::array::DataType::real64(),
+                        atlas::array::make_shape(dst.cells().size(), k_size)};
+  start = Clock::now();
+  AtlasRemapCellField(weights, srcField, dstField);
+  const double timeApply = SecondsSince(start);
+
+  // integral over the destination mesh vs. integral over the covered part of the source cells,
+  // using the column sums of the area weighted matrix as the covered area of each source cell
+  auto srcView = atlas::array::make_view<double, 2>(srcField);
+  auto dstView = atlas::array::make_view<double, 2>(dstField);
+  auto exactView = atlas::array::make_view<double, 2>(dstExact);
+  std::vector<double> coveredArea(src.cells().size(), 0.);
+  for(int row = 0; row < weights.numRows; row++) {
+    for(int pos = weights.rowStart[row]; pos < weights.rowStart[row + 1]; pos++) {
+      coveredArea[weights.colIdx[pos]] += weights.values[pos] * dstWrapper.cellArea(dst, row);
+    }
+  }
+  for(int k = 0; k < k_size; k++) {
+    double integralDst = 0.;
+    double integralSrc = 0.;
+    double totalArea = 0.;
+    for(int cellIdx = 0; cellIdx < dst.cells().size(); cellIdx++) {
+      integralDst += dstWrapper.cellArea(dst, cellIdx) * dstView(cellIdx, k);
+      totalArea += dstWrapper.cellArea(dst, cellIdx);
+    }
+    for(int cellIdx = 0; cellIdx < src.cells().size(); cellIdx++) {
+      integralSrc += coveredArea[cellIdx] * srcView(cellIdx, k);
+    }
+    assert(fabs(integralDst - integralSrc) < 1e-9 * totalArea * (k + 1));
+  }
+
+  double maxError = 0.;
+  for(int cellIdx = 0; cellIdx < dst.cells().size(); cellIdx++) {
+    if(fabs(rowSums[cellIdx] - 1.) < 1e-12) {
+      maxError = fmax(maxError, fabs(dstView(cellIdx, 0) - exactView(cellIdx, 0)));
+    }
+  }
+  assert(maxError < 0.1);
+
+  // persisted weights give bit identical results
+  const std::string fname = "remapWeights.bin";
+  assert(CsrWrite(weights, fname));
+  auto weightsRead = CsrRead(fname);
+  assert(weightsRead.has_value());
+  assert(weightsRead->numRows == weights.numRows && weightsRead->numCols == weights.numCols);
+  assert(weightsRead->rowStart == weights.rowStart && weightsRead->colIdx == weights.colIdx);
+  assert(weightsRead->values == weights.values);
+  atlas::Field dstFieldRead{"dstRead", atlas::array::DataType::real64(),
+                            atlas::array::make_shape(dst.cells().size(), k_size)};
+  AtlasRemapCellField(weightsRead.value(), srcField, dstFieldRead);
+  auto dstReadView = atlas::array::make_view<double, 2>(dstFieldRead);
+  for(int cellIdx = 0; cellIdx < dst.cells().size(); cellIdx++) {
+    for(int k = 0; k < k_size; k++) {
+      assert(dstReadView(cellIdx, k) == dstView(cellIdx, k));
+    }
+  }
+
+  // truncated files and headers not matching the file size are rejected (without allocating
+  // the arrays the header claims)
+  std::vector<char> bytes;
+  FILE* in = fopen(fname.c_str(), "rb");
+  for(int c = fgetc(in); c != EOF; c = fgetc(in)) {
+    bytes.push_back(c);
+  }
+  fclose(in);
+  auto writeBytes = [&](const std::vector<char>& content, size_t size) {
+    FILE* out = fopen(fname.c_str(), "wb");
+    fwrite(content.data(), 1, size, out);
+    fclose(out);
+  };
+  writeBytes(bytes, bytes.size() / 2);
+  assert(!CsrRead(fname).has_value());
+  // numNonZeros is the third int64 of the header, which follows the 8 byte magic
+  std::vector<char> corrupt = bytes;
+  const int64_t hugeNonZeros = std::numeric_limits<int>::max();
+  memcpy(corrupt.data() + 8 + 2 * sizeof(int64_t), &hugeNonZeros, sizeof(hugeNonZeros));
+  writeBytes(corrupt, corrupt.size());
+  assert(!CsrRead(fname).has_value());
+  writeBytes(bytes, bytes.size());
+  assert(CsrRead(fname).has_value());
+  remove(fname.c_str());
+
+  std::cout << name << ": " << weights.numNonZeros() << " weights, max error " << maxError
+            << ", weights computed in " << timeWeights << " s, applied to " << k_size
+            << " levels in " << timeApply << " s\n";
+}
+} // namespace
+
+int main() {
+  checkIdentity(AtlasMeshRect(10));
+  checkRemap(AtlasMeshRect(16), AtlasMeshRect(24), "AtlasMeshRect(16) -> AtlasMeshRect(24)");
+  checkRemap(AtlasMeshRect(32), AtlasMeshRect(12), "AtlasMeshRect(32) -> AtlasMeshRect(12)");
+  atlas::Library::instance().finalise();
+  std::cout << "remapped fields are conservative\n";
+}
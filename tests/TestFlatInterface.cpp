@@ -0,0 +1,135 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks that the flat backend reproduces the neighborhoods of the backend of the mesh it was
+// converted from, element by element and including the order of the neighbors:
+//  - FlatMeshFromToylib against the toylib backend, on regular (periodic and non periodic) grids
+//    and the rectangular toylib mesh
+//  - FlatMeshFromAtlas against the atlas backend, on the complete rectangular atlas mesh
+// Furthermore the reductions of the flat backend need to visit the same neighbors.
+
+#include <assert.h>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <atlas/library/Library.h>
+#include <atlas/mesh/Mesh.h>
+
+#include "../stencils/interfaces/atlas_interface.hpp"
+#include "../stencils/interfaces/flat_interface.hpp"
+#include "../stencils/interfaces/toylib_interface.hpp"
+#include "../utils/FlatMesh.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/GenerateRectToylibMesh.h"
+
+namespace {
+using dawn::LocationType;
+using flatInterface::flatTag;
+
+const std::vector<std::vector<LocationType>> chains = {
+    {LocationType::Cells, LocationType::Edges},
+    {LocationType::Cells, LocationType::Vertices},
+    {LocationType::Edges, LocationType::Cells},
+    {LocationType::Edges, LocationType::Vertices},
+    {LocationType::Vertices, LocationType::Cells},
+    {LocationType::Vertices, LocationType::Edges},
+    // diamond
+    {LocationType::Edges, LocationType::Cells, LocationType::Vertices},
+    // cells sharing an edge
+    {LocationType::Cells, LocationType::Edges, LocationType::Cells},
+};
+
+int numElements(const FlatMesh& mesh, LocationType type) {
+  return mesh.size(FlatLocation(int(type)));
+}
+
+// checks the flat neighbors of all elements against ref(chain, idx), which returns the neighbors
+// of the reference backend as flat indices
+template <typename RefFn>
+void checkChains(const FlatMesh& mesh, RefFn&& ref) {
+  for(const auto& chain : chains) {
+    for(int idx = 0; idx < numElements(mesh, chain.front()); idx++) {
+      std::vector<int> flat = getNeighbors(flatTag{}, mesh, chain, idx);
+      assert(flat == ref(chain, idx));
+      std::vector<int> visited = reduce(flatTag{}, mesh, idx, std::vector<int>{}, chain,
+                                        [](std::vector<int>& lhs, int nbh) { lhs.push_back(nbh); });
+      assert(visited == flat);
+    }
+  }
+}
+
+void checkToylib(const toylib::Grid& grid, const std::string& name) {
+  std::vector<int> toylibEdge;
+  FlatMesh mesh = FlatMeshFromToylib(grid, toylibEdge);
+  assert(mesh.numCells() == int(grid.faces().size()));
+  assert(mesh.numEdges() == int(grid.edges().size()));
+  assert(mesh.numVertices() == int(grid.vertices().size()));
+  std::vector<int> flatEdge(grid.all_edges().size(), -1);
+  for(int edgeIdx = 0; edgeIdx < mesh.numEdges(); edgeIdx++) {
+    flatEdge[toylibEdge[edgeIdx]] = edgeIdx;
+  }
+
+  // every cell has three edges and nodes, every edge two nodes
+  assert(mesh.table(FlatLocation::Cells, FlatLocation::Edges).width() == 3);
+  assert(mesh.table(FlatLocation::Cells, FlatLocation::Vertices).width() == 3);
+  assert(mesh.table(FlatLocation::Edges, FlatLocation::Vertices).width() == 2);
+
+  checkChains(mesh, [&](const std::vector<LocationType>& chain, int idx) {
+    const toylib::ToylibElement* elem;
+    switch(chain.front()) {
+    case LocationType::Cells:
+      elem = &grid.faces()[idx];
+      break;
+    case LocationType::Edges:
+      elem = &grid.edges()[idx].get();
+      break;
+    default:
+      elem = &grid.vertices()[idx];
+      break;
+    }
+    std::vector<int> nbhs;
+    for(const auto* nbh : getNeighbors(toylibInterface::toylibTag{}, grid, chain, elem)) {
+      nbhs.push_back(chain.back() == LocationType::Edges ? flatEdge[nbh->id()] : nbh->id());
+    }
+    return nbhs;
+  });
+  std::cout << name << ": " << mesh.numVertices() << " nodes, " << mesh.numEdges() << " edges, "
+            << mesh.numCells() << " cells, " << mesh.bytes() << " bytes of neighbor tables\n";
+}
+
+void checkAtlas(const atlas::Mesh& atlasMesh, const std::string& name) {
+  FlatMesh mesh = FlatMeshFromAtlas(atlasMesh);
+  assert(mesh.numCells() == atlasMesh.cells().size());
+  assert(mesh.numEdges() == atlasMesh.edges().size());
+  assert(mesh.numVertices() == atlasMesh.nodes().size());
+  // boundary edges have a single cell
+  assert(mesh.table(FlatLocation::Edges, FlatLocation::Cells).width() == 0);
+
+  checkChains(mesh, [&](const std::vector<LocationType>& chain, int idx) {
+    return getNeighbors(atlasInterface::atlasTag{}, atlasMesh, chain, idx);
+  });
+  std::cout << name << ": " << mesh.numVertices() << " nodes, " << mesh.numEdges() << " edges, "
+            << mesh.numCells() << " cells, " << mesh.bytes() << " bytes of neighbor tables\n";
+}
+} // namespace
+
+int main() {
+  checkToylib(toylib::Grid(7, 5, false), "toylib::Grid(7, 5)");
+  checkToylib(toylib::Grid(8, 6, true), "toylib::Grid(8, 6, periodic)");
+  checkToylib(toylibMeshRect(10), "toylibMeshRect(10)");
+  checkAtlas(AtlasMeshRectComplete(10), "AtlasMeshRectComplete(10)");
+  atlas::Library::instance().finalise();
+  std::cout << "flat neighborhoods match toylib and atlas\n";
+}
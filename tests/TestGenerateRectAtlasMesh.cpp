@@ -0,0 +1,144 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks that AtlasMeshRectComplete / AtlasMeshSquareComplete generate the same mesh as
+// AtlasMeshRect / AtlasMeshSquare followed by the atlas build actions: the same number of nodes,
+// edges and cells, the same node coordinates and the same neighbor tables. The numbering differs,
+// so elements are matched by their coordinates (nodes) and their nodes (edges and cells), and the
+// neighbors of every element are compared as sets.
+
+#include <algorithm>
+#include <assert.h>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <atlas/array.h>
+#include <atlas/mesh/Mesh.h>
+#include <atlas/mesh/actions/BuildEdges.h>
+#include <atlas/util/CoordinateEnums.h>
+
+#include "../utils/GenerateRectAtlasMesh.h"
+
+namespace {
+// the neighbors in row of conn, mapped by toRef and sorted. missing values are dropped
+template <typename ConnT>
+std::vector<int> mappedRow(const ConnT& conn, int row, const std::vector<int>& toRef) {
+  std::vector<int> nbh;
+  for(int col = 0; col < conn.cols(row); col++) {
+    if(conn(row, col) != conn.missing_value()) {
+      nbh.push_back(toRef.empty() ? conn(row, col) : toRef[conn(row, col)]);
+    }
+  }
+  std::sort(nbh.begin(), nbh.end());
+  return nbh;
+}
+
+// the reference meshes have no node to cell table, the cells are collected via the edges
+std::vector<int> nodeCells(const atlas::Mesh& mesh, int nodeIdx) {
+  std::set<int> cells;
+  const auto& edgeToCell = mesh.edges().cell_connectivity();
+  for(int edgeIdx : mappedRow(mesh.nodes().edge_connectivity(), nodeIdx, {})) {
+    for(int cellIdx : mappedRow(edgeToCell, edgeIdx, {})) {
+      cells.insert(cellIdx);
+    }
+  }
+  return std::vector<int>(cells.begin(), cells.end());
+}
+
+// index into ref of every element of complete, matched by its (sorted, mapped) nodes
+template <typename ConnT>
+std::vector<int> matchByNodes(const ConnT& completeToNode, const ConnT& refToNode,
+                              const std::vector<int>& nodeToRef) {
+  std::map<std::vector<int>, int> refIdx;
+  for(int idx = 0; idx < refToNode.rows(); idx++) {
+    refIdx[mappedRow(refToNode, idx, {})] = idx;
+  }
+  std::vector<int> toRef(completeToNode.rows());
+  for(int idx = 0; idx < completeToNode.rows(); idx++) {
+    auto it = refIdx.find(mappedRow(completeToNode, idx, nodeToRef));
+    assert(it != refIdx.end());
+    toRef[idx] = it->second;
+  }
+  return toRef;
+}
+
+void checkEquivalent(atlas::Mesh complete, atlas::Mesh ref, const std::string& name) {
+  atlas::mesh::actions::build_edges(ref, atlas::util::Config("pole_edges", false));
+  atlas::mesh::actions::build_node_to_edge_connectivity(ref);
+  atlas::mesh::actions::build_element_to_edge_connectivity(ref);
+
+  assert(complete.nodes().size() == ref.nodes().size());
+  assert(complete.edges().size() == ref.edges().size());
+  assert(complete.cells().size() == ref.cells().size());
+
+  // nodes are matched by their coordinates, which are multiples of the edge length
+  auto xyRef = atlas::array::make_view<double, 2>(ref.nodes().xy());
+  auto xyComplete = atlas::array::make_view<double, 2>(complete.nodes().xy());
+  auto key = [](double x, double y) { return std::make_pair(llround(1e6 * x), llround(1e6 * y)); };
+  std::map<std::pair<long long, long long>, int> refNode;
+  for(int nodeIdx = 0; nodeIdx < ref.nodes().size(); nodeIdx++) {
+    refNode[key(xyRef(nodeIdx, atlas::LON), xyRef(nodeIdx, atlas::LAT))] = nodeIdx;
+  }
+  assert(int(refNode.size()) == ref.nodes().size());
+  std::vector<int> nodeToRef(complete.nodes().size());
+  for(int nodeIdx = 0; nodeIdx < complete.nodes().size(); nodeIdx++) {
+    const double x = xyComplete(nodeIdx, atlas::LON);
+    const double y = xyComplete(nodeIdx, atlas::LAT);
+    auto it = refNode.find(key(x, y));
+    assert(it != refNode.end());
+    nodeToRef[nodeIdx] = it->second;
+    assert(fabs(xyRef(it->second, atlas::LON) - x) < 1e-9);
+    assert(fabs(xyRef(it->second, atlas::LAT) - y) < 1e-9);
+  }
+
+  const std::vector<int> edgeToRef = matchByNodes(complete.edges().node_connectivity(),
+                                                  ref.edges().node_connectivity(), nodeToRef);
+  const std::vector<int> cellToRef = matchByNodes(complete.cells().node_connectivity(),
+                                                  ref.cells().node_connectivity(), nodeToRef);
+  // the matching is a permutation
+  assert(std::set<int>(edgeToRef.begin(), edgeToRef.end()).size() == edgeToRef.size());
+  assert(std::set<int>(cellToRef.begin(), cellToRef.end()).size() == cellToRef.size());
+
+  for(int cellIdx = 0; cellIdx < complete.cells().size(); cellIdx++) {
+    assert(mappedRow(complete.cells().edge_connectivity(), cellIdx, edgeToRef) ==
+           mappedRow(ref.cells().edge_connectivity(), cellToRef[cellIdx], {}));
+  }
+  for(int edgeIdx = 0; edgeIdx < complete.edges().size(); edgeIdx++) {
+    assert(mappedRow(complete.edges().cell_connectivity(), edgeIdx, cellToRef) ==
+           mappedRow(ref.edges().cell_connectivity(), edgeToRef[edgeIdx], {}));
+  }
+  for(int nodeIdx = 0; nodeIdx < complete.nodes().size(); nodeIdx++) {
+    assert(mappedRow(complete.nodes().edge_connectivity(), nodeIdx, edgeToRef) ==
+           mappedRow(ref.nodes().edge_connectivity(), nodeToRef[nodeIdx], {}));
+    assert(mappedRow(complete.nodes().cell_connectivity(), nodeIdx, cellToRef) ==
+           nodeCells(ref, nodeToRef[nodeIdx]));
+  }
+  std::cout << name << ": " << complete.nodes().size() << " nodes, " << complete.edges().size()
+            << " edges, " << complete.cells().size() << " cells match\n";
+}
+} // namespace
+
+int main() {
+  for(int ny : {2, 5, 10, 17}) {
+    checkEquivalent(AtlasMeshRectComplete(ny), AtlasMeshRect(ny),
+                    "AtlasMeshRectComplete(" + std::to_string(ny) + ")");
+    checkEquivalent(AtlasMeshSquareComplete(ny), AtlasMeshSquare(ny),
+                    "AtlasMeshSquareComplete(" + std::to_string(ny) + ")");
+  }
+}
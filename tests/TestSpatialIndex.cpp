@@ -0,0 +1,170 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks the spatial index against brute force searches over all cells, for an atlas mesh and a
+// toylib grid:
+//  - box queries return the same cells as testing the bounding box / the corners of every cell
+//  - point location finds the cell containing a point, the lowest index one on shared edges, and
+//    nothing outside of the mesh
+// Reports the time needed for point location using the index and using brute force.
+
+#include <assert.h>
+#include <cmath>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <atlas/library/Library.h>
+#include <atlas/mesh/Mesh.h>
+
+#include "../utils/AtlasCartesianWrapper.h"
+#include "../utils/GenerateRectAtlasMesh.h"
+#include "../utils/GenerateRectToylibMesh.h"
+#include "../utils/SpatialIndex.h"
+#include "../utils/WallClock.h"
+
+namespace {
+bool contains(const std::array<Point, 3>& t, Point p) {
+  auto cross = [](Point a, Point b, Point p) {
+    return (std::get<0>(b) - std::get<0>(a)) * (std::get<1>(p) - std::get<1>(a)) -
+           (std::get<1>(b) - std::get<1>(a)) * (std::get<0>(p) - std::get<0>(a));
+  };
+  const double tol = 1e-12 * fabs(cross(t[0], t[1], t[2]));
+  const double d0 = cross(t[0], t[1], p);
+  const double d1 = cross(t[1], t[2], p);
+  const double d2 = cross(t[2], t[0], p);
+  return (d0 >= -tol && d1 >= -tol && d2 >= -tol) || (d0 <= tol && d1 <= tol && d2 <= tol);
+}
+
+int locateBruteForce(const SpatialIndex& index, Point p) {
+  for(int triangleIdx = 0; triangleIdx < index.size(); triangleIdx++) {
+    if(contains(index.triangle(triangleIdx), p)) {
+      return triangleIdx;
+    }
+  }
+  return -1;
+}
+
+void checkIndex(const SpatialIndex& index, const std::string& name) {
+  double xMin = std::numeric_limits<double>::max();
+  double yMin = std::numeric_limits<double>::max();
+  double xMax = -std::numeric_limits<double>::max();
+  double yMax = -std::numeric_limits<double>::max();
+  for(int triangleIdx = 0; triangleIdx < index.size(); triangleIdx++) {
+    for(auto [x, y] : index.triangle(triangleIdx)) {
+      xMin = fmin(x, xMin);
+      yMin = fmin(y, yMin);
+      xMax = fmax(x, xMax);
+      yMax = fmax(y, yMax);
+    }
+  }
+  const double lX = xMax - xMin;
+  const double lY = yMax - yMin;
+
+  std::mt19937 gen(42);
+  std::uniform_real_distribution<double> rx(xMin - 0.1 * lX, xMax + 0.1 * lX);
+  std::uniform_real_distribution<double> ry(yMin - 0.1 * lY, yMax + 0.1 * lY);
+  const double inf = std::numeric_limits<double>::infinity();
+
+  // box queries, including unbounded and empty boxes
+  std::vector<std::pair<Point, Point>> boxes = {{{xMin + 0.5 * lX, -inf}, {inf, inf}},
+                                                {{-inf, -inf}, {inf, inf}},
+                                                {{xMax, yMax}, {xMin, yMin}}};
+  for(int boxIdx = 0; boxIdx < 100; boxIdx++) {
+    auto [x0, x1] = std::minmax(rx(gen), rx(gen));
+    auto [y0, y1] = std::minmax(ry(gen), ry(gen));
+    boxes.push_back({{x0, y0}, {x1, y1}});
+  }
+  for(auto [lo, hi] : boxes) {
+    auto [xLo, yLo] = lo;
+    auto [xHi, yHi] = hi;
+    std::vector<int> inBox;
+    std::vector<int> cornerInBox;
+    for(int triangleIdx = 0; triangleIdx < index.size(); triangleIdx++) {
+      const auto& t = index.triangle(triangleIdx);
+      bool cornerIn = false;
+      double txMin = inf, tyMin = inf, txMax = -inf, tyMax = -inf;
+      for(auto [x, y] : t) {
+        txMin = fmin(x, txMin);
+        tyMin = fmin(y, tyMin);
+        txMax = fmax(x, txMax);
+        tyMax = fmax(y, tyMax);
+        cornerIn = cornerIn || (x > xLo && y > yLo && x < xHi && y < yHi);
+      }
+      if(txMin <= xHi && txMax >= xLo && tyMin <= yHi && tyMax >= yLo && xLo <= xHi &&
+         yLo <= yHi) {
+        inBox.push_back(triangleIdx);
+      }
+      if(cornerIn) {
+        cornerInBox.push_back(triangleIdx);
+      }
+    }
+    assert(index.trianglesInBox(lo, hi) == inBox);
+    assert(index.trianglesWithCornerInBox(lo, hi) == cornerInBox);
+  }
+
+  // point location: cell midpoints, corners (shared by several cells) and random points
+  std::vector<Point> points;
+  for(int triangleIdx = 0; triangleIdx < index.size(); triangleIdx++) {
+    const auto& t = index.triangle(triangleIdx);
+    points.push_back({(std::get<0>(t[0]) + std::get<0>(t[1]) + std::get<0>(t[2])) / 3.,
+                      (std::get<1>(t[0]) + std::get<1>(t[1]) + std::get<1>(t[2])) / 3.});
+    assert(index.locate(points.back()) == triangleIdx);
+    points.push_back(t[triangleIdx % 3]);
+  }
+  for(int pointIdx = 0; pointIdx < 1000; pointIdx++) {
+    points.push_back({rx(gen), ry(gen)});
+  }
+  points.push_back({xMax + lX, yMax + lY});
+
+  auto start = Clock::now();
+  std::vector<int> located(points.size());
+  for(size_t pointIdx = 0; pointIdx < points.size(); pointIdx++) {
+    located[pointIdx] = index.locate(points[pointIdx]);
+  }
+  const double timeIndex = SecondsSince(start);
+  start = Clock::now();
+  for(size_t pointIdx = 0; pointIdx < points.size(); pointIdx++) {
+    assert(located[pointIdx] == locateBruteForce(index, points[pointIdx]));
+  }
+  const double timeBruteForce = SecondsSince(start);
+  assert(located.back() == -1);
+
+  std::cout << name << ": " << index.size() << " cells, located " << points.size()
+            << " points in " << timeIndex << " s (brute force " << timeBruteForce << " s)\n";
+}
+} // namespace
+
+int main() {
+  {
+    atlas::Mesh mesh = AtlasMeshRect(24);
+    AtlasToCartesian wrapper(mesh, false);
+    auto start = Clock::now();
+    SpatialIndex index = AtlasSpatialIndex(mesh, wrapper);
+    std::cout << "built index of AtlasMeshRect(24) in " << SecondsSince(start) << " s\n";
+    checkIndex(index, "AtlasMeshRect(24)");
+  }
+  {
+    toylib::Grid grid = toylibMeshRect(20);
+    checkIndex(ToylibSpatialIndex(grid), "toylibMeshRect(20)");
+  }
+  {
+    toylib::Grid grid(20, 10, false, 1., 1., true);
+    checkIndex(ToylibSpatialIndex(grid, 8), "toylib::Grid(20, 10)");
+  }
+  atlas::Library::instance().finalise();
+  std::cout << "spatial index agrees with brute force search\n";
+}
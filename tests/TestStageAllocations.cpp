@@ -0,0 +1,62 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks that allocations are attributed to the stage they are made in (benchmarks/AllocationHook)
+// and that the bookkeeping of a stage (StageScope recording the call) is not attributed to it.
+
+#include <assert.h>
+#include <iostream>
+#include <vector>
+
+#include "../benchmarks/AllocationHook.h"
+#include "../utils/StageInstrumentation.h"
+
+namespace {
+// keeps the allocation of the allocating stage from being optimized away
+std::vector<double>* volatile sink = nullptr;
+
+double noAllocation(int n) {
+  // the name is longer than the small string buffer, s.t. recording the stage allocates
+  StageScope stage("test/stage_which_does_not_allocate");
+  double sum = 0.;
+  for(int i = 0; i < n; i++) {
+    sum += 1. / (i + 1);
+  }
+  stage.addElements(n);
+  return sum;
+}
+
+void allocation(int n) {
+  StageScope stage("test/stage_which_allocates");
+  sink = new std::vector<double>(n);
+}
+} // namespace
+
+int main() {
+  // repeated calls, s.t. the stage table and the trace events of the registry grow
+  double sum = 0.;
+  for(int call = 0; call < 100; call++) {
+    sum += noAllocation(1000);
+  }
+  assert(sum > 0.);
+  StageAllocations none = AllocationsOfStage("test/stage_which_does_not_allocate");
+  assert(none.allocations == 0 && none.bytes == 0);
+
+  allocation(1000);
+  delete sink;
+  StageAllocations some = AllocationsOfStage("test/stage_which_allocates");
+  assert(some.allocations >= 1 && some.bytes >= long(1000 * sizeof(double)));
+
+  std::cout << "allocations are attributed to the stages making them\n";
+}
@@ -0,0 +1,111 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Checks that the table free structured backend reproduces the neighborhoods of the toylib backend
+// element by element, including the order of the neighbors
+
+#include <assert.h>
+#include <iostream>
+#include <vector>
+
+#include "../stencils/interfaces/structured_interface.hpp"
+#include "../stencils/interfaces/toylib_interface.hpp"
+
+namespace {
+const std::vector<std::vector<dawn::LocationType>> chains = {
+    {dawn::LocationType::Cells, dawn::LocationType::Edges},
+    {dawn::LocationType::Cells, dawn::LocationType::Vertices},
+    {dawn::LocationType::Edges, dawn::LocationType::Cells},
+    {dawn::LocationType::Edges, dawn::LocationType::Vertices},
+    {dawn::LocationType::Vertices, dawn::LocationType::Cells},
+    {dawn::LocationType::Vertices, dawn::LocationType::Edges},
+    // diamond
+    {dawn::LocationType::Edges, dawn::LocationType::Cells, dawn::LocationType::Vertices},
+    // cells sharing an edge
+    {dawn::LocationType::Cells, dawn::LocationType::Edges, dawn::LocationType::Cells},
+};
+
+const toylib::ToylibElement* toylibElement(const toylib::Grid& grid, dawn::LocationType type,
+                                           int id) {
+  switch(type) {
+  case dawn::LocationType::Cells:
+    return &grid.faces()[id];
+  case dawn::LocationType::Edges:
+    return &grid.all_edges()[id];
+  default:
+    return &grid.vertices()[id];
+  }
+}
+
+template <bool periodic>
+void checkGrid(int nx, int ny) {
+  toylib::Grid grid(nx, ny, periodic);
+  structuredInterface::StructuredGrid<periodic> mesh(nx, ny);
+  using Tag = structuredInterface::structuredTag<periodic>;
+
+  std::vector<int> edgeIds;
+  for(int id : getEdges(Tag{}, mesh)) {
+    edgeIds.push_back(id);
+  }
+  assert(edgeIds.size() == grid.edges().size());
+  for(size_t idx = 0; idx < edgeIds.size(); idx++) {
+    assert(edgeIds[idx] == grid.edges()[idx].get().id());
+  }
+  assert(mesh.numEdgeIds() == int(grid.all_edges().size()));
+  assert(mesh.numCells() == int(grid.faces().size()));
+  assert(mesh.numVertices() == int(grid.vertices().size()));
+
+  auto checkChain = [&](const std::vector<dawn::LocationType>& chain, int id) {
+    std::vector<int> structured = getNeighbors(Tag{}, mesh, chain, id);
+    std::vector<const toylib::ToylibElement*> ref = toylibInterface::getNeighbors(
+        toylibInterface::toylibTag{}, grid, chain, toylibElement(grid, chain.front(), id));
+    assert(structured.size() == ref.size());
+    for(size_t idx = 0; idx < ref.size(); idx++) {
+      assert(structured[idx] == ref[idx]->id());
+    }
+    // the stack based reduction visits the same neighbors
+    std::vector<int> visited = reduce(Tag{}, mesh, id, std::vector<int>{}, chain,
+                                      [](std::vector<int>& lhs, int nbh) { lhs.push_back(nbh); });
+    assert(visited == structured);
+  };
+
+  for(const auto& chain : chains) {
+    switch(chain.front()) {
+    case dawn::LocationType::Cells:
+      for(int id : getCells(Tag{}, mesh)) {
+        checkChain(chain, id);
+      }
+      break;
+    case dawn::LocationType::Edges:
+      for(int id : edgeIds) {
+        checkChain(chain, id);
+      }
+      break;
+    case dawn::LocationType::Vertices:
+      for(int id : getVertices(Tag{}, mesh)) {
+        checkChain(chain, id);
+      }
+      break;
+    }
+  }
+}
+} // namespace
+
+int main() {
+  checkGrid<false>(2, 2);
+  checkGrid<false>(7, 5);
+  checkGrid<true>(2, 3);
+  checkGrid<true>(8, 6);
+  std::cout << "structured neighborhoods match toylib\n";
+}
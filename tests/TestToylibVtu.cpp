@@ -0,0 +1,162 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include <assert.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "toylib.hpp"
+
+namespace {
+// offset of each data array in the appended section, by name
+std::map<std::string, uint64_t> readOffsets(const std::string& vtu) {
+  std::map<std::string, uint64_t> offsets;
+  size_t pos = 0;
+  while((pos = vtu.find("Name=\"", pos)) != std::string::npos) {
+    pos += 6;
+    std::string name = vtu.substr(pos, vtu.find('"', pos) - pos);
+    size_t offsetPos = vtu.find("offset=\"", pos) + 8;
+    offsets[name] = std::stoull(vtu.substr(offsetPos, vtu.find('"', offsetPos) - offsetPos));
+  }
+  return offsets;
+}
+
+// the appended section starts after the '_' following the AppendedData tag
+const char* appendedData(const std::string& vtu) {
+  return vtu.data() + vtu.find('_', vtu.find("<AppendedData")) + 1;
+}
+
+// reads value idx of the array starting at offset in the appended section
+template <typename T>
+T readValue(const std::string& vtu, uint64_t offset, size_t idx) {
+  T value;
+  memcpy(&value, appendedData(vtu) + offset + sizeof(uint64_t) + idx * sizeof(T), sizeof(T));
+  return value;
+}
+
+// number of values in the array starting at offset, each array is preceded by its size in bytes
+template <typename T>
+uint64_t readSize(const std::string& vtu, uint64_t offset) {
+  uint64_t numBytes;
+  memcpy(&numBytes, appendedData(vtu) + offset, sizeof(uint64_t));
+  return numBytes / sizeof(T);
+}
+
+// values following "SCALARS name" in the legacy vtk output of toVtk
+std::vector<double> readLegacyScalars(const std::string& vtk, const std::string& name) {
+  std::istringstream is(vtk.substr(vtk.find("SCALARS " + name + " ")));
+  std::string line;
+  std::getline(is, line);
+  std::getline(is, line); // LOOKUP_TABLE
+  std::vector<double> values;
+  double value;
+  while(is >> value) {
+    values.push_back(value);
+  }
+  return values;
+}
+
+// the legacy writer averages edge and vertex fields onto the cells as the vtu writer does. the
+// legacy output is ascii with 6 significant digits
+void checkLegacyAverages(const toylib::Grid& grid, const toylib::EdgeData<double>& edgeField,
+                         const toylib::VertexData<double>& vertexField, const std::string& vtu,
+                         std::map<std::string, uint64_t>& offsets, size_t numCells, int kSize) {
+  std::stringstream edgeVtk, vertexVtk;
+  toylib::toVtk("edge", edgeField, grid, edgeVtk);
+  toylib::toVtk("vertex", vertexField, grid, vertexVtk);
+  std::vector<double> edgeValues = readLegacyScalars(edgeVtk.str(), "edge");
+  std::vector<double> vertexValues = readLegacyScalars(vertexVtk.str(), "vertex");
+  assert(edgeValues.size() == numCells * kSize);
+  assert(vertexValues.size() == numCells * kSize);
+  auto close = [](double a, double b) { return fabs(a - b) <= 1e-5 * std::max(1., fabs(b)); };
+  for(size_t idx = 0; idx < numCells * kSize; idx++) {
+    assert(close(edgeValues[idx], readValue<double>(vtu, offsets["edge"], idx)));
+    const int k = idx / numCells;
+    const auto& f = grid.faces()[readValue<int32_t>(vtu, offsets["id"], idx)];
+    double vertexAverage = 0.;
+    for(int vIdx = 0; vIdx < 3; vIdx++) {
+      vertexAverage += vertexField(f.vertex(vIdx), k);
+    }
+    assert(close(vertexValues[idx], vertexAverage / 3.));
+  }
+}
+
+void checkGrid(const toylib::Grid& grid, int kSize) {
+  toylib::FaceData<double> faceField(grid, kSize);
+  toylib::EdgeData<double> edgeField(grid, kSize);
+  toylib::VertexData<double> vertexField(grid, kSize);
+  for(int k = 0; k < kSize; k++) {
+    for(const auto& f : grid.faces()) {
+      faceField(f, k) = f.id() + 1000. * k;
+    }
+    for(const auto& e : grid.edges()) {
+      edgeField(e, k) = 1. + k + 0.1 * e.get().id();
+    }
+    for(const auto& v : grid.vertices()) {
+      vertexField(v, k) = v.x() + v.y() + k;
+    }
+  }
+
+  std::stringstream ss;
+  toylib::VtuWriter(grid, kSize)
+      .add("face", faceField)
+      .add("edge", edgeField)
+      .add("vertex", vertexField)
+      .write(ss);
+  std::string vtu = ss.str();
+  auto offsets = readOffsets(vtu);
+
+  const size_t numVertices = grid.vertices().size();
+  const size_t numCells = readSize<int32_t>(vtu, offsets["id"]) / kSize;
+  assert(readSize<double>(vtu, offsets["Points"]) == 3 * numVertices * kSize);
+  assert(readSize<int64_t>(vtu, offsets["connectivity"]) == 3 * numCells * kSize);
+  assert(readSize<double>(vtu, offsets["vertex"]) == numVertices * kSize);
+
+  for(int k = 0; k < kSize; k++) {
+    for(size_t cellIdx = 0; cellIdx < numCells; cellIdx++) {
+      size_t idx = k * numCells + cellIdx;
+      int32_t faceId = readValue<int32_t>(vtu, offsets["id"], idx);
+      assert(readValue<double>(vtu, offsets["face"], idx) == faceId + 1000. * k);
+      const auto& f = grid.faces()[faceId];
+      const double edgeAverage = (edgeField(f.edge(0), k) + edgeField(f.edge(1), k) +
+                                  edgeField(f.edge(2), k)) /
+                                 3.;
+      assert(readValue<double>(vtu, offsets["edge"], idx) == edgeAverage);
+      // vertices of level k are offset by k * numVertices
+      int64_t nodeIdx = readValue<int64_t>(vtu, offsets["connectivity"], 3 * idx);
+      assert(nodeIdx / int64_t(numVertices) == k);
+      assert(nodeIdx % int64_t(numVertices) == int64_t(grid.faces()[faceId].vertex(0).id()));
+    }
+    for(size_t nodeIdx = 0; nodeIdx < numVertices; nodeIdx++) {
+      const auto& v = grid.vertices()[nodeIdx];
+      assert(readValue<double>(vtu, offsets["vertex"], k * numVertices + nodeIdx) ==
+             v.x() + v.y() + k);
+      assert(readValue<double>(vtu, offsets["Points"], 3 * (k * numVertices + nodeIdx) + 2) == k);
+    }
+  }
+  checkLegacyAverages(grid, edgeField, vertexField, vtu, offsets, numCells, kSize);
+}
+} // namespace
+
+int main() {
+  checkGrid(toylib::Grid(8, 6), 3);
+  checkGrid(toylib::Grid(8, 6, true), 2);
+  std::cout << "vtu output matches the fields\n";
+}
@@ -0,0 +1,269 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Converts many dwd netcdf grids in one process. Every input file is read (AtlasFromNetcdf),
+// optionally projected onto the plane (AtlasProjectMesh) and written to the output directory under
+// the same file name (AtlasToNetcdf).
+//
+//  - files are processed by a pool of worker threads (-j)
+//  - at most a fixed number of meshes are alive at any time (-m), which bounds the memory used. a
+//    worker waits for a free slot before reading the next file
+//  - netcdf-c is not thread safe, all reads and writes are therefore serialized. only the netcdf
+//    I/O holds this lock: the atlas mesh is built from the arrays read after it is released
+//  - atlas mesh construction is not known to be thread safe either, building, projecting and
+//    destroying the meshes is serialized by a second lock. the workers thus overlap the netcdf I/O
+//    of one file with the mesh construction of another. the time spent waiting for either lock is
+//    reported separately for each file
+//
+// The input files are either given on the command line or listed (one per line) in a file passed
+// using -l.
+
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <atlas/library/Library.h>
+#include <atlas/mesh/Mesh.h>
+
+#include "AtlasFromNetcdf.h"
+#include "AtlasProjectMesh.h"
+#include "AtlasToNetcdf.h"
+#include "ParallelFor.h"
+#include "WallClock.h"
+
+namespace {
+struct Options {
+  int numThreads = NumThreads();
+  int maxMeshesInFlight = 2;
+  bool minimal = false;
+  std::optional<std::pair<int, int>> projectFaces;
+  std::string outDir;
+  std::vector<std::string> inFiles;
+};
+
+struct FileReport {
+  bool success = false;
+  std::string error;
+  double waitSlot = 0.;
+  double waitNetcdf = 0.;
+  double waitAtlas = 0.;
+  double read = 0.;
+  double build = 0.;
+  double project = 0.;
+  double write = 0.;
+  double total = 0.;
+};
+
+// bounds the number of meshes in flight
+class Slots {
+public:
+  explicit Slots(int numSlots) : free_(numSlots) {}
+  void acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    available_.wait(lock, [&] { return free_ > 0; });
+    free_--;
+  }
+  void release() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      free_++;
+    }
+    available_.notify_one();
+  }
+
+private:
+  int free_;
+  std::mutex mutex_;
+  std::condition_variable available_;
+};
+
+void printUsage(const char* prog) {
+  std::cout << "intended use is\n"
+            << prog << " [-j threads] [-m meshes_in_flight] [--minimal]"
+            << " [--project start_face num_faces] [-l file_list] -o out_dir [input_file.nc ...]\n";
+}
+
+std::optional<Options> parseOptions(int argc, char const* argv[]) {
+  Options opts;
+  for(int argIdx = 1; argIdx < argc; argIdx++) {
+    std::string arg(argv[argIdx]);
+    auto hasValues = [&](int numValues) { return argIdx + numValues < argc; };
+    if(arg == "-j" && hasValues(1)) {
+      opts.numThreads = std::max(1, atoi(argv[++argIdx]));
+    } else if(arg == "-m" && hasValues(1)) {
+      opts.maxMeshesInFlight = std::max(1, atoi(argv[++argIdx]));
+    } else if(arg == "--minimal") {
+      opts.minimal = true;
+    } else if(arg == "--project" && hasValues(2)) {
+      int startFace = atoi(argv[++argIdx]);
+      int numFaces = atoi(argv[++argIdx]);
+      opts.projectFaces = {startFace, numFaces};
+    } else if(arg == "-o" && hasValues(1)) {
+      opts.outDir = argv[++argIdx];
+    } else if(arg == "-l" && hasValues(1)) {
+      std::ifstream list(argv[++argIdx]);
+      if(!list) {
+        std::cout << "could not open file list " << argv[argIdx] << "\n";
+        return std::nullopt;
+      }
+      for(std::string line; std::getline(list, line);) {
+        if(!line.empty()) {
+          opts.inFiles.push_back(line);
+        }
+      }
+    } else if(!arg.empty() && arg[0] != '-') {
+      opts.inFiles.push_back(arg);
+    } else {
+      std::cout << "unknown or incomplete option " << arg << "\n";
+      return std::nullopt;
+    }
+  }
+  if(opts.outDir.empty() || opts.inFiles.empty()) {
+    return std::nullopt;
+  }
+  return opts;
+}
+
+// the two locks serializing the netcdf I/O and the atlas mesh construction between the workers
+struct Locks {
+  std::mutex netcdf;
+  std::mutex atlas;
+};
+
+// locks mutex, adds the time spent waiting to wait
+std::unique_lock<std::mutex> lockTimed(std::mutex& mutex, double& wait) {
+  auto start = Clock::now();
+  std::unique_lock<std::mutex> lock(mutex);
+  wait += SecondsSince(start);
+  return lock;
+}
+
+// reads, projects and writes a single file. the mesh is only alive during this call
+void convertMesh(const Options& opts, const std::string& inFname, Locks& locks,
+                 FileReport& report) {
+  std::optional<NetCDFMeshData> data;
+  {
+    auto lock = lockTimed(locks.netcdf, report.waitNetcdf);
+    auto phaseStart = Clock::now();
+    data = NetCDFMeshDataFromFile(inFname, !opts.minimal);
+    report.read = SecondsSince(phaseStart);
+  }
+  if(!data.has_value()) {
+    report.error = "could not read mesh";
+    return;
+  }
+
+  // declared first, such that the atlas lock is held again while the mesh is destroyed
+  std::unique_lock<std::mutex> atlasLock = lockTimed(locks.atlas, report.waitAtlas);
+  auto phaseStart = Clock::now();
+  std::optional<atlas::Mesh> meshOpt = AtlasMeshFromNetCDFData(data.value());
+  report.build = SecondsSince(phaseStart);
+  data.reset();
+  if(!meshOpt.has_value()) {
+    report.error = "could not build mesh";
+    return;
+  }
+
+  if(opts.projectFaces.has_value()) {
+    auto phaseStart = Clock::now();
+    auto [startFace, numFaces] = opts.projectFaces.value();
+    meshOpt = AtlasProjectMesh(meshOpt.value(), startFace, numFaces);
+    report.project = SecondsSince(phaseStart);
+    if(!meshOpt.has_value()) {
+      report.error = "projection failed";
+      return;
+    }
+  }
+  atlasLock.unlock();
+
+  std::string outFname =
+      (std::filesystem::path(opts.outDir) / std::filesystem::path(inFname).filename()).string();
+  {
+    auto lock = lockTimed(locks.netcdf, report.waitNetcdf);
+    auto phaseStart = Clock::now();
+    report.success = AtlasToNetCDF(meshOpt.value(), outFname);
+    report.write = SecondsSince(phaseStart);
+  }
+  if(!report.success) {
+    report.error = "could not write " + outFname;
+  }
+  atlasLock.lock();
+}
+
+FileReport convertFile(const Options& opts, const std::string& inFname, Slots& slots,
+                       Locks& locks) {
+  FileReport report;
+  auto start = Clock::now();
+  slots.acquire();
+  report.waitSlot = SecondsSince(start);
+  convertMesh(opts, inFname, locks, report);
+  slots.release();
+  report.total = SecondsSince(start);
+  return report;
+}
+} // namespace
+
+int main(int argc, char const* argv[]) {
+  auto optsOpt = parseOptions(argc, argv);
+  if(!optsOpt.has_value()) {
+    printUsage(argv[0]);
+    return -1;
+  }
+  const Options& opts = optsOpt.value();
+  std::filesystem::create_directories(opts.outDir);
+
+  Slots slots(opts.maxMeshesInFlight);
+  Locks locks;
+  std::mutex printMutex;
+  std::vector<FileReport> reports(opts.inFiles.size());
+
+  auto start = Clock::now();
+  ParallelTasks(
+      opts.inFiles.size(),
+      [&](int fileIdx) {
+        const std::string& inFname = opts.inFiles[fileIdx];
+        FileReport report = convertFile(opts, inFname, slots, locks);
+        std::lock_guard<std::mutex> lock(printMutex);
+        printf("%s: %s read %.3f s, build %.3f s, project %.3f s, write %.3f s, waited %.3f s "
+               "(slot) %.3f s (netcdf) %.3f s (atlas), total %.3f s\n",
+               inFname.c_str(), report.success ? "ok" : report.error.c_str(), report.read,
+               report.build, report.project, report.write, report.waitSlot, report.waitNetcdf,
+               report.waitAtlas, report.total);
+        fflush(stdout);
+        reports[fileIdx] = std::move(report);
+      },
+      opts.numThreads);
+  double wallTime = SecondsSince(start);
+
+  int numFailed = 0;
+  double sumTime = 0.;
+  for(const FileReport& report : reports) {
+    numFailed += !report.success;
+    sumTime += report.total;
+  }
+  printf("converted %d of %d files using %d threads and at most %d meshes in flight: wall time "
+         "%.3f s, sum of per file times %.3f s\n",
+         int(reports.size()) - numFailed, int(reports.size()), opts.numThreads,
+         opts.maxMeshesInFlight, wallTime, sumTime);
+
+  atlas::Library::instance().finalise();
+  return numFailed == 0 ? 0 : 1;
+}
@@ -340,8 +340,20 @@ Point AtlasToCartesian::edgeMidpoint(const atlas::Mesh& mesh, int edgeIdx) const
   return {0.5 * (fromX + toX), 0.5 * (fromY + toY)};
 }
 
-std::vector<int> AtlasToCartesian::innerEdges(const atlas::Mesh& mesh) const {
-  std::set<int> boundaryEdges;
+namespace {
+std::vector<int> MaskToIndices(const std::vector<char>& mask) {
+  std::vector<int> indices;
+  for(int idx = 0; idx < int(mask.size()); idx++) {
+    if(mask[idx]) {
+      indices.push_back(idx);
+    }
+  }
+  return indices;
+}
+} // namespace
+
+std::vector<char> AtlasToCartesian::innerEdgesMask(const atlas::Mesh& mesh) const {
+  std::vector<char> inner(mesh.edges().size(), 1);
   const auto& conn = mesh.nodes().edge_connectivity();
   auto anyMissing = [&](int nodeIdx) {
     int missingValue = conn.missing_value();
@@ -356,21 +368,17 @@ std::vector<int> AtlasToCartesian::innerEdges(const atlas::Mesh& mesh) const {
   for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
     if(conn.cols(nodeIdx) != 6 || anyMissing(nodeIdx)) {
       for(int nbhIdx = 0; nbhIdx < conn.cols(nodeIdx); nbhIdx++) {
-        boundaryEdges.insert(conn(nodeIdx, nbhIdx));
+        const int edgeIdx = conn(nodeIdx, nbhIdx);
+        if(edgeIdx >= 0 && edgeIdx < int(inner.size())) {
+          inner[edgeIdx] = 0;
+        }
       }
     }
   }
-  std::vector<int> innerEdges;
-  for(int edgeIdx = 0; edgeIdx < mesh.edges().size(); edgeIdx++) {
-    if(!boundaryEdges.count(edgeIdx)) {
-      innerEdges.push_back(edgeIdx);
-    }
-  }
-
-  return innerEdges;
+  return inner;
 }
 
-std::vector<int> AtlasToCartesian::innerNodes(const atlas::Mesh& mesh) const {
+std::vector<char> AtlasToCartesian::innerNodesMask(const atlas::Mesh& mesh) const {
   const auto& conn = mesh.nodes().edge_connectivity();
   auto anyMissing = [&](int nodeIdx) {
     int missingValue = conn.missing_value();
@@ -381,20 +389,16 @@ std::vector<int> AtlasToCartesian::innerNodes(const atlas::Mesh& mesh) const {
     }
     return false;
   };
-  std::vector<int> innerNodes;
+  std::vector<char> inner(mesh.nodes().size(), 0);
   for(int nodeIdx = 0; nodeIdx < mesh.nodes().size(); nodeIdx++) {
-    if(anyMissing(nodeIdx) || conn.cols(nodeIdx) != 6) {
-      continue;
-    }
-    innerNodes.push_back(nodeIdx);
+    inner[nodeIdx] = !anyMissing(nodeIdx) && conn.cols(nodeIdx) == 6;
   }
-  return innerNodes;
+  return inner;
 }
 
-std::vector<int> AtlasToCartesian::innerCells(const atlas::Mesh& mesh) const {
+std::vector<char> AtlasToCartesian::innerCellsMask(const atlas::Mesh& mesh) const {
   const auto& cellToEdge = mesh.cells().edge_connectivity();
   const auto& edgeToCell = mesh.edges().cell_connectivity();
-  std::vector<int> innerCells;
   auto isBoundaryEdge = [&edgeToCell](int edgeIdx) {
     if(edgeToCell.cols(edgeIdx) != 2) {
       return true;
@@ -402,16 +406,26 @@ std::vector<int> AtlasToCartesian::innerCells(const atlas::Mesh& mesh) const {
     return edgeToCell(edgeIdx, 0) == edgeToCell.missing_value() ||
            edgeToCell(edgeIdx, 1) == edgeToCell.missing_value();
   };
+  std::vector<char> inner(mesh.cells().size(), 0);
   for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
     int e0 = cellToEdge(cellIdx, 0);
     int e1 = cellToEdge(cellIdx, 1);
     int e2 = cellToEdge(cellIdx, 2);
-    if(isBoundaryEdge(e0) || isBoundaryEdge(e1) || isBoundaryEdge(e2)) {
-      continue;
-    }
-    innerCells.push_back(cellIdx);
+    inner[cellIdx] = !isBoundaryEdge(e0) && !isBoundaryEdge(e1) && !isBoundaryEdge(e2);
   }
-  return innerCells;
+  return inner;
+}
+
+std::vector<int> AtlasToCartesian::innerEdges(const atlas::Mesh& mesh) const {
+  return MaskToIndices(innerEdgesMask(mesh));
+}
+
+std::vector<int> AtlasToCartesian::innerNodes(const atlas::Mesh& mesh) const {
+  return MaskToIndices(innerNodesMask(mesh));
+}
+
+std::vector<int> AtlasToCartesian::innerCells(const atlas::Mesh& mesh) const {
+  return MaskToIndices(innerCellsMask(mesh));
 }
 
 AtlasToCartesian::AtlasToCartesian(const atlas::Mesh& mesh, double scale, bool skewTrafo,
@@ -55,9 +55,19 @@ public:
   std::vector<int> innerNodes(const atlas::Mesh& mesh) const;
   std::vector<int> innerCells(const atlas::Mesh& mesh) const;
 
+  // same selection as above as one entry per element (1 for inner elements, 0 otherwise)
+  std::vector<char> innerEdgesMask(const atlas::Mesh& mesh) const;
+  std::vector<char> innerNodesMask(const atlas::Mesh& mesh) const;
+  std::vector<char> innerCellsMask(const atlas::Mesh& mesh) const;
+
   double distanceToCircumcenter(const atlas::Mesh& mesh, int cellIdx, int nodeIdx) const;
 
   Point nodeLocation(int nodeIdx) const { return nodeToCart[nodeIdx]; }
+
+  // bytes held by the cached node coordinates
+  size_t footprint() const {
+    return (nodeToCart.capacity() + nodeToCartUnskewed.capacity()) * sizeof(Point);
+  }
   double dualCellArea(const atlas::Mesh& mesh, int nodeIdx) const;
 
   explicit AtlasToCartesian(const atlas::Mesh& mesh, double scale, bool skewTrafo = false,
@@ -7,9 +7,13 @@
 #include <atlas/mesh/HybridElements.h>
 #include <atlas/mesh/Nodes.h>
 
+#include <algorithm>
+#include <atomic>
 #include <numeric>
 #include <optional>
 
+#include "ParallelFor.h"
+
 namespace {
 template <typename ConnectivityT>
 void AllocNbhTable(ConnectivityT& connectivity, int numElements, int nbhPerElem) {
@@ -17,28 +21,48 @@ void AllocNbhTable(ConnectivityT& connectivity, int numElements, int nbhPerElem)
   connectivity.add(numElements, nbhPerElem, init.data());
 }
 
+// row keptIndices[i] of connIn becomes row i of connOut, with every neighbor renumbered using
+// oldToNew. neighbors which are not part of the submesh (oldToNew == -1) become missing values.
+// rows are copied in parallel, connOut needs to be allocated already
 template <typename ConnectivityT>
-void CopyNeighborTable(const ConnectivityT& connIn, const std::vector<int> keptIndices,
-                       const std::unordered_map<int, int> oldToNewMap, ConnectivityT& connOut,
-                       std::optional<std::set<int>> filter = std::nullopt) {
-  int linearIdx = 0;
-  for(int keptIdx : keptIndices) {
-    int numNbh = connIn.cols(keptIdx);
-    std::vector<int> newNbh;
+void CopyNeighborTable(const ConnectivityT& connIn, const std::vector<int>& keptIndices,
+                       const std::vector<int>& oldToNew, ConnectivityT& connOut) {
+  const int missingIn = connIn.missing_value();
+  const int missingOut = connOut.missing_value();
+  ParallelFor(0, keptIndices.size(), [&](int rowIdx) {
+    const int keptIdx = keptIndices[rowIdx];
+    const int numNbh = std::min<int>(connIn.cols(keptIdx), connOut.cols(rowIdx));
     for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
-      int elemIdx = connIn(keptIdx, nbhIdx);
-      if(filter != std::nullopt && filter.value().count(elemIdx) == 0) {
-        newNbh.push_back(connOut.missing_value());
-      } else {
-        newNbh.push_back(oldToNewMap.at(elemIdx));
+      const int elemIdx = connIn(keptIdx, nbhIdx);
+      const int newIdx = elemIdx == missingIn ? -1 : oldToNew[elemIdx];
+      connOut.set(rowIdx, nbhIdx, newIdx == -1 ? missingOut : newIdx);
+    }
+  });
+}
+
+// the (ascending) indices of all elements referenced by the rows keptIndices of conn. oldToNew
+// receives the position of each element in the result, or -1 if it is not referenced
+template <typename ConnectivityT>
+std::vector<int> KeptNeighbors(const ConnectivityT& conn, const std::vector<int>& keptIndices,
+                               int numElements, std::vector<int>& oldToNew) {
+  std::vector<std::atomic<char>> marker(numElements);
+  ParallelFor(0, numElements, [&](int idx) { marker[idx].store(0, std::memory_order_relaxed); });
+  const int missing = conn.missing_value();
+  ParallelFor(0, keptIndices.size(), [&](int rowIdx) {
+    const int keptIdx = keptIndices[rowIdx];
+    for(int nbhIdx = 0; nbhIdx < conn.cols(keptIdx); nbhIdx++) {
+      const int elemIdx = conn(keptIdx, nbhIdx);
+      if(elemIdx != missing) {
+        marker[elemIdx].store(1, std::memory_order_relaxed);
       }
     }
-    connOut.set(linearIdx, newNbh.data());
-    linearIdx++;
-  }
+  });
+  return ParallelCompact(
+      numElements, [&](int idx) { return marker[idx].load(std::memory_order_relaxed) != 0; },
+      &oldToNew);
 }
 
-void copyNodeData(const atlas::Mesh& meshIn, const std::vector<int> keptNodeIndices,
+void copyNodeData(const atlas::Mesh& meshIn, const std::vector<int>& keptNodeIndices,
                   atlas::Mesh& meshOut) {
   const atlas::mesh::Nodes& nodesIn = meshIn.nodes();
   auto xyIn = atlas::array::make_view<double, 2>(nodesIn.xy());
@@ -58,21 +82,23 @@ void copyNodeData(const atlas::Mesh& meshIn, const std::vector<int> keptNodeIndi
   auto ghost = atlas::array::make_view<int, 1>(nodes.ghost());
   auto flags = atlas::array::make_view<int, 1>(nodes.flags());
 
-  for(int nodeIdx = 0; nodeIdx < keptNodeIndices.size(); nodeIdx++) {
-    xy(nodeIdx, atlas::LON) = xyIn(keptNodeIndices[nodeIdx], atlas::LON);
-    xy(nodeIdx, atlas::LAT) = xyIn(keptNodeIndices[nodeIdx], atlas::LAT);
-    lonlat(nodeIdx, atlas::LON) = lonlatIn(keptNodeIndices[nodeIdx], atlas::LON);
-    lonlat(nodeIdx, atlas::LAT) = lonlatIn(keptNodeIndices[nodeIdx], atlas::LAT);
-    glbIdxNode(nodeIdx) = glbIdxNodeIn(keptNodeIndices[nodeIdx]);
-    remoteIdx(nodeIdx) = remoteIdxIn(keptNodeIndices[nodeIdx]);
-    part(nodeIdx) = partIn(keptNodeIndices[nodeIdx]);
-    ghost(nodeIdx) = ghostIn(keptNodeIndices[nodeIdx]);
-    flags(nodeIdx) = flagsIn(keptNodeIndices[nodeIdx]);
-  }
+  ParallelFor(0, keptNodeIndices.size(), [&](int nodeIdx) {
+    const int oldIdx = keptNodeIndices[nodeIdx];
+    xy(nodeIdx, atlas::LON) = xyIn(oldIdx, atlas::LON);
+    xy(nodeIdx, atlas::LAT) = xyIn(oldIdx, atlas::LAT);
+    lonlat(nodeIdx, atlas::LON) = lonlatIn(oldIdx, atlas::LON);
+    lonlat(nodeIdx, atlas::LAT) = lonlatIn(oldIdx, atlas::LAT);
+    glbIdxNode(nodeIdx) = glbIdxNodeIn(oldIdx);
+    remoteIdx(nodeIdx) = remoteIdxIn(oldIdx);
+    part(nodeIdx) = partIn(oldIdx);
+    ghost(nodeIdx) = ghostIn(oldIdx);
+    flags(nodeIdx) = flagsIn(oldIdx);
+  });
 }
 
 atlas::Mesh AtlasExtractSubMeshImpl(const atlas::Mesh& meshIn,
-                                    const std::vector<int> keptCellIndices, bool complete = true) {
+                                    const std::vector<int>& keptCellIndices, bool complete = true,
+                                    AtlasSubMeshIndices* indices = nullptr) {
 
   // load old nbh tables
   const auto& cellToNodeIn = meshIn.cells().node_connectivity();
@@ -82,32 +108,18 @@ atlas::Mesh AtlasExtractSubMeshImpl(const atlas::Mesh& meshIn,
   const auto& nodeToEdgeIn = meshIn.nodes().edge_connectivity();
   const auto& nodeToCellIn = meshIn.nodes().cell_connectivity();
 
-  // prepare maps
+  // prepare maps (dense, -1 for elements not in the submesh)
   // -------------
 
-  // nodes
-  std::set<int> keptNodeSet;
-  for(int cellIdx : keptCellIndices) {
-    int numNbh = cellToNodeIn.cols(cellIdx);
-    for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
-      int nodeIdx = cellToNodeIn(cellIdx, nbhIdx);
-      keptNodeSet.insert(nodeIdx);
-    }
-  }
+  // nodes, kept in ascending order of their old index
+  std::vector<int> oldToNewNode;
+  std::vector<int> keptNodeIndices =
+      KeptNeighbors(cellToNodeIn, keptCellIndices, meshIn.nodes().size(), oldToNewNode);
 
-  std::vector<int> keptNodeIndices(keptNodeSet.begin(), keptNodeSet.end());
-  std::unordered_map<int, int> oldToNewNodeMap;
-  for(int idx = 0; idx < keptNodeIndices.size(); idx++) {
-    oldToNewNodeMap.emplace(keptNodeIndices[idx], idx);
-  }
-
-  // cells
-  std::unordered_map<int, int> oldToNewCellMap;
-  std::set<int> keptCellSet;
-  for(int idx = 0; idx < keptCellIndices.size(); idx++) {
-    oldToNewCellMap.emplace(keptCellIndices[idx], idx);
-    keptCellSet.insert(keptCellIndices[idx]);
-  }
+  // cells, kept in the order given
+  std::vector<int> oldToNewCell(meshIn.cells().size(), -1);
+  ParallelFor(0, keptCellIndices.size(),
+              [&](int idx) { oldToNewCell[keptCellIndices[idx]] = idx; });
 
   const int newSizeNodes = keptNodeIndices.size();
   const int newSizeCells = keptCellIndices.size();
@@ -124,39 +136,29 @@ atlas::Mesh AtlasExtractSubMeshImpl(const atlas::Mesh& meshIn,
   atlas::array::ArrayView<atlas::gidx_t, 1> glbIdxCell =
       atlas::array::make_view<atlas::gidx_t, 1>(mesh.cells().global_index());
 
-  for(int cellIdx = 0; cellIdx < newSizeCells; cellIdx++) {
+  ParallelFor(0, newSizeCells, [&](int cellIdx) {
     glbIdxCell[cellIdx] = cellIdx;
     cellsPart[cellIdx] = cellIdx;
-  }
+  });
 
-  CopyNeighborTable(cellToNodeIn, keptCellIndices, oldToNewNodeMap,
+  CopyNeighborTable(cellToNodeIn, keptCellIndices, oldToNewNode,
                     mesh.cells().node_connectivity());
 
   // minimal mesh is now done
   if(!complete) {
+    if(indices) {
+      *indices = {std::move(keptNodeIndices), {}, keptCellIndices};
+    }
     return mesh;
   }
 
   // edges (a minimal mesh may not contain edges, so we have to pull this down)
-  std::set<int> keptEdgeSet;
-  for(int cellIdx : keptCellIndices) {
-    int numNbh = cellToEdgeIn.cols(cellIdx);
-    for(int nbhIdx = 0; nbhIdx < numNbh; nbhIdx++) {
-      int edgeIdx = cellToEdgeIn(cellIdx, nbhIdx);
-      keptEdgeSet.insert(edgeIdx);
-    }
-  }
-
-  std::vector<int> keptEdgeIndices(keptEdgeSet.begin(), keptEdgeSet.end());
-  std::unordered_map<int, int> oldToNewEdgeMap;
-  for(int idx = 0; idx < keptEdgeIndices.size(); idx++) {
-    oldToNewEdgeMap.emplace(keptEdgeIndices[idx], idx);
-  }
+  std::vector<int> oldToNewEdge;
+  std::vector<int> keptEdgeIndices =
+      KeptNeighbors(cellToEdgeIn, keptCellIndices, meshIn.edges().size(), oldToNewEdge);
   const int newSizeEdges = keptEdgeIndices.size();
   mesh.edges().add(new atlas::mesh::temporary::Line(), newSizeEdges);
 
-  auto& cellToEdge = mesh.cells().edge_connectivity();
-
   const int nodesPerEdge = 2;
   const int cellsPerEdge = 2;
   const int cellsPerNode = 6; // maximum is 6, some with 5 exist
@@ -165,7 +167,7 @@ atlas::Mesh AtlasExtractSubMeshImpl(const atlas::Mesh& meshIn,
 
   AllocNbhTable<atlas::mesh::HybridElements::Connectivity>(mesh.cells().edge_connectivity(),
                                                            mesh.cells().size(), edgesPerCell);
-  CopyNeighborTable(cellToEdgeIn, keptCellIndices, oldToNewEdgeMap,
+  CopyNeighborTable(cellToEdgeIn, keptCellIndices, oldToNewEdge,
                     mesh.cells().edge_connectivity());
 
   // edge nbh tables
@@ -173,24 +175,25 @@ atlas::Mesh AtlasExtractSubMeshImpl(const atlas::Mesh& meshIn,
                                                            mesh.edges().size(), cellsPerEdge);
   AllocNbhTable<atlas::mesh::HybridElements::Connectivity>(mesh.edges().node_connectivity(),
                                                            mesh.edges().size(), nodesPerEdge);
-  CopyNeighborTable(edgeToNodeIn, keptEdgeIndices, oldToNewNodeMap,
+  CopyNeighborTable(edgeToNodeIn, keptEdgeIndices, oldToNewNode,
                     mesh.edges().node_connectivity());
-  CopyNeighborTable(edgeToCellIn, keptEdgeIndices, oldToNewCellMap,
-                    mesh.edges().cell_connectivity(), keptCellSet);
+  CopyNeighborTable(edgeToCellIn, keptEdgeIndices, oldToNewCell,
+                    mesh.edges().cell_connectivity());
 
   // node nbh tables
   AllocNbhTable<atlas::mesh::Nodes::Connectivity>(mesh.nodes().cell_connectivity(),
                                                   mesh.nodes().size(), cellsPerNode);
   AllocNbhTable<atlas::mesh::Nodes::Connectivity>(mesh.nodes().edge_connectivity(),
                                                   mesh.nodes().size(), edgesPerNode);
-  auto& nodeToEdge = mesh.nodes().edge_connectivity();
-  auto& nodeToCell = mesh.nodes().cell_connectivity();
 
-  CopyNeighborTable(nodeToEdgeIn, keptNodeIndices, oldToNewEdgeMap,
-                    mesh.nodes().edge_connectivity(), keptEdgeSet);
-  CopyNeighborTable(nodeToCellIn, keptNodeIndices, oldToNewCellMap,
-                    mesh.nodes().cell_connectivity(), keptCellSet);
+  CopyNeighborTable(nodeToEdgeIn, keptNodeIndices, oldToNewEdge,
+                    mesh.nodes().edge_connectivity());
+  CopyNeighborTable(nodeToCellIn, keptNodeIndices, oldToNewCell,
+                    mesh.nodes().cell_connectivity());
 
+  if(indices) {
+    *indices = {std::move(keptNodeIndices), std::move(keptEdgeIndices), keptCellIndices};
+  }
   return mesh;
 };
 } // namespace
@@ -206,7 +209,7 @@ atlas::Mesh AtlasExtractSubMeshComplete(const atlas::Mesh& meshIn, std::pair<int
 }
 
 atlas::Mesh AtlasExtractSubMeshComplete(const atlas::Mesh& meshIn,
-                                        const std::vector<int> keptCellIndices) {
+                                        const std::vector<int>& keptCellIndices) {
   return AtlasExtractSubMeshImpl(meshIn, keptCellIndices, true);
 }
 
@@ -221,6 +224,18 @@ atlas::Mesh AtlasExtractSubMeshMinimal(const atlas::Mesh& meshIn, std::pair<int,
 }
 
 atlas::Mesh AtlasExtractSubMeshMinimal(const atlas::Mesh& meshIn,
-                                       const std::vector<int> keptCellIndices) {
+                                       const std::vector<int>& keptCellIndices) {
   return AtlasExtractSubMeshImpl(meshIn, keptCellIndices, false);
-}
\ No newline at end of file
+}
+
+atlas::Mesh AtlasExtractSubMeshComplete(const atlas::Mesh& meshIn,
+                                        const std::vector<int>& keptCellIndices,
+                                        AtlasSubMeshIndices& indices) {
+  return AtlasExtractSubMeshImpl(meshIn, keptCellIndices, true, &indices);
+}
+
+atlas::Mesh AtlasExtractSubMeshMinimal(const atlas::Mesh& meshIn,
+                                       const std::vector<int>& keptCellIndices,
+                                       AtlasSubMeshIndices& indices) {
+  return AtlasExtractSubMeshImpl(meshIn, keptCellIndices, false, &indices);
+}
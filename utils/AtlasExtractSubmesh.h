@@ -12,8 +12,11 @@
 //
 //===------------------------------------------------------------------------------------------===//
 
+#pragma once
+
 #include <optional>
 #include <string>
+#include <vector>
 
 #include <atlas/mesh/Mesh.h>
 
@@ -25,6 +28,20 @@
 atlas::Mesh AtlasExtractSubMeshMinimal(const atlas::Mesh& mesh, std::pair<int, int> rangeCells);
 atlas::Mesh AtlasExtractSubMeshComplete(const atlas::Mesh& mesh, std::pair<int, int> rangeCells);
 atlas::Mesh AtlasExtractSubMeshMinimal(const atlas::Mesh& mesh,
-                                       const std::vector<int> keptCellIndices);
+                                       const std::vector<int>& keptCellIndices);
+atlas::Mesh AtlasExtractSubMeshComplete(const atlas::Mesh& mesh,
+                                        const std::vector<int>& keptCellIndices);
+
+// old indices of the elements of an extracted submesh, i.e. nodes[newIdx] is the index in the
+// original mesh of node newIdx of the submesh. edges is empty for minimal submeshes
+struct AtlasSubMeshIndices {
+  std::vector<int> nodes;
+  std::vector<int> edges;
+  std::vector<int> cells;
+};
+atlas::Mesh AtlasExtractSubMeshMinimal(const atlas::Mesh& mesh,
+                                       const std::vector<int>& keptCellIndices,
+                                       AtlasSubMeshIndices& indices);
 atlas::Mesh AtlasExtractSubMeshComplete(const atlas::Mesh& mesh,
-                                        const std::vector<int> keptCellIndices);
\ No newline at end of file
+                                        const std::vector<int>& keptCellIndices,
+                                        AtlasSubMeshIndices& indices);
@@ -54,25 +54,23 @@ std::vector<loadT> LoadField(const netCDF::NcFile& dataFile, const std::string&
   return ret;
 }
 
-template <typename loadT>
-std::tuple<std::vector<loadT>, size_t, size_t> Load2DField(const netCDF::NcFile& dataFile,
-                                                           const std::string& name) {
+NetCDFTable LoadTable(const netCDF::NcFile& dataFile, const std::string& name) {
   netCDF::NcVar data = dataFile.getVar(name.c_str());
   if(data.isNull()) {
     return {};
   }
   assert(data.getDimCount() == 2);
-  size_t stride = data.getDim(0).getSize();
-  size_t elPerStride = data.getDim(1).getSize();
-  size_t size = stride * elPerStride;
-  std::vector<loadT> ret(size);
-  data.getVar(ret.data());
-  return {ret, stride, elPerStride};
+  NetCDFTable table;
+  table.nbhPerElem = data.getDim(0).getSize();
+  table.numElems = data.getDim(1).getSize();
+  table.values.resize(table.nbhPerElem * table.numElems);
+  data.getVar(table.values.data());
+  return table;
 }
 
-bool NodesFromNetCDF(const netCDF::NcFile& dataFile, atlas::Mesh& mesh) {
-  auto lon = LoadField<double>(dataFile, "vlon");
-  auto lat = LoadField<double>(dataFile, "vlat");
+bool NodesFromNetCDF(const NetCDFMeshData& data, atlas::Mesh& mesh) {
+  const std::vector<double>& lon = data.lon;
+  const std::vector<double>& lat = data.lat;
   if(lon.size() == 0 || lat.size() == 0) {
     std::cout << "lat / long variable not found\n";
     return false;
@@ -117,9 +115,10 @@ bool NodesFromNetCDF(const netCDF::NcFile& dataFile, atlas::Mesh& mesh) {
   return true;
 }
 
-bool CellsFromNetCDF(const netCDF::NcFile& dataFile, atlas::Mesh& mesh) {
-  auto [cellToVertex, vertexPerCell, ncells] = Load2DField<int>(dataFile, "vertex_of_cell");
-  if(vertexPerCell != 3) {
+bool CellsFromNetCDF(const NetCDFMeshData& data, atlas::Mesh& mesh) {
+  const std::vector<int>& cellToVertex = data.vertexOfCell.values;
+  const size_t ncells = data.vertexOfCell.numElems;
+  if(data.vertexOfCell.nbhPerElem != 3) {
     std::cout << "not a triangle mesh\n";
     return false;
   }
@@ -145,10 +144,11 @@ bool CellsFromNetCDF(const netCDF::NcFile& dataFile, atlas::Mesh& mesh) {
 }
 
 template <typename ConnectivityT>
-bool AddNeighborList(const netCDF::NcFile& dataFile, atlas::Mesh& mesh,
-                     const std::string nbhListName, size_t yPerXExpected,
+bool AddNeighborList(const NetCDFTable& table, size_t yPerXExpected,
                      ConnectivityT& connectivity) {
-  auto [xToY, yPerX, numY] = Load2DField<int>(dataFile, nbhListName);
+  const std::vector<int>& xToY = table.values;
+  const size_t yPerX = table.nbhPerElem;
+  const size_t numY = table.numElems;
   if(yPerX != yPerXExpected) {
     std::cout << "number of neighbors per element not as expected!\n";
     return false;
@@ -171,104 +171,118 @@ void AllocNbhTable(ConnectivityT& connectivity, int numElements, int nbhPerElem)
   std::vector<int> init(numElements * nbhPerElem, connectivity.missing_value());
   connectivity.add(numElements, nbhPerElem, init.data());
 }
-} // namespace
 
-std::optional<atlas::Mesh> AtlasMeshFromNetCDFMinimal(const std::string& filename) {
-  try {
-    atlas::Mesh mesh;
-    netCDF::NcFile dataFile(filename.c_str(), netCDF::NcFile::read);
+bool EdgesFromNetCDF(const NetCDFMeshData& data, atlas::Mesh& mesh) {
+  if(data.numEdges == 0) {
+    std::cout << "no edges found in netcdf file!\n";
+    return false;
+  }
 
-    if(!NodesFromNetCDF(dataFile, mesh)) {
-      return {};
-    }
+  // had no edges so far, add them
+  mesh.edges().add(new atlas::mesh::temporary::Line(), data.numEdges);
 
-    if(!CellsFromNetCDF(dataFile, mesh)) {
-      return {};
-    }
+  const int verticesPerEdge = 2;
+  const int cellsPerEdge = 2;
+  const int cellsPerNode = 6; // maximum is 6, some with 5 exist
+  const int edgesPerNode = 6; // maximum is 6, some with 5 exist
+  const int edgesPerCell = 3;
 
-    return mesh;
-  } catch(netCDF::exceptions::NcException& e) {
-    std::cout << e.what() << "\n";
-    return std::nullopt;
+  // Allocate & fill neighbor tables from file
+  // ------------------------------
+
+  // Edges
+  AllocNbhTable(mesh.edges().cell_connectivity(), mesh.edges().size(), cellsPerEdge);
+  if(!AddNeighborList(data.adjacentCellOfEdge, cellsPerEdge, mesh.edges().cell_connectivity())) {
+    return false;
   }
-}
+  AllocNbhTable(mesh.edges().node_connectivity(), mesh.edges().size(), verticesPerEdge);
+  if(!AddNeighborList(data.edgeVertices, verticesPerEdge, mesh.edges().node_connectivity())) {
+    return false;
+  }
+  // edge to edge connectivity not supported so far
+  // AllocNbhTable(mesh.edges().edge_connectivity(), ??, ??);
 
-std::optional<atlas::Mesh> AtlasMeshFromNetCDFComplete(const std::string& filename) {
-  auto maybeMesh = AtlasMeshFromNetCDFMinimal(filename);
-  if(!maybeMesh.has_value()) {
-    return {};
+  // Nodes
+  AllocNbhTable(mesh.nodes().cell_connectivity(), mesh.nodes().size(), cellsPerNode);
+  if(!AddNeighborList(data.cellsOfVertex, cellsPerNode, mesh.nodes().cell_connectivity())) {
+    return false;
+  }
+  AllocNbhTable(mesh.nodes().edge_connectivity(), mesh.nodes().size(), edgesPerNode);
+  if(!AddNeighborList(data.edgesOfVertex, edgesPerNode, mesh.nodes().edge_connectivity())) {
+    return false;
   }
+  // ATLAS has no conn. tables for node to node
+  // AllocNbhTable(mesh.nodes().node_connectivity(), mesh.nodes().size(), nodesPerNode);
 
+  // Cells
+  // cell to node was already set by CellsFromNetCDF
+  AllocNbhTable(mesh.cells().edge_connectivity(), mesh.cells().size(), edgesPerCell);
+  if(!AddNeighborList(data.edgeOfCell, edgesPerCell, mesh.cells().edge_connectivity())) {
+    return false;
+  }
+  // cell to cell supported by atlas but not present in ICON netcdf
+  // AllocNbhTable(mesh.cells().cell_connectivity(), mesh.cells().size(), cellsPerEdge);
+
+  return true;
+}
+} // namespace
+
+std::optional<NetCDFMeshData> NetCDFMeshDataFromFile(const std::string& filename, bool complete) {
   try {
-    atlas::Mesh mesh = maybeMesh.value();
     netCDF::NcFile dataFile(filename.c_str(), netCDF::NcFile::read);
+    NetCDFMeshData data;
+    data.complete = complete;
+    data.lon = LoadField<double>(dataFile, "vlon");
+    data.lat = LoadField<double>(dataFile, "vlat");
+    data.vertexOfCell = LoadTable(dataFile, "vertex_of_cell");
+    if(!complete) {
+      return data;
+    }
 
     int numEdgesA = LoadField<int>(dataFile, "edge_index").size();
     int numEdgesB = LoadField<int>(dataFile, "elat").size();
     // Explanation: base grids obtained from DWD feature only the edge_index field, while the files
     // generated by using the web interface feature only the elat value.
-
-    if(numEdgesA == 0 && numEdgesB == 0) {
-      std::cout << "no edges found in netcdf file!\n";
-      return {};
-    }
-
-    int numEdges = std::max(numEdgesA, numEdgesB);
-    assert(numEdges > 0);
-
-    // had no edges so far, add them
-    mesh.edges().add(new atlas::mesh::temporary::Line(), numEdges);
-
-    const int verticesPerEdge = 2;
-    const int cellsPerEdge = 2;
-    const int cellsPerNode = 6; // maximum is 6, some with 5 exist
-    const int edgesPerNode = 6; // maximum is 6, some with 5 exist
-    const int edgesPerCell = 3;
-
-    // Allocate & fill neighbor tables from file
-    // ------------------------------
-
-    // Edges
-    AllocNbhTable(mesh.edges().cell_connectivity(), mesh.edges().size(), cellsPerEdge);
-    if(!AddNeighborList(dataFile, mesh, "adjacent_cell_of_edge", cellsPerEdge,
-                        mesh.edges().cell_connectivity())) {
-      return {};
-    }
-    AllocNbhTable(mesh.edges().node_connectivity(), mesh.edges().size(), verticesPerEdge);
-    if(!AddNeighborList(dataFile, mesh, "edge_vertices", verticesPerEdge,
-                        mesh.edges().node_connectivity())) {
-      return {};
-    }
-    // edge to edge connectivity not supported so far
-    // AllocNbhTable(mesh.edges().edge_connectivity(), ??, ??);
-
-    // Nodes
-    AllocNbhTable(mesh.nodes().cell_connectivity(), mesh.nodes().size(), cellsPerNode);
-    if(!AddNeighborList(dataFile, mesh, "cells_of_vertex", cellsPerNode,
-                        mesh.nodes().cell_connectivity())) {
-      return {};
-    }
-    AllocNbhTable(mesh.nodes().edge_connectivity(), mesh.nodes().size(), edgesPerNode);
-    if(!AddNeighborList(dataFile, mesh, "edges_of_vertex", edgesPerNode,
-                        mesh.nodes().edge_connectivity())) {
-      return {};
-    }
-    // ATLAS has no conn. tables for node to node
-    // AllocNbhTable(mesh.nodes().node_connectivity(), mesh.nodes().size(), nodesPerNode);
-
-    // Cells
-    // cell to node was already computed in AtlasMeshFromNetCDFMinimal
-    AllocNbhTable(mesh.cells().edge_connectivity(), mesh.cells().size(), edgesPerCell);
-    if(!AddNeighborList(dataFile, mesh, "edge_of_cell", edgesPerCell,
-                        mesh.cells().edge_connectivity())) {
-      return {};
-    }
-    // cell to cell supported by atlas but not present in ICON netcdf
-    // AllocNbhTable(mesh.cells().cell_connectivity(), mesh.cells().size(), cellsPerEdge);
-
-    return mesh;
+    data.numEdges = std::max(numEdgesA, numEdgesB);
+
+    data.adjacentCellOfEdge = LoadTable(dataFile, "adjacent_cell_of_edge");
+    data.edgeVertices = LoadTable(dataFile, "edge_vertices");
+    data.cellsOfVertex = LoadTable(dataFile, "cells_of_vertex");
+    data.edgesOfVertex = LoadTable(dataFile, "edges_of_vertex");
+    data.edgeOfCell = LoadTable(dataFile, "edge_of_cell");
+    return data;
   } catch(netCDF::exceptions::NcException& e) {
     std::cout << e.what() << "\n";
     return std::nullopt;
   }
-}
\ No newline at end of file
+}
+
+std::optional<atlas::Mesh> AtlasMeshFromNetCDFData(const NetCDFMeshData& data) {
+  atlas::Mesh mesh;
+  if(!NodesFromNetCDF(data, mesh)) {
+    return {};
+  }
+  if(!CellsFromNetCDF(data, mesh)) {
+    return {};
+  }
+  if(data.complete && !EdgesFromNetCDF(data, mesh)) {
+    return {};
+  }
+  return mesh;
+}
+
+std::optional<atlas::Mesh> AtlasMeshFromNetCDFMinimal(const std::string& filename) {
+  auto data = NetCDFMeshDataFromFile(filename, false);
+  if(!data.has_value()) {
+    return {};
+  }
+  return AtlasMeshFromNetCDFData(data.value());
+}
+
+std::optional<atlas::Mesh> AtlasMeshFromNetCDFComplete(const std::string& filename) {
+  auto data = NetCDFMeshDataFromFile(filename, true);
+  if(!data.has_value()) {
+    return {};
+  }
+  return AtlasMeshFromNetCDFData(data.value());
+}
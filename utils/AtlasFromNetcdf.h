@@ -14,6 +14,7 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 #include <atlas/mesh/Mesh.h>
 
@@ -43,5 +44,33 @@
 //   https://en.wikipedia.org/wiki/Map_projection)
 //
 
+// - Reading a file is split into two steps, which can also be called separately:
+//   NetCDFMeshDataFromFile only does the netcdf I/O and returns the raw arrays (std::nullopt if the
+//   file can not be read), AtlasMeshFromNetCDFData builds the atlas mesh from them. This allows to
+//   serialize only the netcdf I/O (netcdf-c is not thread safe) when reading several files
+
 std::optional<atlas::Mesh> AtlasMeshFromNetCDFMinimal(const std::string& filename);
-std::optional<atlas::Mesh> AtlasMeshFromNetCDFComplete(const std::string& filename);
\ No newline at end of file
+std::optional<atlas::Mesh> AtlasMeshFromNetCDFComplete(const std::string& filename);
+
+// neighbor table as stored in the netcdf file: 1 based indices, column major, i.e. neighbor n of
+// element e is values[n * numElems + e]
+struct NetCDFTable {
+  std::vector<int> values;
+  size_t nbhPerElem = 0;
+  size_t numElems = 0;
+};
+
+// the arrays of a dwd netcdf file needed to build the atlas mesh. missing variables are left empty
+struct NetCDFMeshData {
+  // if false, only the node locations and the cell to node table have been read
+  bool complete = false;
+  // node locations in radians ("vlon", "vlat")
+  std::vector<double> lon, lat;
+  NetCDFTable vertexOfCell;
+  // complete only
+  int numEdges = 0;
+  NetCDFTable adjacentCellOfEdge, edgeVertices, cellsOfVertex, edgesOfVertex, edgeOfCell;
+};
+
+std::optional<NetCDFMeshData> NetCDFMeshDataFromFile(const std::string& filename, bool complete);
+std::optional<atlas::Mesh> AtlasMeshFromNetCDFData(const NetCDFMeshData& data);
\ No newline at end of file
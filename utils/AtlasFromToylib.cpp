@@ -0,0 +1,124 @@
+#include "AtlasFromToylib.h"
+
+#include <vector>
+
+#include <atlas/array.h>
+#include <atlas/util/CoordinateEnums.h>
+
+namespace {
+// adds one row per element to conn, listing the ids of the neighbors of the element (as returned
+// by neighbors(elem)) mapped through toAtlas
+template <typename ConnectivityT, typename ElemsT, typename NbhFn, typename MapFn>
+void AddNeighborRows(ConnectivityT& conn, const ElemsT& elems, NbhFn&& neighbors,
+                     MapFn&& toAtlas) {
+  std::vector<int> cols;
+  std::vector<int> values;
+  cols.reserve(elems.size());
+  for(const auto& elem : elems) {
+    const auto nbhs = neighbors(elem);
+    cols.push_back(nbhs.size());
+    for(const auto* nbh : nbhs) {
+      values.push_back(toAtlas(nbh->id()));
+    }
+  }
+  conn.add(cols.size(), cols.data(), values.data());
+}
+} // namespace
+
+atlas::Mesh AtlasMeshFromToylib(const toylib::Grid& grid, AtlasToylibIndices& indices) {
+  const int numNodes = grid.vertices().size();
+  const int numCells = grid.faces().size();
+  const int numEdges = grid.edges().size();
+
+  indices.toylibEdge.resize(numEdges);
+  indices.atlasEdge.assign(grid.all_edges().size(), -1);
+  for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+    const int id = grid.edges()[edgeIdx].get().id();
+    indices.toylibEdge[edgeIdx] = id;
+    indices.atlasEdge[id] = edgeIdx;
+  }
+  auto sameIdx = [](int id) { return id; };
+  auto edgeIdx = [&](int id) { return indices.atlasEdge[id]; };
+
+  atlas::Mesh mesh;
+
+  // nodes
+  mesh.nodes().resize(numNodes);
+  auto xy = atlas::array::make_view<double, 2>(mesh.nodes().xy());
+  auto lonlat = atlas::array::make_view<double, 2>(mesh.nodes().lonlat());
+  auto glbIdx = atlas::array::make_view<atlas::gidx_t, 1>(mesh.nodes().global_index());
+  auto remoteIdx = atlas::array::make_indexview<atlas::idx_t, 1>(mesh.nodes().remote_index());
+  auto part = atlas::array::make_view<int, 1>(mesh.nodes().partition());
+  auto ghost = atlas::array::make_view<int, 1>(mesh.nodes().ghost());
+  auto flags = atlas::array::make_view<int, 1>(mesh.nodes().flags());
+  for(const auto& v : grid.vertices()) {
+    const int nodeIdx = v.id();
+    xy(nodeIdx, atlas::LON) = v.x();
+    xy(nodeIdx, atlas::LAT) = v.y();
+    lonlat(nodeIdx, atlas::LON) = v.x();
+    lonlat(nodeIdx, atlas::LAT) = v.y();
+    glbIdx(nodeIdx) = nodeIdx + 1;
+    remoteIdx(nodeIdx) = nodeIdx;
+    part(nodeIdx) = 0;
+    ghost(nodeIdx) = 0;
+    flags(nodeIdx) = 0;
+  }
+
+  // cells and edges
+  mesh.cells().add(new atlas::mesh::temporary::Triangle(), numCells);
+  mesh.edges().add(new atlas::mesh::temporary::Line(), numEdges);
+  {
+    auto& cellNodeConnectivity = mesh.cells().node_connectivity();
+    auto glbIdxCell = atlas::array::make_view<atlas::gidx_t, 1>(mesh.cells().global_index());
+    auto partCell = atlas::array::make_view<int, 1>(mesh.cells().partition());
+    for(const auto& f : grid.faces()) {
+      int nodes[3];
+      for(int nbhIdx = 0; nbhIdx < 3; nbhIdx++) {
+        nodes[nbhIdx] = f.vertices()[nbhIdx]->id();
+      }
+      cellNodeConnectivity.set(f.id(), nodes);
+      glbIdxCell(f.id()) = f.id();
+      partCell(f.id()) = 0;
+    }
+    auto& edgeNodeConnectivity = mesh.edges().node_connectivity();
+    auto glbIdxEdge = atlas::array::make_view<atlas::gidx_t, 1>(mesh.edges().global_index());
+    auto partEdge = atlas::array::make_view<int, 1>(mesh.edges().partition());
+    for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+      const toylib::Edge& e = grid.edges()[edgeIdx];
+      int nodes[2] = {e.vertices()[0]->id(), e.vertices()[1]->id()};
+      edgeNodeConnectivity.set(edgeIdx, nodes);
+      glbIdxEdge(edgeIdx) = edgeIdx;
+      partEdge(edgeIdx) = 0;
+    }
+  }
+
+  AddNeighborRows(
+      mesh.cells().edge_connectivity(), grid.faces(),
+      [](const toylib::Face& f) { return f.edges(); }, edgeIdx);
+
+  // edge to cell rows always have two entries
+  const int missingVal = mesh.edges().cell_connectivity().missing_value();
+  std::vector<int> edgeToCell(2 * numEdges, missingVal);
+  for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+    const auto faces = grid.edges()[edgeIdx].get().faces();
+    for(int nbhIdx = 0; nbhIdx < int(faces.size()) && nbhIdx < 2; nbhIdx++) {
+      edgeToCell[2 * edgeIdx + nbhIdx] = faces[nbhIdx]->id();
+    }
+  }
+  mesh.edges().cell_connectivity().add(numEdges, 2, edgeToCell.data());
+
+  // node tables, rows only contain the neighbors present
+  AddNeighborRows(
+      mesh.nodes().edge_connectivity(), grid.vertices(),
+      [](const toylib::Vertex& v) { return v.edges(); }, edgeIdx);
+  AddNeighborRows(
+      mesh.nodes().cell_connectivity(), grid.vertices(),
+      [](const toylib::Vertex& v) { return v.faces(); }, sameIdx);
+
+  return mesh;
+}
+
+atlas::Mesh AtlasMeshFromToylib(const toylib::Grid& grid) {
+  AtlasToylibIndices indices;
+  return AtlasMeshFromToylib(grid, indices);
+}
@@ -0,0 +1,44 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Converts a toylib grid into an atlas mesh with all neighbor tables filled (cell, edge and node
+// to cell, edge and node, except onto the element type itself). The converted mesh represents the
+// same elements with the same neighbors in the same order, such that a stencil run on either
+// backend visits the neighbors (and the entries of sparse dimensions) in the same order:
+//
+//  - nodes and cells keep their toylib ids
+//  - edges are numbered in the order of Grid::edges(), i.e. the valid edges of the grid. toylib
+//    edge ids may have gaps (Grid::all_edges contains invalid edges), see AtlasToylibIndices
+//  - every neighbor table row lists the toylib neighbors in toylib order. node rows only contain
+//    the neighbors present (no missing values), edge to cell rows of boundary edges have a missing
+//    value in the second slot
+//
+// The node coordinates (xy and lonlat) are the toylib vertex coordinates.
+
+#pragma once
+
+#include <vector>
+
+#include <atlas/mesh.h>
+
+#include "../libs/toylib.hpp"
+
+// mapping between the edge numbering of both representations
+struct AtlasToylibIndices {
+  std::vector<int> toylibEdge; // atlas edge index -> toylib edge id
+  std::vector<int> atlasEdge;  // toylib edge id -> atlas edge index, -1 for invalid toylib edges
+};
+
+atlas::Mesh AtlasMeshFromToylib(const toylib::Grid& grid);
+atlas::Mesh AtlasMeshFromToylib(const toylib::Grid& grid, AtlasToylibIndices& indices);
@@ -0,0 +1,105 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "AtlasHaloExchange.h"
+
+#include <algorithm>
+#include <map>
+
+#include <atlas/array.h>
+#include <atlas/mesh/HybridElements.h>
+#include <atlas/mesh/Nodes.h>
+
+namespace {
+// partition and remote_index of the elements of a location type
+std::pair<atlas::Field, atlas::Field> ParallelFields(const atlas::Mesh& mesh,
+                                                     HaloLocation location) {
+  switch(location) {
+  case HaloLocation::Nodes:
+    return {mesh.nodes().partition(), mesh.nodes().remote_index()};
+  case HaloLocation::Edges:
+    return {mesh.edges().partition(), mesh.edges().remote_index()};
+  case HaloLocation::Cells:
+  default:
+    return {mesh.cells().partition(), mesh.cells().remote_index()};
+  }
+}
+} // namespace
+
+std::vector<HaloLists> AtlasHaloLists(const std::vector<AtlasPart>& parts, HaloLocation location) {
+  const int numParts = parts.size();
+
+  // send / receive lists keyed by the neighboring part
+  std::vector<std::map<int, std::vector<int>>> send(numParts);
+  std::vector<std::map<int, std::vector<int>>> recv(numParts);
+  for(int partIdx = 0; partIdx < numParts; partIdx++) {
+    const atlas::Mesh& mesh = parts[partIdx].mesh;
+    auto [partField, remoteField] = ParallelFields(mesh, location);
+    auto owner = atlas::array::make_view<int, 1>(partField);
+    auto remoteIdx = atlas::array::make_indexview<atlas::idx_t, 1>(remoteField);
+    // both sides of an exchange list the elements in the same order (the local order on the
+    // receiving part)
+    for(int idx = 0; idx < owner.size(); idx++) {
+      if(owner(idx) != partIdx) {
+        recv[partIdx][owner(idx)].push_back(idx);
+        send[owner(idx)][partIdx].push_back(remoteIdx(idx));
+      }
+    }
+  }
+
+  std::vector<HaloLists> lists(numParts);
+  for(int partIdx = 0; partIdx < numParts; partIdx++) {
+    HaloLists& partLists = lists[partIdx];
+    for(const auto& [nbh, elems] : send[partIdx]) {
+      partLists.neighbors.push_back(nbh);
+    }
+    for(const auto& [nbh, elems] : recv[partIdx]) {
+      partLists.neighbors.push_back(nbh);
+    }
+    std::sort(partLists.neighbors.begin(), partLists.neighbors.end());
+    partLists.neighbors.erase(std::unique(partLists.neighbors.begin(), partLists.neighbors.end()),
+                              partLists.neighbors.end());
+    for(int nbh : partLists.neighbors) {
+      partLists.send.push_back(std::move(send[partIdx][nbh]));
+      partLists.recv.push_back(std::move(recv[partIdx][nbh]));
+    }
+  }
+  return lists;
+}
+
+MailboxTransport::MailboxTransport(int numParts)
+    : numParts_(numParts), mailboxes_(new Mailbox[numParts * numParts]) {}
+
+void MailboxTransport::send(int fromPart, int toPart, int tag, std::vector<double> message) {
+  Mailbox& box = mailbox(toPart, fromPart);
+  {
+    std::lock_guard<std::mutex> lock(box.mutex);
+    box.messages.emplace_back(tag, std::move(message));
+  }
+  box.arrived.notify_all();
+}
+
+std::vector<double> MailboxTransport::receive(int toPart, int fromPart, int tag) {
+  Mailbox& box = mailbox(toPart, fromPart);
+  std::unique_lock<std::mutex> lock(box.mutex);
+  auto hasTag = [&](const std::pair<int, std::vector<double>>& msg) { return msg.first == tag; };
+  auto msgIt = box.messages.end();
+  box.arrived.wait(lock, [&] {
+    msgIt = std::find_if(box.messages.begin(), box.messages.end(), hasTag);
+    return msgIt != box.messages.end();
+  });
+  std::vector<double> message = std::move(msgIt->second);
+  box.messages.erase(msgIt);
+  return message;
+}
@@ -0,0 +1,132 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Halo exchange between the parts of a partitioned mesh (see AtlasPartition.h), for running
+// stencils on all parts concurrently.
+//
+// AtlasHaloLists computes, for every part, the local elements to send to each neighboring part and
+// the local (halo) elements to receive from it: every element not owned by a part is received
+// from its owner, as given by partition and remote_index. All parts live in the same process, so
+// the lists are computed for all of them at once. In a distributed setting each rank would compute
+// its receive lists locally and send them to the owners once.
+//
+// Messages go through a HaloTransport. MailboxTransport passes them between the threads of one
+// process (one thread per part), standing in for MPI. An MPI transport would implement send and
+// receive on top of MPI_Isend / MPI_Recv, with parts mapped to ranks and the tag passed through.
+//
+// HaloExchange splits the exchange of one field into start() (pack and send the owned values
+// needed by the neighbors) and finish() (receive and unpack the halo values), such that
+// computations which do not depend on the halo can overlap the exchange.
+
+#pragma once
+
+#include <cassert>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include "AtlasPartition.h"
+
+enum class HaloLocation { Nodes = 0, Edges, Cells };
+
+// send and receive lists of one part for one location type. send[i] and recv[i] hold local
+// indices and belong to the part neighbors[i]
+struct HaloLists {
+  std::vector<int> neighbors;
+  std::vector<std::vector<int>> send;
+  std::vector<std::vector<int>> recv;
+};
+
+// halo lists of all parts. edges require complete parts (AtlasPartitionMeshComplete)
+std::vector<HaloLists> AtlasHaloLists(const std::vector<AtlasPart>& parts, HaloLocation location);
+
+class HaloTransport {
+public:
+  virtual ~HaloTransport() = default;
+  // does not block, the message is buffered by the transport
+  virtual void send(int fromPart, int toPart, int tag, std::vector<double> message) = 0;
+  // blocks until a message with tag sent by fromPart has arrived. messages with the same tag from
+  // the same part are received in the order they have been sent
+  virtual std::vector<double> receive(int toPart, int fromPart, int tag) = 0;
+};
+
+class MailboxTransport : public HaloTransport {
+public:
+  explicit MailboxTransport(int numParts);
+  void send(int fromPart, int toPart, int tag, std::vector<double> message) override;
+  std::vector<double> receive(int toPart, int fromPart, int tag) override;
+
+private:
+  struct Mailbox {
+    std::mutex mutex;
+    std::condition_variable arrived;
+    std::deque<std::pair<int, std::vector<double>>> messages;
+  };
+  Mailbox& mailbox(int toPart, int fromPart) { return mailboxes_[toPart * numParts_ + fromPart]; }
+
+  int numParts_;
+  std::unique_ptr<Mailbox[]> mailboxes_;
+};
+
+// exchange of the halo of fields of one part. FieldT is any field type accessed as field(idx, k)
+class HaloExchange {
+public:
+  HaloExchange(HaloTransport& transport, int part, const HaloLists& lists, int tag)
+      : transport_(transport), part_(part), lists_(lists), tag_(tag) {}
+
+  template <typename FieldT>
+  void start(const FieldT& field, int kSize) {
+    for(size_t nbhIdx = 0; nbhIdx < lists_.neighbors.size(); nbhIdx++) {
+      const std::vector<int>& send = lists_.send[nbhIdx];
+      if(send.empty()) {
+        continue;
+      }
+      std::vector<double> message;
+      message.reserve(send.size() * kSize);
+      for(int idx : send) {
+        for(int k = 0; k < kSize; k++) {
+          message.push_back(field(idx, k));
+        }
+      }
+      transport_.send(part_, lists_.neighbors[nbhIdx], tag_, std::move(message));
+    }
+  }
+
+  template <typename FieldT>
+  void finish(FieldT& field, int kSize) {
+    for(size_t nbhIdx = 0; nbhIdx < lists_.neighbors.size(); nbhIdx++) {
+      const std::vector<int>& recv = lists_.recv[nbhIdx];
+      if(recv.empty()) {
+        continue;
+      }
+      std::vector<double> message = transport_.receive(part_, lists_.neighbors[nbhIdx], tag_);
+      assert(message.size() == recv.size() * kSize);
+      int pos = 0;
+      for(int idx : recv) {
+        for(int k = 0; k < kSize; k++) {
+          field(idx, k) = message[pos++];
+        }
+      }
+    }
+  }
+
+private:
+  HaloTransport& transport_;
+  int part_;
+  const HaloLists& lists_;
+  int tag_;
+};
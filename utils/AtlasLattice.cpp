@@ -0,0 +1,384 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "AtlasLattice.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <tuple>
+
+#include <atlas/array.h>
+#include <atlas/util/CoordinateEnums.h>
+
+#include "ParallelFor.h"
+
+namespace {
+// maximum deviation of a node from its lattice position, in units of the lattice spacing
+const double latticeTolerance = 1e-3;
+
+struct LatticePoint {
+  int i;
+  int j;
+  bool operator<(const LatticePoint& other) const {
+    return std::tie(j, i) < std::tie(other.j, other.i);
+  }
+};
+
+// collects mesh indices, skipping positions which are not part of the mesh
+class NeighborWriter {
+public:
+  explicit NeighborWriter(int* nbh) : nbh_(nbh) {}
+  void operator()(int idx) {
+    if(idx != -1) {
+      nbh_[size_++] = idx;
+    }
+  }
+  int size() const { return size_; }
+
+private:
+  int* nbh_;
+  int size_ = 0;
+};
+
+// true if the valid entries of every row are a permutation of the lattice neighbors. tables which
+// have not been built (no rows) are skipped, here and in WriteRows
+template <typename ConnectivityT, typename NbhFn>
+bool RowsMatch(const ConnectivityT& conn, int numRows, NbhFn&& nbhOf) {
+  if(conn.rows() == 0) {
+    return true;
+  }
+  if(conn.rows() != numRows) {
+    return false;
+  }
+  std::atomic<bool> match{true};
+  ParallelFor(0, numRows, [&](int row) {
+    int nbh[AtlasLattice::maxNeighbors];
+    int numNbh = nbhOf(row, nbh);
+    std::vector<int> present;
+    for(int col = 0; col < conn.cols(row); col++) {
+      if(conn(row, col) != conn.missing_value()) {
+        present.push_back(conn(row, col));
+      }
+    }
+    std::sort(nbh, nbh + numNbh);
+    std::sort(present.begin(), present.end());
+    if(!std::equal(nbh, nbh + numNbh, present.begin(), present.end())) {
+      match = false;
+    }
+  });
+  return match;
+}
+
+template <typename ConnectivityT, typename NbhFn>
+void WriteRows(ConnectivityT& conn, int numRows, NbhFn&& nbhOf) {
+  if(conn.rows() == 0) {
+    return;
+  }
+  ParallelFor(0, numRows, [&](int row) {
+    int nbh[AtlasLattice::maxNeighbors];
+    int numNbh = nbhOf(row, nbh);
+    for(int col = 0; col < conn.cols(row); col++) {
+      conn.set(row, col, col < numNbh ? nbh[col] : conn.missing_value());
+    }
+  });
+}
+} // namespace
+
+//===------------------------------------------------------------------------------------------===//
+// neighbors in lattice order
+//===------------------------------------------------------------------------------------------===//
+
+int AtlasLattice::nodesOfCell(int cellIdx, int nbh[]) const {
+  auto [i, j, c] = cellPosition(cellIdx);
+  NeighborWriter out(nbh);
+  if(c == LatticeCell::Up) {
+    out(node(i, j));
+    out(node(i + 1, j));
+    out(node(i, j + 1));
+  } else {
+    out(node(i + 1, j));
+    out(node(i + 1, j + 1));
+    out(node(i, j + 1));
+  }
+  return out.size();
+}
+
+int AtlasLattice::edgesOfCell(int cellIdx, int nbh[]) const {
+  auto [i, j, c] = cellPosition(cellIdx);
+  NeighborWriter out(nbh);
+  if(c == LatticeCell::Up) {
+    out(edge(i, j, LatticeEdge::Horizontal));
+    out(edge(i, j, LatticeEdge::Falling));
+    out(edge(i, j, LatticeEdge::Rising));
+  } else {
+    out(edge(i + 1, j, LatticeEdge::Rising));
+    out(edge(i, j + 1, LatticeEdge::Horizontal));
+    out(edge(i, j, LatticeEdge::Falling));
+  }
+  return out.size();
+}
+
+int AtlasLattice::nodesOfEdge(int edgeIdx, int nbh[]) const {
+  auto [i, j, c] = edgePosition(edgeIdx);
+  NeighborWriter out(nbh);
+  switch(c) {
+  case LatticeEdge::Horizontal:
+    out(node(i, j));
+    out(node(i + 1, j));
+    break;
+  case LatticeEdge::Rising:
+    out(node(i, j));
+    out(node(i, j + 1));
+    break;
+  case LatticeEdge::Falling:
+    out(node(i + 1, j));
+    out(node(i, j + 1));
+    break;
+  }
+  return out.size();
+}
+
+int AtlasLattice::cellsOfEdge(int edgeIdx, int nbh[]) const {
+  auto [i, j, c] = edgePosition(edgeIdx);
+  NeighborWriter out(nbh);
+  out(cell(i, j, LatticeCell::Up));
+  switch(c) {
+  case LatticeEdge::Horizontal:
+    out(cell(i, j - 1, LatticeCell::Down));
+    break;
+  case LatticeEdge::Rising:
+    out(cell(i - 1, j, LatticeCell::Down));
+    break;
+  case LatticeEdge::Falling:
+    out(cell(i, j, LatticeCell::Down));
+    break;
+  }
+  return out.size();
+}
+
+// counter clockwise, starting east
+int AtlasLattice::edgesOfNode(int nodeIdx, int nbh[]) const {
+  auto [i, j] = nodePosition(nodeIdx);
+  NeighborWriter out(nbh);
+  out(edge(i, j, LatticeEdge::Horizontal));
+  out(edge(i, j, LatticeEdge::Rising));
+  out(edge(i - 1, j, LatticeEdge::Falling));
+  out(edge(i - 1, j, LatticeEdge::Horizontal));
+  out(edge(i, j - 1, LatticeEdge::Rising));
+  out(edge(i, j - 1, LatticeEdge::Falling));
+  return out.size();
+}
+
+// counter clockwise, starting with the cell between the east and the north east edge
+int AtlasLattice::cellsOfNode(int nodeIdx, int nbh[]) const {
+  auto [i, j] = nodePosition(nodeIdx);
+  NeighborWriter out(nbh);
+  out(cell(i, j, LatticeCell::Up));
+  out(cell(i - 1, j, LatticeCell::Down));
+  out(cell(i - 1, j, LatticeCell::Up));
+  out(cell(i - 1, j - 1, LatticeCell::Down));
+  out(cell(i, j - 1, LatticeCell::Up));
+  out(cell(i, j - 1, LatticeCell::Down));
+  return out.size();
+}
+
+size_t AtlasLattice::footprint() const {
+  return sizeof(int) * (nodeAt_.capacity() + edgeAt_.capacity() + cellAt_.capacity() +
+                        nodePos_.capacity() + edgePos_.capacity() + cellPos_.capacity()) +
+         interiorNode_.capacity() + interiorEdge_.capacity();
+}
+
+//===------------------------------------------------------------------------------------------===//
+// construction
+//===------------------------------------------------------------------------------------------===//
+
+std::optional<AtlasLattice> AtlasLatticeFromMesh(const atlas::Mesh& mesh) {
+  const int numNodes = mesh.nodes().size();
+  const int numEdges = mesh.edges().size();
+  const int numCells = mesh.cells().size();
+  if(numNodes == 0 || numEdges == 0 || numCells == 0) {
+    return std::nullopt;
+  }
+
+  auto xy = atlas::array::make_view<double, 2>(mesh.nodes().xy());
+  const auto& edgeToNode = mesh.edges().node_connectivity();
+  const auto& cellToNode = mesh.cells().node_connectivity();
+
+  // lattice spacing from the first edge, all other edges are checked implicitly below
+  const double l = hypot(xy(edgeToNode(0, 1), atlas::LON) - xy(edgeToNode(0, 0), atlas::LON),
+                         xy(edgeToNode(0, 1), atlas::LAT) - xy(edgeToNode(0, 0), atlas::LAT));
+  const double h = 0.5 * sqrt(3) * l;
+  if(!(l > 0.)) {
+    return std::nullopt;
+  }
+
+  double xMin = std::numeric_limits<double>::max();
+  double yMin = std::numeric_limits<double>::max();
+  for(int nodeIdx = 0; nodeIdx < numNodes; nodeIdx++) {
+    xMin = fmin(xMin, xy(nodeIdx, atlas::LON));
+    yMin = fmin(yMin, xy(nodeIdx, atlas::LAT));
+  }
+
+  // lattice position of each node. x is only a multiple of l up to a constant offset, which is
+  // taken from the first node
+  std::vector<LatticePoint> nodePoint(numNodes);
+  double offsetI = 0.;
+  for(int nodeIdx = 0; nodeIdx < numNodes; nodeIdx++) {
+    double fracJ = (xy(nodeIdx, atlas::LAT) - yMin) / h;
+    int j = lround(fracJ);
+    double fracI = (xy(nodeIdx, atlas::LON) - xMin) / l - 0.5 * j;
+    if(nodeIdx == 0) {
+      offsetI = fracI - round(fracI);
+    }
+    int i = lround(fracI - offsetI);
+    if(fabs(fracJ - j) > latticeTolerance || fabs(fracI - offsetI - i) > latticeTolerance) {
+      return std::nullopt;
+    }
+    nodePoint[nodeIdx] = {i, j};
+  }
+  const int iMin =
+      std::min_element(nodePoint.begin(), nodePoint.end(),
+                       [](const LatticePoint& a, const LatticePoint& b) { return a.i < b.i; })
+          ->i;
+
+  AtlasLattice lattice;
+  for(auto& p : nodePoint) {
+    p.i -= iMin;
+    lattice.nI_ = std::max(lattice.nI_, p.i + 1);
+    lattice.nJ_ = std::max(lattice.nJ_, p.j + 1);
+  }
+  const int numPositions = lattice.nI_ * lattice.nJ_;
+  lattice.nodeAt_.assign(numPositions, -1);
+  lattice.edgeAt_.assign(3 * numPositions, -1);
+  lattice.cellAt_.assign(2 * numPositions, -1);
+  lattice.nodePos_.resize(numNodes);
+  lattice.edgePos_.resize(numEdges);
+  lattice.cellPos_.resize(numCells);
+
+  auto place = [](std::vector<int>& at, std::vector<int>& pos, int elemIdx, int position) {
+    if(at[position] != -1) {
+      return false;
+    }
+    at[position] = elemIdx;
+    pos[elemIdx] = position;
+    return true;
+  };
+
+  for(int nodeIdx = 0; nodeIdx < numNodes; nodeIdx++) {
+    const LatticePoint& p = nodePoint[nodeIdx];
+    if(!place(lattice.nodeAt_, lattice.nodePos_, nodeIdx, p.j * lattice.nI_ + p.i)) {
+      return std::nullopt;
+    }
+  }
+
+  for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+    LatticePoint lo = nodePoint[edgeToNode(edgeIdx, 0)];
+    LatticePoint hi = nodePoint[edgeToNode(edgeIdx, 1)];
+    if(hi < lo) {
+      std::swap(lo, hi);
+    }
+    LatticePoint anchor = lo;
+    LatticeEdge color;
+    if(hi.j == lo.j && hi.i == lo.i + 1) {
+      color = LatticeEdge::Horizontal;
+    } else if(hi.j == lo.j + 1 && hi.i == lo.i) {
+      color = LatticeEdge::Rising;
+    } else if(hi.j == lo.j + 1 && hi.i == lo.i - 1) {
+      color = LatticeEdge::Falling;
+      anchor.i = hi.i;
+    } else {
+      return std::nullopt;
+    }
+    int position = 3 * (anchor.j * lattice.nI_ + anchor.i) + int(color);
+    if(!place(lattice.edgeAt_, lattice.edgePos_, edgeIdx, position)) {
+      return std::nullopt;
+    }
+  }
+
+  for(int cellIdx = 0; cellIdx < numCells; cellIdx++) {
+    if(cellToNode.cols(cellIdx) != 3) {
+      return std::nullopt;
+    }
+    std::array<LatticePoint, 3> p = {nodePoint[cellToNode(cellIdx, 0)],
+                                     nodePoint[cellToNode(cellIdx, 1)],
+                                     nodePoint[cellToNode(cellIdx, 2)]};
+    std::sort(p.begin(), p.end());
+    int position;
+    if(p[0].j == p[1].j && p[1].i == p[0].i + 1 && p[2].j == p[0].j + 1 && p[2].i == p[0].i) {
+      position = 2 * (p[0].j * lattice.nI_ + p[0].i) + int(LatticeCell::Up);
+    } else if(p[1].j == p[0].j + 1 && p[2].j == p[1].j && p[2].i == p[1].i + 1 &&
+              p[0].i == p[2].i) {
+      position = 2 * (p[0].j * lattice.nI_ + p[1].i) + int(LatticeCell::Down);
+    } else {
+      return std::nullopt;
+    }
+    if(!place(lattice.cellAt_, lattice.cellPos_, cellIdx, position)) {
+      return std::nullopt;
+    }
+  }
+
+  lattice.interiorNode_.resize(numNodes);
+  lattice.interiorEdge_.resize(numEdges);
+  ParallelFor(0, numNodes, [&](int nodeIdx) {
+    int nbh[AtlasLattice::maxNeighbors];
+    lattice.interiorNode_[nodeIdx] = lattice.cellsOfNode(nodeIdx, nbh) == 6;
+  });
+  ParallelFor(0, numEdges, [&](int edgeIdx) {
+    int nbh[AtlasLattice::maxNeighbors];
+    lattice.interiorEdge_[edgeIdx] = lattice.cellsOfEdge(edgeIdx, nbh) == 2;
+  });
+
+  return lattice;
+}
+
+bool AtlasSortByLattice(atlas::Mesh& mesh, const AtlasLattice& lattice) {
+  auto& cellToNode = mesh.cells().node_connectivity();
+  auto& cellToEdge = mesh.cells().edge_connectivity();
+  auto& edgeToNode = mesh.edges().node_connectivity();
+  auto& edgeToCell = mesh.edges().cell_connectivity();
+  auto& nodeToEdge = mesh.nodes().edge_connectivity();
+  auto& nodeToCell = mesh.nodes().cell_connectivity();
+
+  const int numNodes = mesh.nodes().size();
+  const int numEdges = mesh.edges().size();
+  const int numCells = mesh.cells().size();
+
+  auto nodesOfCell = [&](int idx, int nbh[]) { return lattice.nodesOfCell(idx, nbh); };
+  auto edgesOfCell = [&](int idx, int nbh[]) { return lattice.edgesOfCell(idx, nbh); };
+  auto nodesOfEdge = [&](int idx, int nbh[]) { return lattice.nodesOfEdge(idx, nbh); };
+  auto cellsOfEdge = [&](int idx, int nbh[]) { return lattice.cellsOfEdge(idx, nbh); };
+  auto edgesOfNode = [&](int idx, int nbh[]) { return lattice.edgesOfNode(idx, nbh); };
+  auto cellsOfNode = [&](int idx, int nbh[]) { return lattice.cellsOfNode(idx, nbh); };
+
+  // check everything first, s.t. the mesh is either fully sorted or not touched at all
+  if(!RowsMatch(cellToNode, numCells, nodesOfCell) ||
+     !RowsMatch(cellToEdge, numCells, edgesOfCell) ||
+     !RowsMatch(edgeToNode, numEdges, nodesOfEdge) ||
+     !RowsMatch(edgeToCell, numEdges, cellsOfEdge) ||
+     !RowsMatch(nodeToEdge, numNodes, edgesOfNode) ||
+     !RowsMatch(nodeToCell, numNodes, cellsOfNode)) {
+    return false;
+  }
+
+  WriteRows(cellToNode, numCells, nodesOfCell);
+  WriteRows(cellToEdge, numCells, edgesOfCell);
+  WriteRows(edgeToNode, numEdges, nodesOfEdge);
+  WriteRows(edgeToCell, numEdges, cellsOfEdge);
+  WriteRows(nodeToEdge, numNodes, edgesOfNode);
+  WriteRows(nodeToCell, numNodes, cellsOfNode);
+  return true;
+}
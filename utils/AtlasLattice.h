@@ -0,0 +1,124 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Structured view of a planar mesh of equilateral triangles, i.e. of a section of the regular
+// triangle lattice. This applies to the meshes returned by AtlasProjectMesh and AtlasMeshRect /
+// AtlasMeshSquare (and their Complete variants).
+//
+// Lattice nodes sit at x = x0 + l * (i + j / 2), y = y0 + j * h, where l is the edge length and h
+// the height of the triangles. Edges and cells are addressed by the lattice position (i, j) of
+// their anchor node and a color:
+//
+//    (i,j+1)_____(i+1,j+1)     edge (i,j,Horizontal):  (i,j)   - (i+1,j)
+//         /\    /              edge (i,j,Rising):      (i,j)   - (i,j+1)
+//        /  \ D/               edge (i,j,Falling):     (i+1,j) - (i,j+1)
+//       / U  \/                cell (i,j,Up):          (i,j), (i+1,j), (i,j+1)
+//  (i,j)------(i+1,j)          cell (i,j,Down):        (i+1,j), (i+1,j+1), (i,j+1)
+//
+// The view stores dense maps lattice position -> mesh index (-1 if the position is not part of
+// the mesh) and mesh index -> lattice position. Neighbors can thus be computed by index arithmetic
+// on the lattice position. All neighbor functions below return the neighbors in a fixed "lattice
+// order" (counter clockwise, see AtlasLattice.cpp) and skip neighbors which are not part of the
+// mesh. AtlasSortByLattice rewrites the neighbor tables of the mesh into that same order, after
+// which arithmetic neighbors and table neighbors can be used interchangeably.
+
+#pragma once
+
+#include <optional>
+#include <tuple>
+#include <vector>
+
+#include <atlas/mesh.h>
+
+enum class LatticeEdge { Horizontal = 0, Rising, Falling };
+enum class LatticeCell { Up = 0, Down };
+
+class AtlasLattice {
+public:
+  // maximum number of neighbors of any element
+  static constexpr int maxNeighbors = 6;
+
+  int nI() const { return nI_; }
+  int nJ() const { return nJ_; }
+
+  //===--------------------------------------------------------------------------------------===//
+  // lattice position -> mesh index, -1 if the position is not part of the mesh
+  //===--------------------------------------------------------------------------------------===//
+  int node(int i, int j) const { return inside(i, j) ? nodeAt_[j * nI_ + i] : -1; }
+  int edge(int i, int j, LatticeEdge c) const {
+    return inside(i, j) ? edgeAt_[3 * (j * nI_ + i) + int(c)] : -1;
+  }
+  int cell(int i, int j, LatticeCell c) const {
+    return inside(i, j) ? cellAt_[2 * (j * nI_ + i) + int(c)] : -1;
+  }
+
+  //===--------------------------------------------------------------------------------------===//
+  // mesh index -> lattice position
+  //===--------------------------------------------------------------------------------------===//
+  std::tuple<int, int> nodePosition(int nodeIdx) const {
+    return {nodePos_[nodeIdx] % nI_, nodePos_[nodeIdx] / nI_};
+  }
+  std::tuple<int, int, LatticeEdge> edgePosition(int edgeIdx) const {
+    const int pos = edgePos_[edgeIdx] / 3;
+    return {pos % nI_, pos / nI_, LatticeEdge(edgePos_[edgeIdx] % 3)};
+  }
+  std::tuple<int, int, LatticeCell> cellPosition(int cellIdx) const {
+    const int pos = cellPos_[cellIdx] / 2;
+    return {pos % nI_, pos / nI_, LatticeCell(cellPos_[cellIdx] % 2)};
+  }
+
+  // true if all neighbors of the element are part of the mesh. cells are always complete
+  bool interiorNode(int nodeIdx) const { return interiorNode_[nodeIdx]; }
+  bool interiorEdge(int edgeIdx) const { return interiorEdge_[edgeIdx]; }
+
+  // bytes held by the maps between lattice positions and mesh indices
+  size_t footprint() const;
+
+  //===--------------------------------------------------------------------------------------===//
+  // neighbors in lattice order, by index arithmetic. nbh needs to hold maxNeighbors entries,
+  // returns the number of neighbors written
+  //===--------------------------------------------------------------------------------------===//
+  int nodesOfCell(int cellIdx, int nbh[]) const;
+  int edgesOfCell(int cellIdx, int nbh[]) const;
+  int nodesOfEdge(int edgeIdx, int nbh[]) const;
+  int cellsOfEdge(int edgeIdx, int nbh[]) const;
+  int edgesOfNode(int nodeIdx, int nbh[]) const;
+  int cellsOfNode(int nodeIdx, int nbh[]) const;
+
+private:
+  friend std::optional<AtlasLattice> AtlasLatticeFromMesh(const atlas::Mesh& mesh);
+
+  bool inside(int i, int j) const { return i >= 0 && j >= 0 && i < nI_ && j < nJ_; }
+
+  int nI_ = 0;
+  int nJ_ = 0;
+  std::vector<int> nodeAt_;
+  std::vector<int> edgeAt_;
+  std::vector<int> cellAt_;
+  std::vector<int> nodePos_;
+  std::vector<int> edgePos_;
+  std::vector<int> cellPos_;
+  std::vector<char> interiorNode_;
+  std::vector<char> interiorEdge_;
+};
+
+// reconstructs the lattice from the node coordinates (xy) and the cell to node and edge to node
+// tables. returns std::nullopt if the mesh is not a section of an equilateral triangle lattice
+std::optional<AtlasLattice> AtlasLatticeFromMesh(const atlas::Mesh& mesh);
+
+// rewrites all neighbor tables (cell, edge and node to cell, edge and node) which have been built
+// into lattice order. rows of elements at the boundary list the neighbors present first, followed
+// by missing values if the row is wider. returns false (and leaves the mesh untouched) if the
+// tables do not agree with the lattice
+bool AtlasSortByLattice(atlas::Mesh& mesh, const AtlasLattice& lattice);
@@ -0,0 +1,429 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "AtlasPartition.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#include <atlas/array.h>
+#include <atlas/mesh/HybridElements.h>
+#include <atlas/mesh/Nodes.h>
+
+#include "ParallelFor.h"
+
+namespace {
+// cells adjacent to each node (in ascending order), inverted from cell -> node so that minimal
+// meshes can be partitioned as well
+class NodeToCells {
+public:
+  explicit NodeToCells(const atlas::Mesh& mesh) : offset_(mesh.nodes().size() + 1, 0) {
+    const auto& cellToNode = mesh.cells().node_connectivity();
+    const int numCells = mesh.cells().size();
+    for(int cellIdx = 0; cellIdx < numCells; cellIdx++) {
+      for(int nbhIdx = 0; nbhIdx < cellToNode.cols(cellIdx); nbhIdx++) {
+        offset_[cellToNode(cellIdx, nbhIdx) + 1]++;
+      }
+    }
+    std::partial_sum(offset_.begin(), offset_.end(), offset_.begin());
+    cells_.resize(offset_.back());
+    std::vector<int> pos(offset_.begin(), offset_.end() - 1);
+    for(int cellIdx = 0; cellIdx < numCells; cellIdx++) {
+      for(int nbhIdx = 0; nbhIdx < cellToNode.cols(cellIdx); nbhIdx++) {
+        cells_[pos[cellToNode(cellIdx, nbhIdx)]++] = cellIdx;
+      }
+    }
+  }
+  const int* begin(int nodeIdx) const { return cells_.data() + offset_[nodeIdx]; }
+  const int* end(int nodeIdx) const { return cells_.data() + offset_[nodeIdx + 1]; }
+  bool empty(int nodeIdx) const { return offset_[nodeIdx] == offset_[nodeIdx + 1]; }
+
+private:
+  std::vector<int> offset_;
+  std::vector<int> cells_;
+};
+
+// cells sharing an edge (i.e. two nodes) with each cell, padded with -1
+using CellNeighbors = std::vector<std::array<int, 3>>;
+
+CellNeighbors EdgeNeighborCells(const atlas::Mesh& mesh, const NodeToCells& nodeToCells) {
+  const auto& cellToNode = mesh.cells().node_connectivity();
+  CellNeighbors neighbors(mesh.cells().size());
+  ParallelFor(0, mesh.cells().size(), [&](int cellIdx) {
+    assert(cellToNode.cols(cellIdx) == 3);
+    // every edge neighbor is adjacent to exactly two of the nodes of the cell
+    std::array<int, 18> candidates;
+    int numCandidates = 0;
+    for(int nbhIdx = 0; nbhIdx < 3; nbhIdx++) {
+      const int nodeIdx = cellToNode(cellIdx, nbhIdx);
+      for(const int* it = nodeToCells.begin(nodeIdx); it != nodeToCells.end(nodeIdx); ++it) {
+        if(*it != cellIdx && numCandidates < int(candidates.size())) {
+          candidates[numCandidates++] = *it;
+        }
+      }
+    }
+    std::sort(candidates.begin(), candidates.begin() + numCandidates);
+    std::array<int, 3>& nbh = neighbors[cellIdx];
+    nbh.fill(-1);
+    int numNbh = 0;
+    for(int candIdx = 1; candIdx < numCandidates && numNbh < 3; candIdx++) {
+      if(candidates[candIdx] == candidates[candIdx - 1]) {
+        nbh[numNbh++] = candidates[candIdx];
+      }
+    }
+  });
+  return neighbors;
+}
+
+// recursive coordinate bisection. the recursion is unrolled into levels, the segments of a level
+// are split in parallel
+std::vector<int> RecursiveBisection(const std::vector<Point>& midpoints, int numParts) {
+  struct Segment {
+    int lo;
+    int hi;
+    int firstPart;
+    int numParts;
+  };
+
+  const int numCells = midpoints.size();
+  std::vector<int> order(numCells);
+  std::iota(order.begin(), order.end(), 0);
+
+  std::vector<Segment> segments{{0, numCells, 0, numParts}};
+  auto unsplit = [](const Segment& seg) { return seg.numParts > 1; };
+  while(std::any_of(segments.begin(), segments.end(), unsplit)) {
+    std::vector<Segment> next(2 * segments.size(), {0, 0, 0, 0});
+    ParallelTasks(segments.size(), [&](int segIdx) {
+      const Segment& seg = segments[segIdx];
+      if(seg.numParts == 1) {
+        next[2 * segIdx] = seg;
+        return;
+      }
+      double xLo = std::numeric_limits<double>::max();
+      double yLo = std::numeric_limits<double>::max();
+      double xHi = -std::numeric_limits<double>::max();
+      double yHi = -std::numeric_limits<double>::max();
+      for(int idx = seg.lo; idx < seg.hi; idx++) {
+        auto [x, y] = midpoints[order[idx]];
+        xLo = fmin(x, xLo);
+        yLo = fmin(y, yLo);
+        xHi = fmax(x, xHi);
+        yHi = fmax(y, yHi);
+      }
+      const bool splitX = xHi - xLo >= yHi - yLo;
+      auto coord = [&](int cellIdx) {
+        return splitX ? std::get<0>(midpoints[cellIdx]) : std::get<1>(midpoints[cellIdx]);
+      };
+
+      const int leftParts = seg.numParts / 2;
+      const int mid = seg.lo + int(long(seg.hi - seg.lo) * leftParts / seg.numParts);
+      // ties are broken by the cell index, which keeps the partition deterministic
+      auto less = [&](int a, int b) {
+        return std::make_pair(coord(a), a) < std::make_pair(coord(b), b);
+      };
+      std::nth_element(order.begin() + seg.lo, order.begin() + mid, order.begin() + seg.hi, less);
+      next[2 * segIdx] = {seg.lo, mid, seg.firstPart, leftParts};
+      next[2 * segIdx + 1] = {mid, seg.hi, seg.firstPart + leftParts, seg.numParts - leftParts};
+    });
+    next.erase(std::remove_if(next.begin(), next.end(),
+                              [](const Segment& seg) { return seg.numParts == 0; }),
+               next.end());
+    segments = std::move(next);
+  }
+
+  std::vector<int> cellPart(numCells);
+  ParallelTasks(segments.size(), [&](int segIdx) {
+    const Segment& seg = segments[segIdx];
+    for(int idx = seg.lo; idx < seg.hi; idx++) {
+      cellPart[order[idx]] = seg.firstPart;
+    }
+  });
+  return cellPart;
+}
+
+// greedy boundary refinement: cells are moved to the neighboring part most of their edge neighbors
+// belong to if this reduces the edge cut (or keeps it and improves the balance). no part grows
+// beyond maxImbalance times the average part size or shrinks below the average part size divided
+// by maxImbalance
+void RefineGreedy(const CellNeighbors& neighbors, int numParts, std::vector<int>& cellPart) {
+  const int maxSweeps = 8;
+  const double maxImbalance = 1.03;
+
+  const int numCells = cellPart.size();
+  std::vector<int> partSize(numParts, 0);
+  for(int part : cellPart) {
+    partSize[part]++;
+  }
+  const int maxSize = int(ceil(maxImbalance * numCells / numParts));
+  const int minSize = std::max(1, int(floor(double(numCells) / numParts / maxImbalance)));
+
+  for(int sweep = 0; sweep < maxSweeps; sweep++) {
+    int numMoved = 0;
+    for(int cellIdx = 0; cellIdx < numCells; cellIdx++) {
+      const int from = cellPart[cellIdx];
+      auto count = [&](int part) {
+        int num = 0;
+        for(int nbhIdx : neighbors[cellIdx]) {
+          num += nbhIdx != -1 && cellPart[nbhIdx] == part;
+        }
+        return num;
+      };
+
+      int best = -1;
+      int bestCount = 0;
+      for(int nbhIdx : neighbors[cellIdx]) {
+        if(nbhIdx == -1 || cellPart[nbhIdx] == from) {
+          continue;
+        }
+        const int to = cellPart[nbhIdx];
+        const int toCount = count(to);
+        if(partSize[to] < maxSize && (best == -1 || toCount > bestCount ||
+                                      (toCount == bestCount && partSize[to] < partSize[best]))) {
+          best = to;
+          bestCount = toCount;
+        }
+      }
+      if(best == -1 || partSize[from] <= minSize) {
+        continue;
+      }
+
+      const int gain = bestCount - count(from);
+      if(gain > 0 || (gain == 0 && partSize[from] > partSize[best] + 1)) {
+        cellPart[cellIdx] = best;
+        partSize[from]--;
+        partSize[best]++;
+        numMoved++;
+      }
+    }
+    if(numMoved == 0) {
+      break;
+    }
+  }
+}
+
+std::vector<AtlasPart> AtlasPartitionMeshImpl(const atlas::Mesh& mesh,
+                                              const std::vector<int>& cellPart, int numParts,
+                                              int haloDepth, bool complete) {
+  const int numNodes = mesh.nodes().size();
+  const int numEdges = mesh.edges().size();
+  const int numCells = mesh.cells().size();
+  assert(int(cellPart.size()) == numCells);
+  assert(haloDepth >= 0);
+
+  const auto& cellToNodeIn = mesh.cells().node_connectivity();
+  const NodeToCells nodeToCells(mesh);
+
+  // owners of nodes and edges
+  std::vector<int> nodeOwner(numNodes, -1);
+  ParallelFor(0, numNodes, [&](int nodeIdx) {
+    if(!nodeToCells.empty(nodeIdx)) {
+      nodeOwner[nodeIdx] = cellPart[*nodeToCells.begin(nodeIdx)];
+    }
+  });
+  std::vector<int> edgeOwner;
+  if(complete) {
+    const auto& edgeToCellIn = mesh.edges().cell_connectivity();
+    edgeOwner.resize(numEdges, -1);
+    ParallelFor(0, numEdges, [&](int edgeIdx) {
+      int minCell = numCells;
+      for(int nbhIdx = 0; nbhIdx < edgeToCellIn.cols(edgeIdx); nbhIdx++) {
+        const int cellIdx = edgeToCellIn(edgeIdx, nbhIdx);
+        if(cellIdx != edgeToCellIn.missing_value()) {
+          minCell = std::min(minCell, cellIdx);
+        }
+      }
+      edgeOwner[edgeIdx] = minCell < numCells ? cellPart[minCell] : -1;
+    });
+  }
+
+  std::vector<std::vector<int>> ownedCells(numParts);
+  for(int cellIdx = 0; cellIdx < numCells; cellIdx++) {
+    assert(cellPart[cellIdx] >= 0 && cellPart[cellIdx] < numParts);
+    ownedCells[cellPart[cellIdx]].push_back(cellIdx);
+  }
+
+  // cut out the parts, owned cells first followed by the halo layers
+  std::vector<AtlasPart> parts(numParts);
+  std::vector<int> cellLayer(numCells, -1);
+  for(int partIdx = 0; partIdx < numParts; partIdx++) {
+    std::vector<int> cells = std::move(ownedCells[partIdx]);
+    for(int cellIdx : cells) {
+      cellLayer[cellIdx] = 0;
+    }
+    int layerBegin = 0;
+    for(int layer = 1; layer <= haloDepth; layer++) {
+      const int layerEnd = cells.size();
+      std::vector<int> halo;
+      for(int idx = layerBegin; idx < layerEnd; idx++) {
+        for(int nbhIdx = 0; nbhIdx < cellToNodeIn.cols(cells[idx]); nbhIdx++) {
+          const int nodeIdx = cellToNodeIn(cells[idx], nbhIdx);
+          for(const int* it = nodeToCells.begin(nodeIdx); it != nodeToCells.end(nodeIdx); ++it) {
+            if(cellLayer[*it] == -1) {
+              cellLayer[*it] = layer;
+              halo.push_back(*it);
+            }
+          }
+        }
+      }
+      std::sort(halo.begin(), halo.end());
+      cells.insert(cells.end(), halo.begin(), halo.end());
+      layerBegin = layerEnd;
+    }
+
+    AtlasPart& part = parts[partIdx];
+    part.numOwnedCells = std::count_if(cells.begin(), cells.end(),
+                                       [&](int cellIdx) { return cellLayer[cellIdx] == 0; });
+    part.mesh = complete ? AtlasExtractSubMeshComplete(mesh, cells, part.indices)
+                         : AtlasExtractSubMeshMinimal(mesh, cells, part.indices);
+
+    auto haloCell = atlas::array::make_view<int, 1>(part.mesh.cells().halo());
+    ParallelFor(0, cells.size(),
+                [&](int cellIdx) { haloCell(cellIdx) = cellLayer[cells[cellIdx]]; });
+    for(int cellIdx : cells) {
+      cellLayer[cellIdx] = -1;
+    }
+  }
+
+  // local index of every element on its owning part
+  auto localOnOwner = [&](auto oldIndices, const std::vector<int>& owner, int size) {
+    std::vector<int> local(size, -1);
+    for(int partIdx = 0; partIdx < numParts; partIdx++) {
+      const std::vector<int>& old = parts[partIdx].indices.*oldIndices;
+      ParallelFor(0, old.size(), [&](int localIdx) {
+        if(owner[old[localIdx]] == partIdx) {
+          local[old[localIdx]] = localIdx;
+        }
+      });
+    }
+    return local;
+  };
+  const std::vector<int> nodeRemote =
+      localOnOwner(&AtlasSubMeshIndices::nodes, nodeOwner, numNodes);
+  const std::vector<int> cellRemote =
+      localOnOwner(&AtlasSubMeshIndices::cells, cellPart, numCells);
+  const std::vector<int> edgeRemote =
+      complete ? localOnOwner(&AtlasSubMeshIndices::edges, edgeOwner, numEdges)
+               : std::vector<int>();
+
+  // parallel fields
+  auto glbIdxCellIn = atlas::array::make_view<atlas::gidx_t, 1>(mesh.cells().global_index());
+  for(int partIdx = 0; partIdx < numParts; partIdx++) {
+    AtlasPart& part = parts[partIdx];
+    const AtlasSubMeshIndices& indices = part.indices;
+
+    atlas::mesh::HybridElements& cells = part.mesh.cells();
+    auto glbIdxCell = atlas::array::make_view<atlas::gidx_t, 1>(cells.global_index());
+    auto partCell = atlas::array::make_view<int, 1>(cells.partition());
+    auto remoteIdxCell = atlas::array::make_indexview<atlas::idx_t, 1>(cells.remote_index());
+    auto haloCell = atlas::array::make_view<int, 1>(cells.halo());
+    ParallelFor(0, indices.cells.size(), [&](int cellIdx) {
+      const int oldIdx = indices.cells[cellIdx];
+      glbIdxCell(cellIdx) = glbIdxCellIn(oldIdx);
+      partCell(cellIdx) = cellPart[oldIdx];
+      remoteIdxCell(cellIdx) = cellRemote[oldIdx];
+    });
+
+    // global indices of nodes have been copied by the extraction already
+    atlas::mesh::Nodes& nodes = part.mesh.nodes();
+    auto partNode = atlas::array::make_view<int, 1>(nodes.partition());
+    auto remoteIdxNode = atlas::array::make_indexview<atlas::idx_t, 1>(nodes.remote_index());
+    auto ghost = atlas::array::make_view<int, 1>(nodes.ghost());
+    auto flags = atlas::array::make_view<int, 1>(nodes.flags());
+    auto haloNode = atlas::array::make_view<int, 1>(nodes.halo());
+    ParallelFor(0, indices.nodes.size(), [&](int nodeIdx) {
+      const int oldIdx = indices.nodes[nodeIdx];
+      partNode(nodeIdx) = nodeOwner[oldIdx];
+      remoteIdxNode(nodeIdx) = nodeRemote[oldIdx];
+      ghost(nodeIdx) = nodeOwner[oldIdx] != partIdx;
+      if(ghost(nodeIdx)) {
+        atlas::mesh::Nodes::Topology::set(flags(nodeIdx), atlas::mesh::Nodes::Topology::GHOST);
+      }
+      haloNode(nodeIdx) = haloDepth;
+    });
+    const auto& cellToNode = cells.node_connectivity();
+    for(int cellIdx = 0; cellIdx < cells.size(); cellIdx++) {
+      for(int nbhIdx = 0; nbhIdx < cellToNode.cols(cellIdx); nbhIdx++) {
+        int& halo = haloNode(cellToNode(cellIdx, nbhIdx));
+        halo = std::min(halo, haloCell(cellIdx));
+      }
+    }
+
+    if(!complete) {
+      continue;
+    }
+    auto glbIdxEdgeIn = atlas::array::make_view<atlas::gidx_t, 1>(mesh.edges().global_index());
+    atlas::mesh::HybridElements& edges = part.mesh.edges();
+    auto glbIdxEdge = atlas::array::make_view<atlas::gidx_t, 1>(edges.global_index());
+    auto partEdge = atlas::array::make_view<int, 1>(edges.partition());
+    auto remoteIdxEdge = atlas::array::make_indexview<atlas::idx_t, 1>(edges.remote_index());
+    auto haloEdge = atlas::array::make_view<int, 1>(edges.halo());
+    ParallelFor(0, indices.edges.size(), [&](int edgeIdx) {
+      const int oldIdx = indices.edges[edgeIdx];
+      glbIdxEdge(edgeIdx) = glbIdxEdgeIn(oldIdx);
+      partEdge(edgeIdx) = edgeOwner[oldIdx];
+      remoteIdxEdge(edgeIdx) = edgeRemote[oldIdx];
+      haloEdge(edgeIdx) = haloDepth;
+    });
+    const auto& cellToEdge = cells.edge_connectivity();
+    for(int cellIdx = 0; cellIdx < cells.size(); cellIdx++) {
+      for(int nbhIdx = 0; nbhIdx < cellToEdge.cols(cellIdx); nbhIdx++) {
+        int& halo = haloEdge(cellToEdge(cellIdx, nbhIdx));
+        halo = std::min(halo, haloCell(cellIdx));
+      }
+    }
+  }
+  return parts;
+}
+} // namespace
+
+std::vector<int> AtlasPartitionCells(const atlas::Mesh& mesh, const AtlasToCartesian& wrapper,
+                                     int numParts, bool refine) {
+  const int numCells = mesh.cells().size();
+  assert(numParts > 0 && numParts <= numCells);
+  std::vector<Point> midpoints(numCells);
+  ParallelFor(0, numCells,
+              [&](int cellIdx) { midpoints[cellIdx] = wrapper.cellMidpoint(mesh, cellIdx); });
+  std::vector<int> cellPart = RecursiveBisection(midpoints, numParts);
+  if(refine) {
+    RefineGreedy(EdgeNeighborCells(mesh, NodeToCells(mesh)), numParts, cellPart);
+  }
+  return cellPart;
+}
+
+int AtlasPartitionEdgeCut(const atlas::Mesh& mesh, const std::vector<int>& cellPart) {
+  const CellNeighbors neighbors = EdgeNeighborCells(mesh, NodeToCells(mesh));
+  int cut = 0;
+  for(int cellIdx = 0; cellIdx < mesh.cells().size(); cellIdx++) {
+    for(int nbhIdx : neighbors[cellIdx]) {
+      cut += nbhIdx > cellIdx && cellPart[nbhIdx] != cellPart[cellIdx];
+    }
+  }
+  return cut;
+}
+
+std::vector<AtlasPart> AtlasPartitionMeshMinimal(const atlas::Mesh& mesh,
+                                                 const std::vector<int>& cellPart, int numParts,
+                                                 int haloDepth) {
+  return AtlasPartitionMeshImpl(mesh, cellPart, numParts, haloDepth, false);
+}
+
+std::vector<AtlasPart> AtlasPartitionMeshComplete(const atlas::Mesh& mesh,
+                                                  const std::vector<int>& cellPart, int numParts,
+                                                  int haloDepth) {
+  return AtlasPartitionMeshImpl(mesh, cellPart, numParts, haloDepth, true);
+}
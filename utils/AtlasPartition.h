@@ -0,0 +1,69 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Domain decomposition of an atlas mesh into parts with halo layers.
+//
+// AtlasPartitionCells assigns every cell to a part using recursive coordinate bisection on the
+// cell midpoints as given by an AtlasToCartesian wrapper: the cells are split along the longer
+// extent of their bounding box, into two halves whose sizes are proportional to the number of
+// parts on each side. Optionally, the partition is refined afterwards by greedily moving cells at
+// part boundaries to the part most of their (edge) neighbors belong to, which reduces the number
+// of cut edges while keeping the parts balanced.
+//
+// AtlasPartitionMesh{Minimal,Complete} cut the mesh into one submesh per part (using
+// AtlasExtractSubMesh{Minimal,Complete}). Every submesh contains the cells owned by the part,
+// followed by haloDepth layers of halo cells. Halo layer k contains the cells sharing a node with
+// layer k - 1 that are not part of any earlier layer. The parallel fields of the submeshes are
+// set as follows:
+//
+//  - global_index: the global index of the element in the input mesh
+//  - partition:    the part owning the element. cells are owned by the part they have been
+//                  assigned to, nodes and edges by the part owning their lowest-index neighbor cell
+//  - remote_index: the (local) index of the element in the submesh of the owning part
+//  - ghost:        nodes not owned by the part are ghosts (the GHOST topology flag is set as well)
+//  - halo:         the halo layer of the element (0 for owned cells, the lowest layer of any
+//                  neighboring cell for nodes and edges)
+//
+// NOTE: this assumes a triangle mesh
+
+#pragma once
+
+#include <vector>
+
+#include <atlas/mesh.h>
+
+#include "AtlasCartesianWrapper.h"
+#include "AtlasExtractSubmesh.h"
+
+struct AtlasPart {
+  atlas::Mesh mesh;
+  // index in the input mesh of every node, edge and cell of mesh
+  AtlasSubMeshIndices indices;
+  // cells [0, numOwnedCells) are owned by the part, the remaining cells are halo cells
+  int numOwnedCells = 0;
+};
+
+// part (in [0, numParts)) of every cell of mesh
+std::vector<int> AtlasPartitionCells(const atlas::Mesh& mesh, const AtlasToCartesian& wrapper,
+                                     int numParts, bool refine = false);
+
+// number of edges (i.e. pairs of cells sharing two nodes) cut by a partition
+int AtlasPartitionEdgeCut(const atlas::Mesh& mesh, const std::vector<int>& cellPart);
+
+std::vector<AtlasPart> AtlasPartitionMeshMinimal(const atlas::Mesh& mesh,
+                                                 const std::vector<int>& cellPart, int numParts,
+                                                 int haloDepth = 1);
+std::vector<AtlasPart> AtlasPartitionMeshComplete(const atlas::Mesh& mesh,
+                                                  const std::vector<int>& cellPart, int numParts,
+                                                  int haloDepth = 1);
@@ -12,6 +12,7 @@
 //
 //===------------------------------------------------------------------------------------------===//
 
+#include <array>
 #include <cmath>
 #include <numeric>
 #include <vector>
@@ -20,6 +21,7 @@
 #include "AtlasExtractSubmesh.h"
 #include "AtlasFromNetcdf.h"
 #include "AtlasToNetcdf.h"
+#include "ParallelFor.h"
 
 #include <atlas/array.h>
 #include <atlas/grid.h>
@@ -110,52 +112,64 @@ void debugDumpUseXY(const atlas::Mesh& mesh, const std::string prefix) {
   }
 }
 
-int GetHorizontalEdge(const atlas::Mesh& m, int cellIdx) {
-  const auto& edgeToCell = m.edges().cell_connectivity();
-  const auto& cellToEdge = m.cells().edge_connectivity();
-  const auto& edgeToNode = m.edges().node_connectivity();
+// tables computed once for the parent mesh and shared by all faces projected from it
+struct ProjectionTables {
+  std::vector<double> sinLat;   // per node, z coordinate on the unit sphere
+  std::vector<int> orientation; // per cell, +1 if the triangle points up, -1 if it points down
+};
 
+ProjectionTables ComputeProjectionTables(const atlas::Mesh& m) {
   auto latToRad = [](double rad) { return rad / 90. * (0.5 * M_PI); };
   auto lonlat = atlas::array::make_view<double, 2>(m.nodes().lonlat());
+  const atlas::mesh::HybridElements::Connectivity& cellToNode = m.cells().node_connectivity();
+
+  ProjectionTables tables;
+  tables.sinLat.resize(m.nodes().size());
+  ParallelFor(0, m.nodes().size(), [&](int nodeIdx) {
+    tables.sinLat[nodeIdx] = sin(latToRad(lonlat(nodeIdx, atlas::LAT)));
+  });
+
+  // for ico faces 5-14 the cartesian orientation is equal to the topological orientation
+  tables.orientation.resize(m.cells().size());
+  ParallelFor(0, m.cells().size(), [&](int cellIdx) {
+    std::array<double, 3> z = {R * tables.sinLat[cellToNode(cellIdx, 0)],
+                               R * tables.sinLat[cellToNode(cellIdx, 1)],
+                               R * tables.sinLat[cellToNode(cellIdx, 2)]};
+    std::sort(z.begin(), z.end());
+    tables.orientation[cellIdx] = fabs(z[0] - z[1]) < fabs(z[1] - z[2]) ? -1 : +1;
+  });
+  return tables;
+}
+
+// local index (0..2) of the horizontal edge of each cell, i.e. the edge with the smallest vertical
+// extent
+std::vector<int> HorizontalEdges(const atlas::Mesh& m, const std::vector<double>& sinLat) {
+  const auto& cellToEdge = m.cells().edge_connectivity();
+  const auto& edgeToNode = m.edges().node_connectivity();
 
   auto verticalExtent = [&](int edgeIdx) {
-    double lat0 = latToRad(lonlat(edgeToNode(edgeIdx, 0), atlas::LAT));
-    double lat1 = latToRad(lonlat(edgeToNode(edgeIdx, 1), atlas::LAT));
-    return fabs(sin(lat0) - sin(lat1));
+    return fabs(sinLat[edgeToNode(edgeIdx, 0)] - sinLat[edgeToNode(edgeIdx, 1)]);
   };
 
-  double minVExtent = std::numeric_limits<double>::max();
-  int horizontalEdge = -1;
-  for(int nbhIdx = 0; nbhIdx < 3; nbhIdx++) {
-    int edgeIdx = cellToEdge(cellIdx, nbhIdx);
-    double vExtent = verticalExtent(edgeIdx);
-    if(vExtent < minVExtent) {
-      minVExtent = vExtent;
-      horizontalEdge = nbhIdx;
+  std::vector<int> horizontalEdge(m.cells().size(), -1);
+  ParallelFor(0, m.cells().size(), [&](int cellIdx) {
+    double minVExtent = std::numeric_limits<double>::max();
+    for(int nbhIdx = 0; nbhIdx < 3; nbhIdx++) {
+      double vExtent = verticalExtent(cellToEdge(cellIdx, nbhIdx));
+      if(vExtent < minVExtent) {
+        minVExtent = vExtent;
+        horizontalEdge[cellIdx] = nbhIdx;
+      }
     }
-  }
-
+  });
   return horizontalEdge;
 }
 
-std::vector<int> NbhV(const atlas::Mesh& m, int cellIdx) {
-  auto latToRad = [](double rad) { return rad / 90. * (0.5 * M_PI); };
-  auto lonlat = atlas::array::make_view<double, 2>(m.nodes().lonlat());
-
+std::vector<int> NbhV(const atlas::Mesh& m, const std::vector<int>& horizontalEdge, int cellIdx) {
   const auto& cellToEdge = m.cells().edge_connectivity();
   const auto& edgeToCell = m.edges().cell_connectivity();
-  const auto& edgeToNode = m.edges().node_connectivity();
   assert(cellToEdge.cols(cellIdx) == 3);
 
-  auto verticalExtent = [&](int edgeIdx) {
-    double lat0 = latToRad(lonlat(edgeToNode(edgeIdx, 0), atlas::LAT));
-    double lat1 = latToRad(lonlat(edgeToNode(edgeIdx, 1), atlas::LAT));
-    return fabs(sin(lat0) - sin(lat1));
-  };
-
-  double minVExtent = std::numeric_limits<double>::max();
-  int horizontalEdge = GetHorizontalEdge(m, cellIdx);
-
   std::vector<int> vNbh;
   for(int nbhIdx = 0; nbhIdx < 3; nbhIdx++) {
     int edgeIdx = cellToEdge(cellIdx, nbhIdx);
@@ -164,7 +178,7 @@ std::vector<int> NbhV(const atlas::Mesh& m, int cellIdx) {
     if(boundary) {
       continue;
     }
-    if(nbhIdx == horizontalEdge) {
+    if(nbhIdx == horizontalEdge[cellIdx]) {
       continue;
     }
     vNbh.push_back(edgeToCell(edgeIdx, 0) == cellIdx ? edgeToCell(edgeIdx, 1)
@@ -174,37 +188,18 @@ std::vector<int> NbhV(const atlas::Mesh& m, int cellIdx) {
   return vNbh;
 }
 
-int NbhH(const atlas::Mesh& m, int cellIdx) {
-  auto latToRad = [](double rad) { return rad / 90. * (0.5 * M_PI); };
-  auto lonlat = atlas::array::make_view<double, 2>(m.nodes().lonlat());
-
+int NbhH(const atlas::Mesh& m, const std::vector<int>& horizontalEdge, int cellIdx) {
   const auto& cellToEdge = m.cells().edge_connectivity();
   const auto& edgeToCell = m.edges().cell_connectivity();
-  const auto& edgeToNode = m.edges().node_connectivity();
   assert(cellToEdge.cols(cellIdx) == 3);
 
-  auto verticalExtent = [&](int edgeIdx) {
-    double lat0 = latToRad(lonlat(edgeToNode(edgeIdx, 0), atlas::LAT));
-    double lat1 = latToRad(lonlat(edgeToNode(edgeIdx, 1), atlas::LAT));
-    return fabs(sin(lat0) - sin(lat1));
-  };
-
-  double minVExtent = std::numeric_limits<double>::max();
-  int horizontalEdge = GetHorizontalEdge(m, cellIdx);
-
-  for(int nbhIdx = 0; nbhIdx < 3; nbhIdx++) {
-    int edgeIdx = cellToEdge(cellIdx, nbhIdx);
-    bool boundary = edgeToCell(edgeIdx, 0) == edgeToCell.missing_value() ||
-                    edgeToCell(edgeIdx, 1) == edgeToCell.missing_value();
-    if(boundary) {
-      continue;
-    }
-    if(nbhIdx == horizontalEdge) {
-      return (edgeToCell(edgeIdx, 0) == cellIdx ? edgeToCell(edgeIdx, 1) : edgeToCell(edgeIdx, 0));
-    }
+  int edgeIdx = cellToEdge(cellIdx, horizontalEdge[cellIdx]);
+  bool boundary = edgeToCell(edgeIdx, 0) == edgeToCell.missing_value() ||
+                  edgeToCell(edgeIdx, 1) == edgeToCell.missing_value();
+  if(boundary) {
+    return -1;
   }
-
-  return -1;
+  return (edgeToCell(edgeIdx, 0) == cellIdx ? edgeToCell(edgeIdx, 1) : edgeToCell(edgeIdx, 0));
 }
 
 bool HasBoundaryEdge(const atlas::Mesh& m, int cellIdx) {
@@ -240,16 +235,26 @@ bool TriangleInBB(const atlas::Mesh& m, int cellIdx,
 
   return inBB(x0, y0) || inBB(x1, y1) || inBB(x2, y2);
 }
-} // namespace
 
-std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int startFace,
+// projects the faces [startFace, startFace + numFaces) of parentMesh. tables holds the tables of
+// parentMesh
+std::optional<atlas::Mesh> ProjectFaceRange(const atlas::Mesh& parentMesh,
+                                            const ProjectionTables& tables, int startFace,
                                             int numFaces) {
-
+  // only the faces of the equatorial band are orientable, see ComputeProjectionTables
   const int icosahedralFaces = 20;
+  const int firstOrientableFace = 5;
+  const int lastOrientableFace = 14;
+  if(numFaces < 1 || startFace < firstOrientableFace ||
+     startFace + numFaces - 1 > lastOrientableFace ||
+     parentMesh.cells().size() % icosahedralFaces != 0) {
+    return std::nullopt;
+  }
   const int cellPerIcoFace = parentMesh.cells().size() / icosahedralFaces;
-  auto subMesh = AtlasExtractSubMeshComplete(
-      parentMesh,
-      std::pair<int, int>{startFace * cellPerIcoFace, (startFace + numFaces) * cellPerIcoFace});
+  std::vector<int> faceCells(numFaces * cellPerIcoFace);
+  std::iota(faceCells.begin(), faceCells.end(), startFace * cellPerIcoFace);
+  AtlasSubMeshIndices parentIdx;
+  auto subMesh = AtlasExtractSubMeshComplete(parentMesh, faceCells, parentIdx);
 
   const bool dbgOut = false;
 
@@ -265,26 +270,16 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
   const atlas::mesh::HybridElements::Connectivity& cellToEdge = subMesh.cells().edge_connectivity();
   const atlas::mesh::HybridElements::Connectivity& edgeToNode = subMesh.edges().node_connectivity();
 
-  // for ico faces 5-? the cartesian orientation is equal to the topological orientation
+  // gather the tables of the parent mesh for the elements of the submesh
+  std::vector<double> sinLat(subMesh.nodes().size());
+  for(int nodeIdx = 0; nodeIdx < subMesh.nodes().size(); nodeIdx++) {
+    sinLat[nodeIdx] = tables.sinLat[parentIdx.nodes[nodeIdx]];
+  }
   std::vector<int> orientation(subMesh.cells().size());
   for(int cellIdx = 0; cellIdx < subMesh.cells().size(); cellIdx++) {
-    int nodeIdx0 = cellToNode(cellIdx, 0);
-    int nodeIdx1 = cellToNode(cellIdx, 1);
-    int nodeIdx2 = cellToNode(cellIdx, 2);
-
-    double latRad0 = latToRad(lonlat(nodeIdx0, atlas::LAT));
-    double latRad1 = latToRad(lonlat(nodeIdx1, atlas::LAT));
-    double latRad2 = latToRad(lonlat(nodeIdx2, atlas::LAT));
-
-    std::vector<double> z = {R * sin(latRad0), R * sin(latRad1), R * sin(latRad2)};
-    std::sort(z.begin(), z.end());
-
-    if(fabs(z[0] - z[1]) < fabs(z[1] - z[2])) {
-      orientation[cellIdx] = -1;
-    } else {
-      orientation[cellIdx] = +1;
-    }
+    orientation[cellIdx] = tables.orientation[parentIdx.cells[cellIdx]];
   }
+  const std::vector<int> horizontalEdge = HorizontalEdges(subMesh, sinLat);
 
   if(dbgOut) {
     FILE* fp = fopen("orientation.txt", "w+");
@@ -302,18 +297,18 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
   // construct vertical boundary triangle strip
   std::vector<int> startCandidates;
   startCandidates.push_back(0);
-  startCandidates.push_back(NbhV(subMesh, 0)[0]);
+  startCandidates.push_back(NbhV(subMesh, horizontalEdge, 0)[0]);
   bool lookHor = true;
   while(true) {
     if(lookHor) {
-      int hNbh = NbhH(subMesh, startCandidates.back());
+      int hNbh = NbhH(subMesh, horizontalEdge, startCandidates.back());
       if(hNbh == -1) {
         break;
       }
       startCandidates.push_back(hNbh);
       lookHor = false;
     } else {
-      auto vNbh = NbhV(subMesh, startCandidates.back());
+      auto vNbh = NbhV(subMesh, horizontalEdge, startCandidates.back());
       startCandidates.push_back(startCandidates.end()[-2] == vNbh[0] ? vNbh[1] : vNbh[0]);
       lookHor = true;
     }
@@ -339,23 +334,29 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
     fclose(fp);
   }
 
-  // using the orientation computed each triangle can now be assigned a unique (I,J) index
-  std::unordered_map<int, std::tuple<int, int>> cellIdxToIJ;
+  // using the orientation computed each triangle can now be assigned a unique (I,J) index. the
+  // indices are kept in dense arrays, -1 marks triangles not (yet) reached
+  std::vector<int> cellI(subMesh.cells().size(), -1);
+  std::vector<int> cellJ(subMesh.cells().size(), -1);
+  auto assignIJ = [&](int cellIdx, int i, int j) {
+    cellI[cellIdx] = i;
+    cellJ[cellIdx] = j;
+  };
   for(int vIdx = 0; vIdx < startCells.size(); vIdx++) {
     std::vector<int> stripeI;
     int cellIdx0 = startCells[vIdx];
-    int cellIdx1 = NbhV(subMesh, startCells[vIdx])[0];
+    int cellIdx1 = NbhV(subMesh, horizontalEdge, startCells[vIdx])[0];
 
     stripeI.push_back(cellIdx0);
     stripeI.push_back(cellIdx1);
 
-    cellIdxToIJ.emplace(cellIdx0, std::tuple<int, int>{vIdx, 0});
-    cellIdxToIJ.emplace(cellIdx1, std::tuple<int, int>{vIdx, 1});
+    assignIJ(cellIdx0, vIdx, 0);
+    assignIJ(cellIdx1, vIdx, 1);
 
     int hIdx = 2;
 
     while(true) {
-      auto vNbh = NbhV(subMesh, stripeI.back());
+      auto vNbh = NbhV(subMesh, horizontalEdge, stripeI.back());
 
       if(vNbh.size() == 1 && stripeI.end()[-2] == vNbh[0]) {
         break;
@@ -364,14 +365,14 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
       if(vNbh.size() == 1) {
         int cellIdx = vNbh[0];
         stripeI.push_back(cellIdx);
-        cellIdxToIJ.emplace(cellIdx, std::tuple<int, int>{vIdx, hIdx});
+        assignIJ(cellIdx, vIdx, hIdx);
         hIdx++;
         continue;
       }
       if(vNbh.size() == 2) {
         int cellIdx = stripeI.end()[-2] == vNbh[0] ? vNbh[1] : vNbh[0];
         stripeI.push_back(cellIdx);
-        cellIdxToIJ.emplace(cellIdx, std::tuple<int, int>{vIdx, hIdx});
+        assignIJ(cellIdx, vIdx, hIdx);
         hIdx++;
       }
     }
@@ -393,29 +394,14 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
     }
   }
 
-  int nI = std::get<0>(max_element(cellIdxToIJ.begin(), cellIdxToIJ.end(),
-                                   [](const std::pair<int, std::tuple<int, int>>& p1,
-                                      const std::pair<int, std::tuple<int, int>>& p2) {
-                                     return std::get<0>(p1.second) < std::get<0>(p1.second);
-                                   })
-                           ->second) +
-           1;
-  int nJ = std::get<1>(max_element(cellIdxToIJ.begin(), cellIdxToIJ.end(),
-                                   [](const std::pair<int, std::tuple<int, int>>& p1,
-                                      const std::pair<int, std::tuple<int, int>>& p2) {
-                                     return std::get<1>(p1.second) < std::get<1>(p1.second);
-                                   })
-                           ->second) +
-           1;
+  int nI = *std::max_element(cellI.begin(), cellI.end()) + 1;
 
   if(dbgOut) {
     FILE* fpI = fopen("indexI.txt", "w+");
     FILE* fpJ = fopen("indexJ.txt", "w+");
     for(int cellIdx = 0; cellIdx < subMesh.cells().size(); cellIdx++) {
-      int i = std::get<0>(cellIdxToIJ[cellIdx]);
-      int j = std::get<1>(cellIdxToIJ[cellIdx]);
-      fprintf(fpI, "%d\n", i);
-      fprintf(fpJ, "%d\n", j);
+      fprintf(fpI, "%d\n", cellI[cellIdx]);
+      fprintf(fpJ, "%d\n", cellJ[cellIdx]);
     }
     fclose(fpI);
     fclose(fpJ);
@@ -442,12 +428,11 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
   for(int cellIdx = 0; cellIdx < subMesh.cells().size(); cellIdx++) {
     // TODO: should I flip vertical index in order to not flip mesh topologically on its head
     // (lowest corner in space should have lowest index)?
-    int vIdx = std::get<0>(cellIdxToIJ[cellIdx]);
-    int hIdx = std::get<1>(cellIdxToIJ[cellIdx]) / 2;
+    int vIdx = cellI[cellIdx];
+    int hIdx = cellJ[cellIdx] / 2;
 
     // each triangle takes care of its horizontal edge
-    int hEdgeIdxLocal = GetHorizontalEdge(subMesh, cellIdx);
-    int hEdgeIdx = cellToEdge(cellIdx, hEdgeIdxLocal);
+    int hEdgeIdx = cellToEdge(cellIdx, horizontalEdge[cellIdx]);
     assert(hEdgeIdx != -1);
     int nodeIdx0 = edgeToNode(hEdgeIdx, 0);
     int nodeIdx1 = edgeToNode(hEdgeIdx, 1);
@@ -500,6 +485,7 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
   // this would be the full area indicated above
   // std::tuple<double, double> bbLo(nI / 2 * l, -std::numeric_limits<double>::max());
   // std::tuple<double, double> bbHi(nJ / 2 * l - 0.5 * l, std::numeric_limits<double>::max());
+  // (with nJ = max(cellJ) + 1)
 
   // however, for now, we want an aspect ratio of 1:2
   double height = h * nI;
@@ -507,12 +493,9 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
   std::tuple<double, double> bbLo(lowX, -std::numeric_limits<double>::max());
   std::tuple<double, double> bbHi(lowX + 2 * height, std::numeric_limits<double>::max());
 
-  std::vector<int> keep;
-  for(int cellIdx = 0; cellIdx < subMesh.cells().size(); cellIdx++) {
-    if(TriangleInBB(subMesh, cellIdx, newXY, bbLo, bbHi)) {
-      keep.push_back(cellIdx);
-    }
-  }
+  std::vector<int> keep = ParallelCompact(subMesh.cells().size(), [&](int cellIdx) {
+    return TriangleInBB(subMesh, cellIdx, newXY, bbLo, bbHi);
+  });
 
   // create yet another atlas submesh only containing the rectangular subsection
   auto xyAtlas = atlas::array::make_view<double, 2>(subMesh.nodes().xy());
@@ -564,4 +547,23 @@ std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int s
   }
 
   return rectangularMesh;
-}
\ No newline at end of file
+}
+} // namespace
+
+std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& parentMesh, int startFace,
+                                            int numFaces) {
+  return ProjectFaceRange(parentMesh, ComputeProjectionTables(parentMesh), startFace, numFaces);
+}
+
+std::vector<std::optional<atlas::Mesh>>
+AtlasProjectMeshFaces(const atlas::Mesh& parentMesh,
+                      const std::vector<std::pair<int, int>>& faceRanges) {
+  const ProjectionTables tables = ComputeProjectionTables(parentMesh);
+  std::vector<std::optional<atlas::Mesh>> projected(faceRanges.size());
+  // serial: atlas mesh construction is not known to be thread safe
+  for(size_t rangeIdx = 0; rangeIdx < faceRanges.size(); rangeIdx++) {
+    auto [startFace, numFaces] = faceRanges[rangeIdx];
+    projected[rangeIdx] = ProjectFaceRange(parentMesh, tables, startFace, numFaces);
+  }
+  return projected;
+}
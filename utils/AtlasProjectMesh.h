@@ -17,6 +17,8 @@
 #include <atlas/mesh/Mesh.h>
 #include <optional>
 #include <string>
+#include <utility>
+#include <vector>
 
 // This utility projects all elements on a range of the icosahdral faces onto the plane. This is
 // HIGHLY EXPERIMENTAL and some very strong assumptions are made:
@@ -29,5 +31,22 @@
 // The resulting triangles are mapped to [-180,180] x [-90, 90] to perform manufactured solution
 // tests. Currently, there is no proper error handling and the method will most likely assert if the
 // mesh does not conform to the assumptions above
+//
+// Only the faces of the equatorial band, 5 to 14, are orientable. std::nullopt is returned if the
+// range [startFace, startFace+numFaces) is empty or not contained in faces 5 to 14, or if the
+// number of cells of the mesh is not a multiple of the 20 icosahedral faces
+//
+// The resulting mesh is a section of the regular equilateral triangle lattice. AtlasLatticeFromMesh
+// (see AtlasLattice.h) recovers the (i, j) lattice index of all elements, which allows to compute
+// neighbors by index arithmetic
+
+std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& in, int startFace, int numFaces);
 
-std::optional<atlas::Mesh> AtlasProjectMesh(const atlas::Mesh& in, int startFace, int numFaces);
\ No newline at end of file
+// Projects several ranges of icosahedral faces of the same mesh. Each entry of faceRanges is a pair
+// (startFace, numFaces) and yields the same mesh as AtlasProjectMesh(in, startFace, numFaces) at
+// the same position of the result, std::nullopt for ranges outside of faces 5 to 14. The per node
+// and per cell tables needed to orient the triangles are computed once for the whole mesh and
+// shared by all ranges. The ranges are projected one after the other, atlas mesh construction is
+// not known to be thread safe
+std::vector<std::optional<atlas::Mesh>>
+AtlasProjectMeshFaces(const atlas::Mesh& in, const std::vector<std::pair<int, int>>& faceRanges);
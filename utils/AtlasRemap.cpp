@@ -0,0 +1,132 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "AtlasRemap.h"
+
+#include <array>
+#include <cassert>
+#include <cmath>
+
+#include <atlas/array.h>
+
+#include "ParallelFor.h"
+#include "SpatialIndex.h"
+
+namespace {
+// convex polygon resulting from clipping a triangle against (the half planes of) another triangle
+struct ClipPolygon {
+  std::array<Point, 9> corners;
+  int size = 0;
+};
+
+double signedArea(const ClipPolygon& poly) {
+  double area = 0.;
+  for(int idx = 0; idx < poly.size; idx++) {
+    auto [x0, y0] = poly.corners[idx];
+    auto [x1, y1] = poly.corners[(idx + 1) % poly.size];
+    area += x0 * y1 - x1 * y0;
+  }
+  return 0.5 * area;
+}
+
+// keeps the part of in left of the directed line a -> b (Sutherland-Hodgman)
+void clipHalfPlane(const ClipPolygon& in, Point a, Point b, ClipPolygon& out) {
+  auto [ax, ay] = a;
+  auto [bx, by] = b;
+  auto side = [&](Point p) {
+    return (bx - ax) * (std::get<1>(p) - ay) - (by - ay) * (std::get<0>(p) - ax);
+  };
+  out.size = 0;
+  for(int idx = 0; idx < in.size; idx++) {
+    const Point p = in.corners[idx];
+    const Point q = in.corners[(idx + 1) % in.size];
+    const double sp = side(p);
+    const double sq = side(q);
+    if(sp >= 0.) {
+      out.corners[out.size++] = p;
+    }
+    if((sp >= 0.) != (sq >= 0.)) {
+      const double t = sp / (sp - sq);
+      out.corners[out.size++] = {std::get<0>(p) + t * (std::get<0>(q) - std::get<0>(p)),
+                                 std::get<1>(p) + t * (std::get<1>(q) - std::get<1>(p))};
+    }
+  }
+}
+
+double intersectionArea(const std::array<Point, 3>& t, std::array<Point, 3> clip) {
+  ClipPolygon poly;
+  poly.corners = {t[0], t[1], t[2]};
+  poly.size = 3;
+  ClipPolygon clipped;
+  clipped.corners = {clip[0], clip[1], clip[2]};
+  clipped.size = 3;
+  if(signedArea(clipped) < 0.) {
+    std::swap(clip[1], clip[2]);
+  }
+  for(int edgeIdx = 0; edgeIdx < 3 && poly.size > 0; edgeIdx++) {
+    clipHalfPlane(poly, clip[edgeIdx], clip[(edgeIdx + 1) % 3], clipped);
+    poly = clipped;
+  }
+  return poly.size < 3 ? 0. : fabs(signedArea(poly));
+}
+} // namespace
+
+CsrMatrix AtlasConservativeRemapWeights(const atlas::Mesh& src, const AtlasToCartesian& srcWrapper,
+                                        const atlas::Mesh& dst,
+                                        const AtlasToCartesian& dstWrapper) {
+  const SpatialIndex srcIndex = AtlasSpatialIndex(src, srcWrapper);
+  const auto& cellToNode = dst.cells().node_connectivity();
+
+  std::vector<std::vector<std::pair<int, double>>> rows(dst.cells().size());
+  ParallelFor(
+      0, dst.cells().size(),
+      [&](int cellIdx) {
+        std::array<Point, 3> t;
+        for(int cornerIdx = 0; cornerIdx < 3; cornerIdx++) {
+          t[cornerIdx] = dstWrapper.nodeLocation(cellToNode(cellIdx, cornerIdx));
+        }
+        ClipPolygon poly;
+        poly.corners = {t[0], t[1], t[2]};
+        poly.size = 3;
+        const double area = fabs(signedArea(poly));
+        if(area == 0.) {
+          return;
+        }
+
+        Point lo = t[0];
+        Point hi = t[0];
+        for(auto [x, y] : t) {
+          lo = {fmin(std::get<0>(lo), x), fmin(std::get<1>(lo), y)};
+          hi = {fmax(std::get<0>(hi), x), fmax(std::get<1>(hi), y)};
+        }
+        // drop slivers caused by round off in cells touching only along an edge
+        const double minArea = 1e-12 * area;
+        for(int srcCellIdx : srcIndex.trianglesInBox(lo, hi)) {
+          const double overlap = intersectionArea(t, srcIndex.triangle(srcCellIdx));
+          if(overlap > minArea) {
+            rows[cellIdx].push_back({srcCellIdx, overlap / area});
+          }
+        }
+      },
+      256);
+  return CsrFromRows(src.cells().size(), rows);
+}
+
+void AtlasRemapCellField(const CsrMatrix& weights, const atlas::Field& src, atlas::Field& dst) {
+  auto srcView = atlas::array::make_view<double, 2>(src);
+  auto dstView = atlas::array::make_view<double, 2>(dst);
+  assert(srcView.shape(0) == weights.numCols && dstView.shape(0) == weights.numRows);
+  assert(srcView.shape(1) == dstView.shape(1));
+  CsrApply(weights, srcView.data(), dstView.data(), dstView.shape(1));
+}
@@ -0,0 +1,48 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// First order conservative remapping of cell fields between two planar triangle meshes, e.g.
+// between AtlasMeshRect meshes of different resolution or from a global mesh to a projected patch
+// (both given in the same coordinates).
+//
+// The remapped value of a destination cell is the area weighted mean of the source cells it
+// overlaps:
+//
+//   dst(i) = sum_j area(dst_i intersected with src_j) / area(dst_i) * src(j)
+//
+// The weights are computed once (AtlasConservativeRemapWeights) and stored as a sparse matrix,
+// which can be persisted (CsrWrite / CsrRead, see CsrMatrix.h) and applied to any number of fields
+// and levels. Candidate source cells are found using a spatial index (SpatialIndex.h), the
+// intersection areas by clipping the triangles against each other. Rows are computed in parallel.
+//
+// The integral of a field over the region covered by both meshes is preserved. Destination cells
+// only partially covered by the source mesh have row sums below one (CsrRowSums), cells outside
+// of it an empty row (and thus the value 0)
+
+#pragma once
+
+#include <atlas/field.h>
+#include <atlas/mesh.h>
+
+#include "AtlasCartesianWrapper.h"
+#include "CsrMatrix.h"
+
+// weights of the remap from the cells of src to the cells of dst. the matrix has one row per cell
+// of dst and one column per cell of src
+CsrMatrix AtlasConservativeRemapWeights(const atlas::Mesh& src, const AtlasToCartesian& srcWrapper,
+                                        const atlas::Mesh& dst,
+                                        const AtlasToCartesian& dstWrapper);
+
+// remaps the cell field src (shape {cells of src, k_size}) into dst (shape {cells of dst, k_size})
+void AtlasRemapCellField(const CsrMatrix& weights, const atlas::Field& src, atlas::Field& dst);
@@ -1,5 +1,6 @@
 #include "AtlasToNetcdf.h"
 
+#include <algorithm>
 #include <netcdf>
 #include <numeric>
 #include <vector>
@@ -10,18 +11,34 @@
 #include <atlas/util/CoordinateEnums.h>
 
 namespace {
-template <std::size_t SizeT>
+// large fields and tables are written in chunks of this many elements, so that no second full copy
+// of them is ever held in memory
+const int chunkSize = 1 << 16;
+
+struct Identity {
+  double operator()(double value) const { return value; }
+};
+
+// writes column offset of field. trafo is applied chunk wise on contiguous buffers, pass a lambda
+// (not a std::function) so that the loop can be inlined and vectorized
+template <std::size_t SizeT, typename TrafoT = Identity>
 void writeField(const netCDF::NcFile& dataFile, const std::string& name,
                 const atlas::array::ArrayView<double, SizeT> field, int fieldSize, int offset,
-                std::optional<std::function<double(const double&)>> trafo = std::nullopt) {
+                TrafoT trafo = {}) {
   auto dim = dataFile.addDim("n" + name, fieldSize);
   netCDF::NcVar data = dataFile.addVar(name.c_str(), netCDF::ncDouble, dim);
-  std::vector<double> dataOut;
-  for(int i = 0; i < fieldSize; i++) {
-    (trafo == std::nullopt) ? dataOut.push_back(field(i, offset))
-                            : dataOut.push_back(trafo.value()(field(i, offset)));
+  std::vector<double> chunk(std::min(fieldSize, chunkSize));
+  for(int lo = 0; lo < fieldSize; lo += chunkSize) {
+    const int size = std::min(chunkSize, fieldSize - lo);
+    // strided gather first, then transform the contiguous buffer
+    for(int i = 0; i < size; i++) {
+      chunk[i] = field(lo + i, offset);
+    }
+    for(int i = 0; i < size; i++) {
+      chunk[i] = trafo(chunk[i]);
+    }
+    data.putVar({size_t(lo)}, {size_t(size)}, chunk.data());
   }
-  data.putVar(dataOut.data());
 }
 
 template <typename ConnectivityT>
@@ -30,16 +47,28 @@ void writeConnectivityTable(const netCDF::NcFile& dataFile, const std::string& n
   auto dimX = dataFile.addDim("numEl" + name, numEl);
   auto dimYperX = dataFile.addDim("numNbh" + name, numNbhPerEl);
   netCDF::NcVar data = dataFile.addVar(name.c_str(), netCDF::ncInt, {dimYperX, dimX});
-  std::vector<int> dataOut(numEl * numNbhPerEl);
-  for(int elemIdx = 0; elemIdx < numEl; elemIdx++) {
-    for(int innerIdx = 0; innerIdx < numNbhPerEl; innerIdx++) {
-      // indices in netcdf are 1 based, data is column major
-      int dbg = connectivity(elemIdx, innerIdx);
-      dataOut[innerIdx * numEl + elemIdx] = connectivity(elemIdx, innerIdx) + 1;
+
+  // data is column major, i.e. the table needs to be transposed. this is done one block of elements
+  // at a time: the rows of the block are read contiguously, and each of the numNbhPerEl columns of
+  // the block is written contiguously
+  const int blockSize = std::max(1, chunkSize / numNbhPerEl);
+  std::vector<int> block(numNbhPerEl * std::min(numEl, blockSize));
+  for(int lo = 0; lo < numEl; lo += blockSize) {
+    const int size = std::min(blockSize, numEl - lo);
+    for(int blockIdx = 0; blockIdx < size; blockIdx++) {
+      const int elemIdx = lo + blockIdx;
+      const int numNbh = std::min<int>(connectivity.cols(elemIdx), numNbhPerEl);
+      for(int innerIdx = 0; innerIdx < numNbh; innerIdx++) {
+        // indices in netcdf are 1 based
+        block[innerIdx * size + blockIdx] = connectivity(elemIdx, innerIdx) + 1;
+      }
+      // rows with less than numNbhPerEl neighbors are padded using the missing value
+      for(int innerIdx = numNbh; innerIdx < numNbhPerEl; innerIdx++) {
+        block[innerIdx * size + blockIdx] = connectivity.missing_value() + 1;
+      }
     }
+    data.putVar({0, size_t(lo)}, {size_t(numNbhPerEl), size_t(size)}, block.data());
   }
-  // printf("%d %d %d\n", dataOut[0 * numEl + 0], dataOut[1 * numEl + 0], dataOut[2 * numEl + 0]);
-  data.putVar(dataOut.data());
 }
 
 bool isMinimalMesh(const atlas::Mesh& mesh) {
@@ -105,9 +134,13 @@ bool AtlasToNetCDF(const atlas::Mesh& mesh, const std::string& filename) {
     {
       auto dim = dataFile.addDim("nEdgeIdx", mesh.edges().size());
       netCDF::NcVar data = dataFile.addVar("edge_index", netCDF::ncInt, dim);
-      std::vector<int> dataOut(mesh.edges().size());
-      std::iota(std::begin(dataOut), std::end(dataOut), 0);
-      data.putVar(dataOut.data());
+      const int numEdges = mesh.edges().size();
+      std::vector<int> chunk(std::min(numEdges, chunkSize));
+      for(int lo = 0; lo < numEdges; lo += chunkSize) {
+        const int size = std::min(chunkSize, numEdges - lo);
+        std::iota(chunk.begin(), chunk.begin() + size, lo);
+        data.putVar({size_t(lo)}, {size_t(size)}, chunk.data());
+      }
     }
 
     // nodes
@@ -0,0 +1,180 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "CsrMatrix.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <memory>
+
+#include "ParallelFor.h"
+
+namespace {
+// file layout: magic, numRows, numCols, numNonZeros (int64), rowStart, colIdx (int32), values
+const char fileMagic[8] = {'C', 'S', 'R', 'M', 'A', 'T', '0', '1'};
+
+bool validMatrix(const CsrMatrix& A) {
+  if(A.numRows < 0 || A.numCols < 0 || A.rowStart.size() != size_t(A.numRows) + 1 ||
+     A.rowStart.front() != 0 || A.rowStart.back() != A.numNonZeros() ||
+     A.values.size() != A.colIdx.size()) {
+    return false;
+  }
+  for(int row = 0; row < A.numRows; row++) {
+    if(A.rowStart[row] > A.rowStart[row + 1]) {
+      return false;
+    }
+  }
+  return std::all_of(A.colIdx.begin(), A.colIdx.end(),
+                     [&](int col) { return col >= 0 && col < A.numCols; });
+}
+} // namespace
+
+CsrMatrix CsrFromRows(int numCols, const std::vector<std::vector<std::pair<int, double>>>& rows) {
+  CsrMatrix A;
+  A.numRows = rows.size();
+  A.numCols = numCols;
+
+  // sort and merge a copy of every row, then concatenate them
+  std::vector<std::vector<std::pair<int, double>>> merged(rows.size());
+  ParallelFor(
+      0, A.numRows,
+      [&](int row) {
+        std::vector<std::pair<int, double>> entries = rows[row];
+        std::sort(entries.begin(), entries.end(),
+                  [](const auto& a, const auto& b) { return a.first < b.first; });
+        for(const auto& [col, value] : entries) {
+          if(!merged[row].empty() && merged[row].back().first == col) {
+            merged[row].back().second += value;
+          } else {
+            merged[row].push_back({col, value});
+          }
+        }
+      },
+      256);
+
+  A.rowStart.resize(A.numRows + 1);
+  A.rowStart[0] = 0;
+  for(int row = 0; row < A.numRows; row++) {
+    A.rowStart[row + 1] = A.rowStart[row] + merged[row].size();
+  }
+  A.colIdx.resize(A.rowStart.back());
+  A.values.resize(A.rowStart.back());
+  ParallelFor(
+      0, A.numRows,
+      [&](int row) {
+        int pos = A.rowStart[row];
+        for(const auto& [col, value] : merged[row]) {
+          A.colIdx[pos] = col;
+          A.values[pos] = value;
+          pos++;
+        }
+      },
+      256);
+  return A;
+}
+
+void CsrApply(const CsrMatrix& A, const double* x, double* y, int kSize) {
+  ParallelForChunks(
+      0, A.numRows,
+      [&](int lo, int hi) {
+        for(int row = lo; row < hi; row++) {
+          double* yRow = y + long(row) * kSize;
+          std::fill(yRow, yRow + kSize, 0.);
+          for(int pos = A.rowStart[row]; pos < A.rowStart[row + 1]; pos++) {
+            const double w = A.values[pos];
+            const double* xCol = x + long(A.colIdx[pos]) * kSize;
+            for(int k = 0; k < kSize; k++) {
+              yRow[k] += w * xCol[k];
+            }
+          }
+        }
+      },
+      std::max(1, 4096 / std::max(1, kSize)));
+}
+
+std::vector<double> CsrRowSums(const CsrMatrix& A) {
+  std::vector<double> sums(A.numRows, 0.);
+  ParallelFor(0, A.numRows, [&](int row) {
+    for(int pos = A.rowStart[row]; pos < A.rowStart[row + 1]; pos++) {
+      sums[row] += A.values[pos];
+    }
+  });
+  return sums;
+}
+
+bool CsrWrite(const CsrMatrix& A, const std::string& filename) {
+  FILE* fp = fopen(filename.c_str(), "wb");
+  if(!fp) {
+    return false;
+  }
+  const int64_t header[3] = {A.numRows, A.numCols, A.numNonZeros()};
+  bool ok = fwrite(fileMagic, sizeof(fileMagic), 1, fp) == 1 &&
+            fwrite(header, sizeof(header), 1, fp) == 1;
+  ok = ok && fwrite(A.rowStart.data(), sizeof(int), A.rowStart.size(), fp) == A.rowStart.size();
+  ok = ok && fwrite(A.colIdx.data(), sizeof(int), A.colIdx.size(), fp) == A.colIdx.size();
+  ok = ok && fwrite(A.values.data(), sizeof(double), A.values.size(), fp) == A.values.size();
+  // buffered data is only written (and write errors reported) on close
+  const bool closed = fclose(fp) == 0;
+  return ok && closed;
+}
+
+std::optional<CsrMatrix> CsrRead(const std::string& filename) {
+  std::unique_ptr<FILE, int (*)(FILE*)> fp(fopen(filename.c_str(), "rb"), fclose);
+  if(!fp) {
+    return std::nullopt;
+  }
+  char magic[sizeof(fileMagic)];
+  int64_t header[3];
+  if(fread(magic, sizeof(magic), 1, fp.get()) != 1 ||
+     !std::equal(magic, magic + sizeof(magic), fileMagic) ||
+     fread(header, sizeof(header), 1, fp.get()) != 1) {
+    return std::nullopt;
+  }
+  const int64_t maxSize = std::numeric_limits<int>::max();
+  if(header[0] < 0 || header[1] < 0 || header[2] < 0 || header[0] >= maxSize ||
+     header[1] > maxSize || header[2] > maxSize) {
+    return std::nullopt;
+  }
+  // the arrays need to fill the rest of the file exactly. checked before allocating them, such
+  // that a corrupt header does not lead to huge allocations
+  const long dataStart = ftell(fp.get());
+  if(dataStart < 0 || fseek(fp.get(), 0, SEEK_END) != 0) {
+    return std::nullopt;
+  }
+  const long fileEnd = ftell(fp.get());
+  const int64_t dataBytes = (header[0] + 1) * int64_t(sizeof(int)) +
+                            header[2] * int64_t(sizeof(int) + sizeof(double));
+  if(fileEnd < 0 || fileEnd - dataStart != dataBytes ||
+     fseek(fp.get(), dataStart, SEEK_SET) != 0) {
+    return std::nullopt;
+  }
+
+  CsrMatrix A;
+  A.numRows = header[0];
+  A.numCols = header[1];
+  A.rowStart.resize(A.numRows + 1);
+  A.colIdx.resize(header[2]);
+  A.values.resize(header[2]);
+  if(fread(A.rowStart.data(), sizeof(int), A.rowStart.size(), fp.get()) != A.rowStart.size() ||
+     fread(A.colIdx.data(), sizeof(int), A.colIdx.size(), fp.get()) != A.colIdx.size() ||
+     fread(A.values.data(), sizeof(double), A.values.size(), fp.get()) != A.values.size()) {
+    return std::nullopt;
+  }
+  if(!validMatrix(A)) {
+    return std::nullopt;
+  }
+  return A;
+}
@@ -0,0 +1,58 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Sparse matrix in compressed sparse row (CSR) format, used to store linear operators between
+// fields (e.g. remapping weights), such that they can be computed once and applied to many fields.
+//
+// Fields are stored as in the stencils, i.e. element major with the kSize levels of an element
+// contiguous: value (elementIdx, k) is at elementIdx * kSize + k. CsrApply applies the matrix to
+// all levels at once.
+//
+// CsrWrite / CsrRead persist a matrix in a simple binary format (native byte order), such that
+// expensive weight computations can be reused across runs.
+
+#pragma once
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+struct CsrMatrix {
+  int numRows = 0;
+  int numCols = 0;
+  // entries of row r are colIdx[rowStart[r]..rowStart[r + 1]) and values[rowStart[r]..)
+  std::vector<int> rowStart = {0};
+  std::vector<int> colIdx;
+  std::vector<double> values;
+
+  int numNonZeros() const { return colIdx.size(); }
+};
+
+// assembles a matrix from a list of (column, value) entries per row. the entries of a row are
+// sorted by column, entries with the same column are summed up
+CsrMatrix CsrFromRows(int numCols, const std::vector<std::vector<std::pair<int, double>>>& rows);
+
+// y = A x for kSize levels, i.e. y(row, k) = sum_col A(row, col) x(col, k) for all k in
+// [0, kSize). x holds numCols * kSize values, y numRows * kSize values. rows are processed in
+// parallel
+void CsrApply(const CsrMatrix& A, const double* x, double* y, int kSize = 1);
+
+// sum of the values of each row
+std::vector<double> CsrRowSums(const CsrMatrix& A);
+
+// returns false if the file could not be written
+bool CsrWrite(const CsrMatrix& A, const std::string& filename);
+// returns std::nullopt if the file could not be read or is not a valid matrix
+std::optional<CsrMatrix> CsrRead(const std::string& filename);
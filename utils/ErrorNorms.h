@@ -0,0 +1,155 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Error norms of a computed field against a reference solution. L_inf, L_1 and L_2 (the latter two
+// normalized by the number of elements, as printed by the drivers) as well as the norms relative
+// to the reference (|ref - sol| / |ref| in the respective norm, 0 if the reference norm is 0) are
+// computed in a single pass.
+// Elements are selected by a mask, e.g. the inner elements of a mesh.
+//
+// The result does not depend on the number of threads: the elements are split into blocks of a
+// fixed size, each block is summed sequentially (Kahan summation) and the block sums are combined
+// pairwise in a fixed order. ErrorNormsAccumulator can be fed from within a stencil loop (fused
+// check), which gives the same bits as ComputeErrorNorms running over the output afterwards.
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "ParallelFor.h"
+
+struct ErrorNorms {
+  double Linf = 0.;
+  double L1 = 0.;
+  double L2 = 0.;
+  double relLinf = 0.;
+  double relL1 = 0.;
+  double relL2 = 0.;
+  long count = 0;
+};
+
+class ErrorNormsAccumulator {
+public:
+  static constexpr int blockSize = 1024;
+
+  // accumulator for elements with indices in [0, size)
+  explicit ErrorNormsAccumulator(int size) : blocks_((size + blockSize - 1) / blockSize) {}
+
+  // adds element idx. the elements of a block ([b * blockSize, (b + 1) * blockSize)) need to be
+  // added in ascending order by a single thread, different blocks can be added concurrently
+  void add(int idx, double ref, double sol) {
+    Block& block = blocks_[idx / blockSize];
+    const double dif = fabs(ref - sol);
+    block.maxDif = std::max(block.maxDif, dif);
+    block.maxRef = std::max(block.maxRef, fabs(ref));
+    block.sumDif.add(dif);
+    block.sumDifSq.add(dif * dif);
+    block.sumRef.add(fabs(ref));
+    block.sumRefSq.add(ref * ref);
+    block.count++;
+  }
+
+  ErrorNorms result() const {
+    if(blocks_.empty()) {
+      return {};
+    }
+    const Block total = combine(0, blocks_.size());
+    ErrorNorms norms;
+    norms.count = total.count;
+    if(total.count == 0) {
+      return norms;
+    }
+    norms.Linf = total.maxDif;
+    norms.L1 = total.sumDif.value() / total.count;
+    norms.L2 = sqrt(total.sumDifSq.value()) / sqrt(double(total.count));
+    // the relative norms are 0 for a zero reference instead of 0 / 0
+    auto relative = [](double dif, double ref) { return ref > 0. ? dif / ref : 0.; };
+    norms.relLinf = relative(total.maxDif, total.maxRef);
+    norms.relL1 = relative(total.sumDif.value(), total.sumRef.value());
+    norms.relL2 = sqrt(relative(total.sumDifSq.value(), total.sumRefSq.value()));
+    return norms;
+  }
+
+private:
+  // compensated (Kahan) sum
+  struct Sum {
+    double sum = 0.;
+    double compensation = 0.;
+    void add(double value) {
+      const double y = value - compensation;
+      const double t = sum + y;
+      compensation = (t - sum) - y;
+      sum = t;
+    }
+    void add(const Sum& other) {
+      add(other.sum);
+      add(-other.compensation);
+    }
+    double value() const { return sum - compensation; }
+  };
+
+  struct Block {
+    double maxDif = 0.;
+    double maxRef = 0.;
+    Sum sumDif, sumDifSq, sumRef, sumRefSq;
+    long count = 0;
+  };
+
+  // pairwise combination of the blocks [lo, hi)
+  Block combine(int lo, int hi) const {
+    if(hi - lo == 1) {
+      return blocks_[lo];
+    }
+    const int mid = lo + (hi - lo) / 2;
+    Block left = combine(lo, mid);
+    const Block right = combine(mid, hi);
+    left.maxDif = std::max(left.maxDif, right.maxDif);
+    left.maxRef = std::max(left.maxRef, right.maxRef);
+    left.sumDif.add(right.sumDif);
+    left.sumDifSq.add(right.sumDifSq);
+    left.sumRef.add(right.sumRef);
+    left.sumRefSq.add(right.sumRefSq);
+    left.count += right.count;
+    return left;
+  }
+
+  std::vector<Block> blocks_;
+};
+
+// error norms of sol(idx) against ref(idx) over all idx in [0, size) for which mask(idx) is true.
+// ref, sol and mask are called in parallel and need to be thread safe
+template <typename RefFn, typename SolFn, typename MaskFn>
+ErrorNorms ComputeErrorNorms(int size, RefFn&& ref, SolFn&& sol, MaskFn&& mask) {
+  ErrorNormsAccumulator accumulator(size);
+  const int numBlocks = (size + ErrorNormsAccumulator::blockSize - 1) /
+                        ErrorNormsAccumulator::blockSize;
+  ParallelTasks(numBlocks, [&](int blockIdx) {
+    const int lo = blockIdx * ErrorNormsAccumulator::blockSize;
+    const int hi = std::min(size, lo + ErrorNormsAccumulator::blockSize);
+    for(int idx = lo; idx < hi; idx++) {
+      if(mask(idx)) {
+        accumulator.add(idx, ref(idx), sol(idx));
+      }
+    }
+  });
+  return accumulator.result();
+}
+
+// overload for a mask stored as one entry per element (e.g. AtlasToCartesian::innerEdgesMask)
+template <typename RefFn, typename SolFn>
+ErrorNorms ComputeErrorNorms(RefFn&& ref, SolFn&& sol, const std::vector<char>& mask) {
+  return ComputeErrorNorms(mask.size(), ref, sol, [&](int idx) { return mask[idx] != 0; });
+}
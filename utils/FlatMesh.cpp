@@ -0,0 +1,97 @@
+#include "FlatMesh.h"
+
+namespace {
+// converts an atlas neighbor table, dropping missing values
+template <typename ConnectivityT>
+FlatConnectivity FromAtlas(const ConnectivityT& conn) {
+  return FlatConnectivity::FromRows(conn.rows(), [&](int row, std::vector<int32_t>& nbh) {
+    for(int col = 0; col < conn.cols(row); col++) {
+      if(conn(row, col) != conn.missing_value()) {
+        nbh.push_back(conn(row, col));
+      }
+    }
+  });
+}
+
+// converts the neighbors(elem) of all elems, mapping the toylib ids through toFlat
+template <typename ElemFn, typename NbhFn, typename MapFn>
+FlatConnectivity FromToylib(int numElems, ElemFn&& elem, NbhFn&& neighbors, MapFn&& toFlat) {
+  return FlatConnectivity::FromRows(numElems, [&](int row, std::vector<int32_t>& nbh) {
+    for(const auto* neighbor : neighbors(elem(row))) {
+      nbh.push_back(toFlat(neighbor->id()));
+    }
+  });
+}
+} // namespace
+
+size_t FlatMesh::bytes() const {
+  size_t bytes = 0;
+  for(const auto& tablesFrom : tables_) {
+    for(const auto& table : tablesFrom) {
+      bytes += table.bytes();
+    }
+  }
+  return bytes;
+}
+
+FlatMesh FlatMeshFromAtlas(const atlas::Mesh& mesh) {
+  const int cells = int(FlatLocation::Cells);
+  const int edges = int(FlatLocation::Edges);
+  const int vertices = int(FlatLocation::Vertices);
+
+  FlatMesh flat;
+  flat.sizes_[cells] = mesh.cells().size();
+  flat.sizes_[edges] = mesh.edges().size();
+  flat.sizes_[vertices] = mesh.nodes().size();
+
+  flat.tables_[cells][edges] = FromAtlas(mesh.cells().edge_connectivity());
+  flat.tables_[cells][vertices] = FromAtlas(mesh.cells().node_connectivity());
+  flat.tables_[edges][cells] = FromAtlas(mesh.edges().cell_connectivity());
+  flat.tables_[edges][vertices] = FromAtlas(mesh.edges().node_connectivity());
+  flat.tables_[vertices][cells] = FromAtlas(mesh.nodes().cell_connectivity());
+  flat.tables_[vertices][edges] = FromAtlas(mesh.nodes().edge_connectivity());
+  return flat;
+}
+
+FlatMesh FlatMeshFromToylib(const toylib::Grid& grid, std::vector<int>& toylibEdge) {
+  const int cells = int(FlatLocation::Cells);
+  const int edges = int(FlatLocation::Edges);
+  const int vertices = int(FlatLocation::Vertices);
+
+  const int numEdges = grid.edges().size();
+  toylibEdge.resize(numEdges);
+  std::vector<int> flatEdge(grid.all_edges().size(), -1);
+  for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+    toylibEdge[edgeIdx] = grid.edges()[edgeIdx].get().id();
+    flatEdge[toylibEdge[edgeIdx]] = edgeIdx;
+  }
+  auto sameIdx = [](int id) { return id; };
+  auto edgeIdx = [&](int id) { return flatEdge[id]; };
+  auto cell = [&](int idx) -> const toylib::Face& { return grid.faces()[idx]; };
+  auto edge = [&](int idx) -> const toylib::Edge& { return grid.edges()[idx]; };
+  auto vertex = [&](int idx) -> const toylib::Vertex& { return grid.vertices()[idx]; };
+
+  FlatMesh flat;
+  flat.sizes_[cells] = grid.faces().size();
+  flat.sizes_[edges] = numEdges;
+  flat.sizes_[vertices] = grid.vertices().size();
+
+  flat.tables_[cells][edges] = FromToylib(
+      flat.sizes_[cells], cell, [](const toylib::Face& f) { return f.edges(); }, edgeIdx);
+  flat.tables_[cells][vertices] = FromToylib(
+      flat.sizes_[cells], cell, [](const toylib::Face& f) { return f.vertices(); }, sameIdx);
+  flat.tables_[edges][cells] = FromToylib(
+      numEdges, edge, [](const toylib::Edge& e) { return e.faces(); }, sameIdx);
+  flat.tables_[edges][vertices] = FromToylib(
+      numEdges, edge, [](const toylib::Edge& e) { return e.vertices(); }, sameIdx);
+  flat.tables_[vertices][cells] = FromToylib(
+      flat.sizes_[vertices], vertex, [](const toylib::Vertex& v) { return v.faces(); }, sameIdx);
+  flat.tables_[vertices][edges] = FromToylib(
+      flat.sizes_[vertices], vertex, [](const toylib::Vertex& v) { return v.edges(); }, edgeIdx);
+  return flat;
+}
+
+FlatMesh FlatMeshFromToylib(const toylib::Grid& grid) {
+  std::vector<int> toylibEdge;
+  return FlatMeshFromToylib(grid, toylibEdge);
+}
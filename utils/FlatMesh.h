@@ -0,0 +1,169 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Mesh made of plain arrays, used by the flat backend (stencils/interfaces/flat_interface.hpp).
+// Elements are indices [0, size) per location type and every neighbor table (cell, edge and node
+// to cell, edge and node, except onto the location type itself) is a FlatConnectivity: a row per
+// element listing only the neighbors present, in the order of the mesh it was converted from.
+// Tables where all rows have the same length are stored with a fixed width, all others in CSR
+// format. All arrays are int32_t and 64 byte aligned.
+//
+// Converters are provided from atlas meshes (same element indices, missing values are dropped) and
+// from toylib grids (nodes and cells keep their ids, edges are numbered in the order of
+// Grid::edges() as for AtlasMeshFromToylib).
+
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include <atlas/mesh.h>
+
+#include "../libs/toylib.hpp"
+
+// owning array of trivially copyable values, aligned to a cache line. the values are not
+// initialized
+template <typename T>
+class AlignedArray {
+public:
+  static constexpr size_t alignment = 64;
+
+  AlignedArray() = default;
+  explicit AlignedArray(size_t size) { allocate(size); }
+
+  // replaces the buffer by a fresh one of size values: the existing contents are discarded (not
+  // copied) and the new values are not initialized
+  void allocate(size_t size) {
+    // aligned_alloc requires the size to be a multiple of the alignment
+    const size_t bytes = (std::max<size_t>(1, size) * sizeof(T) + alignment - 1) / alignment *
+                         alignment;
+    T* ptr = static_cast<T*>(std::aligned_alloc(alignment, bytes));
+    if(!ptr) {
+      throw std::bad_alloc();
+    }
+    data_.reset(ptr);
+    size_ = size;
+  }
+
+  size_t size() const { return size_; }
+  size_t bytes() const { return size_ * sizeof(T); }
+  T* data() { return data_.get(); }
+  const T* data() const { return data_.get(); }
+  T& operator[](size_t idx) { return data_[idx]; }
+  const T& operator[](size_t idx) const { return data_[idx]; }
+
+private:
+  struct Free {
+    void operator()(T* ptr) const { std::free(ptr); }
+  };
+  std::unique_ptr<T[], Free> data_;
+  size_t size_ = 0;
+};
+
+// neighbor table with a variable number of neighbors per row
+class FlatConnectivity {
+public:
+  // builds the table from the rows returned by rowFn(row, std::vector<int32_t>& nbh), which
+  // appends the neighbors of row to nbh
+  template <typename RowFn>
+  static FlatConnectivity FromRows(int numRows, RowFn&& rowFn);
+
+  int rows() const { return numRows_; }
+  // number of neighbors of all rows if the table has a fixed width, 0 otherwise
+  int width() const { return width_; }
+  int cols(int row) const { return end(row) - begin(row); }
+
+  const int32_t* begin(int row) const {
+    assert(row >= 0 && row < numRows_);
+    return width_ ? values_.data() + row * width_ : values_.data() + offsets_[row];
+  }
+  const int32_t* end(int row) const {
+    return width_ ? values_.data() + (row + 1) * width_ : values_.data() + offsets_[row + 1];
+  }
+
+  size_t bytes() const { return offsets_.bytes() + values_.bytes(); }
+
+private:
+  int numRows_ = 0;
+  int width_ = 0;
+  AlignedArray<int32_t> offsets_; // empty for fixed width tables
+  AlignedArray<int32_t> values_;
+};
+
+// location types of a FlatMesh, in the order of dawn::LocationType
+enum class FlatLocation { Cells = 0, Edges, Vertices };
+
+class FlatMesh {
+public:
+  int size(FlatLocation location) const { return sizes_[int(location)]; }
+  int numCells() const { return size(FlatLocation::Cells); }
+  int numEdges() const { return size(FlatLocation::Edges); }
+  int numVertices() const { return size(FlatLocation::Vertices); }
+
+  // table from -> to. tables onto the same location type and tables which have not been present
+  // in the source mesh have no rows
+  const FlatConnectivity& table(FlatLocation from, FlatLocation to) const {
+    return tables_[int(from)][int(to)];
+  }
+
+  // bytes held by all neighbor tables
+  size_t bytes() const;
+
+private:
+  friend FlatMesh FlatMeshFromAtlas(const atlas::Mesh& mesh);
+  friend FlatMesh FlatMeshFromToylib(const toylib::Grid& grid, std::vector<int>& toylibEdge);
+
+  int sizes_[3] = {0, 0, 0};
+  FlatConnectivity tables_[3][3];
+};
+
+// converts all neighbor tables of mesh which have been built, element indices are the same
+FlatMesh FlatMeshFromAtlas(const atlas::Mesh& mesh);
+
+// converts all neighbor tables of grid. toylibEdge receives the toylib id of every edge of the flat
+// mesh
+FlatMesh FlatMeshFromToylib(const toylib::Grid& grid, std::vector<int>& toylibEdge);
+FlatMesh FlatMeshFromToylib(const toylib::Grid& grid);
+
+template <typename RowFn>
+FlatConnectivity FlatConnectivity::FromRows(int numRows, RowFn&& rowFn) {
+  std::vector<int32_t> offsets(numRows + 1, 0);
+  std::vector<int32_t> values;
+  for(int row = 0; row < numRows; row++) {
+    rowFn(row, values);
+    offsets[row + 1] = values.size();
+  }
+
+  FlatConnectivity conn;
+  conn.numRows_ = numRows;
+  const int firstCols = numRows > 0 ? offsets[1] : 0;
+  bool fixedWidth = firstCols > 0;
+  for(int row = 1; row < numRows && fixedWidth; row++) {
+    fixedWidth = offsets[row + 1] - offsets[row] == firstCols;
+  }
+  if(fixedWidth) {
+    conn.width_ = firstCols;
+  } else {
+    conn.offsets_.allocate(offsets.size());
+    std::copy(offsets.begin(), offsets.end(), conn.offsets_.data());
+  }
+  conn.values_.allocate(values.size());
+  std::copy(values.begin(), values.end(), conn.values_.data());
+  return conn;
+}
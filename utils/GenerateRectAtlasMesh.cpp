@@ -2,6 +2,12 @@
 
 #include "AtlasExtractSubmesh.h"
 
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <tuple>
+#include <vector>
+
 #include <atlas/array.h>
 #include <atlas/grid.h>
 #include <atlas/meshgenerator.h>
@@ -182,7 +188,379 @@ atlas::Mesh AtlasMeshRectImpl(int ny, double lengthFac) {
   return rectMesh;
 }
 
+//===------------------------------------------------------------------------------------------===//
+// direct generator
+//===------------------------------------------------------------------------------------------===//
+
+// The mesh generated by AtlasMeshRectImpl, described analytically. The structured grid has nodes
+// (i, j), i in [0, nx), j in [0, ny), which are mapped to (i - 0.5 j, j sqrt(3)/2) to make the
+// triangles equilateral. Strip j (between rows j and j+1) contains the triangles
+//
+//     lower L(i, j) = (i, j), (i+1, j), (i+1, j+1)
+//     upper U(i, j) = (i, j), (i+1, j+1), (i, j+1)
+//
+// A triangle is part of the rectangle if the crop in AtlasMeshRectImpl keeps it, i.e. if any of its
+// vertices x satisfies 0 < x < xHi. For every strip, the kept lower and upper triangles are
+// contiguous ranges of i, and so are the nodes of every row. All indices below are computed from
+// these ranges:
+//
+//  - nodes are numbered row by row, with increasing i in each row
+//  - cells are numbered strip by strip, with increasing i in each strip, L(i, j) before U(i, j)
+//  - edges are numbered in the order they are first encountered when visiting the cells in order
+//    and the edges of every cell in local order
+//
+// The local edges of the cells (and the cells across them) are
+//
+//     L(i, j): 0 = (i, j)-(i+1, j)      across U(i, j-1), local 1
+//              1 = (i+1, j)-(i+1, j+1)  across U(i+1, j), local 2
+//              2 = (i, j)-(i+1, j+1)    across U(i, j),   local 0
+//     U(i, j): 0 = (i, j)-(i+1, j+1)    across L(i, j),   local 2
+//              1 = (i, j+1)-(i+1, j+1)  across L(i, j+1), local 0
+//              2 = (i, j)-(i, j+1)      across L(i-1, j), local 1
+struct IndexRange {
+  int lo = 0;
+  int hi = 0; // exclusive
+  int size() const { return std::max(0, hi - lo); }
+  bool contains(int idx) const { return idx >= lo && idx < hi; }
+  int countBelow(int idx) const { return std::clamp(idx - lo, 0, size()); }
+};
+
+enum class TriangleKind { Lower, Upper };
+
+class RectLayout {
+public:
+  RectLayout(int ny, double lengthFac) : nx_(3 * ny), ny_(ny) {
+    // same bound as in AtlasMeshRectImpl (keep the expressions, the comparisons need to agree to
+    // the last bit)
+    double newHeight = (ny - 1) * sqrt(3) / 2.;
+    double length = newHeight * lengthFac;
+    const double xHi = length + length / (nx_)*0.1;
+    auto inside = [&](int i, int j) {
+      double x = double(i) - 0.5 * double(j);
+      return x > 0. && x < xHi;
+    };
+
+    lower_.resize(ny_ - 1);
+    upper_.resize(ny_ - 1);
+    stripOffset_.resize(ny_, 0);
+    for(int j = 0; j < ny_ - 1; j++) {
+      lower_[j] = keptRange([&](int i) {
+        return inside(i, j) || inside(i + 1, j) || inside(i + 1, j + 1);
+      });
+      upper_[j] = keptRange([&](int i) {
+        return inside(i, j) || inside(i + 1, j + 1) || inside(i, j + 1);
+      });
+      stripOffset_[j + 1] = stripOffset_[j] + lower_[j].size() + upper_[j].size();
+    }
+
+    // nodes of row j are used by the bottom of strip j and the top of strip j-1
+    nodes_.resize(ny_);
+    rowOffset_.resize(ny_ + 1, 0);
+    for(int j = 0; j < ny_; j++) {
+      int lo = std::numeric_limits<int>::max();
+      int hi = std::numeric_limits<int>::min();
+      auto extend = [&](const IndexRange& range, int first, int last) {
+        if(range.size() > 0) {
+          lo = std::min(lo, range.lo + first);
+          hi = std::max(hi, range.hi - 1 + last + 1);
+        }
+      };
+      if(j < ny_ - 1) {
+        extend(lower_[j], 0, 1); // (i, j), (i+1, j)
+        extend(upper_[j], 0, 0); // (i, j)
+      }
+      if(j > 0) {
+        extend(lower_[j - 1], 1, 1); // (i+1, j)
+        extend(upper_[j - 1], 0, 1); // (i, j), (i+1, j)
+      }
+      nodes_[j] = lo <= hi ? IndexRange{lo, hi} : IndexRange{};
+      rowOffset_[j + 1] = rowOffset_[j] + nodes_[j].size();
+    }
+  }
+
+  int nx() const { return nx_; }
+  int ny() const { return ny_; }
+  int numNodes() const { return rowOffset_.back(); }
+  int numCells() const { return stripOffset_.back(); }
+  const IndexRange& nodeRange(int j) const { return nodes_[j]; }
+  const IndexRange& cellRange(TriangleKind kind, int j) const {
+    return kind == TriangleKind::Lower ? lower_[j] : upper_[j];
+  }
+
+  // -1 if the node is not part of the rectangle
+  int node(int i, int j) const {
+    if(j < 0 || j >= ny_ || !nodes_[j].contains(i)) {
+      return -1;
+    }
+    return rowOffset_[j] + i - nodes_[j].lo;
+  }
+
+  // -1 if the cell is not part of the rectangle
+  int cell(TriangleKind kind, int i, int j) const {
+    if(j < 0 || j >= ny_ - 1 || !cellRange(kind, j).contains(i)) {
+      return -1;
+    }
+    int idx = stripOffset_[j] + lower_[j].countBelow(i) + upper_[j].countBelow(i);
+    if(kind == TriangleKind::Upper && lower_[j].contains(i)) {
+      idx++;
+    }
+    return idx;
+  }
+
+  std::array<int, 3> cellNodes(TriangleKind kind, int i, int j) const {
+    return kind == TriangleKind::Lower
+               ? std::array<int, 3>{node(i, j), node(i + 1, j), node(i + 1, j + 1)}
+               : std::array<int, 3>{node(i, j), node(i + 1, j + 1), node(i, j + 1)};
+  }
+
+  // the cell across local edge edgeIdx and the local index of the same edge in that cell
+  std::tuple<int, int> across(TriangleKind kind, int i, int j, int edgeIdx) const {
+    using TK = TriangleKind;
+    if(kind == TK::Lower) {
+      switch(edgeIdx) {
+      case 0:
+        return {cell(TK::Upper, i, j - 1), 1};
+      case 1:
+        return {cell(TK::Upper, i + 1, j), 2};
+      default:
+        return {cell(TK::Upper, i, j), 0};
+      }
+    }
+    switch(edgeIdx) {
+    case 0:
+      return {cell(TK::Lower, i, j), 2};
+    case 1:
+      return {cell(TK::Lower, i, j + 1), 0};
+    default:
+      return {cell(TK::Lower, i - 1, j), 1};
+    }
+  }
+
+  // nodes of local edge edgeIdx, ordered bottom to top resp. left to right
+  std::tuple<int, int> edgeNodes(TriangleKind kind, int i, int j, int edgeIdx) const {
+    if(kind == TriangleKind::Lower) {
+      switch(edgeIdx) {
+      case 0:
+        return {node(i, j), node(i + 1, j)};
+      case 1:
+        return {node(i + 1, j), node(i + 1, j + 1)};
+      default:
+        return {node(i, j), node(i + 1, j + 1)};
+      }
+    }
+    switch(edgeIdx) {
+    case 0:
+      return {node(i, j), node(i + 1, j + 1)};
+    case 1:
+      return {node(i, j + 1), node(i + 1, j + 1)};
+    default:
+      return {node(i, j), node(i, j + 1)};
+    }
+  }
+
+private:
+  // the range of i in [0, nx-1) for which keep(i) holds, keep is true on a contiguous range
+  template <typename KeepFn>
+  IndexRange keptRange(KeepFn&& keep) const {
+    IndexRange range;
+    int i = 0;
+    while(i < nx_ - 1 && !keep(i)) {
+      i++;
+    }
+    range.lo = i;
+    while(i < nx_ - 1 && keep(i)) {
+      i++;
+    }
+    range.hi = i;
+    return range;
+  }
+
+  int nx_;
+  int ny_;
+  std::vector<IndexRange> lower_;
+  std::vector<IndexRange> upper_;
+  std::vector<IndexRange> nodes_;
+  std::vector<int> stripOffset_;
+  std::vector<int> rowOffset_;
+};
+
+void RectNodes(const RectLayout& layout, atlas::Mesh& mesh) {
+  mesh.nodes().resize(layout.numNodes());
+  auto xy = atlas::array::make_view<double, 2>(mesh.nodes().xy());
+  auto lonlat = atlas::array::make_view<double, 2>(mesh.nodes().lonlat());
+  auto glbIdx = atlas::array::make_view<atlas::gidx_t, 1>(mesh.nodes().global_index());
+  auto remoteIdx = atlas::array::make_indexview<atlas::idx_t, 1>(mesh.nodes().remote_index());
+  auto part = atlas::array::make_view<int, 1>(mesh.nodes().partition());
+  auto ghost = atlas::array::make_view<int, 1>(mesh.nodes().ghost());
+  auto flags = atlas::array::make_view<int, 1>(mesh.nodes().flags());
+
+  double xMin = std::numeric_limits<double>::max();
+  double yMin = std::numeric_limits<double>::max();
+  double xMax = -std::numeric_limits<double>::max();
+  double yMax = -std::numeric_limits<double>::max();
+  for(int j = 0; j < layout.ny(); j++) {
+    for(int i = layout.nodeRange(j).lo; i < layout.nodeRange(j).hi; i++) {
+      int nodeIdx = layout.node(i, j);
+      double x = double(i) - 0.5 * double(j);
+      double y = double(j) * sqrt(3.) / 2.;
+      xy(nodeIdx, atlas::LON) = x;
+      xy(nodeIdx, atlas::LAT) = y;
+      // lonlat is the position on the structured grid, as for the cropped mesh
+      lonlat(nodeIdx, atlas::LON) = i;
+      lonlat(nodeIdx, atlas::LAT) = j;
+      glbIdx(nodeIdx) = nodeIdx + 1;
+      remoteIdx(nodeIdx) = nodeIdx;
+      part(nodeIdx) = 0;
+      ghost(nodeIdx) = 0;
+      flags(nodeIdx) = 0;
+      xMin = fmin(x, xMin);
+      yMin = fmin(y, yMin);
+      xMax = fmax(x, xMax);
+      yMax = fmax(y, yMax);
+    }
+  }
+
+  // re-center and scale exactly like AtlasMeshRectImpl
+  double lX = xMax - xMin;
+  double lY = yMax - yMin;
+  double scale = 180 / lY;
+  for(int nodeIdx = 0; nodeIdx < layout.numNodes(); nodeIdx++) {
+    double x = xy(nodeIdx, atlas::LON) - xMin - lX / 2;
+    double y = xy(nodeIdx, atlas::LAT) - yMin - lY / 2;
+    xy(nodeIdx, atlas::LON) = x * scale;
+    xy(nodeIdx, atlas::LAT) = y * scale;
+  }
+}
+
+// visits all kept cells in order, calls fn(cellIdx, kind, i, j)
+template <typename Fn>
+void ForEachRectCell(const RectLayout& layout, Fn&& fn) {
+  for(int j = 0; j < layout.ny() - 1; j++) {
+    const IndexRange& lower = layout.cellRange(TriangleKind::Lower, j);
+    const IndexRange& upper = layout.cellRange(TriangleKind::Upper, j);
+    for(int i = std::min(lower.lo, upper.lo); i < std::max(lower.hi, upper.hi); i++) {
+      if(lower.contains(i)) {
+        fn(layout.cell(TriangleKind::Lower, i, j), TriangleKind::Lower, i, j);
+      }
+      if(upper.contains(i)) {
+        fn(layout.cell(TriangleKind::Upper, i, j), TriangleKind::Upper, i, j);
+      }
+    }
+  }
+}
+
+atlas::Mesh AtlasMeshRectCompleteImpl(int ny, double lengthFac) {
+  RectLayout layout(ny, lengthFac);
+  const int numCells = layout.numCells();
+
+  atlas::Mesh mesh;
+  RectNodes(layout, mesh);
+
+  // cells and edges, single pass over the cells. an edge gets its index from the first cell
+  // visited, the second cell (if any) copies it from there
+  const int edgesPerCell = 3;
+  const int missingVal = mesh.cells().edge_connectivity().missing_value();
+  std::vector<int> cellToNode(edgesPerCell * numCells);
+  std::vector<int> cellToEdge(edgesPerCell * numCells);
+  std::vector<int> edgeToNode;
+  std::vector<int> edgeToCell;
+  edgeToNode.reserve(2 * (3 * numCells / 2 + layout.ny()));
+  edgeToCell.reserve(2 * (3 * numCells / 2 + layout.ny()));
+  ForEachRectCell(layout, [&](int cellIdx, TriangleKind kind, int i, int j) {
+    auto nodes = layout.cellNodes(kind, i, j);
+    std::copy(nodes.begin(), nodes.end(), cellToNode.begin() + edgesPerCell * cellIdx);
+    for(int edgeIdx = 0; edgeIdx < edgesPerCell; edgeIdx++) {
+      auto [nbhCellIdx, nbhEdgeIdx] = layout.across(kind, i, j, edgeIdx);
+      if(nbhCellIdx != -1 && nbhCellIdx < cellIdx) {
+        cellToEdge[edgesPerCell * cellIdx + edgeIdx] =
+            cellToEdge[edgesPerCell * nbhCellIdx + nbhEdgeIdx];
+        continue;
+      }
+      cellToEdge[edgesPerCell * cellIdx + edgeIdx] = edgeToNode.size() / 2;
+      auto [nodeLo, nodeHi] = layout.edgeNodes(kind, i, j, edgeIdx);
+      edgeToNode.insert(edgeToNode.end(), {nodeLo, nodeHi});
+      edgeToCell.insert(edgeToCell.end(), {cellIdx, nbhCellIdx == -1 ? missingVal : nbhCellIdx});
+    }
+  });
+  const int numEdges = edgeToNode.size() / 2;
+
+  mesh.cells().add(new atlas::mesh::temporary::Triangle(), numCells);
+  mesh.edges().add(new atlas::mesh::temporary::Line(), numEdges);
+  {
+    auto& cellNodeConnectivity = mesh.cells().node_connectivity();
+    auto glbIdxCell = atlas::array::make_view<atlas::gidx_t, 1>(mesh.cells().global_index());
+    auto partCell = atlas::array::make_view<int, 1>(mesh.cells().partition());
+    for(int cellIdx = 0; cellIdx < numCells; cellIdx++) {
+      cellNodeConnectivity.set(cellIdx, cellToNode.data() + edgesPerCell * cellIdx);
+      glbIdxCell(cellIdx) = cellIdx;
+      partCell(cellIdx) = 0;
+    }
+    auto& edgeNodeConnectivity = mesh.edges().node_connectivity();
+    auto glbIdxEdge = atlas::array::make_view<atlas::gidx_t, 1>(mesh.edges().global_index());
+    auto partEdge = atlas::array::make_view<int, 1>(mesh.edges().partition());
+    for(int edgeIdx = 0; edgeIdx < numEdges; edgeIdx++) {
+      edgeNodeConnectivity.set(edgeIdx, edgeToNode.data() + 2 * edgeIdx);
+      glbIdxEdge(edgeIdx) = edgeIdx;
+      partEdge(edgeIdx) = 0;
+    }
+  }
+  std::vector<int>().swap(cellToNode);
+  std::vector<int>().swap(edgeToNode);
+
+  mesh.cells().edge_connectivity().add(numCells, edgesPerCell, cellToEdge.data());
+  mesh.edges().cell_connectivity().add(numEdges, 2, edgeToCell.data());
+  std::vector<int>().swap(edgeToCell);
+
+  // node tables, neighbors are ordered counter clockwise starting east. rows of boundary nodes only
+  // contain the neighbors present
+  using TK = TriangleKind;
+  auto edgeOf = [&](int cellIdx, int edgeIdx) {
+    return cellIdx == -1 ? -1 : cellToEdge[edgesPerCell * cellIdx + edgeIdx];
+  };
+  auto firstOf = [](int a, int b) { return a != -1 ? a : b; };
+  std::vector<int> nodeToEdgeCols(layout.numNodes());
+  std::vector<int> nodeToCellCols(layout.numNodes());
+  std::vector<int> nodeToEdge;
+  std::vector<int> nodeToCell;
+  nodeToEdge.reserve(6 * layout.numNodes());
+  nodeToCell.reserve(6 * layout.numNodes());
+  for(int j = 0; j < layout.ny(); j++) {
+    for(int i = layout.nodeRange(j).lo; i < layout.nodeRange(j).hi; i++) {
+      const std::array<int, 6> cells{
+          layout.cell(TK::Lower, i, j),         layout.cell(TK::Upper, i, j),
+          layout.cell(TK::Lower, i - 1, j),     layout.cell(TK::Upper, i - 1, j - 1),
+          layout.cell(TK::Lower, i - 1, j - 1), layout.cell(TK::Upper, i, j - 1)};
+      // each edge is looked up in one of the two cells sharing it
+      const std::array<int, 6> edges{firstOf(edgeOf(cells[0], 0), edgeOf(cells[5], 1)),
+                                     firstOf(edgeOf(cells[0], 2), edgeOf(cells[1], 0)),
+                                     firstOf(edgeOf(cells[1], 2), edgeOf(cells[2], 1)),
+                                     firstOf(edgeOf(cells[2], 0), edgeOf(cells[3], 1)),
+                                     firstOf(edgeOf(cells[3], 0), edgeOf(cells[4], 2)),
+                                     firstOf(edgeOf(cells[4], 1), edgeOf(cells[5], 2))};
+      const int nodeIdx = layout.node(i, j);
+      for(int nbhIdx = 0; nbhIdx < 6; nbhIdx++) {
+        if(cells[nbhIdx] != -1) {
+          nodeToCell.push_back(cells[nbhIdx]);
+          nodeToCellCols[nodeIdx]++;
+        }
+        if(edges[nbhIdx] != -1) {
+          nodeToEdge.push_back(edges[nbhIdx]);
+          nodeToEdgeCols[nodeIdx]++;
+        }
+      }
+    }
+  }
+  mesh.nodes().edge_connectivity().add(layout.numNodes(), nodeToEdgeCols.data(),
+                                       nodeToEdge.data());
+  mesh.nodes().cell_connectivity().add(layout.numNodes(), nodeToCellCols.data(),
+                                       nodeToCell.data());
+
+  return mesh;
+}
 } // namespace
 
 atlas::Mesh AtlasMeshRect(int ny) { return AtlasMeshRectImpl(ny, 2.0); }
-atlas::Mesh AtlasMeshSquare(int ny) { return AtlasMeshRectImpl(ny, 1.0); }
\ No newline at end of file
+atlas::Mesh AtlasMeshSquare(int ny) { return AtlasMeshRectImpl(ny, 1.0); }
+
+atlas::Mesh AtlasMeshRectComplete(int ny) { return AtlasMeshRectCompleteImpl(ny, 2.0); }
+atlas::Mesh AtlasMeshSquareComplete(int ny) { return AtlasMeshRectCompleteImpl(ny, 1.0); }
@@ -20,4 +20,15 @@
 #include <atlas/mesh.h>
 
 atlas::Mesh AtlasMeshRect(int ny);
-atlas::Mesh AtlasMeshSquare(int ny);
\ No newline at end of file
+atlas::Mesh AtlasMeshSquare(int ny);
+
+// Same meshes as above (same triangles, same node locations), but generated directly instead of
+// cropping an oversized atlas mesh. All neighbor tables (cell/edge/node to cell/edge/node, except
+// onto the element type itself) are filled, so no atlas actions (build_edges and friends) need to
+// be called afterwards. The element numbering differs from the functions above:
+//  - nodes and cells are numbered row by row from bottom to top, left to right
+//  - the neighbors of a node are ordered counter clockwise, starting east. rows of boundary nodes
+//    only contain the neighbors present (no missing values)
+//  - edge to cell rows of boundary edges have a missing value in the second slot
+atlas::Mesh AtlasMeshRectComplete(int ny);
+atlas::Mesh AtlasMeshSquareComplete(int ny);
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "MemoryFootprint.h"
+
+#include <cstdlib>
+#include <functional>
+
+#include "AtlasCartesianWrapper.h"
+#include "AtlasLattice.h"
+#include "FlatMesh.h"
+
+namespace {
+const double MB = 1024. * 1024.;
+
+const FootprintLocation allLocations[] = {FootprintLocation::Cells, FootprintLocation::Edges,
+                                          FootprintLocation::Nodes, FootprintLocation::None};
+
+// the fields of the nodes, cells or edges of an atlas mesh
+template <typename ElementsT>
+void AddFields(MemoryFootprint& footprint, const std::string& prefix, FootprintLocation location,
+               const ElementsT& elements) {
+  for(int fieldIdx = 0; fieldIdx < elements.nb_fields(); fieldIdx++) {
+    const atlas::Field& field = elements.field(fieldIdx);
+    footprint.add("mesh", prefix + field.name(), location, field.footprint());
+  }
+}
+} // namespace
+
+void MemoryFootprint::add(const std::string& category, const std::string& name,
+                          FootprintLocation location, size_t bytes) {
+  entries_.push_back({category, name, location, bytes});
+}
+
+size_t MemoryFootprint::total() const {
+  size_t sum = 0;
+  for(const auto& entry : entries_) {
+    sum += entry.bytes;
+  }
+  return sum;
+}
+
+size_t MemoryFootprint::total(FootprintLocation location) const {
+  size_t sum = 0;
+  for(const auto& entry : entries_) {
+    sum += entry.location == location ? entry.bytes : 0;
+  }
+  return sum;
+}
+
+size_t MemoryFootprint::total(const std::string& category) const {
+  size_t sum = 0;
+  for(const auto& entry : entries_) {
+    sum += entry.category == category ? entry.bytes : 0;
+  }
+  return sum;
+}
+
+void MemoryFootprint::print(FILE* fp) const {
+  fprintf(fp, "%-10s %-36s %-8s %12s\n", "category", "name", "location", "size [MB]");
+  for(const auto& entry : entries_) {
+    fprintf(fp, "%-10s %-36s %-8s %12.3f\n", entry.category.c_str(), entry.name.c_str(),
+            FootprintLocationName(entry.location), entry.bytes / MB);
+  }
+  fprintf(fp, "total per location:");
+  for(FootprintLocation location : allLocations) {
+    fprintf(fp, " %s %.3f MB", FootprintLocationName(location), total(location) / MB);
+  }
+  fprintf(fp, "\ntotal per category:");
+  for(const char* category : {"mesh", "field", "geometry"}) {
+    fprintf(fp, " %s %.3f MB", category, total(category) / MB);
+  }
+  fprintf(fp, "\ntotal: %.3f MB\n", total() / MB);
+}
+
+const char* FootprintLocationName(FootprintLocation location) {
+  switch(location) {
+  case FootprintLocation::Cells:
+    return "cells";
+  case FootprintLocation::Edges:
+    return "edges";
+  case FootprintLocation::Nodes:
+    return "nodes";
+  default:
+    return "none";
+  }
+}
+
+bool MemoryReportRequested() {
+  const char* env = std::getenv("ATLAS_UTILS_MEMORY_REPORT");
+  return env && std::string(env) != "0";
+}
+
+void AddFootprint(MemoryFootprint& footprint, const atlas::Mesh& mesh) {
+  const auto& nodes = mesh.nodes();
+  const auto& edges = mesh.edges();
+  const auto& cells = mesh.cells();
+  footprint.add("mesh", "nodes/edge_connectivity", FootprintLocation::Nodes,
+                nodes.edge_connectivity().footprint());
+  footprint.add("mesh", "nodes/cell_connectivity", FootprintLocation::Nodes,
+                nodes.cell_connectivity().footprint());
+  footprint.add("mesh", "edges/node_connectivity", FootprintLocation::Edges,
+                edges.node_connectivity().footprint());
+  footprint.add("mesh", "edges/cell_connectivity", FootprintLocation::Edges,
+                edges.cell_connectivity().footprint());
+  footprint.add("mesh", "cells/node_connectivity", FootprintLocation::Cells,
+                cells.node_connectivity().footprint());
+  footprint.add("mesh", "cells/edge_connectivity", FootprintLocation::Cells,
+                cells.edge_connectivity().footprint());
+  AddFields(footprint, "nodes/", FootprintLocation::Nodes, nodes);
+  AddFields(footprint, "edges/", FootprintLocation::Edges, edges);
+  AddFields(footprint, "cells/", FootprintLocation::Cells, cells);
+}
+
+void AddFootprint(MemoryFootprint& footprint, FootprintLocation location,
+                  const atlas::Field& field) {
+  footprint.add("field", field.name(), location, field.footprint());
+}
+
+void AddFootprint(MemoryFootprint& footprint, const toylib::Grid& grid) {
+  // the neighbor vectors of the elements are counted by their size, their capacity is not exposed
+  size_t vertexBytes = 0;
+  for(const auto& v : grid.vertices()) {
+    vertexBytes += sizeof(v) + sizeof(void*) * (v.edges().size() + v.faces().size());
+  }
+  size_t edgeBytes = 0;
+  for(const auto& e : grid.all_edges()) {
+    edgeBytes += sizeof(e) + sizeof(void*) * (e.vertices().size() + e.faces().size());
+  }
+  edgeBytes += sizeof(std::reference_wrapper<const toylib::Edge>) * grid.edges().size();
+  size_t faceBytes = 0;
+  for(const auto& f : grid.faces()) {
+    faceBytes += sizeof(f) + sizeof(void*) * (f.vertices().size() + f.edges().size());
+  }
+  footprint.add("mesh", "vertices", FootprintLocation::Nodes, vertexBytes);
+  footprint.add("mesh", "edges", FootprintLocation::Edges, edgeBytes);
+  footprint.add("mesh", "faces", FootprintLocation::Cells, faceBytes);
+}
+
+void AddFootprint(MemoryFootprint& footprint, const FlatMesh& mesh) {
+  const FlatLocation flatLocations[] = {FlatLocation::Cells, FlatLocation::Edges,
+                                        FlatLocation::Vertices};
+  const FootprintLocation locations[] = {FootprintLocation::Cells, FootprintLocation::Edges,
+                                         FootprintLocation::Nodes};
+  for(int from = 0; from < 3; from++) {
+    for(int to = 0; to < 3; to++) {
+      if(from == to) {
+        continue;
+      }
+      const std::string name = std::string("flat/") + FootprintLocationName(locations[from]) +
+                               "_to_" + FootprintLocationName(locations[to]);
+      footprint.add("mesh", name, locations[from],
+                    mesh.table(flatLocations[from], flatLocations[to]).bytes());
+    }
+  }
+}
+
+void AddFootprint(MemoryFootprint& footprint, const AtlasToCartesian& wrapper) {
+  footprint.add("geometry", "cartesian node coordinates", FootprintLocation::Nodes,
+                wrapper.footprint());
+}
+
+void AddFootprint(MemoryFootprint& footprint, const AtlasLattice& lattice) {
+  // the maps scale with the number of lattice positions, i.e. with the nodes
+  footprint.add("geometry", "lattice", FootprintLocation::Nodes, lattice.footprint());
+}
@@ -0,0 +1,114 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Accounting of the memory held by a configuration (mesh, fields and geometry caches). Every
+// contribution is recorded as an entry with a category ("mesh", "field" or "geometry"), a name and
+// the location type it scales with, such that the totals per location type can be extrapolated to
+// other resolutions. The AddFootprint overloads below record the neighbor tables and fields of
+// atlas meshes, atlas fields, toylib grids and fields, flat meshes and the geometry caches:
+//
+//    MemoryFootprint footprint;
+//    AddFootprint(footprint, mesh);
+//    AddFootprint(footprint, FootprintLocation::Edges, vec_F);
+//    footprint.print();
+//
+// Atlas objects report their own footprint. For toylib grids the elements and their neighbor
+// pointers are counted, i.e. the numbers are a (tight) lower bound. Drivers print the report if the
+// environment variable ATLAS_UTILS_MEMORY_REPORT is set (see MemoryReportRequested).
+
+#pragma once
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <atlas/field.h>
+#include <atlas/mesh.h>
+
+#include "../libs/toylib.hpp"
+
+class AtlasLattice;
+class AtlasToCartesian;
+class FlatMesh;
+
+// location type an entry scales with. None for data of fixed size
+enum class FootprintLocation { Cells = 0, Edges, Nodes, None };
+
+struct FootprintEntry {
+  std::string category;
+  std::string name;
+  FootprintLocation location;
+  size_t bytes;
+};
+
+class MemoryFootprint {
+public:
+  void add(const std::string& category, const std::string& name, FootprintLocation location,
+           size_t bytes);
+
+  const std::vector<FootprintEntry>& entries() const { return entries_; }
+
+  size_t total() const;
+  size_t total(FootprintLocation location) const;
+  size_t total(const std::string& category) const;
+
+  // one row per entry, followed by the totals per location type and per category
+  void print(FILE* fp = stdout) const;
+
+private:
+  std::vector<FootprintEntry> entries_;
+};
+
+// "cells", "edges", "nodes" or "none"
+const char* FootprintLocationName(FootprintLocation location);
+
+// true if the environment variable ATLAS_UTILS_MEMORY_REPORT is set to a value other than 0
+bool MemoryReportRequested();
+
+//===------------------------------------------------------------------------------------------===//
+// accounting of the data structures used in this repository
+//===------------------------------------------------------------------------------------------===//
+
+// all neighbor tables and fields (coordinates, indices, flags, ...) of the nodes, edges and cells
+void AddFootprint(MemoryFootprint& footprint, const atlas::Mesh& mesh);
+
+// a field allocated on location, named after the field
+void AddFootprint(MemoryFootprint& footprint, FootprintLocation location,
+                  const atlas::Field& field);
+
+// vertices, edges and faces of the grid including their neighbor pointers
+void AddFootprint(MemoryFootprint& footprint, const toylib::Grid& grid);
+
+// all neighbor tables of a flat mesh (stencils/interfaces/flat_interface.hpp)
+void AddFootprint(MemoryFootprint& footprint, const FlatMesh& mesh);
+
+// geometry caches: the node coordinates of the cartesian wrapper and the lattice view of a mesh
+void AddFootprint(MemoryFootprint& footprint, const AtlasToCartesian& wrapper);
+void AddFootprint(MemoryFootprint& footprint, const AtlasLattice& lattice);
+
+// toylib fields, the location is given by the element type of the field
+inline FootprintLocation ToylibLocation(const toylib::Face*) { return FootprintLocation::Cells; }
+inline FootprintLocation ToylibLocation(const toylib::Edge*) { return FootprintLocation::Edges; }
+inline FootprintLocation ToylibLocation(const toylib::Vertex*) { return FootprintLocation::Nodes; }
+
+template <typename O, typename T>
+void AddFootprint(MemoryFootprint& footprint, const std::string& name,
+                  const toylib::Data<O, T>& field) {
+  footprint.add("field", name, ToylibLocation(static_cast<const O*>(nullptr)), field.bytes());
+}
+template <typename O, typename T>
+void AddFootprint(MemoryFootprint& footprint, const std::string& name,
+                  const toylib::SparseData<O, T>& field) {
+  footprint.add("field", name, ToylibLocation(static_cast<const O*>(nullptr)), field.bytes());
+}
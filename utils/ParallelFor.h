@@ -0,0 +1,156 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Minimal fork-join helpers built on std::thread. Threads are spawned per call, so these are meant
+// for loops which are large enough to amortize that (mesh sized loops, not inner loops).
+
+// number of threads used by the helpers below. defaults to the number of hardware threads, can be
+// overridden by setting the environment variable ATLAS_UTILS_NUM_THREADS
+inline int NumThreads() {
+  static const int numThreads = [] {
+    if(const char* env = std::getenv("ATLAS_UTILS_NUM_THREADS")) {
+      int n = atoi(env);
+      if(n > 0) {
+        return n;
+      }
+    }
+    return std::max(1, int(std::thread::hardware_concurrency()));
+  }();
+  return numThreads;
+}
+
+// the half open range of chunk chunkIdx if [begin, end) is split into numChunks contiguous chunks
+// of (almost) equal size
+inline std::pair<int, int> ChunkRange(int begin, int end, int numChunks, int chunkIdx) {
+  long size = end - begin;
+  int lo = begin + int(size * chunkIdx / numChunks);
+  int hi = begin + int(size * (chunkIdx + 1) / numChunks);
+  return {lo, hi};
+}
+
+// true while the calling thread executes a task of ParallelTasks. nested calls run serially, such
+// that parallel loops called from within a task do not oversubscribe the machine
+inline bool& InParallelTask() {
+  thread_local bool inTask = false;
+  return inTask;
+}
+
+// runs fn(taskIdx) for all taskIdx in [0, numTasks). tasks are distributed dynamically over at most
+// numThreads threads, the calling thread participates
+template <typename Fn>
+void ParallelTasks(int numTasks, Fn&& fn, int numThreads = NumThreads()) {
+  const int numWorkers = std::min(numThreads, numTasks);
+  if(numWorkers <= 1 || InParallelTask()) {
+    for(int taskIdx = 0; taskIdx < numTasks; taskIdx++) {
+      fn(taskIdx);
+    }
+    return;
+  }
+
+  std::atomic<int> nextTask{0};
+  auto work = [&]() {
+    InParallelTask() = true;
+    for(int taskIdx = nextTask++; taskIdx < numTasks; taskIdx = nextTask++) {
+      fn(taskIdx);
+    }
+    InParallelTask() = false;
+  };
+  std::vector<std::thread> workers;
+  for(int workerIdx = 1; workerIdx < numWorkers; workerIdx++) {
+    workers.emplace_back(work);
+  }
+  work();
+  for(auto& worker : workers) {
+    worker.join();
+  }
+}
+
+// calls fn(lo, hi) for contiguous chunks [lo, hi) covering [begin, end) in parallel. chunks contain
+// at least minChunk elements (except if the range itself is smaller)
+template <typename Fn>
+void ParallelForChunks(int begin, int end, Fn&& fn, int minChunk = 4096) {
+  if(end <= begin) {
+    return;
+  }
+  const int maxChunks = std::max(1, (end - begin) / std::max(1, minChunk));
+  const int numChunks = std::min(maxChunks, 4 * NumThreads());
+  ParallelTasks(numChunks, [&](int chunkIdx) {
+    auto [lo, hi] = ChunkRange(begin, end, numChunks, chunkIdx);
+    fn(lo, hi);
+  });
+}
+
+// calls fn(idx) for all idx in [begin, end) in parallel
+template <typename Fn>
+void ParallelFor(int begin, int end, Fn&& fn, int minChunk = 4096) {
+  ParallelForChunks(
+      begin, end,
+      [&](int lo, int hi) {
+        for(int idx = lo; idx < hi; idx++) {
+          fn(idx);
+        }
+      },
+      minChunk);
+}
+
+// compacts the indices in [0, size) for which keep(idx) is true into a vector, in ascending order.
+// if newIdx is given it is resized to size and receives the position of each index in the result
+// (-1 for indices not kept). keep is called twice per index and needs to be thread safe
+template <typename KeepFn>
+std::vector<int> ParallelCompact(int size, KeepFn&& keep, std::vector<int>* newIdx = nullptr) {
+  const int minChunk = 4096;
+  const int numChunks = std::max(1, std::min(size / minChunk, 4 * NumThreads()));
+
+  // count kept indices per chunk, then turn the counts into chunk offsets
+  std::vector<int> chunkOffset(numChunks + 1, 0);
+  ParallelTasks(numChunks, [&](int chunkIdx) {
+    auto [lo, hi] = ChunkRange(0, size, numChunks, chunkIdx);
+    int count = 0;
+    for(int idx = lo; idx < hi; idx++) {
+      count += keep(idx) ? 1 : 0;
+    }
+    chunkOffset[chunkIdx + 1] = count;
+  });
+  for(int chunkIdx = 0; chunkIdx < numChunks; chunkIdx++) {
+    chunkOffset[chunkIdx + 1] += chunkOffset[chunkIdx];
+  }
+
+  std::vector<int> kept(chunkOffset[numChunks]);
+  if(newIdx) {
+    newIdx->resize(size);
+  }
+  ParallelTasks(numChunks, [&](int chunkIdx) {
+    auto [lo, hi] = ChunkRange(0, size, numChunks, chunkIdx);
+    int pos = chunkOffset[chunkIdx];
+    for(int idx = lo; idx < hi; idx++) {
+      const bool isKept = keep(idx);
+      if(newIdx) {
+        (*newIdx)[idx] = isKept ? pos : -1;
+      }
+      if(isKept) {
+        kept[pos++] = idx;
+      }
+    }
+  });
+  return kept;
+}
@@ -0,0 +1,228 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+#include "SpatialIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+
+#include "ParallelFor.h"
+
+namespace {
+double cross(Point a, Point b, Point p) {
+  auto [ax, ay] = a;
+  auto [bx, by] = b;
+  auto [px, py] = p;
+  return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+}
+
+bool triangleContains(const std::array<Point, 3>& t, Point p) {
+  // relative to twice the area of the triangle, such that the tolerance does not depend on the
+  // scale of the mesh
+  const double tol = 1e-12 * fabs(cross(t[0], t[1], t[2]));
+  const double d0 = cross(t[0], t[1], p);
+  const double d1 = cross(t[1], t[2], p);
+  const double d2 = cross(t[2], t[0], p);
+  return (d0 >= -tol && d1 >= -tol && d2 >= -tol) || (d0 <= tol && d1 <= tol && d2 <= tol);
+}
+} // namespace
+
+SpatialIndex::SpatialIndex(std::vector<std::array<Point, 3>> triangles, int trianglesPerBucket)
+    : triangles_(std::move(triangles)), boxes_(triangles_.size()) {
+  const int numTriangles = triangles_.size();
+  ParallelFor(0, numTriangles, [&](int triangleIdx) {
+    const auto& t = triangles_[triangleIdx];
+    auto& box = boxes_[triangleIdx];
+    box = {std::get<0>(t[0]), std::get<1>(t[0]), std::get<0>(t[0]), std::get<1>(t[0])};
+    for(int cornerIdx = 1; cornerIdx < 3; cornerIdx++) {
+      auto [x, y] = t[cornerIdx];
+      box = {fmin(box[0], x), fmin(box[1], y), fmax(box[2], x), fmax(box[3], y)};
+    }
+  });
+
+  // bounding box of all triangles, reduced per chunk
+  const int numChunks = std::max(1, std::min(numTriangles / 4096, 4 * NumThreads()));
+  const double inf = std::numeric_limits<double>::infinity();
+  std::vector<std::array<double, 4>> chunkBounds(numChunks, {inf, inf, -inf, -inf});
+  ParallelTasks(numChunks, [&](int chunkIdx) {
+    auto [lo, hi] = ChunkRange(0, numTriangles, numChunks, chunkIdx);
+    auto& bounds = chunkBounds[chunkIdx];
+    for(int triangleIdx = lo; triangleIdx < hi; triangleIdx++) {
+      const auto& box = boxes_[triangleIdx];
+      bounds = {fmin(bounds[0], box[0]), fmin(bounds[1], box[1]), fmax(bounds[2], box[2]),
+                fmax(bounds[3], box[3])};
+    }
+  });
+  std::array<double, 4> bounds = chunkBounds[0];
+  for(const auto& chunk : chunkBounds) {
+    bounds = {fmin(bounds[0], chunk[0]), fmin(bounds[1], chunk[1]), fmax(bounds[2], chunk[2]),
+              fmax(bounds[3], chunk[3])};
+  }
+  if(numTriangles == 0) {
+    bounds = {0., 0., 0., 0.};
+  }
+
+  // choose the number of buckets per direction such that buckets are roughly square
+  const double lX = bounds[2] - bounds[0];
+  const double lY = bounds[3] - bounds[1];
+  const int targetBuckets = std::max(1, numTriangles / std::max(1, trianglesPerBucket));
+  if(lX > 0. && lY > 0.) {
+    numBucketsX_ = std::clamp(int(sqrt(targetBuckets * lX / lY)), 1, targetBuckets);
+    numBucketsY_ = std::max(1, targetBuckets / numBucketsX_);
+  } else if(lX > 0.) {
+    numBucketsX_ = targetBuckets;
+  } else if(lY > 0.) {
+    numBucketsY_ = targetBuckets;
+  }
+  xLo_ = bounds[0];
+  yLo_ = bounds[1];
+  bucketSizeX_ = lX > 0. ? lX / numBucketsX_ : 1.;
+  bucketSizeY_ = lY > 0. ? lY / numBucketsY_ : 1.;
+
+  // count the triangles per bucket, turn the counts into offsets and fill the buckets. the order
+  // within a bucket depends on the scheduling, hence the buckets are sorted afterwards
+  const int numBuckets = numBucketsX_ * numBucketsY_;
+  std::vector<std::atomic<int>> count(numBuckets);
+  auto forBuckets = [&](int triangleIdx, auto&& fn) {
+    const auto& box = boxes_[triangleIdx];
+    auto [iLo, iHi] = bucketRangeX(box[0], box[2]);
+    auto [jLo, jHi] = bucketRangeY(box[1], box[3]);
+    for(int j = jLo; j <= jHi; j++) {
+      for(int i = iLo; i <= iHi; i++) {
+        fn(j * numBucketsX_ + i);
+      }
+    }
+  };
+  ParallelFor(0, numTriangles, [&](int triangleIdx) {
+    forBuckets(triangleIdx, [&](int bucketIdx) { count[bucketIdx]++; });
+  });
+  bucketStart_.resize(numBuckets + 1);
+  bucketStart_[0] = 0;
+  for(int bucketIdx = 0; bucketIdx < numBuckets; bucketIdx++) {
+    bucketStart_[bucketIdx + 1] = bucketStart_[bucketIdx] + count[bucketIdx];
+    count[bucketIdx] = bucketStart_[bucketIdx];
+  }
+  bucketTriangles_.resize(bucketStart_[numBuckets]);
+  ParallelFor(0, numTriangles, [&](int triangleIdx) {
+    forBuckets(triangleIdx,
+               [&](int bucketIdx) { bucketTriangles_[count[bucketIdx]++] = triangleIdx; });
+  });
+  ParallelFor(
+      0, numBuckets,
+      [&](int bucketIdx) {
+        std::sort(bucketTriangles_.begin() + bucketStart_[bucketIdx],
+                  bucketTriangles_.begin() + bucketStart_[bucketIdx + 1]);
+      },
+      256);
+}
+
+std::array<int, 2> SpatialIndex::bucketRangeX(double lo, double hi) const {
+  auto bucket = [&](double x) {
+    return int(std::clamp(floor((x - xLo_) / bucketSizeX_), 0., double(numBucketsX_ - 1)));
+  };
+  return {bucket(lo), bucket(hi)};
+}
+
+std::array<int, 2> SpatialIndex::bucketRangeY(double lo, double hi) const {
+  auto bucket = [&](double y) {
+    return int(std::clamp(floor((y - yLo_) / bucketSizeY_), 0., double(numBucketsY_ - 1)));
+  };
+  return {bucket(lo), bucket(hi)};
+}
+
+template <typename Fn>
+void SpatialIndex::visitBuckets(Point lo, Point hi, Fn&& fn) const {
+  auto [iLo, iHi] = bucketRangeX(std::get<0>(lo), std::get<0>(hi));
+  auto [jLo, jHi] = bucketRangeY(std::get<1>(lo), std::get<1>(hi));
+  for(int j = jLo; j <= jHi; j++) {
+    for(int i = iLo; i <= iHi; i++) {
+      const int bucketIdx = j * numBucketsX_ + i;
+      for(int pos = bucketStart_[bucketIdx]; pos < bucketStart_[bucketIdx + 1]; pos++) {
+        fn(bucketTriangles_[pos]);
+      }
+    }
+  }
+}
+
+std::vector<int> SpatialIndex::trianglesInBox(Point lo, Point hi) const {
+  auto [xLo, yLo] = lo;
+  auto [xHi, yHi] = hi;
+  std::vector<int> result;
+  if(xLo > xHi || yLo > yHi) {
+    return result;
+  }
+  visitBuckets(lo, hi, [&](int triangleIdx) {
+    const auto& box = boxes_[triangleIdx];
+    if(box[0] <= xHi && box[2] >= xLo && box[1] <= yHi && box[3] >= yLo) {
+      result.push_back(triangleIdx);
+    }
+  });
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+  return result;
+}
+
+std::vector<int> SpatialIndex::trianglesWithCornerInBox(Point lo, Point hi) const {
+  auto [xLo, yLo] = lo;
+  auto [xHi, yHi] = hi;
+  auto inBox = [&](Point p) {
+    auto [x, y] = p;
+    return x > xLo && y > yLo && x < xHi && y < yHi;
+  };
+  std::vector<int> result;
+  for(int triangleIdx : trianglesInBox(lo, hi)) {
+    const auto& t = triangles_[triangleIdx];
+    if(inBox(t[0]) || inBox(t[1]) || inBox(t[2])) {
+      result.push_back(triangleIdx);
+    }
+  }
+  return result;
+}
+
+int SpatialIndex::locate(Point p) const {
+  // triangles are sorted within the bucket, the first hit is the lowest index
+  int found = -1;
+  visitBuckets(p, p, [&](int triangleIdx) {
+    if(found == -1 && triangleContains(triangles_[triangleIdx], p)) {
+      found = triangleIdx;
+    }
+  });
+  return found;
+}
+
+SpatialIndex AtlasSpatialIndex(const atlas::Mesh& mesh, const AtlasToCartesian& wrapper,
+                               int trianglesPerBucket) {
+  const atlas::mesh::HybridElements::Connectivity& cellToNode = mesh.cells().node_connectivity();
+  std::vector<std::array<Point, 3>> triangles(mesh.cells().size());
+  ParallelFor(0, mesh.cells().size(), [&](int cellIdx) {
+    for(int cornerIdx = 0; cornerIdx < 3; cornerIdx++) {
+      triangles[cellIdx][cornerIdx] = wrapper.nodeLocation(cellToNode(cellIdx, cornerIdx));
+    }
+  });
+  return SpatialIndex(std::move(triangles), trianglesPerBucket);
+}
+
+SpatialIndex ToylibSpatialIndex(const toylib::Grid& grid, int trianglesPerBucket) {
+  const auto& faces = grid.faces();
+  std::vector<std::array<Point, 3>> triangles(faces.size());
+  ParallelFor(0, faces.size(), [&](int faceIdx) {
+    for(int cornerIdx = 0; cornerIdx < 3; cornerIdx++) {
+      const toylib::Vertex& v = faces[faceIdx].vertex(cornerIdx);
+      triangles[faceIdx][cornerIdx] = {v.x(), v.y()};
+    }
+  });
+  return SpatialIndex(std::move(triangles), trianglesPerBucket);
+}
@@ -0,0 +1,91 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Spatial index over the triangles of a planar mesh, for queries like "which cells lie in this
+// box" or "which cell contains this point" without visiting every cell of the mesh.
+//
+// The index is a uniform grid of buckets over the bounding box of all triangles. Each bucket lists
+// the triangles whose bounding box overlaps it, so a query only tests the triangles listed in the
+// buckets it touches. The grid is sized such that a bucket holds about trianglesPerBucket
+// triangles on average, which keeps the expected cost of a point location constant and the cost
+// of a box query proportional to the size of the result (for meshes with roughly uniform triangle
+// sizes). The index is built in parallel (ParallelFor.h).
+//
+// AtlasSpatialIndex and ToylibSpatialIndex build the index for the cells of an atlas mesh (using
+// the coordinates of an AtlasToCartesian wrapper) and of a toylib grid. Triangle indices returned
+// by the queries are cell indices of the mesh respectively face indices of the grid.
+//
+// NOTE: the triangles of periodic toylib grids which wrap around the domain are indexed using the
+// coordinates of their vertices as they are, i.e. they span the whole domain
+
+#pragma once
+
+#include <array>
+#include <vector>
+
+#include <atlas/mesh.h>
+
+#include "../libs/toylib.hpp"
+#include "AtlasCartesianWrapper.h"
+
+class SpatialIndex {
+public:
+  // triangles are given by the coordinates of their three corners
+  explicit SpatialIndex(std::vector<std::array<Point, 3>> triangles, int trianglesPerBucket = 2);
+
+  int size() const { return triangles_.size(); }
+  const std::array<Point, 3>& triangle(int triangleIdx) const { return triangles_[triangleIdx]; }
+
+  // triangles whose bounding box intersects the box [lo, hi] (bounds included), in ascending order.
+  // the bounds may be infinite
+  std::vector<int> trianglesInBox(Point lo, Point hi) const;
+
+  // triangles with at least one corner strictly inside the box (lo, hi), in ascending order. this
+  // is the criterion used to crop meshes (see GenerateRectAtlasMesh and AtlasProjectMesh)
+  std::vector<int> trianglesWithCornerInBox(Point lo, Point hi) const;
+
+  // the triangle containing p (boundaries included, up to a small tolerance), -1 if p is not
+  // covered by any triangle. if several triangles contain p (p on a shared edge or node) the one
+  // with the lowest index is returned
+  int locate(Point p) const;
+
+private:
+  // bucket range [lo, hi] (inclusive) overlapped by a coordinate range
+  std::array<int, 2> bucketRangeX(double lo, double hi) const;
+  std::array<int, 2> bucketRangeY(double lo, double hi) const;
+
+  // calls fn(triangleIdx) for all triangles listed in the buckets overlapping [lo, hi]. triangles
+  // overlapping several of these buckets are visited several times
+  template <typename Fn>
+  void visitBuckets(Point lo, Point hi, Fn&& fn) const;
+
+  std::vector<std::array<Point, 3>> triangles_;
+  // bounding box of every triangle: xMin, yMin, xMax, yMax
+  std::vector<std::array<double, 4>> boxes_;
+
+  double xLo_ = 0.;
+  double yLo_ = 0.;
+  double bucketSizeX_ = 1.;
+  double bucketSizeY_ = 1.;
+  int numBucketsX_ = 1;
+  int numBucketsY_ = 1;
+  // triangles of bucket (i, j) are bucketTriangles_[bucketStart_[b]..bucketStart_[b + 1]), with
+  // b = j * numBucketsX_ + i, in ascending order
+  std::vector<int> bucketStart_;
+  std::vector<int> bucketTriangles_;
+};
+
+SpatialIndex AtlasSpatialIndex(const atlas::Mesh& mesh, const AtlasToCartesian& wrapper,
+                               int trianglesPerBucket = 2);
+SpatialIndex ToylibSpatialIndex(const toylib::Grid& grid, int trianglesPerBucket = 2);
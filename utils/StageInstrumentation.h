@@ -0,0 +1,347 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Per stage instrumentation of stencils and drivers. A stage is a statement (typically one loop
+// over the mesh) prefixed by INSTRUMENT_STAGE:
+//
+//    INSTRUMENT_STAGE("laplacian/rot_vec")
+//    for(auto const& loc : getVertices(LibTag{}, m_mesh)) {
+//      INSTRUMENT_ELEMENTS(1);
+//      ...
+//    }
+//
+// For each stage name, the number of calls, the elements processed (as reported using
+// INSTRUMENT_ELEMENTS) and the wall time (total, min, max) are aggregated over all calls and
+// threads. INSTRUMENT_REPORT(traceFile) prints the aggregated table and writes every call as a
+// Chrome trace event (load in chrome://tracing or https://ui.perfetto.dev).
+//
+// If the environment variable ATLAS_UTILS_PERF_COUNTERS is set, cycles, instructions and last
+// level cache misses of the calling thread are recorded as well using perf_event_open (Linux
+// only, subject to /proc/sys/kernel/perf_event_paranoid). Counters which cannot be opened are
+// reported as unavailable.
+//
+// Independent of the macros, the calling thread carries the label of the innermost stage it is in
+// (StageLabel, set by every stage and by the benchmark suite for each benchmark). It is used to
+// attribute allocations to stages, see benchmarks/AllocationHook.cpp.
+//
+// The macros expand to nothing unless ATLAS_UTILS_INSTRUMENT is defined (cmake option
+// -DATLAS_UTILS_INSTRUMENT=ON), i.e. instrumentation has no cost if switched off. The hooks may be
+// used in headers included by targets not linking atlasUtilsLib, hence everything is inline.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef ATLAS_UTILS_INSTRUMENT
+#define INSTRUMENT_STAGE(name) if(StageScope instrumentStage_(name); true)
+#define INSTRUMENT_ELEMENTS(n) instrumentStage_.addElements(n)
+#define INSTRUMENT_REPORT(traceFile) StageReport(traceFile)
+#else
+#define INSTRUMENT_STAGE(name)
+#define INSTRUMENT_ELEMENTS(n)
+#define INSTRUMENT_REPORT(traceFile)
+#endif
+
+// label of the innermost stage of the calling thread, nullptr outside of any stage
+inline const char*& CurrentStageLabel() {
+  thread_local const char* label = nullptr;
+  return label;
+}
+
+// sets the stage label of the calling thread for its lifetime. label needs to outlive the object
+class StageLabel {
+public:
+  explicit StageLabel(const char* label) : previous_(CurrentStageLabel()) {
+    CurrentStageLabel() = label;
+  }
+  ~StageLabel() { CurrentStageLabel() = previous_; }
+  StageLabel(const StageLabel&) = delete;
+
+private:
+  const char* previous_;
+};
+
+// hardware counters of the calling thread: cycles, instructions, last level cache misses
+class StagePerfCounters {
+public:
+  static constexpr int numCounters = 3;
+
+  // counters of the calling thread, opened on first use
+  static StagePerfCounters& threadCounters() {
+    thread_local StagePerfCounters counters;
+    return counters;
+  }
+  static bool requested() {
+    static const bool requested = std::getenv("ATLAS_UTILS_PERF_COUNTERS") != nullptr;
+    return requested;
+  }
+
+  // current counter values, -1 for counters not available
+  void read(long long values[numCounters]) const {
+    for(int counterIdx = 0; counterIdx < numCounters; counterIdx++) {
+      values[counterIdx] = -1;
+#ifdef __linux__
+      long long value = 0;
+      if(fd_[counterIdx] >= 0 && ::read(fd_[counterIdx], &value, sizeof(value)) == sizeof(value)) {
+        values[counterIdx] = value;
+      }
+#endif
+    }
+  }
+
+  StagePerfCounters(const StagePerfCounters&) = delete;
+  ~StagePerfCounters() {
+#ifdef __linux__
+    for(int fd : fd_) {
+      if(fd >= 0) {
+        close(fd);
+      }
+    }
+#endif
+  }
+
+private:
+  StagePerfCounters() {
+#ifdef __linux__
+    if(!requested()) {
+      return;
+    }
+    const unsigned long long configs[numCounters] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES};
+    for(int counterIdx = 0; counterIdx < numCounters; counterIdx++) {
+      perf_event_attr attr{};
+      attr.size = sizeof(attr);
+      attr.type = PERF_TYPE_HARDWARE;
+      attr.config = configs[counterIdx];
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      // this thread, any cpu
+      fd_[counterIdx] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+#endif
+  }
+
+  int fd_[numCounters] = {-1, -1, -1};
+};
+
+// aggregated statistics of all calls of one stage
+struct StageStats {
+  std::string name;
+  long calls = 0;
+  long elements = 0;
+  double totalTime = 0.;
+  double minTime = 0.;
+  double maxTime = 0.;
+  // sums of the counter deltas, -1 if unavailable in any call
+  long long counters[StagePerfCounters::numCounters] = {0, 0, 0};
+};
+
+class StageRegistry {
+public:
+  // at most this many calls are kept for the trace, the statistics include all calls
+  static constexpr int maxTraceEvents = 1 << 20;
+
+  static StageRegistry& instance() {
+    static StageRegistry registry;
+    return registry;
+  }
+
+  // seconds since the registry was created
+  double now() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+  }
+
+  void record(const char* name, double start, double end, long elements,
+              const long long counterDeltas[StagePerfCounters::numCounters]) {
+    thread_local const int threadIdx = nextThreadIdx_++;
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto [it, inserted] = index_.try_emplace(name, int(stats_.size()));
+    if(inserted) {
+      stats_.emplace_back();
+      stats_.back().name = name;
+    }
+    StageStats& stats = stats_[it->second];
+    const double time = end - start;
+    stats.minTime = stats.calls == 0 ? time : std::min(stats.minTime, time);
+    stats.maxTime = std::max(stats.maxTime, time);
+    stats.calls++;
+    stats.elements += elements;
+    stats.totalTime += time;
+    for(int counterIdx = 0; counterIdx < StagePerfCounters::numCounters; counterIdx++) {
+      if(counterDeltas[counterIdx] < 0 || stats.counters[counterIdx] < 0) {
+        stats.counters[counterIdx] = -1;
+      } else {
+        stats.counters[counterIdx] += counterDeltas[counterIdx];
+      }
+    }
+    if(events_.size() < maxTraceEvents) {
+      events_.push_back({it->second, threadIdx, start, time, elements});
+    } else {
+      droppedEvents_++;
+    }
+  }
+
+  // statistics in order of the first call of each stage
+  std::vector<StageStats> stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+  }
+
+  void printTable(FILE* fp) const {
+    std::vector<StageStats> stats = this->stats();
+    if(stats.empty()) {
+      return;
+    }
+    const bool withCounters = StagePerfCounters::requested();
+    fprintf(fp, "%-32s %8s %12s %12s %10s %10s %10s %10s", "stage", "calls", "elements",
+            "total [ms]", "mean [us]", "min [us]", "max [us]", "ns/elem");
+    if(withCounters) {
+      fprintf(fp, " %10s %6s %12s", "cyc/elem", "IPC", "LLCmiss/elem");
+    }
+    fprintf(fp, "\n");
+    for(const StageStats& s : stats) {
+      const double perElement = s.elements > 0 ? 1e9 * s.totalTime / s.elements : 0.;
+      fprintf(fp, "%-32s %8ld %12ld %12.3f %10.1f %10.1f %10.1f %10.2f", s.name.c_str(), s.calls,
+              s.elements, 1e3 * s.totalTime, 1e6 * s.totalTime / s.calls, 1e6 * s.minTime,
+              1e6 * s.maxTime, perElement);
+      if(withCounters) {
+        // per element rates, n/a if the counter is unavailable
+        const double elements = std::max(1L, s.elements);
+        char cycles[32] = "n/a", ipc[32] = "n/a", misses[32] = "n/a";
+        if(s.counters[0] >= 0) {
+          snprintf(cycles, sizeof(cycles), "%.1f", s.counters[0] / elements);
+        }
+        if(s.counters[0] > 0 && s.counters[1] >= 0) {
+          snprintf(ipc, sizeof(ipc), "%.2f", double(s.counters[1]) / s.counters[0]);
+        }
+        if(s.counters[2] >= 0) {
+          snprintf(misses, sizeof(misses), "%.3f", s.counters[2] / elements);
+        }
+        fprintf(fp, " %10s %6s %12s", cycles, ipc, misses);
+      }
+      fprintf(fp, "\n");
+    }
+    if(droppedEvents_ > 0) {
+      fprintf(fp, "%ld calls not included in the trace (limit %d)\n", droppedEvents_,
+              maxTraceEvents);
+    }
+  }
+
+  // writes all recorded calls as complete events ("ph": "X") of the Chrome trace event format.
+  // returns false if the file could not be written
+  bool writeChromeTrace(const std::string& filename) const {
+    FILE* fp = fopen(filename.c_str(), "w");
+    if(!fp) {
+      return false;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    fprintf(fp, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    for(size_t eventIdx = 0; eventIdx < events_.size(); eventIdx++) {
+      const Event& e = events_[eventIdx];
+      fprintf(fp,
+              "%s\n{\"name\": \"%s\", \"cat\": \"stage\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, "
+              "\"ts\": %.3f, \"dur\": %.3f, \"args\": {\"elements\": %ld}}",
+              eventIdx == 0 ? "" : ",", stats_[e.stageIdx].name.c_str(), e.threadIdx,
+              1e6 * e.start, 1e6 * e.duration, e.elements);
+    }
+    fprintf(fp, "\n]}\n");
+    return fclose(fp) == 0;
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    stats_.clear();
+    events_.clear();
+    droppedEvents_ = 0;
+  }
+
+private:
+  StageRegistry() = default;
+
+  struct Event {
+    int stageIdx;
+    int threadIdx;
+    double start;
+    double duration;
+    long elements;
+  };
+
+  const std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+  std::atomic<int> nextThreadIdx_{0};
+  mutable std::mutex mutex_;
+  std::unordered_map<std::string, int> index_;
+  std::vector<StageStats> stats_;
+  std::vector<Event> events_;
+  long droppedEvents_ = 0;
+};
+
+// records the time (and hardware counters) between its construction and destruction as one call
+// of the stage name. name needs to outlive the scope, usually it is a string literal. The stage
+// label is only set in between, s.t. allocations made by the bookkeeping itself (opening the
+// counters, recording the call) are not attributed to the stage
+class StageScope {
+public:
+  explicit StageScope(const char* name) : name_(name) {
+    StagePerfCounters::threadCounters().read(counters_);
+    StageRegistry& registry = StageRegistry::instance();
+    label_.emplace(name);
+    start_ = registry.now();
+  }
+  ~StageScope() {
+    const double end = StageRegistry::instance().now();
+    long long counters[StagePerfCounters::numCounters];
+    StagePerfCounters::threadCounters().read(counters);
+    label_.reset();
+    for(int counterIdx = 0; counterIdx < StagePerfCounters::numCounters; counterIdx++) {
+      counters[counterIdx] = (counters[counterIdx] < 0 || counters_[counterIdx] < 0)
+                                 ? -1
+                                 : counters[counterIdx] - counters_[counterIdx];
+    }
+    StageRegistry::instance().record(name_, start_, end, elements_, counters);
+  }
+  StageScope(const StageScope&) = delete;
+
+  void addElements(long n) { elements_ += n; }
+
+private:
+  const char* name_;
+  std::optional<StageLabel> label_;
+  double start_ = 0.;
+  long elements_ = 0;
+  long long counters_[StagePerfCounters::numCounters];
+};
+
+// prints the table of all stages to stdout and writes the trace to traceFile (if not empty)
+inline void StageReport(const std::string& traceFile) {
+  StageRegistry::instance().printTable(stdout);
+  if(!traceFile.empty() && !StageRegistry::instance().writeChromeTrace(traceFile)) {
+    printf("could not write stage trace %s\n", traceFile.c_str());
+  }
+}
@@ -157,3 +157,25 @@ std::vector<toylib::Vertex> innerNodes(const toylib::Grid& m) {
   }
   return innerVertices;
 }
+
+std::vector<char> innerCellsMask(const toylib::Grid& m) {
+  std::vector<char> mask(m.faces().size(), 0);
+  for(const auto& f : innerCells(m)) {
+    mask[f.id()] = 1;
+  }
+  return mask;
+}
+std::vector<char> innerEdgesMask(const toylib::Grid& m) {
+  std::vector<char> mask(m.edges().size(), 0);
+  for(const auto& e : innerEdges(m)) {
+    mask[e.id()] = 1;
+  }
+  return mask;
+}
+std::vector<char> innerNodesMask(const toylib::Grid& m) {
+  std::vector<char> mask(m.vertices().size(), 0);
+  for(const auto& v : innerNodes(m)) {
+    mask[v.id()] = 1;
+  }
+  return mask;
+}
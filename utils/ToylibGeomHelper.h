@@ -17,6 +17,7 @@
 #include "../libs/toylib.hpp"
 
 #include <tuple>
+#include <vector>
 
 std::tuple<double, double> EdgeMidpoint(const toylib::Edge& e);
 std::tuple<double, double> CellCircumcenter(const toylib::Face& c);
@@ -32,4 +33,9 @@ double TangentOrientation(const toylib::Edge& e);
 
 std::vector<toylib::Face> innerCells(const toylib::Grid& m);
 std::vector<toylib::Edge> innerEdges(const toylib::Grid& m);
-std::vector<toylib::Vertex> innerNodes(const toylib::Grid& m);
\ No newline at end of file
+std::vector<toylib::Vertex> innerNodes(const toylib::Grid& m);
+
+// same selection as above as one entry per element id (1 for inner elements, 0 otherwise)
+std::vector<char> innerCellsMask(const toylib::Grid& m);
+std::vector<char> innerEdgesMask(const toylib::Grid& m);
+std::vector<char> innerNodesMask(const toylib::Grid& m);
\ No newline at end of file
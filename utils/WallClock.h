@@ -0,0 +1,30 @@
+//===--------------------------------------------------------------------------------*- C++ -*-===//
+//                          _
+//                         | |
+//                       __| | __ ___      ___ ___
+//                      / _` |/ _` \ \ /\ / / '_  |
+//                     | (_| | (_| |\ V  V /| | | |
+//                      \__,_|\__,_| \_/\_/ |_| |_| - Compiler Toolchain
+//
+//
+//  This file is distributed under the MIT License (MIT).
+//  See LICENSE.txt for details.
+//
+//===------------------------------------------------------------------------------------------===//
+
+// Wall clock used for all timings in this repository (drivers, benchmarks, tests):
+//
+//    auto start = Clock::now();
+//    ...
+//    double time = SecondsSince(start);
+
+#pragma once
+
+#include <chrono>
+
+using Clock = std::chrono::steady_clock;
+
+// seconds elapsed since start
+inline double SecondsSince(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}